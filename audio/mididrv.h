@@ -196,7 +196,13 @@ public:
 		PROP_OLD_ADLIB = 2,
 		PROP_CHANNEL_MASK = 3,
 		// HACK: Not so nice, but our SCUMM AdLib code is in audio/
-		PROP_SCUMM_OPL3 = 4
+		PROP_SCUMM_OPL3 = 4,
+		// Emulated drivers only: start caching the rendered output of the
+		// track identified by param (non-zero), see MidiDriver_Emulated.
+		PROP_RENDER_CACHE_BEGIN = 5,
+		// Emulated drivers only: the cached track has ended. param is 1 if
+		// it played through to the end, 0 if it was interrupted.
+		PROP_RENDER_CACHE_END = 6
 	};
 
 	/**
@@ -34,7 +34,8 @@ MidiPlayer::MidiPlayer() :
 	_isLooping(false),
 	_isPlaying(false),
 	_masterVolume(0),
-	_nativeMT32(false) {
+	_nativeMT32(false),
+	_renderCacheKey(0) {
 
 	memset(_channelsTable, 0, sizeof(_channelsTable));
 	memset(_channelsVolume, 127, sizeof(_channelsVolume));
@@ -134,10 +135,37 @@ void MidiPlayer::metaEvent(byte type, byte *data, uint16 length) {
 	}
 }
 
+void MidiPlayer::beginRenderCache(const byte *data, uint32 size) {
+	// FNV-1a, the key only needs to tell the tracks of a game apart
+	uint32 key = 2166136261u;
+	for (uint32 i = 0; i < size; ++i)
+		key = (key ^ data[i]) * 16777619;
+
+	// Zero means no track
+	_renderCacheKey = key ? key : 1;
+	sendRenderCacheBegin();
+}
+
+void MidiPlayer::sendRenderCacheBegin() {
+	if (!_driver)
+		return;
+
+	// The master volume is applied to the events, so it is part of the key
+	uint32 key = (_renderCacheKey ^ _masterVolume) * 16777619;
+	if (!key)
+		key = 1;
+	_driver->property(MidiDriver::PROP_RENDER_CACHE_BEGIN, key);
+}
+
 void MidiPlayer::endOfTrack() {
+	if (_renderCacheKey && _driver)
+		_driver->property(MidiDriver::PROP_RENDER_CACHE_END, 1);
+
 	if (_isLooping) {
 		assert(_parser);
 		_parser->jumpToTick(0);
+		if (_renderCacheKey)
+			sendRenderCacheBegin();
 	} else
 		stop();
 }
@@ -163,6 +191,12 @@ void MidiPlayer::stop() {
 	Common::StackLock lock(_mutex);
 
 	_isPlaying = false;
+	if (_renderCacheKey) {
+		if (_driver)
+			_driver->property(MidiDriver::PROP_RENDER_CACHE_END, 0);
+		_renderCacheKey = 0;
+	}
+
 	if (_parser) {
 		_parser->unloadMusic();
 
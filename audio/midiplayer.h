@@ -141,6 +141,17 @@ protected:
 
 	void createDriver(int flags = MDT_MIDI | MDT_ADLIB | MDT_PREFER_GM);
 
+	/**
+	 * Lets an emulated driver cache the rendered output of the track which
+	 * is about to be played, see MidiDriver::PROP_RENDER_CACHE_BEGIN. To be
+	 * called after the parser has been set up, with the track data. The
+	 * cache is finished by endOfTrack() and abandoned by stop().
+	 */
+	void beginRenderCache(const byte *data, uint32 size);
+
+private:
+	void sendRenderCacheBegin();
+
 protected:
 	enum {
 		/**
@@ -180,6 +191,9 @@ protected:
 	int _masterVolume;	// FIXME: byte or int ?
 
 	bool _nativeMT32;
+
+	/** Hash of the track being cached by the driver, or 0. */
+	uint32 _renderCacheKey;
 };
 
 
@@ -51,8 +51,10 @@ MODULE_OBJS := \
 	softsynth/fmtowns_pc98/towns_pc98_fmsynth.o \
 	softsynth/fmtowns_pc98/towns_pc98_plugins.o \
 	softsynth/appleiigs.o \
+	softsynth/emumidi.o \
 	softsynth/fluidsynth.o \
 	softsynth/mt32.o \
+	softsynth/mt32_eventqueue.o \
 	softsynth/eas.o \
 	softsynth/pcspk.o \
 	softsynth/sid.o \
@@ -63,10 +65,10 @@ MODULE_OBJS += \
 	alsa_opl.o
 endif
 
-ifndef USE_ARM_SOUND_ASM
 MODULE_OBJS += \
 	rate.o
-else
+
+ifdef USE_ARM_SOUND_ASM
 MODULE_OBJS += \
 	rate_arm.o \
 	rate_arm_asm.o
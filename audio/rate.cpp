@@ -35,8 +35,23 @@
 #include "common/textconsole.h"
 #include "common/util.h"
 
+#if !defined(OUTPUT_UNSIGNED_AUDIO)
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define RATE_SIMD_SSE2
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define RATE_SIMD_NEON
+#endif
+#endif
+
 namespace Audio {
 
+#ifdef USE_ARM_SOUND_ASM
+// Implemented in rate_arm.cpp
+RateConverter *makeARMRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo);
+#endif
+
 
 /**
  * The size of the intermediate input cache. Bigger values may increase
@@ -57,6 +72,170 @@ enum {
 	FRAC_HALF_LOW = (1L << (FRAC_BITS_LOW-1))
 };
 
+/**
+ * Volumes range from 0 to Mixer::kMaxMixerVolume (256), so applying one is
+ * a multiply and a shift. Unlike a divide the shift rounds towards negative
+ * infinity, negative samples may come out one step lower.
+ */
+enum {
+	VOLUME_SHIFT = 8
+};
+
+/**
+ * Number of sample pairs the resampling converters produce before handing
+ * them to the mixing kernel.
+ */
+#define MIX_BLOCK_SIZE 256
+
+/**
+ * Mixing kernel: scales 'frames' sample pairs (or mono samples) from 'in'
+ * by the channel volumes and adds them with saturation to the sample pairs
+ * in 'obuf'.
+ */
+typedef void (*MixProc)(st_sample_t *obuf, const st_sample_t *in, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r);
+
+template<bool stereo, bool reverseStereo>
+static void mixGeneric(st_sample_t *obuf, const st_sample_t *in, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+	for (; frames > 0; frames--) {
+		st_sample_t out0, out1;
+		out0 = *in++;
+		out1 = (stereo ? *in++ : out0);
+
+		// output left channel
+		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) >> VOLUME_SHIFT);
+
+		// output right channel
+		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) >> VOLUME_SHIFT);
+
+		obuf += 2;
+	}
+}
+
+#if defined(RATE_SIMD_SSE2)
+
+static inline __m128i scaleSSE2(__m128i x, __m128i vol) {
+	// Full 32 bit products, shifted and packed back with saturation
+	const __m128i lo = _mm_mullo_epi16(x, vol);
+	const __m128i hi = _mm_mulhi_epi16(x, vol);
+	return _mm_packs_epi32(_mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), VOLUME_SHIFT),
+	                       _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), VOLUME_SHIFT));
+}
+
+template<bool stereo, bool reverseStereo>
+static void mixSIMD(st_sample_t *obuf, const st_sample_t *in, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+	// Volumes in output order, for reversed stereo the input pairs get swapped
+	const int16 volOut0 = reverseStereo ? vol_r : vol_l;
+	const int16 volOut1 = reverseStereo ? vol_l : vol_r;
+	const __m128i vol = _mm_setr_epi16(volOut0, volOut1, volOut0, volOut1, volOut0, volOut1, volOut0, volOut1);
+
+	for (; frames >= 4; frames -= 4) {
+		__m128i x;
+		if (stereo) {
+			x = _mm_loadu_si128((const __m128i *)in);
+			if (reverseStereo)
+				x = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+			in += 8;
+		} else {
+			x = _mm_loadl_epi64((const __m128i *)in);
+			x = _mm_unpacklo_epi16(x, x);
+			in += 4;
+		}
+
+		_mm_storeu_si128((__m128i *)obuf, _mm_adds_epi16(_mm_loadu_si128((const __m128i *)obuf), scaleSSE2(x, vol)));
+		obuf += 8;
+	}
+
+	mixGeneric<stereo, reverseStereo>(obuf, in, frames, vol_l, vol_r);
+}
+
+#elif defined(RATE_SIMD_NEON)
+
+template<bool stereo, bool reverseStereo>
+static void mixSIMD(st_sample_t *obuf, const st_sample_t *in, st_size_t frames, st_volume_t vol_l, st_volume_t vol_r) {
+	// Volumes in output order, for reversed stereo the input pairs get swapped
+	const int16 volOut0 = reverseStereo ? vol_r : vol_l;
+	const int16 volOut1 = reverseStereo ? vol_l : vol_r;
+	const int16 volLanes[4] = { volOut0, volOut1, volOut0, volOut1 };
+	const int16x4_t vol = vld1_s16(volLanes);
+
+	for (; frames >= 4; frames -= 4) {
+		int16x8_t x;
+		if (stereo) {
+			x = vld1q_s16(in);
+			if (reverseStereo)
+				x = vrev32q_s16(x);
+			in += 8;
+		} else {
+			const int16x4_t m = vld1_s16(in);
+			const int16x4x2_t z = vzip_s16(m, m);
+			x = vcombine_s16(z.val[0], z.val[1]);
+			in += 4;
+		}
+
+		// Full 32 bit products, shifted and narrowed back with saturation
+		const int16x8_t scaled = vcombine_s16(vqshrn_n_s32(vmull_s16(vget_low_s16(x), vol), VOLUME_SHIFT),
+		                                      vqshrn_n_s32(vmull_s16(vget_high_s16(x), vol), VOLUME_SHIFT));
+		vst1q_s16(obuf, vqaddq_s16(vld1q_s16(obuf), scaled));
+		obuf += 8;
+	}
+
+	mixGeneric<stereo, reverseStereo>(obuf, in, frames, vol_l, vol_r);
+}
+
+#endif
+
+static RateConverterBackend getDefaultBackend() {
+#if defined(RATE_SIMD_SSE2) || defined(RATE_SIMD_NEON)
+	return kRateConverterSIMD;
+#else
+	return kRateConverterGeneric;
+#endif
+}
+
+static RateConverterBackend s_rateConverterBackend = getDefaultBackend();
+
+template<bool stereo, bool reverseStereo>
+static MixProc getMixProc() {
+#if defined(RATE_SIMD_SSE2) || defined(RATE_SIMD_NEON)
+	if (s_rateConverterBackend == kRateConverterSIMD)
+		return &mixSIMD<stereo, reverseStereo>;
+#endif
+	return &mixGeneric<stereo, reverseStereo>;
+}
+
+bool hasRateConverterBackend(RateConverterBackend backend) {
+	switch (backend) {
+	case kRateConverterGeneric:
+		return true;
+	case kRateConverterSIMD:
+#if defined(RATE_SIMD_SSE2) || defined(RATE_SIMD_NEON)
+		return true;
+#else
+		return false;
+#endif
+	case kRateConverterARM:
+#ifdef USE_ARM_SOUND_ASM
+		return true;
+#else
+		return false;
+#endif
+	default:
+		return false;
+	}
+}
+
+bool setRateConverterBackend(RateConverterBackend backend) {
+	if (!hasRateConverterBackend(backend))
+		return false;
+
+	s_rateConverterBackend = backend;
+	return true;
+}
+
+RateConverterBackend getRateConverterBackend() {
+	return s_rateConverterBackend;
+}
+
 /**
  * Audio rate converter based on simple resampling. Used when no
  * interpolation is required.
@@ -77,6 +256,8 @@ protected:
 	/** fractional position increment in the output stream */
 	long opos_inc;
 
+	MixProc _mix;
+
 public:
 	SimpleRateConverter(st_rate_t inrate, st_rate_t outrate);
 	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
@@ -105,6 +286,8 @@ SimpleRateConverter<stereo, reverseStereo>::SimpleRateConverter(st_rate_t inrate
 	opos_inc = inrate / outrate;
 
 	inLen = 0;
+
+	_mix = getMixProc<stereo, reverseStereo>();
 }
 
 /*
@@ -115,41 +298,45 @@ template<bool stereo, bool reverseStereo>
 int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 	st_sample_t *ostart, *oend;
 
+	st_sample_t block[MIX_BLOCK_SIZE * 2];
+
 	ostart = obuf;
 	oend = obuf + osamp * 2;
 
 	while (obuf < oend) {
+		// Pick the samples of a block, then mix it in one go
+		const st_size_t blockSize = MIN<st_size_t>((oend - obuf) / 2, MIX_BLOCK_SIZE);
+		st_sample_t *blockPtr = block;
+
+		for (st_size_t i = 0; i < blockSize; i++) {
+			// read enough input samples so that opos >= 0
+			do {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						_mix(obuf, block, i, vol_l, vol_r);
+						return (obuf - ostart) / 2 + i;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				opos--;
+				if (opos >= 0) {
+					inPtr += (stereo ? 2 : 1);
+				}
+			} while (opos >= 0);
+
+			*blockPtr++ = *inPtr++;
+			if (stereo)
+				*blockPtr++ = *inPtr++;
 
-		// read enough input samples so that opos >= 0
-		do {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
-			}
-			inLen -= (stereo ? 2 : 1);
-			opos--;
-			if (opos >= 0) {
-				inPtr += (stereo ? 2 : 1);
-			}
-		} while (opos >= 0);
-
-		st_sample_t out0, out1;
-		out0 = *inPtr++;
-		out1 = (stereo ? *inPtr++ : out0);
-
-		// Increment output position
-		opos += opos_inc;
-
-		// output left channel
-		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-		// output right channel
-		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+			// Increment output position
+			opos += opos_inc;
+		}
 
-		obuf += 2;
+		_mix(obuf, block, blockSize, vol_l, vol_r);
+		obuf += blockSize * 2;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -183,6 +370,8 @@ protected:
 	/** current sample(s) in the input stream (left/right channel) */
 	st_sample_t icur0, icur1;
 
+	MixProc _mix;
+
 public:
 	LinearRateConverter(st_rate_t inrate, st_rate_t outrate);
 	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
@@ -214,6 +403,8 @@ LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate
 	icur0 = icur1 = 0;
 
 	inLen = 0;
+
+	_mix = getMixProc<stereo, reverseStereo>();
 }
 
 /*
@@ -224,51 +415,55 @@ template<bool stereo, bool reverseStereo>
 int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 	st_sample_t *ostart, *oend;
 
+	st_sample_t block[MIX_BLOCK_SIZE * 2];
+
 	ostart = obuf;
 	oend = obuf + osamp * 2;
 
 	while (obuf < oend) {
-
-		// read enough input samples so that opos < 0
-		while ((frac_t)FRAC_ONE_LOW <= opos) {
-			// Check if we have to refill the buffer
-			if (inLen == 0) {
-				inPtr = inBuf;
-				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
-				if (inLen <= 0)
-					return (obuf - ostart) / 2;
+		// Interpolate a block, then mix it in one go
+		const st_size_t blockSize = MIN<st_size_t>((oend - obuf) / 2, MIX_BLOCK_SIZE);
+		st_sample_t *blockPtr = block;
+		st_size_t i = 0;
+
+		while (i < blockSize) {
+			// read enough input samples so that opos < 0
+			while ((frac_t)FRAC_ONE_LOW <= opos) {
+				// Check if we have to refill the buffer
+				if (inLen == 0) {
+					inPtr = inBuf;
+					inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
+					if (inLen <= 0) {
+						_mix(obuf, block, i, vol_l, vol_r);
+						return (obuf - ostart) / 2 + i;
+					}
+				}
+				inLen -= (stereo ? 2 : 1);
+				ilast0 = icur0;
+				icur0 = *inPtr++;
+				if (stereo) {
+					ilast1 = icur1;
+					icur1 = *inPtr++;
+				}
+				opos -= FRAC_ONE_LOW;
 			}
-			inLen -= (stereo ? 2 : 1);
-			ilast0 = icur0;
-			icur0 = *inPtr++;
-			if (stereo) {
-				ilast1 = icur1;
-				icur1 = *inPtr++;
+
+			// Loop as long as the outpos trails behind, and as long as there is
+			// still space in the block.
+			while (opos < (frac_t)FRAC_ONE_LOW && i < blockSize) {
+				// interpolate
+				*blockPtr++ = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
+				if (stereo)
+					*blockPtr++ = (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
+				i++;
+
+				// Increment output position
+				opos += opos_inc;
 			}
-			opos -= FRAC_ONE_LOW;
 		}
 
-		// Loop as long as the outpos trails behind, and as long as there is
-		// still space in the output buffer.
-		while (opos < (frac_t)FRAC_ONE_LOW && obuf < oend) {
-			// interpolate
-			st_sample_t out0, out1;
-			out0 = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
-			out1 = (stereo ?
-						  (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW)) :
-						  out0);
-
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
-
-			obuf += 2;
-
-			// Increment output position
-			opos += opos_inc;
-		}
+		_mix(obuf, block, blockSize, vol_l, vol_r);
+		obuf += blockSize * 2;
 	}
 	return (obuf - ostart) / 2;
 }
@@ -284,8 +479,9 @@ template<bool stereo, bool reverseStereo>
 class CopyRateConverter : public RateConverter {
 	st_sample_t *_buffer;
 	st_size_t _bufferSize;
+	MixProc _mix;
 public:
-	CopyRateConverter() : _buffer(0), _bufferSize(0) {}
+	CopyRateConverter() : _buffer(0), _bufferSize(0), _mix(getMixProc<stereo, reverseStereo>()) {}
 	~CopyRateConverter() {
 		free(_buffer);
 	}
@@ -293,11 +489,8 @@ public:
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 		assert(input.isStereo() == stereo);
 
-		st_sample_t *ptr;
 		st_size_t len;
 
-		st_sample_t *ostart = obuf;
-
 		if (stereo)
 			osamp *= 2;
 
@@ -315,21 +508,12 @@ public:
 		len = input.readBuffer(_buffer, osamp);
 
 		// Mix the data into the output buffer
-		ptr = _buffer;
-		for (; len > 0; len -= (stereo ? 2 : 1)) {
-			st_sample_t out0, out1;
-			out0 = *ptr++;
-			out1 = (stereo ? *ptr++ : out0);
-
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+		if ((int)len <= 0)
+			return 0;
 
-			obuf += 2;
-		}
-		return (obuf - ostart) / 2;
+		len /= (stereo ? 2 : 1);
+		_mix(obuf, _buffer, len, vol_l, vol_r);
+		return len;
 	}
 
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
@@ -341,7 +525,7 @@ public:
 #pragma mark -
 
 template<bool stereo, bool reverseStereo>
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
+static RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
 	if (inrate != outrate) {
 		if ((inrate % outrate) == 0 && (inrate < 65536)) {
 			return new SimpleRateConverter<stereo, reverseStereo>(inrate, outrate);
@@ -357,6 +541,11 @@ RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
  * Create and return a RateConverter object for the specified input and output rates.
  */
 RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+#ifdef USE_ARM_SOUND_ASM
+	if (s_rateConverterBackend == kRateConverterARM)
+		return makeARMRateConverter(inrate, outrate, stereo, reverseStereo);
+#endif
+
 	if (stereo) {
 		if (reverseStereo)
 			return makeRateConverter<true, true>(inrate, outrate);
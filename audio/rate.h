@@ -80,6 +80,30 @@ public:
 
 RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false);
 
+/**
+ * Implementations of the sample loops used by the rate converters.
+ */
+enum RateConverterBackend {
+	kRateConverterGeneric,	///< Portable C++ code
+	kRateConverterSIMD,		///< SSE2 or NEON code, if the build targets either
+	kRateConverterARM		///< ARM assembly, if built with USE_ARM_SOUND_ASM
+};
+
+/**
+ * Check whether a backend is compiled in.
+ */
+bool hasRateConverterBackend(RateConverterBackend backend);
+
+/**
+ * Select the backend used by rate converters created afterwards. The default
+ * is the SIMD backend when available and the generic one otherwise.
+ *
+ * @return false if the backend is not compiled in
+ */
+bool setRateConverterBackend(RateConverterBackend backend);
+
+RateConverterBackend getRateConverterBackend();
+
 } // End of namespace Audio
 
 #endif
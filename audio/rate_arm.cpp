@@ -26,6 +26,9 @@
  * code should be identical to that of rate.cpp, but faster. The heavy
  * lifting is done in the assembler file.
  *
+ * It is one of the rate converter backends in rate.cpp, used for converters
+ * created after setRateConverterBackend(kRateConverterARM).
+ *
  * To be as portable as possible we implement the core routines with C
  * linkage in assembly, and implement the C++ routines that call into
  * the C here. The C++ symbol mangling varies wildly between compilers,
@@ -100,11 +103,11 @@ typedef struct {
 } SimpleRateDetails;
 
 template<bool stereo, bool reverseStereo>
-class SimpleRateConverter : public RateConverter {
+class ARMSimpleRateConverter : public RateConverter {
 protected:
 	SimpleRateDetails  sr;
 public:
-	SimpleRateConverter(st_rate_t inrate, st_rate_t outrate);
+	ARMSimpleRateConverter(st_rate_t inrate, st_rate_t outrate);
 	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return (ST_SUCCESS);
@@ -116,7 +119,7 @@ public:
  * Prepare processing.
  */
 template<bool stereo, bool reverseStereo>
-SimpleRateConverter<stereo, reverseStereo>::SimpleRateConverter(st_rate_t inrate, st_rate_t outrate) {
+ARMSimpleRateConverter<stereo, reverseStereo>::ARMSimpleRateConverter(st_rate_t inrate, st_rate_t outrate) {
 	if (inrate == outrate) {
 		error("Input and Output rates must be different to use rate effect");
 	}
@@ -179,7 +182,7 @@ extern "C" int SimpleRate_readFudge(Audio::AudioStream &input, int16 *a, int b)
 }
 
 template<bool stereo, bool reverseStereo>
-int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+int ARMSimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 
 #ifdef DEBUG_RATECONV
 	debug("Simple st=%d rev=%d", stereo, reverseStereo);
@@ -273,12 +276,12 @@ extern "C" st_sample_t *ARM_LinearRate_R(
 								st_volume_t vol_r);
 
 template<bool stereo, bool reverseStereo>
-class LinearRateConverter : public RateConverter {
+class ARMLinearRateConverter : public RateConverter {
 protected:
 	LinearRateDetails lr;
 
 public:
-	LinearRateConverter(st_rate_t inrate, st_rate_t outrate);
+	ARMLinearRateConverter(st_rate_t inrate, st_rate_t outrate);
 	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
 	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
 		return (ST_SUCCESS);
@@ -290,7 +293,7 @@ public:
  * Prepare processing.
  */
 template<bool stereo, bool reverseStereo>
-LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate, st_rate_t outrate) {
+ARMLinearRateConverter<stereo, reverseStereo>::ARMLinearRateConverter(st_rate_t inrate, st_rate_t outrate) {
 	unsigned long incr;
 
 	if (inrate == outrate) {
@@ -320,7 +323,7 @@ LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate
  * Return number of sample pairs processed.
  */
 template<bool stereo, bool reverseStereo>
-int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+int ARMLinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
 
 #ifdef DEBUG_RATECONV
 	debug("Linear st=%d rev=%d", stereo, reverseStereo);
@@ -390,13 +393,13 @@ extern "C" st_sample_t *ARM_CopyRate_R(
 
 
 template<bool stereo, bool reverseStereo>
-class CopyRateConverter : public RateConverter {
+class ARMCopyRateConverter : public RateConverter {
 	st_sample_t *_buffer;
 	st_size_t _bufferSize;
 
 public:
-	CopyRateConverter() : _buffer(0), _bufferSize(0) {}
-	~CopyRateConverter() {
+	ARMCopyRateConverter() : _buffer(0), _bufferSize(0) {}
+	~ARMCopyRateConverter() {
 		free(_buffer);
 	}
 
@@ -445,35 +448,35 @@ public:
 
 
 /**
- * Create and return a RateConverter object for the specified input and output rates.
+ * Create and return an ARM RateConverter object for the specified input and output rates.
  */
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+RateConverter *makeARMRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
 	if (inrate != outrate) {
 		if ((inrate % outrate) == 0 && (inrate < 65536)) {
 			if (stereo) {
 				if (reverseStereo)
-					return new SimpleRateConverter<true, true>(inrate, outrate);
+					return new ARMSimpleRateConverter<true, true>(inrate, outrate);
 				else
-					return new SimpleRateConverter<true, false>(inrate, outrate);
+					return new ARMSimpleRateConverter<true, false>(inrate, outrate);
 			} else
-				return new SimpleRateConverter<false, false>(inrate, outrate);
+				return new ARMSimpleRateConverter<false, false>(inrate, outrate);
 		} else {
 			if (stereo) {
 				if (reverseStereo)
-					return new LinearRateConverter<true, true>(inrate, outrate);
+					return new ARMLinearRateConverter<true, true>(inrate, outrate);
 				else
-					return new LinearRateConverter<true, false>(inrate, outrate);
+					return new ARMLinearRateConverter<true, false>(inrate, outrate);
 			} else
-				return new LinearRateConverter<false, false>(inrate, outrate);
+				return new ARMLinearRateConverter<false, false>(inrate, outrate);
 		 }
 	} else {
 		if (stereo) {
 			if (reverseStereo)
-				return new CopyRateConverter<true, true>();
+				return new ARMCopyRateConverter<true, true>();
 			else
-				return new CopyRateConverter<true, false>();
+				return new ARMCopyRateConverter<true, false>();
 		} else
-			return new CopyRateConverter<false, false>();
+			return new ARMCopyRateConverter<false, false>();
 	}
 }
 
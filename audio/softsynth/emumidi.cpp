@@ -0,0 +1,696 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/softsynth/emumidi.h"
+
+#include "common/config-manager.h"
+#include "common/debug.h"
+#include "common/endian.h"
+#include "common/md5.h"
+#include "common/memstream.h"
+#include "common/savefile.h"
+#include "common/system.h"
+
+/*
+ * Render cache file layout. After the header, the file is a sequence of
+ * records, each starting with its type byte:
+ *
+ *  'E' uint32 position, uint32 message    - MIDI event
+ *  'X' uint32 position, uint16 length, data - SysEx
+ *  'S' uint16 frames, int16 samples[]      - rendered output, little endian
+ *  'T'                                     - track played through to the end
+ *
+ * Positions are in sample frames since the timer tick the recording started
+ * on. The file is compressed by the savefile manager. Only recordings of
+ * tracks which played through to the end are written, so a file always ends
+ * with the 'T' record. When a track is replayed to its end, the 'T' record
+ * must be next. A file which ends before it is incomplete and is removed.
+ *
+ * The files are kept within the size set by midi_render_cache_size, in
+ * megabytes of uncompressed data. The least recently played ones are removed
+ * first, their order is kept in an index file.
+ */
+
+#define RENDER_CACHE_TAG MKTAG('M', 'R', 'C', '0')
+#define RENDER_CACHE_INDEX_TAG MKTAG('M', 'R', 'I', '0')
+
+static const char *const kRenderCacheIndexName = "midicache.index";
+
+enum {
+	kRenderCacheEvent = 'E',
+	kRenderCacheSysEx = 'X',
+	kRenderCacheSamples = 'S',
+	kRenderCacheTrackEnd = 'T',
+	kRenderCacheNoRecord = 0,
+
+	kRenderCacheHeaderSize = 9,
+	kRenderCacheMaxFrames = 4096,
+
+	// About three minutes of 44.1 kHz stereo, longer tracks are not cached
+	kRenderCacheMaxRecording = 32 * 1024 * 1024
+};
+
+/**
+ * A track being recorded. Its storage is allocated up front, outside the
+ * mixer callback, for the longest track which is cached. The pages never
+ * written to are usually not backed by memory.
+ */
+class MidiDriver_Emulated::RenderCacheBuffer : public Common::WriteStream {
+public:
+	RenderCacheBuffer() : _data((byte *)malloc(kRenderCacheMaxRecording)), _size(0), _full(!_data) {}
+
+	~RenderCacheBuffer() {
+		free(_data);
+	}
+
+	uint32 write(const void *dataPtr, uint32 dataSize) {
+		if (_full || _size + dataSize > kRenderCacheMaxRecording) {
+			_full = true;
+			return 0;
+		}
+
+		memcpy(_data + _size, dataPtr, dataSize);
+		_size += dataSize;
+		return dataSize;
+	}
+
+	int32 pos() const { return _size; }
+	bool err() const { return _full; }
+
+	/** Writes the recording to the given stream. */
+	void copyTo(Common::WriteStream &out) const {
+		out.write(_data, _size);
+	}
+
+private:
+	byte *_data;
+	uint32 _size;
+	bool _full;
+};
+
+MidiDriver_Emulated::MidiDriver_Emulated(Audio::Mixer *mixer) :
+	_mixer(mixer),
+	_isOpen(false),
+	_timerProc(0),
+	_timerParam(0),
+	_nextTick(0),
+	_samplesPerTick(0),
+	_renderCacheState(kRenderCacheOff),
+	_inTimerProc(false),
+	_renderCacheKey(0),
+	_renderCacheSysExHash(0),
+	_sysExHash(0),
+	_renderCacheIn(0),
+	_renderCacheOut(0),
+	_renderCacheComplete(false),
+	_renderCacheBroken(false),
+	_renderCacheStopReason(0),
+	_renderCachePos(0),
+	_renderCacheFrames(0),
+	_renderCacheRecord(kRenderCacheNoRecord),
+	_renderCacheIndexLoaded(false),
+	_baseFreq(250) {
+	memset(_renderCacheNotes, 0, sizeof(_renderCacheNotes));
+}
+
+MidiDriver_Emulated::~MidiDriver_Emulated() {
+	delete _renderCacheIn;
+	delete _renderCacheOut;
+}
+
+uint32 MidiDriver_Emulated::property(int prop, uint32 param) {
+	switch (prop) {
+	case PROP_RENDER_CACHE_BEGIN:
+		return beginRenderCache(param) ? 1 : 0;
+
+	case PROP_RENDER_CACHE_END: {
+		RenderCacheFiles files;
+		{
+			Common::StackLock lock(_renderCacheMutex);
+			endRenderCache(param != 0);
+
+			// At the end of a track this is called from the mixer callback,
+			// the files are then handled by the next call from outside
+			if (_inTimerProc)
+				return 1;
+			takeRenderCacheFiles(files);
+		}
+
+		handleRenderCacheFiles(files);
+		return 1;
+	}
+	}
+
+	return 0;
+}
+
+void MidiDriver_Emulated::closeRenderCache() {
+	RenderCacheFiles files;
+	{
+		Common::StackLock lock(_renderCacheMutex);
+		endRenderCache(false);
+		takeRenderCacheFiles(files);
+	}
+
+	handleRenderCacheFiles(files);
+}
+
+int MidiDriver_Emulated::readBuffer(int16 *data, const int numSamples) {
+	const int stereoFactor = isStereo() ? 2 : 1;
+	int len = numSamples / stereoFactor;
+	int step;
+
+	do {
+		step = len;
+		if (step > (_nextTick >> FIXP_SHIFT))
+			step = (_nextTick >> FIXP_SHIFT);
+
+		renderSamples(data, step);
+
+		_nextTick -= step << FIXP_SHIFT;
+		if (!(_nextTick >> FIXP_SHIFT)) {
+			{
+				Common::StackLock lock(_renderCacheMutex);
+				if (_renderCacheState == kRenderCachePending) {
+					startRenderCache();
+
+					// Event positions are in frames, so the following ticks
+					// must fall on the same frames on every play
+					_nextTick = 0;
+				}
+			}
+
+			// The cache mutex must not be held here, the timer proc usually
+			// locks the music player, which might be waiting on us
+			_inTimerProc = true;
+			if (_timerProc)
+				(*_timerProc)(_timerParam);
+			_inTimerProc = false;
+
+			onTimer();
+
+			_nextTick += _samplesPerTick;
+		}
+
+		data += step * stereoFactor;
+		len -= step;
+	} while (len);
+
+	return numSamples;
+}
+
+bool MidiDriver_Emulated::filterRenderCacheEvent(uint32 b) {
+	Common::StackLock lock(_renderCacheMutex);
+
+	switch (_renderCacheState) {
+	case kRenderCacheRecording:
+		_renderCacheOut->writeByte(kRenderCacheEvent);
+		_renderCacheOut->writeUint32LE(_renderCachePos);
+		_renderCacheOut->writeUint32LE(b);
+		return false;
+
+	case kRenderCacheReplaying:
+		if (_renderCacheFrames || peekRenderCacheRecord() != kRenderCacheEvent) {
+			divergeRenderCache("unexpected event");
+			resumeRenderCacheNotes();
+			return false;
+		}
+
+		_renderCacheRecord = kRenderCacheNoRecord;
+		if (_renderCacheIn->readUint32LE() != _renderCachePos || _renderCacheIn->readUint32LE() != b) {
+			divergeRenderCache("event mismatch");
+			resumeRenderCacheNotes();
+			return false;
+		}
+
+		// Notes are heard from the cache, everything else is still passed
+		// on so the synth state is correct if we have to fall back to it
+		trackRenderCacheNote(b);
+		switch (b & 0xF0) {
+		case 0x80:
+		case 0x90:
+		case 0xA0:
+			return true;
+		default:
+			return false;
+		}
+
+	default:
+		return false;
+	}
+}
+
+bool MidiDriver_Emulated::filterRenderCacheSysEx(const byte *msg, uint16 length) {
+	Common::StackLock lock(_renderCacheMutex);
+
+	// SysEx messages may upload patches, so they are part of the cache key.
+	// Games often send the same messages again, e.g. for every room, so only
+	// distinct messages are counted, regardless of their order.
+	uint32 hash = 2166136261u;
+	for (uint16 i = 0; i < length; ++i)
+		hash = (hash ^ msg[i]) * 16777619;
+	if (!_sysExSeen.contains(hash)) {
+		_sysExSeen[hash] = true;
+		_sysExHash += hash;
+	}
+
+	switch (_renderCacheState) {
+	case kRenderCacheRecording:
+		_renderCacheOut->writeByte(kRenderCacheSysEx);
+		_renderCacheOut->writeUint32LE(_renderCachePos);
+		_renderCacheOut->writeUint16LE(length);
+		_renderCacheOut->write(msg, length);
+		break;
+
+	case kRenderCacheReplaying: {
+		if (_renderCacheFrames || peekRenderCacheRecord() != kRenderCacheSysEx) {
+			divergeRenderCache("unexpected SysEx");
+			break;
+		}
+
+		_renderCacheRecord = kRenderCacheNoRecord;
+		bool match = _renderCacheIn->readUint32LE() == _renderCachePos && _renderCacheIn->readUint16LE() == length;
+		for (uint16 i = 0; match && i < length; ++i)
+			match = _renderCacheIn->readByte() == msg[i];
+		if (!match)
+			divergeRenderCache("SysEx mismatch");
+		break;
+	}
+
+	default:
+		break;
+	}
+
+	return false;
+}
+
+void MidiDriver_Emulated::renderSamples(int16 *data, int len) {
+	Common::StackLock lock(_renderCacheMutex);
+
+	switch (_renderCacheState) {
+	case kRenderCacheRecording:
+		generateSamples(data, len);
+		writeRenderCacheSamples(data, len);
+		_renderCachePos += len;
+		break;
+
+	case kRenderCacheReplaying: {
+		// Only keep the synth running as long as it is still sounding,
+		// otherwise just let it apply the events it has been sent
+		const bool generated = !isRenderIdle();
+		if (generated)
+			generateSamples(data, len);
+		else
+			flushEvents();
+
+		const int read = readRenderCacheSamples(data, len);
+		if (read < len) {
+			// A synth which was still sounding has already rendered the
+			// rest, the notes are then heard from the next tick
+			divergeRenderCache("missing event");
+			resumeRenderCacheNotes();
+			if (!generated)
+				generateSamples(data + read * (isStereo() ? 2 : 1), len - read);
+		} else {
+			_renderCachePos += len;
+		}
+		break;
+	}
+
+	default:
+		generateSamples(data, len);
+		break;
+	}
+}
+
+bool MidiDriver_Emulated::beginRenderCache(uint32 key) {
+	RenderCacheFiles files;
+	uint32 sysExHash;
+
+	{
+		Common::StackLock lock(_renderCacheMutex);
+		endRenderCache(false);
+
+		if (_inTimerProc) {
+			// No files are opened in the mixer callback. A track can only be
+			// replayed again while its file is open, as when it loops.
+			if (!key || key != _renderCacheKey || !_renderCacheIn || _renderCacheBroken
+			    || _sysExHash != _renderCacheSysExHash || !_renderCacheIn->seek(kRenderCacheHeaderSize))
+				return false;
+
+			_renderCacheState = kRenderCachePending;
+			return true;
+		}
+
+		takeRenderCacheFiles(files);
+		sysExHash = _sysExHash;
+	}
+
+	handleRenderCacheFiles(files);
+
+	if (!key || !ConfMan.getBool("midi_render_cache") || getRenderCacheId().empty())
+		return false;
+
+	const Common::String id = Common::String::format("%s:%08x:%08x:%d:%d", getRenderCacheId().c_str(), key, sysExHash, getRate(), isStereo() ? 2 : 1);
+	Common::MemoryReadStream idStream((const byte *)id.c_str(), id.size());
+	const Common::String name = "midicache-" + Common::computeStreamMD5AsString(idStream);
+
+	Common::InSaveFile *in = openRenderCache(name);
+	RenderCacheBuffer *recording = 0;
+	if (in) {
+		debug(3, "MidiDriver_Emulated: Replaying track %08x from %s", key, name.c_str());
+		updateRenderCacheIndex(name, in->size());
+	} else {
+		recording = new RenderCacheBuffer();
+		recording->writeUint32BE(RENDER_CACHE_TAG);
+		recording->writeUint32LE(getRate());
+		recording->writeByte(isStereo() ? 2 : 1);
+		debug(3, "MidiDriver_Emulated: Recording track %08x to %s", key, name.c_str());
+	}
+
+	// The cache is started on the next timer tick, so that event positions
+	// are measured from the same point on every play
+	Common::StackLock lock(_renderCacheMutex);
+	_renderCacheName = name;
+	_renderCacheKey = key;
+	_renderCacheSysExHash = sysExHash;
+	_renderCacheIn = in;
+	_renderCacheOut = recording;
+	_renderCacheState = kRenderCachePending;
+	return true;
+}
+
+void MidiDriver_Emulated::startRenderCache() {
+	// Anything still sounding would end up in the recording, and SysEx
+	// messages sent since the track was set up change its sound
+	if (!isRenderIdle() || _sysExHash != _renderCacheSysExHash) {
+		_renderCacheStopReason = isRenderIdle() ? "SysEx sent before the start" : "synth busy at the start";
+		_renderCachePos = 0;
+		endRenderCache(false);
+		return;
+	}
+
+	_renderCachePos = 0;
+	_renderCacheFrames = 0;
+	_renderCacheRecord = kRenderCacheNoRecord;
+	memset(_renderCacheNotes, 0, sizeof(_renderCacheNotes));
+	_renderCacheState = _renderCacheIn ? kRenderCacheReplaying : kRenderCacheRecording;
+}
+
+void MidiDriver_Emulated::endRenderCache(bool completed) {
+	switch (_renderCacheState) {
+	case kRenderCacheRecording:
+		if (completed) {
+			_renderCacheOut->writeByte(kRenderCacheTrackEnd);
+			_renderCacheComplete = !_renderCacheOut->err();
+			if (!_renderCacheComplete)
+				_renderCacheStopReason = "track too long";
+		}
+		break;
+
+	case kRenderCacheReplaying:
+		if (completed && (_renderCacheFrames || peekRenderCacheRecord() != kRenderCacheTrackEnd))
+			divergeRenderCache("track ended early");
+		break;
+
+	default:
+		break;
+	}
+
+	// A finished recording is kept until it can be written
+	if (!_renderCacheComplete) {
+		delete _renderCacheOut;
+		_renderCacheOut = 0;
+	}
+	_renderCacheState = kRenderCacheOff;
+}
+
+void MidiDriver_Emulated::divergeRenderCache(const char *reason) {
+	_renderCacheStopReason = reason;
+
+	// A truncated or damaged file will never match, so it is removed. A
+	// mismatch is simply another play of the track, the file is kept.
+	if (_renderCacheIn->eos() || _renderCacheIn->err())
+		_renderCacheBroken = true;
+	_renderCacheState = kRenderCacheOff;
+}
+
+void MidiDriver_Emulated::trackRenderCacheNote(uint32 b) {
+	const byte channel = b & 0x0F;
+	const byte param1 = (b >> 8) & 0x7F;
+	const byte param2 = (b >> 16) & 0x7F;
+
+	switch (b & 0xF0) {
+	case 0x80:
+		_renderCacheNotes[channel][param1] = 0;
+		break;
+	case 0x90:
+		_renderCacheNotes[channel][param1] = param2;
+		break;
+	case 0xB0:
+		// All sound off, and the channel mode messages which end all notes
+		if (param1 == 0x78 || param1 >= 0x7B)
+			memset(_renderCacheNotes[channel], 0, sizeof(_renderCacheNotes[channel]));
+		break;
+	default:
+		break;
+	}
+}
+
+void MidiDriver_Emulated::resumeRenderCacheNotes() {
+	// The cache is off by now, so the notes go straight to the synth. They
+	// restart rather than continue, which is the best the synth can do.
+	for (byte channel = 0; channel < 16; ++channel) {
+		for (byte note = 0; note < 128; ++note) {
+			if (_renderCacheNotes[channel][note]) {
+				send(0x90 | channel | (note << 8) | (_renderCacheNotes[channel][note] << 16));
+				_renderCacheNotes[channel][note] = 0;
+			}
+		}
+	}
+}
+
+void MidiDriver_Emulated::takeRenderCacheFiles(RenderCacheFiles &files) {
+	files.recording = _renderCacheOut;
+	files.in = _renderCacheIn;
+	files.broken = _renderCacheBroken;
+	files.stopReason = _renderCacheStopReason;
+	files.stopPos = _renderCachePos;
+
+	_renderCacheOut = 0;
+	_renderCacheIn = 0;
+	_renderCacheComplete = false;
+	_renderCacheBroken = false;
+	_renderCacheStopReason = 0;
+}
+
+void MidiDriver_Emulated::handleRenderCacheFiles(const RenderCacheFiles &files) {
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+
+	if (files.stopReason)
+		debug(3, "MidiDriver_Emulated: Stopped caching at frame %u of %s: %s", files.stopPos, _renderCacheName.c_str(), files.stopReason);
+
+	delete files.in;
+	if (files.broken) {
+		saveFileMan->removeSavefile(_renderCacheName);
+		updateRenderCacheIndex(_renderCacheName, 0);
+	}
+
+	if (!files.recording)
+		return;
+
+	Common::OutSaveFile *out = saveFileMan->openForSaving(_renderCacheName);
+	if (out) {
+		files.recording->copyTo(*out);
+		// The stream is not finalized, that would also sync it to the cloud
+		out->flush();
+		const bool failed = out->err();
+		delete out;
+
+		if (failed) {
+			saveFileMan->removeSavefile(_renderCacheName);
+		} else {
+			debug(3, "MidiDriver_Emulated: Recorded %u bytes to %s", files.recording->pos(), _renderCacheName.c_str());
+			updateRenderCacheIndex(_renderCacheName, files.recording->pos());
+		}
+	}
+
+	delete files.recording;
+}
+
+Common::InSaveFile *MidiDriver_Emulated::openRenderCache(const Common::String &name) {
+	// Loading the index removes the files which are not in it
+	loadRenderCacheIndex();
+
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	Common::InSaveFile *in = saveFileMan->openForLoading(name);
+	if (!in)
+		return 0;
+
+	if (in->readUint32BE() == RENDER_CACHE_TAG && in->readUint32LE() == (uint32)getRate()
+	    && in->readByte() == (isStereo() ? 2 : 1) && !in->err())
+		return in;
+
+	warning("MidiDriver_Emulated: Invalid render cache %s", name.c_str());
+	delete in;
+	saveFileMan->removeSavefile(name);
+	updateRenderCacheIndex(name, 0);
+	return 0;
+}
+
+void MidiDriver_Emulated::loadRenderCacheIndex() {
+	if (_renderCacheIndexLoaded)
+		return;
+	_renderCacheIndexLoaded = true;
+
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	Common::StringArray files = saveFileMan->listSavefiles("midicache-*");
+
+	Common::InSaveFile *in = saveFileMan->openForLoading(kRenderCacheIndexName);
+	if (in && in->readUint32BE() == RENDER_CACHE_INDEX_TAG) {
+		for (uint32 count = in->readUint32LE(); count > 0 && !in->eos() && !in->err(); --count) {
+			RenderCacheEntry entry;
+			const byte nameLength = in->readByte();
+			for (byte i = 0; i < nameLength; ++i)
+				entry.name += (char)in->readByte();
+			entry.size = in->readUint32LE();
+
+			for (uint i = 0; i < files.size(); ++i) {
+				if (files[i] == entry.name) {
+					files.remove_at(i);
+					if (!in->eos() && !in->err())
+						_renderCacheIndex.push_back(entry);
+					break;
+				}
+			}
+		}
+	}
+	delete in;
+
+	// Files missing from the index were left by a crash, their use is unknown
+	for (uint i = 0; i < files.size(); ++i)
+		saveFileMan->removeSavefile(files[i]);
+}
+
+void MidiDriver_Emulated::updateRenderCacheIndex(const Common::String &name, uint32 size) {
+	loadRenderCacheIndex();
+
+	for (uint i = 0; i < _renderCacheIndex.size(); ++i) {
+		if (_renderCacheIndex[i].name == name) {
+			_renderCacheIndex.remove_at(i);
+			break;
+		}
+	}
+
+	if (size) {
+		RenderCacheEntry entry;
+		entry.name = name;
+		entry.size = size;
+		_renderCacheIndex.push_back(entry);
+	}
+
+	// Remove the least recently played tracks beyond the budget, but never
+	// the current one
+	Common::SaveFileManager *saveFileMan = g_system->getSavefileManager();
+	const uint32 budget = (uint32)MAX(ConfMan.getInt("midi_render_cache_size"), 0) * 1024 * 1024;
+	uint32 total = 0;
+	for (uint i = 0; i < _renderCacheIndex.size(); ++i)
+		total += _renderCacheIndex[i].size;
+
+	while (total > budget && _renderCacheIndex.size() > 1) {
+		debug(3, "MidiDriver_Emulated: Removing %s from the render cache", _renderCacheIndex[0].name.c_str());
+		saveFileMan->removeSavefile(_renderCacheIndex[0].name);
+		total -= _renderCacheIndex[0].size;
+		_renderCacheIndex.remove_at(0);
+	}
+
+	Common::OutSaveFile *out = saveFileMan->openForSaving(kRenderCacheIndexName, false);
+	if (!out)
+		return;
+
+	out->writeUint32BE(RENDER_CACHE_INDEX_TAG);
+	out->writeUint32LE(_renderCacheIndex.size());
+	for (uint i = 0; i < _renderCacheIndex.size(); ++i) {
+		out->writeByte(_renderCacheIndex[i].name.size());
+		out->write(_renderCacheIndex[i].name.c_str(), _renderCacheIndex[i].name.size());
+		out->writeUint32LE(_renderCacheIndex[i].size);
+	}
+	out->flush();
+	delete out;
+}
+
+byte MidiDriver_Emulated::peekRenderCacheRecord() {
+	if (_renderCacheRecord == kRenderCacheNoRecord) {
+		_renderCacheRecord = _renderCacheIn->readByte();
+		if (_renderCacheIn->eos() || _renderCacheIn->err())
+			_renderCacheRecord = kRenderCacheNoRecord;
+	}
+	return _renderCacheRecord;
+}
+
+int MidiDriver_Emulated::readRenderCacheSamples(int16 *data, int len) {
+	const int stereoFactor = isStereo() ? 2 : 1;
+	int read = 0;
+
+	while (read < len) {
+		if (!_renderCacheFrames) {
+			if (peekRenderCacheRecord() != kRenderCacheSamples)
+				break;
+			_renderCacheRecord = kRenderCacheNoRecord;
+			_renderCacheFrames = _renderCacheIn->readUint16LE();
+			continue;
+		}
+
+		const int step = MIN<int>(len - read, _renderCacheFrames);
+		int16 *out = data + read * stereoFactor;
+		const uint32 bytes = step * stereoFactor * sizeof(int16);
+		if (_renderCacheIn->read(out, bytes) != bytes)
+			break;
+#ifdef SCUMM_BIG_ENDIAN
+		for (int i = 0; i < step * stereoFactor; ++i)
+			out[i] = FROM_LE_16(out[i]);
+#endif
+
+		_renderCacheFrames -= step;
+		read += step;
+	}
+
+	return read;
+}
+
+void MidiDriver_Emulated::writeRenderCacheSamples(const int16 *data, int len) {
+	const int stereoFactor = isStereo() ? 2 : 1;
+
+	while (len > 0) {
+		const int step = MIN<int>(len, kRenderCacheMaxFrames);
+		_renderCacheOut->writeByte(kRenderCacheSamples);
+		_renderCacheOut->writeUint16LE(step);
+#ifdef SCUMM_BIG_ENDIAN
+		for (int i = 0; i < step * stereoFactor; ++i)
+			_renderCacheOut->writeSint16LE(data[i]);
+#else
+		_renderCacheOut->write(data, step * stereoFactor * sizeof(int16));
+#endif
+		data += step * stereoFactor;
+		len -= step;
+	}
+}
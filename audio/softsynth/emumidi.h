@@ -26,6 +26,11 @@
 #include "audio/audiostream.h"
 #include "audio/mididrv.h"
 #include "audio/mixer.h"
+#include "common/array.h"
+#include "common/hashmap.h"
+#include "common/mutex.h"
+#include "common/savefile.h"
+#include "common/str.h"
 
 class MidiDriver_Emulated : public Audio::AudioStream, public MidiDriver {
 protected:
@@ -44,22 +49,123 @@ private:
 	int _nextTick;
 	int _samplesPerTick;
 
+	/**
+	 * State of the pre-rendered music cache, see PROP_RENDER_CACHE_BEGIN.
+	 * While a track is recorded, all events and the generated samples are
+	 * kept in memory, and written to a compressed file in the save path once
+	 * the track played through to the end. When the same track is played
+	 * again, the samples are streamed from that file and synthesis is
+	 * skipped, for as long as the incoming events match the recorded ones.
+	 *
+	 * The files are only opened, written and removed by property() and
+	 * closeRenderCache() outside the mixer callback. The callback only
+	 * switches to the file opened beforehand on the next timer tick, and
+	 * leaves the rest to the next call from the music player's thread.
+	 */
+	enum RenderCacheState {
+		kRenderCacheOff,
+		kRenderCachePending,
+		kRenderCacheRecording,
+		kRenderCacheReplaying
+	};
+
+	class RenderCacheBuffer;
+
+	struct RenderCacheEntry {
+		Common::String name;
+		uint32 size;
+	};
+
+	/** What the mixer callback left to do with the files. */
+	struct RenderCacheFiles {
+		RenderCacheFiles() : recording(0), in(0), broken(false), stopReason(0), stopPos(0) {}
+
+		RenderCacheBuffer *recording;
+		Common::InSaveFile *in;
+		bool broken;
+		const char *stopReason;
+		uint32 stopPos;
+	};
+
+	Common::Mutex _renderCacheMutex;
+	RenderCacheState _renderCacheState;
+	bool _inTimerProc;
+	uint32 _renderCacheKey;
+	uint32 _renderCacheSysExHash;
+	uint32 _sysExHash;
+	Common::HashMap<uint32, bool> _sysExSeen;
+	Common::InSaveFile *_renderCacheIn;
+	RenderCacheBuffer *_renderCacheOut;
+	bool _renderCacheComplete;
+	bool _renderCacheBroken;
+	const char *_renderCacheStopReason;
+	uint32 _renderCachePos;
+	uint32 _renderCacheFrames;
+	byte _renderCacheRecord;
+	// Velocity of the notes held while replaying, per channel and note.
+	// The synth does not get them, so they are sent when falling back.
+	byte _renderCacheNotes[16][128];
+
+	// Only used outside the mixer callback
+	Common::String _renderCacheName;
+	Common::Array<RenderCacheEntry> _renderCacheIndex;
+	bool _renderCacheIndexLoaded;
+
+	void renderSamples(int16 *data, int len);
+	bool beginRenderCache(uint32 key);
+	void startRenderCache();
+	void endRenderCache(bool completed);
+	void divergeRenderCache(const char *reason);
+	void trackRenderCacheNote(uint32 b);
+	void resumeRenderCacheNotes();
+	void takeRenderCacheFiles(RenderCacheFiles &files);
+	void handleRenderCacheFiles(const RenderCacheFiles &files);
+	Common::InSaveFile *openRenderCache(const Common::String &name);
+	void loadRenderCacheIndex();
+	void updateRenderCacheIndex(const Common::String &name, uint32 size);
+	byte peekRenderCacheRecord();
+	int readRenderCacheSamples(int16 *data, int len);
+	void writeRenderCacheSamples(const int16 *data, int len);
+
 protected:
 	int _baseFreq;
 
 	virtual void generateSamples(int16 *buf, int len) = 0;
 	virtual void onTimer() {}
 
+	/**
+	 * Identifies the synth and all the settings affecting its output, for the
+	 * render cache. An empty string, the default, disables the cache.
+	 */
+	virtual Common::String getRenderCacheId() const { return Common::String(); }
+
+	/**
+	 * Whether the synth has stopped producing sound. While the cache is
+	 * replayed, the synth only keeps rendering until it is idle.
+	 */
+	virtual bool isRenderIdle() const { return true; }
+
+	/**
+	 * Applies any events the synth queued for the next generateSamples()
+	 * call. Used when events arrive while the cache is replayed and the synth
+	 * is idle.
+	 */
+	virtual void flushEvents() {}
+
+	/**
+	 * To be called by send() and sysEx() before passing the event to the
+	 * synth. Returns true if the event must be dropped, because its sound is
+	 * streamed from the render cache.
+	 */
+	bool filterRenderCacheEvent(uint32 b);
+	bool filterRenderCacheSysEx(const byte *msg, uint16 length);
+
+	/** Stops recording or replaying the cache, to be called by close(). */
+	void closeRenderCache();
+
 public:
-	MidiDriver_Emulated(Audio::Mixer *mixer) :
-		_mixer(mixer),
-		_isOpen(false),
-		_timerProc(0),
-		_timerParam(0),
-		_nextTick(0),
-		_samplesPerTick(0),
-		_baseFreq(250) {
-	}
+	MidiDriver_Emulated(Audio::Mixer *mixer);
+	virtual ~MidiDriver_Emulated();
 
 	// MidiDriver API
 	virtual int open() {
@@ -87,35 +193,10 @@ public:
 		return 1000000 / _baseFreq;
 	}
 
-	// AudioStream API
-	virtual int readBuffer(int16 *data, const int numSamples) {
-		const int stereoFactor = isStereo() ? 2 : 1;
-		int len = numSamples / stereoFactor;
-		int step;
-
-		do {
-			step = len;
-			if (step > (_nextTick >> FIXP_SHIFT))
-				step = (_nextTick >> FIXP_SHIFT);
-
-			generateSamples(data, step);
-
-			_nextTick -= step << FIXP_SHIFT;
-			if (!(_nextTick >> FIXP_SHIFT)) {
-				if (_timerProc)
-					(*_timerProc)(_timerParam);
+	virtual uint32 property(int prop, uint32 param);
 
-				onTimer();
-
-				_nextTick += _samplesPerTick;
-			}
-
-			data += step * stereoFactor;
-			len -= step;
-		} while (len);
-
-		return numSamples;
-	}
+	// AudioStream API
+	virtual int readBuffer(int16 *data, const int numSamples);
 
 	virtual bool endOfData() const {
 		return false;
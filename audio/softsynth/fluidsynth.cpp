@@ -44,6 +44,7 @@ private:
 	fluid_synth_t *_synth;
 	int _soundFont;
 	int _outputRate;
+	Common::String _renderCacheId;
 
 protected:
 	// Because GCC complains about casting from const to non-const...
@@ -53,6 +54,9 @@ protected:
 
 	void generateSamples(int16 *buf, int len);
 
+	Common::String getRenderCacheId() const { return _renderCacheId; }
+	bool isRenderIdle() const { return fluid_synth_get_active_voice_count(_synth) == 0; }
+
 public:
 	MidiDriver_FluidSynth(Audio::Mixer *mixer);
 
@@ -197,6 +201,16 @@ int MidiDriver_FluidSynth::open() {
 	if (_soundFont == -1)
 		error("Failed loading custom sound font '%s'", soundfont);
 
+	// Everything above affects the rendered output
+	_renderCacheId = Common::String::format("fluidsynth:%s:%d:%s:%d:%d:%d:%d:%s:%s:%d:%d:%d:%d:%d:%s",
+		ConfMan.get("soundfont").c_str(), ConfMan.getInt("midi_gain"),
+		ConfMan.get("fluidsynth_chorus_activate").c_str(), ConfMan.getInt("fluidsynth_chorus_nr"),
+		ConfMan.getInt("fluidsynth_chorus_level"), ConfMan.getInt("fluidsynth_chorus_speed"),
+		ConfMan.getInt("fluidsynth_chorus_depth"), ConfMan.get("fluidsynth_chorus_waveform").c_str(),
+		ConfMan.get("fluidsynth_reverb_activate").c_str(), ConfMan.getInt("fluidsynth_reverb_roomsize"),
+		ConfMan.getInt("fluidsynth_reverb_damping"), ConfMan.getInt("fluidsynth_reverb_width"),
+		ConfMan.getInt("fluidsynth_reverb_level"), _outputRate, interpolation.c_str());
+
 	MidiDriver_Emulated::open();
 
 	_mixer->playStream(Audio::Mixer::kPlainSoundType, &_mixerSoundHandle, this, -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO, true);
@@ -209,6 +223,7 @@ void MidiDriver_FluidSynth::close() {
 	_isOpen = false;
 
 	_mixer->stopHandle(_mixerSoundHandle);
+	closeRenderCache();
 
 	if (_soundFont != -1)
 		fluid_synth_sfunload(_synth, _soundFont, 1);
@@ -218,6 +233,9 @@ void MidiDriver_FluidSynth::close() {
 }
 
 void MidiDriver_FluidSynth::send(uint32 b) {
+	if (filterRenderCacheEvent(b))
+		return;
+
 	//byte param3 = (byte) ((b >> 24) & 0xFF);
 	uint param2 = (byte) ((b >> 16) & 0xFF);
 	uint param1 = (byte) ((b >>  8) & 0xFF);
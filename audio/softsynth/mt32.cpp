@@ -29,6 +29,7 @@
 #include "audio/softsynth/mt32/ROMInfo.h"
 
 #include "audio/softsynth/emumidi.h"
+#include "audio/softsynth/mt32_eventqueue.h"
 #include "audio/musicplugin.h"
 #include "audio/mpu401.h"
 
@@ -41,6 +42,7 @@
 #include "common/util.h"
 #include "common/archive.h"
 #include "common/textconsole.h"
+#include "common/timer.h"
 #include "common/translation.h"
 
 #include "graphics/fontman.h"
@@ -105,6 +107,10 @@ private:
 protected:
 	void generateSamples(int16 *buf, int len);
 
+	Common::String getRenderCacheId() const;
+	bool isRenderIdle() const { return !_synth->isActive(); }
+	void flushEvents() { _synth->flushMIDIQueue(); }
+
 public:
 	bool _initializing;
 
@@ -236,6 +242,9 @@ int MidiDriver_MT32::open() {
 }
 
 void MidiDriver_MT32::send(uint32 b) {
+	if (filterRenderCacheEvent(b))
+		return;
+
 	_synth->playMsg(b);
 }
 
@@ -257,6 +266,8 @@ void MidiDriver_MT32::setPitchBendRange(byte channel, uint range) {
 }
 
 void MidiDriver_MT32::sysEx(const byte *msg, uint16 length) {
+	filterRenderCacheSysEx(msg, length);
+
 	if (msg[0] == 0xf0) {
 		_synth->playSysex(msg, length);
 	} else {
@@ -273,6 +284,7 @@ void MidiDriver_MT32::close() {
 	setTimerCallback(NULL, NULL);
 	// Detach the mixer callback handler
 	_mixer->stopHandle(_mixerSoundHandle);
+	closeRenderCache();
 
 	_synth->close();
 	deleteMuntStructures();
@@ -289,7 +301,18 @@ uint32 MidiDriver_MT32::property(int prop, uint32 param) {
 		return 1;
 	}
 
-	return 0;
+	return MidiDriver_Emulated::property(prop, param);
+}
+
+Common::String MidiDriver_MT32::getRenderCacheId() const {
+	const MT32Emu::ROMInfo *controlInfo = _controlROM->getROMInfo();
+	const MT32Emu::ROMInfo *pcmInfo = _pcmROM->getROMInfo();
+	if (!controlInfo || !pcmInfo)
+		return Common::String();
+
+	// The rendering mode is left out, all modes produce the same output
+	return Common::String::format("mt32:%s:%s:%d:%d:%d", controlInfo->sha1Digest,
+		pcmInfo->sha1Digest, ConfMan.getInt("midi_gain"), _synth->getDACInputMode(), _outputRate);
 }
 
 MidiChannel *MidiDriver_MT32::allocateChannel() {
@@ -311,119 +334,82 @@ MidiChannel *MidiDriver_MT32::getPercussionChannel() {
 	return &_midiChannels[9];
 }
 
-// This code should be used when calling the timer callback from the mixer thread is undesirable.
-// Note that it results in less accurate timing.
-#if 0
-class MidiEvent_MT32 {
-public:
-	MidiEvent_MT32 *_next;
-	uint32 _msg; // 0xFFFFFFFF indicates a sysex message
-	byte *_data;
-	uint32 _len;
-
-	MidiEvent_MT32(uint32 msg, byte *data, uint32 len) {
-		_msg = msg;
-		if (len > 0) {
-			_data = new byte[len];
-			memcpy(_data, data, len);
-		}
-		_len = len;
-		_next = NULL;
-	}
-
-	MidiEvent_MT32() {
-		if (_len > 0)
-			delete _data;
-	}
-};
-
+// Runs the music player on a timer thread instead of the mixer thread, for
+// engines which must not block the mixer. Note that it results in less
+// accurate timing. Enabled with the mt32_threaded config key.
 class MidiDriver_ThreadedMT32 : public MidiDriver_MT32 {
 private:
-	OSystem::Mutex _eventMutex;
-	MidiEvent_MT32 *_events;
-	TimerManager::TimerProc _timer_proc;
-
-	void pushMidiEvent(MidiEvent_MT32 *event);
-	MidiEvent_MT32 *popMidiEvent();
+	MidiEventQueue_MT32 _eventQueue;
+	// Engines send from their own thread as well as from the timer, the
+	// queue only takes one producer at a time. The mixer never locks it.
+	Common::Mutex _pushMutex;
+	Common::TimerManager::TimerProc _timer_proc;
 
 protected:
-	void send(uint32 b);
-	void sysEx(const byte *msg, uint16 length);
+	// Events reach the synth on the mixer tick after they were sent, which
+	// is not the same frame on every play
+	Common::String getRenderCacheId() const { return Common::String(); }
 
 public:
 	MidiDriver_ThreadedMT32(Audio::Mixer *mixer);
 
+	void send(uint32 b);
+	void sysEx(const byte *msg, uint16 length);
+
 	void onTimer();
 	void close();
-	void setTimerCallback(void *timer_param, TimerManager::TimerProc timer_proc);
+	void setTimerCallback(void *timer_param, Common::TimerManager::TimerProc timer_proc);
 };
 
 
 MidiDriver_ThreadedMT32::MidiDriver_ThreadedMT32(Audio::Mixer *mixer) : MidiDriver_MT32(mixer) {
-	_events = NULL;
 	_timer_proc = NULL;
 }
 
 void MidiDriver_ThreadedMT32::close() {
+	setTimerCallback(NULL, NULL);
 	MidiDriver_MT32::close();
-	while ((popMidiEvent() != NULL)) {
-		// Just eat any leftover events
-	}
+
+	// Both threads are stopped now, just eat any leftover events
+	if (_eventQueue.getOverflowCount())
+		debug(1, "MT32emu: %u MIDI events were dropped because the queue was full", _eventQueue.getOverflowCount());
+	_eventQueue.reset();
 }
 
-void MidiDriver_ThreadedMT32::setTimerCallback(void *timer_param, TimerManager::TimerProc timer_proc) {
+void MidiDriver_ThreadedMT32::setTimerCallback(void *timer_param, Common::TimerManager::TimerProc timer_proc) {
 	if (!_timer_proc || !timer_proc) {
 		if (_timer_proc)
-			_vm->_timer->removeTimerProc(_timer_proc);
+			g_system->getTimerManager()->removeTimerProc(_timer_proc);
 		_timer_proc = timer_proc;
 		if (timer_proc)
-			_vm->_timer->installTimerProc(timer_proc, getBaseTempo(), timer_param, "MT32tempo");
+			g_system->getTimerManager()->installTimerProc(timer_proc, getBaseTempo(), timer_param, "MT32tempo");
 	}
 }
 
-void MidiDriver_ThreadedMT32::pushMidiEvent(MidiEvent_MT32 *event) {
-	Common::StackLock lock(_eventMutex);
-	if (_events == NULL) {
-		_events = event;
-	} else {
-		MidiEvent_MT32 *last = _events;
-		while (last->_next != NULL)
-			last = last->_next;
-		last->_next = event;
-	}
-}
-
-MidiEvent_MT32 *MidiDriver_ThreadedMT32::popMidiEvent() {
-	Common::StackLock lock(_eventMutex);
-	MidiEvent_MT32 *event;
-	event = _events;
-	if (event != NULL)
-		_events = event->_next;
-	return event;
-}
-
 void MidiDriver_ThreadedMT32::send(uint32 b) {
-	MidiEvent_MT32 *event = new MidiEvent_MT32(b, NULL, 0);
-	pushMidiEvent(event);
+	Common::StackLock lock(_pushMutex);
+	if (!_eventQueue.push(b, NULL, 0))
+		debug(5, "MT32emu: MIDI event queue full, dropping message %08x", b);
 }
 
 void MidiDriver_ThreadedMT32::sysEx(const byte *msg, uint16 length) {
-	MidiEvent_MT32 *event = new MidiEvent_MT32(0xFFFFFFFF, msg, length);
-	pushMidiEvent(event);
+	Common::StackLock lock(_pushMutex);
+	if (!_eventQueue.push(0xFFFFFFFF, msg, length))
+		debug(5, "MT32emu: MIDI event queue full, dropping SysEx of %d bytes", length);
 }
 
 void MidiDriver_ThreadedMT32::onTimer() {
-	MidiEvent_MT32 *event;
-	while ((event = popMidiEvent()) != NULL) {
-		if (event->_msg == 0xFFFFFFFF) {
-			MidiDriver_MT32::sysEx(event->_data, event->_len);
+	uint32 msg, len;
+	const byte *data;
+	while (_eventQueue.peek(msg, data, len)) {
+		if (msg == 0xFFFFFFFF) {
+			MidiDriver_MT32::sysEx(data, len);
 		} else {
-			MidiDriver_MT32::send(event->_msg);
+			MidiDriver_MT32::send(msg);
 		}
-		delete event;
+		_eventQueue.pop();
 	}
 }
-#endif
 
 
 // Plugin interface
@@ -460,7 +446,10 @@ bool MT32EmuMusicPlugin::checkDevice(MidiDriver::DeviceHandle) const {
 }
 
 Common::Error MT32EmuMusicPlugin::createInstance(MidiDriver **mididriver, MidiDriver::DeviceHandle) const {
-	*mididriver = new MidiDriver_MT32(g_system->getMixer());
+	if (ConfMan.getBool("mt32_threaded"))
+		*mididriver = new MidiDriver_ThreadedMT32(g_system->getMixer());
+	else
+		*mididriver = new MidiDriver_MT32(g_system->getMixer());
 
 	return Common::kNoError;
 }
@@ -18,6 +18,7 @@
 //#include <cstring>
 #include "mt32emu.h"
 #include "BReverbModel.h"
+#include "SampleKernels.h"
 
 // Analysing of state of reverb RAM address lines gives exact sizes of the buffers of filters used. This also indicates that
 // the reverb model implemented in the real devices consists of three series allpass filters preceded by a non-feedback comb (or a delay with a LPF)
@@ -34,6 +35,9 @@ static const Bit32u PROCESS_DELAY = 1;
 static const Bit32u MODE_3_ADDITIONAL_DELAY = 1;
 static const Bit32u MODE_3_FEEDBACK_DELAY = 1;
 
+// Maximum number of samples processed at once by BReverbModel::processBlocks()
+static const Bit32u MAX_BLOCK_LENGTH = 256;
+
 // Default reverb settings for "new" reverb model implemented in CM-32L / LAPC-I.
 // Found by tracing reverb RAM data lines (thanks go to Lord_Nightmare & balrog).
 const BReverbSettings &BReverbModel::getCM32L_LAPCSettings(const ReverbMode mode) {
@@ -209,6 +213,10 @@ Sample RingBuffer::next() {
 	return buffer[index];
 }
 
+Bit32u RingBuffer::getTapPosition(const Bit32u delay) const {
+	return (index + 1 + size - delay) % size;
+}
+
 bool RingBuffer::isEmpty() const {
 	if (buffer == NULL) return true;
 
@@ -252,6 +260,25 @@ Sample AllpassFilter::process(const Sample in) {
 #endif
 }
 
+void AllpassFilter::processBlock(const Sample *in, Sample *out, const Bit32u len) {
+#if MT32EMU_USE_FLOAT_SAMPLES
+	for (Bit32u i = 0; i < len; i++) {
+		out[i] = process(in[i]);
+	}
+#else
+	Bit32u start = index + 1;
+	if (start >= size) {
+		start = 0;
+	}
+	const Bit32u firstLen = (start + len > size) ? size - start : len;
+	SampleKernels::allpass(buffer + start, in, out, firstLen);
+	if (firstLen < len) {
+		SampleKernels::allpass(buffer, in + firstLen, out + firstLen, len - firstLen);
+	}
+	index = (start + len - 1) % size;
+#endif
+}
+
 CombFilter::CombFilter(const Bit32u useSize, const Bit32u useFilterFactor) : RingBuffer(useSize), filterFactor(useFilterFactor) {}
 
 void CombFilter::process(const Sample in) {
@@ -267,6 +294,37 @@ void CombFilter::process(const Sample in) {
 	buffer[index] = weirdMul(last, filterFactor, 0xC0) - filterIn;
 }
 
+void CombFilter::processBlock(const Sample *in, Sample *outA, const Bit32u delayA, Sample *outB, const Bit32u delayB, const Bit32u len) {
+	Bit32u tapA = getTapPosition(delayA);
+	Bit32u tapB = getTapPosition(delayB);
+	Sample last = buffer[index];
+
+	for (Bit32u i = 0; i < len; i++) {
+		if (++index >= size) {
+			index = 0;
+		}
+
+		// The taps are read before storing, a delay equal to the size gives the value about to be replaced
+		if (outA != NULL) {
+			outA[i] = buffer[tapA];
+		}
+		if (outB != NULL) {
+			outB[i] = buffer[tapB];
+		}
+
+		const Sample filterIn = in[i] + weirdMul(buffer[index], feedbackFactor, 0xF0);
+		last = weirdMul(last, filterFactor, 0xC0) - filterIn;
+		buffer[index] = last;
+
+		if (++tapA >= size) {
+			tapA = 0;
+		}
+		if (++tapB >= size) {
+			tapB = 0;
+		}
+	}
+}
+
 Sample CombFilter::getOutputAt(const Bit32u outIndex) const {
 	return buffer[(size + index - outIndex) % size];
 }
@@ -292,6 +350,21 @@ void DelayWithLowPassFilter::process(const Sample in) {
 	buffer[index] = weirdMul(lpfOut, amp, 0xFF);
 }
 
+void DelayWithLowPassFilter::processBlock(const Sample *in, Sample *out, const Bit32u len) {
+	Sample last = buffer[index];
+
+	for (Bit32u i = 0; i < len; i++) {
+		if (++index >= size) {
+			index = 0;
+		}
+		out[i] = buffer[index];
+
+		const Sample lpfOut = weirdMul(last, filterFactor, 0xFF) + in[i];
+		last = weirdMul(lpfOut, amp, 0xFF);
+		buffer[index] = last;
+	}
+}
+
 TapDelayCombFilter::TapDelayCombFilter(const Bit32u useSize, const Bit32u useFilterFactor) : CombFilter(useSize, useFilterFactor) {}
 
 void TapDelayCombFilter::process(const Sample in) {
@@ -309,6 +382,40 @@ void TapDelayCombFilter::process(const Sample in) {
 	buffer[index] = weirdMul(last, filterFactor, 0xF0) - filterIn;
 }
 
+void TapDelayCombFilter::processBlock(const Sample *in, Sample *outLeft, Sample *outRight, const Bit32u len) {
+	Bit32u feedbackTap = getTapPosition(outR + MODE_3_FEEDBACK_DELAY);
+	Bit32u leftTap = getTapPosition(outL + PROCESS_DELAY + MODE_3_ADDITIONAL_DELAY);
+	Bit32u rightTap = getTapPosition(outR + PROCESS_DELAY + MODE_3_ADDITIONAL_DELAY);
+	Sample last = buffer[index];
+
+	for (Bit32u i = 0; i < len; i++) {
+		if (++index >= size) {
+			index = 0;
+		}
+
+		const Sample filterIn = in[i] + weirdMul(buffer[feedbackTap], feedbackFactor, 0xF0);
+		last = weirdMul(last, filterFactor, 0xF0) - filterIn;
+		buffer[index] = last;
+
+		if (outLeft != NULL) {
+			outLeft[i] = buffer[leftTap];
+		}
+		if (outRight != NULL) {
+			outRight[i] = buffer[rightTap];
+		}
+
+		if (++feedbackTap >= size) {
+			feedbackTap = 0;
+		}
+		if (++leftTap >= size) {
+			leftTap = 0;
+		}
+		if (++rightTap >= size) {
+			rightTap = 0;
+		}
+	}
+}
+
 Sample TapDelayCombFilter::getLeftOutput() const {
 	return getOutputAt(outL + PROCESS_DELAY + MODE_3_ADDITIONAL_DELAY);
 }
@@ -325,7 +432,14 @@ void TapDelayCombFilter::setOutputPositions(const Bit32u useOutL, const Bit32u u
 BReverbModel::BReverbModel(const ReverbMode mode, const bool mt32CompatibleModel) :
 	allpasses(NULL), combs(NULL),
 	currentSettings(mt32CompatibleModel ? getMT32Settings(mode) : getCM32L_LAPCSettings(mode)),
-	tapDelayMode(mode == REVERB_MODE_TAP_DELAY) {}
+	tapDelayMode(mode == REVERB_MODE_TAP_DELAY), maxBlockLength(MAX_BLOCK_LENGTH) {
+	// The allpass filters can only process blocks up to their size at once
+	for (Bit32u i = 0; i < currentSettings.numberOfAllpasses; i++) {
+		if (currentSettings.allpassSizes[i] < maxBlockLength) {
+			maxBlockLength = currentSettings.allpassSizes[i];
+		}
+	}
+}
 
 BReverbModel::~BReverbModel() {
 	close();
@@ -525,4 +639,73 @@ void BReverbModel::process(const Sample *inLeft, const Sample *inRight, Sample *
 	}
 }
 
+void BReverbModel::processBlocks(const Sample *inLeft, const Sample *inRight, Sample *outLeft, Sample *outRight, unsigned long numSamples) {
+#if MT32EMU_USE_FLOAT_SAMPLES || MT32EMU_BOSS_REVERB_PRECISE_MODE
+	process(inLeft, inRight, outLeft, outRight, numSamples);
+#else
+	if (combs == NULL) {
+		process(inLeft, inRight, outLeft, outRight, numSamples);
+		return;
+	}
+
+	Sample dry[MAX_BLOCK_LENGTH], link[MAX_BLOCK_LENGTH];
+	Sample tapsLeft[3][MAX_BLOCK_LENGTH], tapsRight[3][MAX_BLOCK_LENGTH];
+
+	while (numSamples > 0) {
+		const Bit32u len = numSamples < maxBlockLength ? Bit32u(numSamples) : maxBlockLength;
+
+		if (tapDelayMode) {
+			SampleKernels::reverbDryInput(dry, inLeft, inRight, 1, dryAmp, len);
+
+			TapDelayCombFilter *comb = static_cast<TapDelayCombFilter *> (*combs);
+			comb->processBlock(dry, outLeft != NULL ? tapsLeft[0] : NULL, outRight != NULL ? tapsRight[0] : NULL, len);
+
+			if (outLeft != NULL) {
+				SampleKernels::scale(outLeft, tapsLeft[0], wetLevel, len);
+			}
+			if (outRight != NULL) {
+				SampleKernels::scale(outRight, tapsRight[0], wetLevel, len);
+			}
+		} else {
+			SampleKernels::reverbDryInput(dry, inLeft, inRight, 2, dryAmp, len);
+
+			static_cast<DelayWithLowPassFilter *> (combs[0])->processBlock(dry, link, len);
+
+			// This introduces reverb noise which actually makes output from the real Boss chip nondeterministic
+			for (Bit32u i = 0; i < len; i++) {
+				link[i] = link[i] - 1;
+			}
+			allpasses[0]->processBlock(link, link, len);
+			allpasses[1]->processBlock(link, link, len);
+			allpasses[2]->processBlock(link, link, len);
+
+			// The taps of the combs are read before the new sample is stored. This matters for the left output of the first comb only,
+			// process() also reads it beforehand. All other positions are below the comb sizes.
+			for (Bit32u i = 1; i < 4; i++) {
+				combs[i]->processBlock(link,
+					outLeft != NULL ? tapsLeft[i - 1] : NULL, currentSettings.outLPositions[i - 1],
+					outRight != NULL ? tapsRight[i - 1] : NULL, currentSettings.outRPositions[i - 1], len);
+			}
+
+			if (outLeft != NULL) {
+				SampleKernels::reverbWetOutput(outLeft, tapsLeft[0], tapsLeft[1], tapsLeft[2], wetLevel, len);
+			}
+			if (outRight != NULL) {
+				SampleKernels::reverbWetOutput(outRight, tapsRight[0], tapsRight[1], tapsRight[2], wetLevel, len);
+			}
+		}
+
+		inLeft += len;
+		inRight += len;
+		if (outLeft != NULL) {
+			outLeft += len;
+		}
+		if (outRight != NULL) {
+			outRight += len;
+		}
+		numSamples -= len;
+	}
+#endif
+}
+
 }
@@ -40,6 +40,9 @@ protected:
 	const Bit32u size;
 	Bit32u index;
 
+	// Position of the sample stored delay samples before the next one
+	Bit32u getTapPosition(const Bit32u delay) const;
+
 public:
 	RingBuffer(const Bit32u size);
 	virtual ~RingBuffer();
@@ -48,10 +51,15 @@ public:
 	void mute();
 };
 
+// The block processing methods below run len samples at once and produce exactly the same result as calling process() for each of them.
+// Where a method taps the ring buffer, outX[i] receives the sample stored delayX samples before the i-th new sample (0 < delayX <= size).
+
 class AllpassFilter : public RingBuffer {
 public:
 	AllpassFilter(const Bit32u size);
 	Sample process(const Sample in);
+	// len must not exceed the size of the filter. May run in place.
+	void processBlock(const Sample *in, Sample *out, const Bit32u len);
 };
 
 class CombFilter : public RingBuffer {
@@ -62,6 +70,7 @@ protected:
 public:
 	CombFilter(const Bit32u size, const Bit32u useFilterFactor);
 	virtual void process(const Sample in);
+	void processBlock(const Sample *in, Sample *outA, const Bit32u delayA, Sample *outB, const Bit32u delayB, const Bit32u len);
 	Sample getOutputAt(const Bit32u outIndex) const;
 	void setFeedbackFactor(const Bit32u useFeedbackFactor);
 };
@@ -72,6 +81,8 @@ class DelayWithLowPassFilter : public CombFilter {
 public:
 	DelayWithLowPassFilter(const Bit32u useSize, const Bit32u useFilterFactor, const Bit32u useAmp);
 	void process(const Sample in);
+	// out receives the samples leaving the delay line
+	void processBlock(const Sample *in, Sample *out, const Bit32u len);
 	void setFeedbackFactor(const Bit32u) {}
 };
 
@@ -82,6 +93,7 @@ class TapDelayCombFilter : public CombFilter {
 public:
 	TapDelayCombFilter(const Bit32u useSize, const Bit32u useFilterFactor);
 	void process(const Sample in);
+	void processBlock(const Sample *in, Sample *outL, Sample *outR, const Bit32u len);
 	Sample getLeftOutput() const;
 	Sample getRightOutput() const;
 	void setOutputPositions(const Bit32u useOutL, const Bit32u useOutR);
@@ -95,6 +107,7 @@ class BReverbModel {
 	const bool tapDelayMode;
 	Bit32u dryAmp;
 	Bit32u wetLevel;
+	Bit32u maxBlockLength;
 
 	static const BReverbSettings &getCM32L_LAPCSettings(const ReverbMode mode);
 	static const BReverbSettings &getMT32Settings(const ReverbMode mode);
@@ -109,6 +122,8 @@ public:
 	void mute();
 	void setParameters(Bit8u time, Bit8u level);
 	void process(const Sample *inLeft, const Sample *inRight, Sample *outLeft, Sample *outRight, unsigned long numSamples);
+	// Same as process() but runs each filter over a block of samples at a time, used in RenderingMode_SIMD.
+	void processBlocks(const Sample *inLeft, const Sample *inRight, Sample *outLeft, Sample *outRight, unsigned long numSamples);
 	bool isActive() const;
 	bool isMT32Compatible(const ReverbMode mode) const;
 };
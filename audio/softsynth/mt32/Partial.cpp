@@ -22,6 +22,7 @@
 #include "mt32emu.h"
 #include "mmath.h"
 #include "internals.h"
+#include "SampleKernels.h"
 
 namespace MT32Emu {
 
@@ -276,6 +277,13 @@ bool Partial::produceOutput(Sample *leftBuf, Sample *rightBuf, unsigned long len
 	}
 	alreadyOutputed = true;
 
+#if !MT32EMU_USE_FLOAT_SAMPLES
+	// In RenderingMode_SIMD, the samples are generated first and panned and mixed in a single pass afterwards
+	Sample blockBuf[MAX_SAMPLES_PER_RUN];
+	Sample *blockOut = blockBuf;
+	const bool mixBlock = synth->renderingMode == RenderingMode_SIMD && length <= MAX_SAMPLES_PER_RUN;
+#endif
+
 	for (sampleNum = 0; sampleNum < length; sampleNum++) {
 		if (!tva->isPlaying() || !la32Pair.isActive(LA32PartialPair::MASTER)) {
 			deactivate();
@@ -304,6 +312,11 @@ bool Partial::produceOutput(Sample *leftBuf, Sample *rightBuf, unsigned long len
 		*(leftBuf++) += leftOut;
 		*(rightBuf++) += rightOut;
 #else
+		if (mixBlock) {
+			*(blockOut++) = sample;
+			continue;
+		}
+
 		// FIXME: Dividing by 7 (or by 14 in a Mok-friendly way) looks of course pointless. Need clarification.
 		// FIXME2: LA32 may produce distorted sound in case if the absolute value of maximal amplitude of the input exceeds 8191
 		// when the panning value is non-zero. Most probably the distortion occurs in the same way it does with ring modulation,
@@ -319,6 +332,11 @@ bool Partial::produceOutput(Sample *leftBuf, Sample *rightBuf, unsigned long len
 		rightBuf++;
 #endif
 	}
+#if !MT32EMU_USE_FLOAT_SAMPLES
+	if (mixBlock) {
+		SampleKernels::mixPanned(leftBuf, rightBuf, blockBuf, leftPanValue, rightPanValue, Bit32u(blockOut - blockBuf));
+	}
+#endif
 	sampleNum = 0;
 	return true;
 }
@@ -0,0 +1,203 @@
+/* Copyright (C) 2003, 2004, 2005, 2006, 2008, 2009 Dean Beeler, Jerome Fisher
+ * Copyright (C) 2011, 2012, 2013, 2014 Dean Beeler, Jerome Fisher, Sergey V. Mikayev
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation, either version 2.1 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MT32EMU_SAMPLE_KERNELS_H
+#define MT32EMU_SAMPLE_KERNELS_H
+
+// Block kernels used in RenderingMode_SIMD. Each of them produces exactly the same samples as the per-sample code it replaces,
+// including the wrap-around of the 16-bit arithmetic, so both rendering modes remain interchangeable.
+// Only the 16-bit integer sample format is supported.
+
+#if !MT32EMU_USE_FLOAT_SAMPLES
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define MT32EMU_SIMD_SSE2 1
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MT32EMU_SIMD_NEON 1
+#endif
+
+namespace MT32Emu {
+
+namespace SampleKernels {
+
+#if MT32EMU_SIMD_SSE2
+// Returns Sample((a * factor) >> 8) for each lane, truncating the result like a plain cast does
+static inline __m128i mulShift8(const __m128i a, const __m128i factor) {
+	const __m128i lo = _mm_mullo_epi16(a, factor);
+	const __m128i hi = _mm_mulhi_epi16(a, factor);
+	__m128i p0 = _mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), 8);
+	__m128i p1 = _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), 8);
+	p0 = _mm_srai_epi32(_mm_slli_epi32(p0, 16), 16);
+	p1 = _mm_srai_epi32(_mm_slli_epi32(p1, 16), 16);
+	return _mm_packs_epi32(p0, p1);
+}
+#elif MT32EMU_SIMD_NEON
+static inline int16x8_t mulShift8(const int16x8_t a, const int16x4_t factor) {
+	const int32x4_t p0 = vshrq_n_s32(vmull_s16(vget_low_s16(a), factor), 8);
+	const int32x4_t p1 = vshrq_n_s32(vmull_s16(vget_high_s16(a), factor), 8);
+	return vcombine_s16(vmovn_s32(p0), vmovn_s32(p1));
+}
+#endif
+
+// Pans a mono partial output and adds it to the stereo buffers with saturation
+static inline void mixPanned(Sample *leftBuf, Sample *rightBuf, const Sample *in, Bit32s leftPan, Bit32s rightPan, Bit32u len) {
+	Bit32u i = 0;
+#if MT32EMU_SIMD_SSE2
+	const __m128i vLeftPan = _mm_set1_epi16(Bit16s(leftPan));
+	const __m128i vRightPan = _mm_set1_epi16(Bit16s(rightPan));
+	for (; i + 8 <= len; i += 8) {
+		const __m128i s = _mm_loadu_si128((const __m128i *)(in + i));
+		const __m128i l = _mm_loadu_si128((const __m128i *)(leftBuf + i));
+		const __m128i r = _mm_loadu_si128((const __m128i *)(rightBuf + i));
+		_mm_storeu_si128((__m128i *)(leftBuf + i), _mm_adds_epi16(l, mulShift8(s, vLeftPan)));
+		_mm_storeu_si128((__m128i *)(rightBuf + i), _mm_adds_epi16(r, mulShift8(s, vRightPan)));
+	}
+#elif MT32EMU_SIMD_NEON
+	const int16x4_t vLeftPan = vdup_n_s16(Bit16s(leftPan));
+	const int16x4_t vRightPan = vdup_n_s16(Bit16s(rightPan));
+	for (; i + 8 <= len; i += 8) {
+		const int16x8_t s = vld1q_s16(in + i);
+		vst1q_s16(leftBuf + i, vqaddq_s16(vld1q_s16(leftBuf + i), mulShift8(s, vLeftPan)));
+		vst1q_s16(rightBuf + i, vqaddq_s16(vld1q_s16(rightBuf + i), mulShift8(s, vRightPan)));
+	}
+#endif
+	for (; i < len; i++) {
+		const Sample leftOut = Sample((in[i] * leftPan) >> 8);
+		const Sample rightOut = Sample((in[i] * rightPan) >> 8);
+		leftBuf[i] = Synth::clipSampleEx((SampleEx)leftBuf[i] + (SampleEx)leftOut);
+		rightBuf[i] = Synth::clipSampleEx((SampleEx)rightBuf[i] + (SampleEx)rightOut);
+	}
+}
+
+// Computes the reverb input from the dry stereo signal: ((left >> shift) + (right >> shift)) * amp >> 8
+static inline void reverbDryInput(Sample *out, const Sample *inLeft, const Sample *inRight, const int shift, Bit32u amp, Bit32u len) {
+	Bit32u i = 0;
+#if MT32EMU_SIMD_SSE2
+	const __m128i vAmp = _mm_set1_epi16(Bit16s(amp));
+	const __m128i vShift = _mm_cvtsi32_si128(shift);
+	for (; i + 8 <= len; i += 8) {
+		const __m128i l = _mm_sra_epi16(_mm_loadu_si128((const __m128i *)(inLeft + i)), vShift);
+		const __m128i r = _mm_sra_epi16(_mm_loadu_si128((const __m128i *)(inRight + i)), vShift);
+		_mm_storeu_si128((__m128i *)(out + i), mulShift8(_mm_add_epi16(l, r), vAmp));
+	}
+#elif MT32EMU_SIMD_NEON
+	const int16x4_t vAmp = vdup_n_s16(Bit16s(amp));
+	const int16x8_t vShift = vdupq_n_s16(Bit16s(-shift));
+	for (; i + 8 <= len; i += 8) {
+		const int16x8_t l = vshlq_s16(vld1q_s16(inLeft + i), vShift);
+		const int16x8_t r = vshlq_s16(vld1q_s16(inRight + i), vShift);
+		vst1q_s16(out + i, mulShift8(vaddq_s16(l, r), vAmp));
+	}
+#endif
+	for (; i < len; i++) {
+		const Sample dry = Sample((inLeft[i] >> shift) + (inRight[i] >> shift));
+		out[i] = Sample(((Bit32s)dry * (Bit32s)amp) >> 8);
+	}
+}
+
+// Runs an allpass filter over a contiguous part of its ring buffer. The block must not be longer than the filter,
+// then every value read from the buffer was written before the block started. May run in place.
+static inline void allpass(Sample *buffer, const Sample *in, Sample *out, Bit32u len) {
+	Bit32u i = 0;
+#if MT32EMU_SIMD_SSE2
+	for (; i + 8 <= len; i += 8) {
+		const __m128i bufferOut = _mm_loadu_si128((const __m128i *)(buffer + i));
+		const __m128i stored = _mm_sub_epi16(_mm_loadu_si128((const __m128i *)(in + i)), _mm_srai_epi16(bufferOut, 1));
+		_mm_storeu_si128((__m128i *)(buffer + i), stored);
+		_mm_storeu_si128((__m128i *)(out + i), _mm_add_epi16(bufferOut, _mm_srai_epi16(stored, 1)));
+	}
+#elif MT32EMU_SIMD_NEON
+	for (; i + 8 <= len; i += 8) {
+		const int16x8_t bufferOut = vld1q_s16(buffer + i);
+		const int16x8_t stored = vsubq_s16(vld1q_s16(in + i), vshrq_n_s16(bufferOut, 1));
+		vst1q_s16(buffer + i, stored);
+		vst1q_s16(out + i, vaddq_s16(bufferOut, vshrq_n_s16(stored, 1)));
+	}
+#endif
+	for (; i < len; i++) {
+		const Sample bufferOut = buffer[i];
+		buffer[i] = Sample(in[i] - (bufferOut >> 1));
+		out[i] = Sample(bufferOut + (buffer[i] >> 1));
+	}
+}
+
+// Sums the comb filter taps of one reverb channel with saturation and applies the wet level
+static inline void reverbWetOutput(Sample *out, const Sample *out1, const Sample *out2, const Sample *out3, Bit32u wetLevel, Bit32u len) {
+	Bit32u i = 0;
+#if MT32EMU_SIMD_SSE2
+	const __m128i vWet = _mm_set1_epi16(Bit16s(wetLevel));
+	for (; i + 8 <= len; i += 8) {
+		const __m128i o1 = _mm_loadu_si128((const __m128i *)(out1 + i));
+		const __m128i o2 = _mm_loadu_si128((const __m128i *)(out2 + i));
+		const __m128i o3 = _mm_loadu_si128((const __m128i *)(out3 + i));
+		// Sign extend to 32 bits
+		const __m128i a0 = _mm_srai_epi32(_mm_unpacklo_epi16(o1, o1), 16), a1 = _mm_srai_epi32(_mm_unpackhi_epi16(o1, o1), 16);
+		const __m128i b0 = _mm_srai_epi32(_mm_unpacklo_epi16(o2, o2), 16), b1 = _mm_srai_epi32(_mm_unpackhi_epi16(o2, o2), 16);
+		const __m128i c0 = _mm_srai_epi32(_mm_unpacklo_epi16(o3, o3), 16), c1 = _mm_srai_epi32(_mm_unpackhi_epi16(o3, o3), 16);
+		const __m128i s0 = _mm_add_epi32(_mm_add_epi32(_mm_add_epi32(a0, _mm_srai_epi32(a0, 1)), _mm_add_epi32(b0, _mm_srai_epi32(b0, 1))), c0);
+		const __m128i s1 = _mm_add_epi32(_mm_add_epi32(_mm_add_epi32(a1, _mm_srai_epi32(a1, 1)), _mm_add_epi32(b1, _mm_srai_epi32(b1, 1))), c1);
+		_mm_storeu_si128((__m128i *)(out + i), mulShift8(_mm_packs_epi32(s0, s1), vWet));
+	}
+#elif MT32EMU_SIMD_NEON
+	const int16x4_t vWet = vdup_n_s16(Bit16s(wetLevel));
+	for (; i + 8 <= len; i += 8) {
+		const int16x8_t o1 = vld1q_s16(out1 + i);
+		const int16x8_t o2 = vld1q_s16(out2 + i);
+		const int16x8_t o3 = vld1q_s16(out3 + i);
+		int32x4_t s0 = vaddl_s16(vget_low_s16(o1), vget_low_s16(vshrq_n_s16(o1, 1)));
+		int32x4_t s1 = vaddl_s16(vget_high_s16(o1), vget_high_s16(vshrq_n_s16(o1, 1)));
+		s0 = vaddq_s32(s0, vaddl_s16(vget_low_s16(o2), vget_low_s16(vshrq_n_s16(o2, 1))));
+		s1 = vaddq_s32(s1, vaddl_s16(vget_high_s16(o2), vget_high_s16(vshrq_n_s16(o2, 1))));
+		s0 = vaddw_s16(s0, vget_low_s16(o3));
+		s1 = vaddw_s16(s1, vget_high_s16(o3));
+		vst1q_s16(out + i, mulShift8(vcombine_s16(vqmovn_s32(s0), vqmovn_s32(s1)), vWet));
+	}
+#endif
+	for (; i < len; i++) {
+		const Sample outSample = Synth::clipSampleEx((SampleEx)out1[i] + SampleEx(out1[i] >> 1) + (SampleEx)out2[i] + SampleEx(out2[i] >> 1) + (SampleEx)out3[i]);
+		out[i] = Sample(((Bit32s)outSample * (Bit32s)wetLevel) >> 8);
+	}
+}
+
+// Applies a level factor: Sample((in * factor) >> 8)
+static inline void scale(Sample *out, const Sample *in, Bit32u factor, Bit32u len) {
+	Bit32u i = 0;
+#if MT32EMU_SIMD_SSE2
+	const __m128i vFactor = _mm_set1_epi16(Bit16s(factor));
+	for (; i + 8 <= len; i += 8) {
+		_mm_storeu_si128((__m128i *)(out + i), mulShift8(_mm_loadu_si128((const __m128i *)(in + i)), vFactor));
+	}
+#elif MT32EMU_SIMD_NEON
+	const int16x4_t vFactor = vdup_n_s16(Bit16s(factor));
+	for (; i + 8 <= len; i += 8) {
+		vst1q_s16(out + i, mulShift8(vld1q_s16(in + i), vFactor));
+	}
+#endif
+	for (; i < len; i++) {
+		out[i] = Sample(((Bit32s)in[i] * (Bit32s)factor) >> 8);
+	}
+}
+
+}
+
+}
+
+#endif
+
+#endif
@@ -82,6 +82,7 @@ Synth::Synth(ReportHandler *useReportHandler) : mt32ram(*new MemParams()), mt32d
 	analog = NULL;
 	setDACInputMode(DACInputMode_NICE);
 	setMIDIDelayMode(MIDIDelayMode_DELAY_SHORT_MESSAGES_ONLY);
+	setRenderingMode(RenderingMode_SIMD);
 	setOutputGain(1.0f);
 	setReverbOutputGain(1.0f);
 	setReversedStereoEnabled(false);
@@ -215,6 +216,14 @@ MIDIDelayMode Synth::getMIDIDelayMode() const {
 	return midiDelayMode;
 }
 
+void Synth::setRenderingMode(RenderingMode mode) {
+	renderingMode = mode;
+}
+
+RenderingMode Synth::getRenderingMode() const {
+	return renderingMode;
+}
+
 void Synth::setOutputGain(float newOutputGain) {
 	if (newOutputGain < 0.0f) newOutputGain = -newOutputGain;
 	outputGain = newOutputGain;
@@ -1621,7 +1630,11 @@ void Synth::doRenderStreams(Sample *nonReverbLeft, Sample *nonReverbRight, Sampl
 		produceLA32Output(reverbDryRight, len);
 
 		if (isReverbEnabled()) {
-			reverbModel->process(reverbDryLeft, reverbDryRight, reverbWetLeft, reverbWetRight, len);
+			if (renderingMode == RenderingMode_SIMD) {
+				reverbModel->processBlocks(reverbDryLeft, reverbDryRight, reverbWetLeft, reverbWetRight, len);
+			} else {
+				reverbModel->process(reverbDryLeft, reverbDryRight, reverbWetLeft, reverbWetRight, len);
+			}
 			if (reverbWetLeft != NULL) convertSamplesToOutput(reverbWetLeft, len);
 			if (reverbWetRight != NULL) convertSamplesToOutput(reverbWetRight, len);
 		} else {
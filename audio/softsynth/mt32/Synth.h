@@ -103,6 +103,15 @@ enum AnalogOutputMode {
 	AnalogOutputMode_OVERSAMPLED
 };
 
+// Implementations of the sample processing loops. Both produce exactly the same output.
+enum RenderingMode {
+	// Reference implementation which processes one sample at a time.
+	RenderingMode_SCALAR,
+	// Processes partial output and reverb in blocks of samples, using SSE2 or NEON where available.
+	// Falls back to RenderingMode_SCALAR when float samples or the precise Boss reverb mode are in use.
+	RenderingMode_SIMD
+};
+
 enum ReverbMode {
 	REVERB_MODE_ROOM,
 	REVERB_MODE_HALL,
@@ -209,6 +218,7 @@ private:
 
 	MIDIDelayMode midiDelayMode;
 	DACInputMode dacInputMode;
+	RenderingMode renderingMode;
 
 	float outputGain;
 	float reverbOutputGain;
@@ -372,6 +382,10 @@ public:
 	DACInputMode getDACInputMode() const;
 	void setMIDIDelayMode(MIDIDelayMode mode);
 	MIDIDelayMode getMIDIDelayMode() const;
+	// Selects the implementation of the sample processing loops. Both keep the same internal state, so the mode may be changed at any time.
+	// Defaults to RenderingMode_SIMD.
+	void setRenderingMode(RenderingMode mode);
+	RenderingMode getRenderingMode() const;
 
 	// Sets output gain factor for synth output channels. Applied to all output samples and unrelated with the synth's Master volume,
 	// it rather corresponds to the gain of the output analog circuitry of the hardware units. However, together with setReverbOutputGain()
@@ -0,0 +1,95 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/softsynth/mt32_eventqueue.h"
+
+uint32 MidiEventQueue_MT32::loadAcquire(const uint32 &value) {
+#if defined(__GNUC__)
+	return __atomic_load_n(&value, __ATOMIC_ACQUIRE);
+#else
+	return *(const volatile uint32 *)&value;
+#endif
+}
+
+void MidiEventQueue_MT32::storeRelease(uint32 &value, uint32 newValue) {
+#if defined(__GNUC__)
+	__atomic_store_n(&value, newValue, __ATOMIC_RELEASE);
+#else
+	*(volatile uint32 *)&value = newValue;
+#endif
+}
+
+bool MidiEventQueue_MT32::push(uint32 msg, const byte *data, uint32 len) {
+	const uint32 eventWrite = _eventWrite;
+	if (eventWrite - loadAcquire(_eventRead) >= kEventCount) {
+		++_overflowCount;
+		return false;
+	}
+
+	Event &event = _events[eventWrite & (kEventCount - 1)];
+	event.msg = msg;
+	event.len = len;
+	event.sysExStart = event.sysExEnd = _sysExWrite;
+
+	if (len > 0) {
+		// Payloads are kept contiguous, skip the end of the ring if needed
+		uint32 start = _sysExWrite;
+		const uint32 offset = start & (kSysExBufferSize - 1);
+		if (offset + len > kSysExBufferSize)
+			start += kSysExBufferSize - offset;
+
+		if (start + len - loadAcquire(_sysExRead) > kSysExBufferSize) {
+			++_overflowCount;
+			return false;
+		}
+
+		memcpy(_sysExBuffer + (start & (kSysExBufferSize - 1)), data, len);
+		event.sysExStart = start;
+		event.sysExEnd = _sysExWrite = start + len;
+	}
+
+	storeRelease(_eventWrite, eventWrite + 1);
+	return true;
+}
+
+bool MidiEventQueue_MT32::peek(uint32 &msg, const byte *&data, uint32 &len) const {
+	if (_eventRead == loadAcquire(_eventWrite))
+		return false;
+
+	const Event &event = _events[_eventRead & (kEventCount - 1)];
+	msg = event.msg;
+	len = event.len;
+	data = len ? _sysExBuffer + (event.sysExStart & (kSysExBufferSize - 1)) : NULL;
+	return true;
+}
+
+void MidiEventQueue_MT32::pop() {
+	const Event &event = _events[_eventRead & (kEventCount - 1)];
+	storeRelease(_sysExRead, event.sysExEnd);
+	storeRelease(_eventRead, _eventRead + 1);
+}
+
+void MidiEventQueue_MT32::reset() {
+	_eventRead = _eventWrite = 0;
+	_sysExRead = _sysExWrite = 0;
+	_overflowCount = 0;
+}
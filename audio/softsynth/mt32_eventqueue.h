@@ -0,0 +1,95 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef AUDIO_SOFTSYNTH_MT32_EVENTQUEUE_H
+#define AUDIO_SOFTSYNTH_MT32_EVENTQUEUE_H
+
+#include "common/scummsys.h"
+
+/**
+ * Bounded single producer, single consumer queue which passes MIDI events from
+ * the timer thread running the music player to the mixer thread. Events and
+ * SysEx payloads are stored in preallocated rings, so neither side has to lock
+ * or allocate. Events which do not fit are dropped and counted instead of
+ * blocking the producer on a mixer which might not be running.
+ */
+class MidiEventQueue_MT32 {
+public:
+	MidiEventQueue_MT32() { reset(); }
+
+	/**
+	 * Queue an event. Only to be called from the producer thread.
+	 *
+	 * @param msg   the short MIDI message, or 0xFFFFFFFF for SysEx
+	 * @param data  the SysEx payload, or NULL
+	 * @param len   length of the SysEx payload
+	 * @return false if the queue was full and the event got dropped
+	 */
+	bool push(uint32 msg, const byte *data, uint32 len);
+
+	/**
+	 * Look at the oldest event without removing it. Only to be called from
+	 * the consumer thread. The SysEx data stays valid until pop().
+	 *
+	 * @return false if the queue is empty
+	 */
+	bool peek(uint32 &msg, const byte *&data, uint32 &len) const;
+
+	/** Remove the oldest event. Only to be called from the consumer thread. */
+	void pop();
+
+	/** Drop all events. Neither thread may be using the queue. */
+	void reset();
+
+	/** Number of events dropped because the queue was full. */
+	uint32 getOverflowCount() const { return _overflowCount; }
+
+private:
+	enum {
+		// Both sizes must be powers of two
+		kEventCount = 1024,
+		kSysExBufferSize = 8192
+	};
+
+	struct Event {
+		uint32 msg;
+		uint32 len;
+		uint32 sysExStart;
+		uint32 sysExEnd;
+	};
+
+	static uint32 loadAcquire(const uint32 &value);
+	static void storeRelease(uint32 &value, uint32 newValue);
+
+	Event _events[kEventCount];
+	byte _sysExBuffer[kSysExBufferSize];
+
+	// All positions are free running and only wrapped on access. Each write
+	// position is only changed by the producer, each read position only by
+	// the consumer.
+	uint32 _eventRead, _eventWrite;
+	uint32 _sysExRead, _sysExWrite;
+
+	uint32 _overflowCount;
+};
+
+#endif
@@ -40,6 +40,12 @@
 #include <math.h>
 #include <string.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace OPL {
 namespace DOSBox {
 
@@ -145,6 +151,61 @@ uint8 Chip::read() {
 	return ret;
 }
 
+/**
+ * Convert the mix to 16 bit. Like a plain cast, this keeps the low bits of
+ * samples which are out of range.
+ */
+static void convertSamples(int16 *dst, const int32 *src, uint count) {
+	uint i = 0;
+
+#if defined(__SSE2__)
+	for (; i + 8 <= count; i += 8) {
+		__m128i lo = _mm_loadu_si128((const __m128i *)(src + i));
+		__m128i hi = _mm_loadu_si128((const __m128i *)(src + i + 4));
+		// Sign extend the low halves, so the pack does not saturate
+		lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+		hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi32(lo, hi));
+	}
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+	for (; i + 8 <= count; i += 8)
+		vst1q_s16(dst + i, vcombine_s16(vmovn_s32(vld1q_s32(src + i)), vmovn_s32(vld1q_s32(src + i + 4))));
+#endif
+
+	for (; i < count; ++i)
+		dst[i] = src[i];
+}
+
+static void renderFrames(DBOPL::Chip &chip, int16 *buffer, uint frames, bool stereo) {
+	const uint bufferLength = 512;
+	int32 tempBuffer[bufferLength * 2];
+
+	while (frames > 0) {
+		const uint readFrames = MIN<uint>(frames, bufferLength);
+
+		if (chip.opl3Active) {
+			chip.GenerateBlock3(readFrames, tempBuffer);
+			if (stereo) {
+				convertSamples(buffer, tempBuffer, readFrames << 1);
+			} else {
+				for (uint i = 0; i < readFrames; ++i)
+					buffer[i] = tempBuffer[i << 1];
+			}
+		} else {
+			chip.GenerateBlock2(readFrames, tempBuffer);
+			if (stereo) {
+				for (uint i = 0; i < readFrames; ++i)
+					buffer[i << 1] = buffer[(i << 1) + 1] = tempBuffer[i];
+			} else {
+				convertSamples(buffer, tempBuffer, readFrames);
+			}
+		}
+
+		buffer += stereo ? (readFrames << 1) : readFrames;
+		frames -= readFrames;
+	}
+}
+
 OPL::OPL(Config::OplType type) : _type(type), _rate(0), _emulator(0) {
 }
 
@@ -159,6 +220,8 @@ void OPL::free() {
 }
 
 bool OPL::init() {
+	Common::StackLock lock(_mutex);
+
 	free();
 
 	memset(&_reg, 0, sizeof(_reg));
@@ -190,7 +253,7 @@ void OPL::write(int port, int val) {
 		case Config::kOpl2:
 		case Config::kOpl3:
 			if (!_chip[0].write(_reg.normal, val))
-				_emulator->WriteReg(_reg.normal, val);
+				writeEmulator(_reg.normal, val);
 			break;
 		case Config::kDualOpl2:
 			// Not a 0x??8 port, then write to a specific port
@@ -209,10 +272,10 @@ void OPL::write(int port, int val) {
 		// Make sure to clip them in the right range
 		switch (_type) {
 		case Config::kOpl2:
-			_reg.normal = _emulator->WriteAddr(port, val) & 0xff;
+			_reg.normal = writeEmulatorAddr(port, val) & 0xff;
 			break;
 		case Config::kOpl3:
-			_reg.normal = _emulator->WriteAddr(port, val) & 0x1ff;
+			_reg.normal = writeEmulatorAddr(port, val) & 0x1ff;
 			break;
 		case Config::kDualOpl2:
 			// Not a 0x?88 port, when write to a specific side
@@ -306,43 +369,28 @@ void OPL::dualWrite(uint8 index, uint8 reg, uint8 val) {
 	}
 
 	uint32 fullReg = reg + (index ? 0x100 : 0);
-	_emulator->WriteReg(fullReg, val);
+	writeEmulator(fullReg, val);
 }
 
-void OPL::generateSamples(int16 *buffer, int length) {
-	// For stereo OPL cards, we divide the sample count by 2,
-	// to match stereo AudioStream behavior.
-	if (_type != Config::kOpl2)
-		length >>= 1;
-
-	const uint bufferLength = 512;
-	int32 tempBuffer[bufferLength * 2];
-
-	if (_emulator->opl3Active) {
-		while (length > 0) {
-			const uint readSamples = MIN<uint>(length, bufferLength);
-
-			_emulator->GenerateBlock3(readSamples, tempBuffer);
-
-			for (uint i = 0; i < (readSamples << 1); ++i)
-				buffer[i] = tempBuffer[i];
+uint32 OPL::writeEmulatorAddr(int port, uint8 val) {
+	Common::StackLock lock(_mutex);
+	return _emulator->WriteAddr(port, val);
+}
 
-			buffer += (readSamples << 1);
-			length -= readSamples;
-		}
-	} else {
-		while (length > 0) {
-			const uint readSamples = MIN<uint>(length, bufferLength << 1);
+void OPL::writeEmulator(uint32 reg, uint8 val) {
+	Common::StackLock lock(_mutex);
+	_emulator->WriteReg(reg, val);
+}
 
-			_emulator->GenerateBlock2(readSamples, tempBuffer);
+void OPL::generateSamples(int16 *buffer, int length) {
+	Common::StackLock lock(_mutex);
 
-			for (uint i = 0; i < readSamples; ++i)
-				buffer[i] = tempBuffer[i];
+	// For stereo OPL cards, we divide the sample count by 2,
+	// to match stereo AudioStream behavior.
+	const bool stereo = (_type != Config::kOpl2);
+	const uint frames = stereo ? (length >> 1) : length;
 
-			buffer += readSamples;
-			length -= readSamples;
-		}
-	}
+	renderFrames(*_emulator, buffer, frames, stereo);
 }
 
 } // End of namespace DOSBox
@@ -34,6 +34,8 @@
 
 #include "audio/fmopl.h"
 
+#include "common/mutex.h"
+
 namespace OPL {
 namespace DOSBox {
 
@@ -81,8 +83,13 @@ private:
 		uint8 dual[2];
 	} _reg;
 
+	// Register writes may come from other threads than the mixer
+	Common::Mutex _mutex;
+
 	void free();
 	void dualWrite(uint8 index, uint8 reg, uint8 val);
+	uint32 writeEmulatorAddr(int port, uint8 val);
+	void writeEmulator(uint32 reg, uint8 val);
 public:
 	OPL(Config::OplType type);
 	~OPL();
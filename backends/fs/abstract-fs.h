@@ -173,6 +173,16 @@ public:
 	 */
 	virtual bool isWritable() const = 0;
 
+	/**
+	 * Returns the size and the time of the last modification of the file
+	 * referred by this node, so callers can tell whether it has changed.
+	 * The default implementation reports them as unavailable.
+	 *
+	 * @param size				set to the size of the file in bytes
+	 * @param modificationTime	set to the time of the last modification, in a backend specific unit
+	 * @return bool true if the information is available, false otherwise.
+	 */
+	virtual bool getFileStats(uint32 &size, uint32 &modificationTime) const { return false; }
 
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
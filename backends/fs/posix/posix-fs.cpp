@@ -38,6 +38,9 @@
 #include <stdio.h>
 #include <errno.h>
 #include <fcntl.h>
+#ifndef PLAYSTATION3
+#include <sys/stat.h>
+#endif
 
 void POSIXFilesystemNode::setFlags()
 {
@@ -157,6 +160,20 @@ AbstractFSNode *POSIXFilesystemNode::getParent() const
 	return makeNode(Common::String(start, end));
 }
 
+bool POSIXFilesystemNode::getFileStats(uint32 &size, uint32 &modificationTime) const {
+#ifndef PLAYSTATION3
+	struct stat st;
+	if (stat(_path.c_str(), &st) != 0 || S_ISDIR(st.st_mode))
+		return false;
+
+	size = (uint32)st.st_size;
+	modificationTime = (uint32)st.st_mtime;
+	return true;
+#else
+	return false;
+#endif
+}
+
 Common::SeekableReadStream *POSIXFilesystemNode::createReadStream() {
 	return StdioStream::makeFromPath(getPath(), false);
 }
@@ -0,0 +1,589 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+/* Headless benchmark driver for the libretro core.
+ *
+ * Loads the core with dlopen(), runs a .scummvm file for a number of frames
+ * with stub video/audio callbacks and reports per frame time percentiles.
+ * The time spent in the core is split with its performance counters into
+ * emulation (the engine running on the emulator thread), presentation
+ * (updateScreen() converting the screen) and audio mixing.
+ *
+ * Usage: retro_bench [options] <core> <game.scummvm>
+ *   -n <frames>        number of frames to run (default 3600)
+ *   -i <script>        input script
+ *   -s <dir>           system and save directory (default .)
+ *   -o <key>=<value>   core option, may be repeated
+ *   -v                 show the core's log
+ *
+ * The timing option defaults to "fixed", so runs of the same game with the
+ * same script are reproducible.
+ *
+ * Input scripts contain one event per line, '#' starts a comment:
+ *   <frame> press <button>          hold a joypad button
+ *   <frame> release <button>        release it again
+ *   <frame> mouse <dx> <dy>         move the mouse during that frame
+ *   <frame> click <left|right> <down|up>
+ *   <frame> key <keycode> <down|up> [character]
+ * Buttons are b, y, select, start, up, down, left, right, a, x, l, r,
+ * keycodes are the RETROK_* values.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <dlfcn.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "libretro.h"
+
+#define MAX_OPTIONS 32
+#define MAX_COUNTERS 32
+#define MAX_EVENTS 4096
+
+enum
+{
+   EVENT_PRESS,
+   EVENT_RELEASE,
+   EVENT_MOUSE,
+   EVENT_CLICK,
+   EVENT_KEY
+};
+
+struct bench_event
+{
+   unsigned frame;
+   int type;
+   int a, b, c;
+};
+
+struct bench_core
+{
+   void (*retro_set_environment)(retro_environment_t);
+   void (*retro_set_video_refresh)(retro_video_refresh_t);
+   void (*retro_set_audio_sample)(retro_audio_sample_t);
+   void (*retro_set_audio_sample_batch)(retro_audio_sample_batch_t);
+   void (*retro_set_input_poll)(retro_input_poll_t);
+   void (*retro_set_input_state)(retro_input_state_t);
+   void (*retro_init)(void);
+   void (*retro_deinit)(void);
+   bool (*retro_load_game)(const struct retro_game_info *);
+   void (*retro_unload_game)(void);
+   void (*retro_get_system_av_info)(struct retro_system_av_info *);
+   void (*retro_run)(void);
+};
+
+static struct bench_core core;
+
+static const char *system_dir = ".";
+static const char *option_keys[MAX_OPTIONS];
+static const char *option_values[MAX_OPTIONS];
+static unsigned num_options;
+static bool verbose;
+
+static struct retro_perf_counter *counters[MAX_COUNTERS];
+static unsigned num_counters;
+
+static retro_keyboard_event_t keyboard_cb;
+static retro_frame_time_callback_t frame_time_cb;
+static retro_usec_t frame_time_reference;
+static bool shutdown_requested;
+
+static struct bench_event events[MAX_EVENTS];
+static unsigned num_events;
+
+static bool joypad[16];
+static bool mouse_buttons[2];
+static int mouse_dx, mouse_dy;
+
+static unsigned long frames_presented, frames_duped, audio_frames;
+
+static retro_time_t bench_time_usec(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (retro_time_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static retro_perf_tick_t bench_perf_counter(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (retro_perf_tick_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint64_t bench_cpu_features(void)
+{
+   return 0;
+}
+
+static void bench_perf_register(struct retro_perf_counter *counter)
+{
+   if (num_counters < MAX_COUNTERS)
+      counters[num_counters++] = counter;
+   counter->registered = true;
+}
+
+static void bench_perf_start(struct retro_perf_counter *counter)
+{
+   counter->call_cnt++;
+   counter->start = bench_perf_counter();
+}
+
+static void bench_perf_stop(struct retro_perf_counter *counter)
+{
+   counter->total += bench_perf_counter() - counter->start;
+}
+
+static void bench_perf_log(void)
+{
+}
+
+static void bench_log(enum retro_log_level level, const char *fmt, ...)
+{
+   va_list args;
+
+   if (!verbose && level < RETRO_LOG_WARN)
+      return;
+
+   va_start(args, fmt);
+   vfprintf(stderr, fmt, args);
+   va_end(args);
+}
+
+static bool bench_environment(unsigned cmd, void *data)
+{
+   unsigned i;
+
+   switch (cmd)
+   {
+      case RETRO_ENVIRONMENT_GET_LOG_INTERFACE:
+         ((struct retro_log_callback*)data)->log = bench_log;
+         return true;
+      case RETRO_ENVIRONMENT_GET_PERF_INTERFACE:
+         {
+            struct retro_perf_callback *cb = (struct retro_perf_callback*)data;
+            cb->get_time_usec = bench_time_usec;
+            cb->get_cpu_features = bench_cpu_features;
+            cb->get_perf_counter = bench_perf_counter;
+            cb->perf_register = bench_perf_register;
+            cb->perf_start = bench_perf_start;
+            cb->perf_stop = bench_perf_stop;
+            cb->perf_log = bench_perf_log;
+         }
+         return true;
+      case RETRO_ENVIRONMENT_GET_SYSTEM_DIRECTORY:
+      case RETRO_ENVIRONMENT_GET_SAVE_DIRECTORY:
+         *(const char**)data = system_dir;
+         return true;
+      case RETRO_ENVIRONMENT_GET_VARIABLE:
+         {
+            struct retro_variable *var = (struct retro_variable*)data;
+            var->value = NULL;
+            for (i = 0; i < num_options; i++)
+               if (!strcmp(option_keys[i], var->key))
+                  var->value = option_values[i];
+         }
+         return true;
+      case RETRO_ENVIRONMENT_GET_CAN_DUPE:
+         *(bool*)data = true;
+         return true;
+      case RETRO_ENVIRONMENT_SET_PIXEL_FORMAT:
+      case RETRO_ENVIRONMENT_SET_VARIABLES:
+      case RETRO_ENVIRONMENT_SET_SUPPORT_NO_GAME:
+      case RETRO_ENVIRONMENT_SET_INPUT_DESCRIPTORS:
+         return true;
+      case RETRO_ENVIRONMENT_SET_KEYBOARD_CALLBACK:
+         keyboard_cb = ((const struct retro_keyboard_callback*)data)->callback;
+         return true;
+      case RETRO_ENVIRONMENT_SET_FRAME_TIME_CALLBACK:
+         frame_time_cb = ((const struct retro_frame_time_callback*)data)->callback;
+         frame_time_reference = ((const struct retro_frame_time_callback*)data)->reference;
+         return true;
+      case RETRO_ENVIRONMENT_SHUTDOWN:
+         shutdown_requested = true;
+         return true;
+      default:
+         return false;
+   }
+}
+
+static void bench_video_refresh(const void *data, unsigned width, unsigned height, size_t pitch)
+{
+   if (data)
+      frames_presented++;
+   else
+      frames_duped++;
+}
+
+static void bench_audio_sample(int16_t left, int16_t right)
+{
+   audio_frames++;
+}
+
+static size_t bench_audio_sample_batch(const int16_t *data, size_t frames)
+{
+   audio_frames += frames;
+   return frames;
+}
+
+static void bench_input_poll(void)
+{
+}
+
+static int16_t bench_input_state(unsigned port, unsigned device, unsigned index, unsigned id)
+{
+   if (port != 0)
+      return 0;
+
+   switch (device)
+   {
+      case RETRO_DEVICE_JOYPAD:
+         return id < 16 ? joypad[id] : 0;
+      case RETRO_DEVICE_MOUSE:
+         switch (id)
+         {
+            case RETRO_DEVICE_ID_MOUSE_X:
+               return mouse_dx;
+            case RETRO_DEVICE_ID_MOUSE_Y:
+               return mouse_dy;
+            case RETRO_DEVICE_ID_MOUSE_LEFT:
+               return mouse_buttons[0];
+            case RETRO_DEVICE_ID_MOUSE_RIGHT:
+               return mouse_buttons[1];
+         }
+         return 0;
+      default:
+         return 0;
+   }
+}
+
+static int parse_button(const char *name)
+{
+   static const char *names[] = { "b", "y", "select", "start", "up", "down", "left", "right", "a", "x", "l", "r" };
+   unsigned i;
+
+   for (i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+      if (!strcmp(names[i], name))
+         return i;
+
+   return -1;
+}
+
+static bool parse_script(const char *path)
+{
+   char line[256];
+   unsigned lineno = 0;
+   FILE *file = fopen(path, "r");
+
+   if (!file)
+   {
+      fprintf(stderr, "Could not open input script %s\n", path);
+      return false;
+   }
+
+   while (fgets(line, sizeof(line), file))
+   {
+      struct bench_event ev;
+      char command[32], arg1[32], arg2[32], arg3[32];
+      char *comment = strchr(line, '#');
+      int count;
+
+      lineno++;
+      if (comment)
+         *comment = '\0';
+
+      count = sscanf(line, "%u %31s %31s %31s %31s", &ev.frame, command, arg1, arg2, arg3);
+      if (count <= 0)
+         continue;
+
+      memset(&ev.a, 0, sizeof(int) * 3);
+      if (count >= 3 && (!strcmp(command, "press") || !strcmp(command, "release")))
+      {
+         ev.type = strcmp(command, "press") ? EVENT_RELEASE : EVENT_PRESS;
+         ev.a = parse_button(arg1);
+         count = ev.a < 0 ? 0 : count;
+      }
+      else if (count >= 4 && !strcmp(command, "mouse"))
+      {
+         ev.type = EVENT_MOUSE;
+         ev.a = atoi(arg1);
+         ev.b = atoi(arg2);
+      }
+      else if (count >= 4 && !strcmp(command, "click"))
+      {
+         ev.type = EVENT_CLICK;
+         ev.a = !strcmp(arg1, "right");
+         ev.b = !strcmp(arg2, "down");
+      }
+      else if (count >= 4 && !strcmp(command, "key"))
+      {
+         ev.type = EVENT_KEY;
+         ev.a = atoi(arg1);
+         ev.b = !strcmp(arg2, "down");
+         ev.c = count >= 5 ? arg3[0] : 0;
+      }
+      else
+         count = 0;
+
+      if (count <= 0 || num_events == MAX_EVENTS)
+      {
+         fprintf(stderr, "%s:%u: invalid event\n", path, lineno);
+         fclose(file);
+         return false;
+      }
+
+      /* Keep the script sorted by frame, events of one frame stay in order */
+      {
+         unsigned i = num_events++;
+         while (i > 0 && events[i - 1].frame > ev.frame)
+         {
+            events[i] = events[i - 1];
+            i--;
+         }
+         events[i] = ev;
+      }
+   }
+
+   fclose(file);
+   return true;
+}
+
+static void apply_events(unsigned frame, unsigned *next)
+{
+   mouse_dx = mouse_dy = 0;
+
+   for (; *next < num_events && events[*next].frame <= frame; (*next)++)
+   {
+      const struct bench_event *ev = &events[*next];
+      switch (ev->type)
+      {
+         case EVENT_PRESS:
+         case EVENT_RELEASE:
+            joypad[ev->a] = ev->type == EVENT_PRESS;
+            break;
+         case EVENT_MOUSE:
+            mouse_dx += ev->a;
+            mouse_dy += ev->b;
+            break;
+         case EVENT_CLICK:
+            mouse_buttons[ev->a] = ev->b;
+            break;
+         case EVENT_KEY:
+            if (keyboard_cb)
+               keyboard_cb(ev->b, ev->a, ev->c, RETROKMOD_NONE);
+            break;
+      }
+   }
+}
+
+static struct retro_perf_counter *find_counter(const char *ident)
+{
+   unsigned i;
+
+   for (i = 0; i < num_counters; i++)
+      if (!strcmp(counters[i]->ident, ident))
+         return counters[i];
+
+   return NULL;
+}
+
+static retro_perf_tick_t counter_total(const char *ident)
+{
+   const struct retro_perf_counter *counter = find_counter(ident);
+   return counter ? counter->total : 0;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+   const double x = *(const double*)a;
+   const double y = *(const double*)b;
+   return x < y ? -1 : x > y;
+}
+
+static void report(const char *name, double *samples, unsigned count)
+{
+   double sum = 0.0;
+   unsigned i;
+
+   if (!count)
+      return;
+
+   for (i = 0; i < count; i++)
+      sum += samples[i];
+
+   qsort(samples, count, sizeof(double), compare_double);
+
+   printf("%-14s %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f\n", name,
+         sum / count,
+         samples[0],
+         samples[count / 2],
+         samples[(unsigned)(count * 0.90)],
+         samples[(unsigned)(count * 0.99)],
+         samples[count - 1]);
+}
+
+#define LOAD_SYMBOL(name) \
+   if (!(*(void**)&core.name = dlsym(handle, #name))) \
+   { \
+      fprintf(stderr, "Core does not export " #name "\n"); \
+      return 1; \
+   }
+
+int main(int argc, char *argv[])
+{
+   struct retro_system_av_info av_info;
+   struct retro_game_info game;
+   double *total, *emulation, *presentation, *audio;
+   const char *script = NULL;
+   unsigned frames = 3600;
+   unsigned frame, next_event = 0;
+   void *handle;
+   int i;
+
+   for (i = 1; i < argc - 2; i++)
+   {
+      if (!strcmp(argv[i], "-n") && i + 1 < argc - 2)
+         frames = strtoul(argv[++i], NULL, 0);
+      else if (!strcmp(argv[i], "-i") && i + 1 < argc - 2)
+         script = argv[++i];
+      else if (!strcmp(argv[i], "-s") && i + 1 < argc - 2)
+         system_dir = argv[++i];
+      else if (!strcmp(argv[i], "-o") && i + 1 < argc - 2 && num_options < MAX_OPTIONS)
+      {
+         char *value = strchr(argv[++i], '=');
+         if (!value)
+            break;
+         *value = '\0';
+         option_keys[num_options] = argv[i];
+         option_values[num_options++] = value + 1;
+      }
+      else if (!strcmp(argv[i], "-v"))
+         verbose = true;
+      else
+         break;
+   }
+
+   if (i != argc - 2 || !frames)
+   {
+      fprintf(stderr, "Usage: %s [-n frames] [-i script] [-s dir] [-o key=value]... [-v] <core> <game.scummvm>\n", argv[0]);
+      return 1;
+   }
+
+   if (script && !parse_script(script))
+      return 1;
+
+   /* Reproducible by default */
+   if (num_options < MAX_OPTIONS)
+   {
+      option_keys[num_options] = "scummvm_timing";
+      option_values[num_options++] = "fixed";
+   }
+
+   handle = dlopen(argv[argc - 2], RTLD_NOW | RTLD_LOCAL);
+   if (!handle)
+   {
+      fprintf(stderr, "%s\n", dlerror());
+      return 1;
+   }
+
+   LOAD_SYMBOL(retro_set_environment)
+   LOAD_SYMBOL(retro_set_video_refresh)
+   LOAD_SYMBOL(retro_set_audio_sample)
+   LOAD_SYMBOL(retro_set_audio_sample_batch)
+   LOAD_SYMBOL(retro_set_input_poll)
+   LOAD_SYMBOL(retro_set_input_state)
+   LOAD_SYMBOL(retro_init)
+   LOAD_SYMBOL(retro_deinit)
+   LOAD_SYMBOL(retro_load_game)
+   LOAD_SYMBOL(retro_unload_game)
+   LOAD_SYMBOL(retro_get_system_av_info)
+   LOAD_SYMBOL(retro_run)
+
+   core.retro_set_environment(bench_environment);
+   core.retro_init();
+   core.retro_set_video_refresh(bench_video_refresh);
+   core.retro_set_audio_sample(bench_audio_sample);
+   core.retro_set_audio_sample_batch(bench_audio_sample_batch);
+   core.retro_set_input_poll(bench_input_poll);
+   core.retro_set_input_state(bench_input_state);
+
+   memset(&game, 0, sizeof(game));
+   game.path = argv[argc - 1];
+   if (!core.retro_load_game(&game))
+   {
+      fprintf(stderr, "Could not load %s\n", game.path);
+      return 1;
+   }
+
+   core.retro_get_system_av_info(&av_info);
+
+   total = (double*)calloc(frames, sizeof(double));
+   emulation = (double*)calloc(frames, sizeof(double));
+   presentation = (double*)calloc(frames, sizeof(double));
+   audio = (double*)calloc(frames, sizeof(double));
+   if (!total || !emulation || !presentation || !audio)
+      return 1;
+
+   for (frame = 0; frame < frames && !shutdown_requested; frame++)
+   {
+      const retro_perf_tick_t emulation_start = counter_total("retro_emulation");
+      const retro_perf_tick_t presentation_start = counter_total("retro_presentation");
+      const retro_perf_tick_t audio_start = counter_total("retro_audio_mix");
+      retro_perf_tick_t start, end;
+
+      apply_events(frame, &next_event);
+
+      if (frame_time_cb)
+         frame_time_cb(frame_time_reference);
+
+      start = bench_perf_counter();
+      core.retro_run();
+      end = bench_perf_counter();
+
+      /* Presentation happens inside the emulator thread, report it on its own */
+      total[frame] = (end - start) / 1e6;
+      presentation[frame] = (counter_total("retro_presentation") - presentation_start) / 1e6;
+      emulation[frame] = (counter_total("retro_emulation") - emulation_start) / 1e6 - presentation[frame];
+      audio[frame] = (counter_total("retro_audio_mix") - audio_start) / 1e6;
+   }
+
+   printf("%u frames at %.2f fps, %lu presented, %lu duped, %lu audio frames at %.0f Hz\n",
+         frame, av_info.timing.fps, frames_presented, frames_duped, audio_frames, av_info.timing.sample_rate);
+   printf("%-14s %9s %9s %9s %9s %9s %9s\n", "ms per frame", "mean", "min", "p50", "p90", "p99", "max");
+   report("retro_run", total, frame);
+   report("emulation", emulation, frame);
+   report("presentation", presentation, frame);
+   report("audio mix", audio, frame);
+
+   core.retro_unload_game();
+   core.retro_deinit();
+
+   free(total);
+   free(emulation);
+   free(presentation);
+   free(audio);
+   return 0;
+}
@@ -2,6 +2,7 @@
 
 #include "base/main.h"
 #include "common/scummsys.h"
+#include "common/util.h"
 #include "graphics/surface.libretro.h"
 #include "audio/mixer_intern.h"
 
@@ -15,14 +16,44 @@
  * @see http://linux.die.net/man/3/basename
  */
 #include <libgen.h>
+#include <stdlib.h>
 #include <string.h>
 
 retro_log_printf_t log_cb = NULL;
+struct retro_perf_callback perf_cb;
 static retro_video_refresh_t video_cb = NULL;
 static retro_audio_sample_batch_t audio_batch_cb = NULL;
 static retro_environment_t environ_cb = NULL;
 static retro_input_poll_t poll_cb = NULL;
 static retro_input_state_t input_cb = NULL;
+static bool can_dupe = false;
+
+#define RETRO_FPS 60
+#define AUDIO_RATE_MAX 48000
+/* One frame at the highest rate, plus a catch-up burst when the frontend is about to run dry */
+#define AUDIO_FRAMES_MAX (AUDIO_RATE_MAX / RETRO_FPS * 2)
+
+static unsigned audio_rate = 44100;
+static unsigned audio_remainder = 0;
+/* Frames uploaded ahead of the rate to avoid an underrun, left out later */
+static int audio_debt = 0;
+static bool audio_active = true;
+static bool audio_underrun = false;
+#ifdef HAVE_THREADS
+/* The core option, and whether the thread runs or could not be started */
+static bool audio_thread = false;
+static bool audio_thread_started = false;
+static bool audio_thread_failed = false;
+#endif
+
+/* Frame time reported by the frontend, it drives the backend clock */
+#define FRAME_TIME_REFERENCE (1000000 / RETRO_FPS)
+#define FRAME_TIME_MAX 250000
+static retro_usec_t frame_time = FRAME_TIME_REFERENCE;
+
+/* Fixed timing advances the clock by exactly 1/RETRO_FPS s per retro_run, whatever the frontend reports */
+static bool fixed_timing = false;
+static unsigned fixed_timing_remainder = 0;
 
 void retro_set_video_refresh(retro_video_refresh_t cb) { video_cb = cb; }
 void retro_set_audio_sample(retro_audio_sample_t cb) { }
@@ -35,6 +66,17 @@ void retro_set_environment(retro_environment_t cb)
    environ_cb = cb;
    bool tmp = true;
    environ_cb(RETRO_ENVIRONMENT_SET_SUPPORT_NO_GAME, &tmp);
+
+   static const struct retro_variable vars[] = {
+      { "scummvm_pixel_format", "Pixel format (restart); XRGB8888|RGB565" },
+      { "scummvm_audio_rate", "Audio output rate (restart); 44100|48000|22050" },
+#ifdef HAVE_THREADS
+      { "scummvm_audio_thread", "Mix audio on a separate thread (restart); disabled|enabled" },
+#endif
+      { "scummvm_timing", "Timing (restart); frontend|fixed" },
+      { NULL, NULL },
+   };
+   environ_cb(RETRO_ENVIRONMENT_SET_VARIABLES, (void*)vars);
 }
 
 bool FRONTENDwantsExit;
@@ -51,6 +93,18 @@ void retro_leave_thread(void)
    co_switch(mainThread);
 }
 
+void retro_enter_thread(void)
+{
+   co_switch(emuThread);
+}
+
+static bool retro_emulator_running(void)
+{
+   /* g_system is created on the emulator thread, so it is parked in the
+    * backend whenever the frontend calls us. */
+   return emuThread && g_system && !EMULATORexited;
+}
+
 static void retro_start_emulator(void)
 {
    g_system = retroBuildOS();
@@ -111,8 +165,8 @@ void retro_get_system_av_info(struct retro_system_av_info *info)
    info->geometry.max_width = RES_W;
    info->geometry.max_height = RES_H;
    info->geometry.aspect_ratio = 4.0f / 3.0f;
-   info->timing.fps = 60.0;
-   info->timing.sample_rate = 44100.0;
+   info->timing.fps = RETRO_FPS;
+   info->timing.sample_rate = audio_rate;
 }
 
 void retro_init (void)
@@ -123,6 +177,8 @@ void retro_init (void)
    else
       log_cb = NULL;
 
+   if (!environ_cb(RETRO_ENVIRONMENT_GET_PERF_INTERFACE, &perf_cb))
+      memset(&perf_cb, 0, sizeof(perf_cb));
 }
 
 void retro_deinit(void)
@@ -173,6 +229,84 @@ void parse_command_params(char* cmdline)
    }
 }
 
+static void retro_frame_time(retro_usec_t usec)
+{
+   frame_time = usec;
+}
+
+static unsigned retro_frame_micros(void)
+{
+   if (fixed_timing)
+   {
+      fixed_timing_remainder += 1000000;
+      const unsigned micros = fixed_timing_remainder / RETRO_FPS;
+      fixed_timing_remainder %= RETRO_FPS;
+      return micros;
+   }
+
+   return frame_time > FRAME_TIME_MAX ? FRAME_TIME_MAX : (unsigned)frame_time;
+}
+
+static void retro_audio_buffer_status(bool active, unsigned occupancy, bool underrun_likely)
+{
+   audio_active = active;
+   audio_underrun = underrun_likely;
+}
+
+static void retro_upload_audio(void)
+{
+   static uint32 buf[AUDIO_FRAMES_MAX];
+
+   /* Carry the fractional part over so the average matches the rate exactly */
+   audio_remainder += audio_rate;
+   unsigned count = audio_remainder / RETRO_FPS;
+   audio_remainder %= RETRO_FPS;
+
+   /* Top the frontend buffer up by half a frame before it runs dry, and
+    * pay the extra frames back in small steps once it is safe again, so the
+    * average still matches the rate. A frontend which keeps running dry
+    * consumes faster than the rate, so it is not owed more than a second. */
+   if (audio_underrun)
+   {
+      const unsigned extra = count / 2;
+      count += extra;
+      audio_debt = MIN<int>(audio_debt + extra, audio_rate);
+   }
+   else if (audio_debt > 0)
+   {
+      const unsigned repaid = MIN<unsigned>(audio_debt, count / 8);
+      count -= repaid;
+      audio_debt -= repaid;
+   }
+
+   RETRO_PERFORMANCE_INIT(retro_audio_mix);
+   RETRO_PERFORMANCE_START(retro_audio_mix);
+#ifdef HAVE_THREADS
+   /* The mixer exists once the emulator ran for the first time */
+   if (audio_thread && !audio_thread_started && !audio_thread_failed)
+   {
+      audio_thread_started = retroStartAudioThread(audio_rate / RETRO_FPS + 1);
+      if (!audio_thread_started)
+      {
+         /* Try again with the next game rather than on every frame */
+         audio_thread_failed = true;
+         if (log_cb)
+            log_cb(RETRO_LOG_WARN, "Could not start the audio thread, mixing on the frontend thread.\n");
+      }
+   }
+
+   if (audio_thread_started)
+      retroReadAudio(buf, count);
+   else
+#endif
+   ((Audio::MixerImpl*)g_system->getMixer())->mixCallback((byte*)buf, count * 4);
+   RETRO_PERFORMANCE_STOP(retro_audio_mix);
+
+   /* The mixer keeps its streams in time either way, only skip the upload */
+   if (audio_active)
+      audio_batch_cb((int16_t*)buf, count);
+}
+
 bool retro_load_game(const struct retro_game_info *game)
 {
    const char* sysdir;
@@ -236,23 +370,76 @@ bool retro_load_game(const struct retro_game_info *game)
 
    environ_cb(RETRO_ENVIRONMENT_SET_INPUT_DESCRIPTORS, desc);
 
+   if (!environ_cb(RETRO_ENVIRONMENT_GET_CAN_DUPE, &can_dupe))
+      can_dupe = false;
+
    /* Get color mode: 32 first as VGA has 6 bits per pixel */
-#if 0
-   RDOSGFXcolorMode = RETRO_PIXEL_FORMAT_XRGB8888;
-   if(!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &RDOSGFXcolorMode))
+   enum retro_pixel_format pixel_format = RETRO_PIXEL_FORMAT_XRGB8888;
+   struct retro_variable var = { "scummvm_pixel_format", NULL };
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value && !strcmp(var.value, "RGB565"))
+      pixel_format = RETRO_PIXEL_FORMAT_RGB565;
+
+   if (pixel_format == RETRO_PIXEL_FORMAT_XRGB8888 && !environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &pixel_format))
+      pixel_format = RETRO_PIXEL_FORMAT_RGB565;
+
+#ifdef FRONTEND_SUPPORTS_RGB565
+   if (pixel_format == RETRO_PIXEL_FORMAT_RGB565 && !environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &pixel_format))
+      pixel_format = RETRO_PIXEL_FORMAT_0RGB1555;
+#else
+   if (pixel_format == RETRO_PIXEL_FORMAT_RGB565)
+      pixel_format = RETRO_PIXEL_FORMAT_0RGB1555;
+#endif
+
+   if (log_cb)
+      log_cb(RETRO_LOG_INFO, "Using %s pixel format.\n",
+            pixel_format == RETRO_PIXEL_FORMAT_XRGB8888 ? "XRGB8888" :
+            pixel_format == RETRO_PIXEL_FORMAT_RGB565 ? "RGB565" : "0RGB1555");
+
+   retroSetPixelFormat(pixel_format);
+
+   /* Audio rate, the mixer is created with it once the emulator starts */
+   audio_rate = 44100;
+   var.key = "scummvm_audio_rate";
+   var.value = NULL;
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value)
    {
-      RDOSGFXcolorMode = RETRO_PIXEL_FORMAT_RGB565;
-      if(!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &RDOSGFXcolorMode))
-         RDOSGFXcolorMode = RETRO_PIXEL_FORMAT_0RGB1555;
+      const unsigned rate = atoi(var.value);
+      if (rate == 22050 || rate == 48000)
+         audio_rate = rate;
    }
-#endif
 
-#ifdef FRONTEND_SUPPORTS_RGB565
-   enum retro_pixel_format rgb565 = RETRO_PIXEL_FORMAT_RGB565;
-   if (!environ_cb(RETRO_ENVIRONMENT_SET_PIXEL_FORMAT, &rgb565) && log_cb)
-      log_cb(RETRO_LOG_INFO, "Frontend supports RGB565 -will use that instead of XRGB1555.\n");
+   audio_remainder = 0;
+   audio_debt = 0;
+   retroSetAudioRate(audio_rate);
+
+#ifdef HAVE_THREADS
+   audio_thread = false;
+   audio_thread_started = false;
+   audio_thread_failed = false;
+   var.key = "scummvm_audio_thread";
+   var.value = NULL;
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value && !strcmp(var.value, "enabled"))
+      audio_thread = true;
 #endif
 
+   audio_active = true;
+   audio_underrun = false;
+   struct retro_audio_buffer_status_callback buf_status_cb = { retro_audio_buffer_status };
+   environ_cb(RETRO_ENVIRONMENT_SET_AUDIO_BUFFER_STATUS_CALLBACK, &buf_status_cb);
+
+   fixed_timing = false;
+   fixed_timing_remainder = 0;
+   var.key = "scummvm_timing";
+   var.value = NULL;
+   if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE, &var) && var.value && !strcmp(var.value, "fixed"))
+      fixed_timing = true;
+
+   retroSetFixedTiming(fixed_timing);
+
+   frame_time = FRAME_TIME_REFERENCE;
+   struct retro_frame_time_callback frame_time_cb = { retro_frame_time, FRAME_TIME_REFERENCE };
+   environ_cb(RETRO_ENVIRONMENT_SET_FRAME_TIME_CALLBACK, &frame_time_cb);
+
    retro_keyboard_callback cb = {retroKeyEvent};
    environ_cb(RETRO_ENVIRONMENT_SET_KEYBOARD_CALLBACK, &cb);
 
@@ -298,24 +485,43 @@ void retro_run (void)
    {
       poll_cb();
       retroProcessMouse(input_cb);
+
+      /* Hand out this frame's time, a stall in the frontend does not turn into a burst of engine time */
+      retroAdvanceFrame(retro_frame_micros());
    }
 
-   /* Run emu */
+   /* Run emu, this includes the presentation done in updateScreen */
+   RETRO_PERFORMANCE_INIT(retro_emulation);
+   RETRO_PERFORMANCE_START(retro_emulation);
    co_switch(emuThread);
+   RETRO_PERFORMANCE_STOP(retro_emulation);
 
    if(g_system)
    {
-      /* Upload video: TODO: Check the CANDUPE env value */
+      /* Upload video, or let the frontend repeat the last frame if nothing was redrawn */
       const Graphics::Surface& screen = getScreen();
-      video_cb(screen.pixels, screen.w, screen.h, screen.pitch);
+      const bool updated = retroScreenUpdated();
+      video_cb((updated || !can_dupe) ? screen.pixels : NULL, screen.w, screen.h, screen.pitch);
 
-      // Upload audio
-      static uint32 buf[735];
-      int count = ((Audio::MixerImpl*)g_system->getMixer())->mixCallback((byte*)buf, 735*4);
-      audio_batch_cb((int16_t*)buf, count);
+      retro_upload_audio();
    }
 }
 
+size_t retro_serialize_size (void)
+{
+   return retro_emulator_running() ? retroGetStateSize() : 0;
+}
+
+bool retro_serialize(void *data, size_t size)
+{
+   return retro_emulator_running() && retroSaveState(data, size);
+}
+
+bool retro_unserialize(const void * data, size_t size)
+{
+   return retro_emulator_running() && retroLoadState(data, size);
+}
+
 void retro_unload_game (void)
 {
    if(!emuThread)
@@ -328,6 +534,15 @@ void retro_unload_game (void)
       co_switch(emuThread);
    }
 
+#ifdef HAVE_THREADS
+   /* Only join once the emulator has unwound. While it is parked it may
+    * hold a mutex the audio thread is waiting for, since the emulator
+    * runs on this thread and co_switch() does not release its locks. */
+   if (audio_thread_started)
+      retroStopAudioThread();
+   audio_thread_started = false;
+#endif
+
    co_delete(emuThread);
    emuThread = 0;
 }
@@ -337,9 +552,6 @@ void retro_set_controller_port_device(unsigned in_port, unsigned device) { }
 void *retro_get_memory_data(unsigned type) { return 0; }
 size_t retro_get_memory_size(unsigned type) { return 0; }
 void retro_reset (void) { }
-size_t retro_serialize_size (void) { return 0; }
-bool retro_serialize(void *data, size_t size) { return false; }
-bool retro_unserialize(const void * data, size_t size) { return false; }
 void retro_cheat_reset(void) { }
 void retro_cheat_set(unsigned unused, bool unused1, const char* unused2) { }
 
@@ -26,13 +26,21 @@
 #include <sys/time.h>
 #include <list>
 
+#ifdef HAVE_THREADS
+#include <pthread.h>
+#endif
+
 #include <retro_miscellaneous.h>
 #include <retro_inline.h>
 
 #include "graphics/surface.libretro.h"
 #include "backends/base-backend.h"
 #include "common/events.h"
+#include "common/rect.h"
+#include "common/memstream.h"
+#include "common/endian.h"
 #include "audio/mixer_intern.h"
+#include "engines/engine.h"
 
 #if defined(_WIN32)
 #include "backends/fs/windows/windows-fs-factory.h"
@@ -62,21 +70,46 @@
 #endif
 
 #include "libretro.h"
+#include "os.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define RETRO_BLIT_SSE2
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define RETRO_BLIT_NEON
+#endif
 
 extern retro_log_printf_t log_cb;
 
+#ifdef FRONTEND_SUPPORTS_RGB565
+static Graphics::PixelFormat s_screenFormat(2, 5, 6, 5, 0, 11, 5, 0, 0);
+#else
+static Graphics::PixelFormat s_screenFormat(2, 5, 5, 5, 1, 10, 5, 0, 15);
+#endif
+
+static INLINE const Graphics::PixelFormat& getRetroScreenFormat()
+{
+   return s_screenFormat;
+}
+
 struct RetroPalette
 {
    unsigned char _colors[256 * 3];
 
+   /* _colors already converted to the screen format, refreshed by set() */
+   uint32 _native[256];
+
    RetroPalette()
    {
       memset(_colors, 0, sizeof(_colors));
+      updateNative(0, 256);
    }
 
    void set(const byte *colors, uint start, uint num)
    {
       memcpy(_colors + start * 3, colors, num * 3);
+      updateNative(start, num);
    }
 
    void get(byte* colors, uint start, uint num)
@@ -88,155 +121,456 @@ struct RetroPalette
    {
       return (unsigned char*)&_colors[aIndex * 3];
    }
+
+   const uint32 *getNativeColors() const
+   {
+      return _native;
+   }
+
+   private:
+   void updateNative(uint start, uint num)
+   {
+      const Graphics::PixelFormat& format = getRetroScreenFormat();
+
+      for(uint i = start; i < start + num; i ++)
+      {
+         const unsigned char *col = getColor(i);
+         _native[i] = format.RGBToColor(col[0], col[1], col[2]);
+      }
+   }
 };
 
-static INLINE void blit_uint8_uint16_fast(Graphics::Surface& aOut, const Graphics::Surface& aIn, const RetroPalette& aColors)
+/* Row converters used by the presentation path. All of them write exactly
+ * the same values as the generic colorToRGB/RGBToColor round trip. */
+
+template<typename TOut>
+static INLINE void convertRow_CLUT8(TOut *out, const uint8_t *in, int w, const uint32 *lut)
 {
-   for(int i = 0; i < aIn.h; i ++)
+   int j = 0;
+
+   for(; j + 4 <= w; j += 4)
    {
-      if(i >= aOut.h)
-         continue;
+      out[j + 0] = lut[in[j + 0]];
+      out[j + 1] = lut[in[j + 1]];
+      out[j + 2] = lut[in[j + 2]];
+      out[j + 3] = lut[in[j + 3]];
+   }
 
-      uint8_t * const in  = (uint8_t*)aIn.pixels + (i * aIn.w);
-      uint16_t* const out = (uint16_t*)aOut.pixels + (i * aOut.w);
+   for(; j < w; j ++)
+      out[j] = lut[in[j]];
+}
 
-      for(int j = 0; j < aIn.w; j ++)
-      {
-         if (j >= aOut.w)
-            continue;
+/* XRGB1555 to RGB565, green is widened the same way PixelFormat does it. */
+static INLINE void convertRow_555_565(uint16_t *out, const uint16_t *in, int w)
+{
+   int j = 0;
 
-         uint8 r, g, b;
+#if defined(RETRO_BLIT_SSE2)
+   const __m128i rgMask = _mm_set1_epi16((short)0xFFC0);
+   const __m128i gLowMask = _mm_set1_epi16(0x0020);
+   const __m128i bMask = _mm_set1_epi16(0x001F);
 
-         const uint8_t val = in[j];
-         if(val != 0xFFFFFFFF)
-         {
-            if(aIn.format.bytesPerPixel == 1)
-            {
-               unsigned char *col = aColors.getColor(val);
-               r = *col++;
-               g = *col++;
-               b = *col++;
-            }
-            else
-               aIn.format.colorToRGB(in[j], r, g, b);
+   for(; j + 8 <= w; j += 8)
+   {
+      const __m128i p = _mm_loadu_si128((const __m128i *)(in + j));
+      __m128i o = _mm_and_si128(_mm_slli_epi16(p, 1), rgMask);
+      o = _mm_or_si128(o, _mm_and_si128(_mm_srli_epi16(p, 4), gLowMask));
+      o = _mm_or_si128(o, _mm_and_si128(p, bMask));
+      _mm_storeu_si128((__m128i *)(out + j), o);
+   }
+#elif defined(RETRO_BLIT_NEON)
+   const uint16x8_t rgMask = vdupq_n_u16(0xFFC0);
+   const uint16x8_t gLowMask = vdupq_n_u16(0x0020);
+   const uint16x8_t bMask = vdupq_n_u16(0x001F);
 
-            out[j] = aOut.format.RGBToColor(r, g, b);
-         }
+   for(; j + 8 <= w; j += 8)
+   {
+      const uint16x8_t p = vld1q_u16(in + j);
+      uint16x8_t o = vandq_u16(vshlq_n_u16(p, 1), rgMask);
+      o = vorrq_u16(o, vandq_u16(vshrq_n_u16(p, 4), gLowMask));
+      o = vorrq_u16(o, vandq_u16(p, bMask));
+      vst1q_u16(out + j, o);
+   }
+#endif
+
+   for(; j < w; j ++)
+   {
+      const uint16_t p = in[j];
+      out[j] = ((p << 1) & 0xFFC0) | ((p >> 4) & 0x0020) | (p & 0x001F);
+   }
+}
+
+/* Any 8 bits per channel 32bpp layout to RGB565. */
+static INLINE void convertRow_8888_565(uint16_t *out, const uint32_t *in, int w, int rShift, int gShift, int bShift)
+{
+   int j = 0;
+
+#if defined(RETRO_BLIT_SSE2)
+   const __m128i rCount = _mm_cvtsi32_si128(rShift);
+   const __m128i gCount = _mm_cvtsi32_si128(gShift);
+   const __m128i bCount = _mm_cvtsi32_si128(bShift);
+   const __m128i rbMask = _mm_set1_epi32(0xF8);
+   const __m128i gMask = _mm_set1_epi32(0xFC);
+
+   for(; j + 8 <= w; j += 8)
+   {
+      __m128i o[2];
+      for(int k = 0; k < 2; k ++)
+      {
+         const __m128i p = _mm_loadu_si128((const __m128i *)(in + j + k * 4));
+         const __m128i r = _mm_slli_epi32(_mm_and_si128(_mm_srl_epi32(p, rCount), rbMask), 8);
+         const __m128i g = _mm_slli_epi32(_mm_and_si128(_mm_srl_epi32(p, gCount), gMask), 3);
+         const __m128i b = _mm_srli_epi32(_mm_and_si128(_mm_srl_epi32(p, bCount), rbMask), 3);
+         /* Sign extend so the saturating pack keeps the bit pattern. */
+         o[k] = _mm_srai_epi32(_mm_slli_epi32(_mm_or_si128(_mm_or_si128(r, g), b), 16), 16);
       }
+      _mm_storeu_si128((__m128i *)(out + j), _mm_packs_epi32(o[0], o[1]));
+   }
+#elif defined(RETRO_BLIT_NEON)
+   const int32x4_t rCount = vdupq_n_s32(-rShift);
+   const int32x4_t gCount = vdupq_n_s32(-gShift);
+   const int32x4_t bCount = vdupq_n_s32(-bShift);
+   const uint32x4_t rbMask = vdupq_n_u32(0xF8);
+   const uint32x4_t gMask = vdupq_n_u32(0xFC);
+
+   for(; j + 8 <= w; j += 8)
+   {
+      uint16x4_t o[2];
+      for(int k = 0; k < 2; k ++)
+      {
+         const uint32x4_t p = vld1q_u32(in + j + k * 4);
+         const uint32x4_t r = vshlq_n_u32(vandq_u32(vshlq_u32(p, rCount), rbMask), 8);
+         const uint32x4_t g = vshlq_n_u32(vandq_u32(vshlq_u32(p, gCount), gMask), 3);
+         const uint32x4_t b = vshrq_n_u32(vandq_u32(vshlq_u32(p, bCount), rbMask), 3);
+         o[k] = vmovn_u32(vorrq_u32(vorrq_u32(r, g), b));
+      }
+      vst1q_u16(out + j, vcombine_u16(o[0], o[1]));
+   }
+#endif
+
+   for(; j < w; j ++)
+   {
+      const uint32_t p = in[j];
+      out[j] = (((p >> rShift) & 0xF8) << 8) | (((p >> gShift) & 0xFC) << 3) | (((p >> bShift) & 0xF8) >> 3);
    }
 }
 
-static INLINE void blit_uint32_uint16(Graphics::Surface& aOut, const Graphics::Surface& aIn, const RetroPalette& aColors)
+/* XRGB1555 (GBITS == 5) or RGB565 (GBITS == 6) to XRGB8888, channels are
+ * widened by replicating their top bits like PixelFormat::colorToRGB. */
+template<int GBITS>
+static INLINE void convertRow_16_XRGB8888(uint32_t *out, const uint16_t *in, int w)
 {
-   for(int i = 0; i < aIn.h; i ++)
+   const int rShift = 5 + GBITS;
+   const int gMask = (1 << GBITS) - 1;
+   int j = 0;
+
+#if defined(RETRO_BLIT_SSE2)
+   const __m128i mask5 = _mm_set1_epi16(0x1F);
+   const __m128i maskG = _mm_set1_epi16(gMask);
+
+   for(; j + 8 <= w; j += 8)
    {
-      if(i >= aOut.h)
-         continue;
+      const __m128i p = _mm_loadu_si128((const __m128i *)(in + j));
+      __m128i r = _mm_and_si128(_mm_srli_epi16(p, rShift), mask5);
+      __m128i g = _mm_and_si128(_mm_srli_epi16(p, 5), maskG);
+      __m128i b = _mm_and_si128(p, mask5);
+      r = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+      g = _mm_or_si128(_mm_slli_epi16(g, 8 - GBITS), _mm_srli_epi16(g, 2 * GBITS - 8));
+      b = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+
+      /* Low halves hold g:b, high halves hold 0:r. */
+      const __m128i gb = _mm_or_si128(_mm_slli_epi16(g, 8), b);
+      _mm_storeu_si128((__m128i *)(out + j), _mm_unpacklo_epi16(gb, r));
+      _mm_storeu_si128((__m128i *)(out + j + 4), _mm_unpackhi_epi16(gb, r));
+   }
+#elif defined(RETRO_BLIT_NEON)
+   const uint16x8_t mask5 = vdupq_n_u16(0x1F);
+   const uint16x8_t maskG = vdupq_n_u16(gMask);
 
-      uint32_t* const in = (uint32_t*)aIn.pixels + (i * aIn.w);
-      uint16_t* const out = (uint16_t*)aOut.pixels + (i * aOut.w);
+   for(; j + 8 <= w; j += 8)
+   {
+      const uint16x8_t p = vld1q_u16(in + j);
+      uint16x8_t r = vandq_u16(vshrq_n_u16(p, rShift), mask5);
+      uint16x8_t g = vandq_u16(vshrq_n_u16(p, 5), maskG);
+      uint16x8_t b = vandq_u16(p, mask5);
+      r = vorrq_u16(vshlq_n_u16(r, 3), vshrq_n_u16(r, 2));
+      g = vorrq_u16(vshlq_n_u16(g, 8 - GBITS), vshrq_n_u16(g, 2 * GBITS - 8));
+      b = vorrq_u16(vshlq_n_u16(b, 3), vshrq_n_u16(b, 2));
+
+      const uint16x8_t gb = vorrq_u16(vshlq_n_u16(g, 8), b);
+      const uint16x8x2_t o = vzipq_u16(gb, r);
+      vst1q_u16((uint16_t *)(out + j), o.val[0]);
+      vst1q_u16((uint16_t *)(out + j + 4), o.val[1]);
+   }
+#endif
 
-      for(int j = 0; j < aIn.w; j ++)
-      {
-         if(j >= aOut.w)
-            continue;
+   for(; j < w; j ++)
+   {
+      const uint16_t p = in[j];
+      uint32_t r = (p >> rShift) & 0x1F;
+      uint32_t g = (p >> 5) & gMask;
+      uint32_t b = p & 0x1F;
+      r = (r << 3) | (r >> 2);
+      g = (g << (8 - GBITS)) | (g >> (2 * GBITS - 8));
+      b = (b << 3) | (b >> 2);
+      out[j] = (r << 16) | (g << 8) | b;
+   }
+}
 
-         uint8 r, g, b;
+/* Any 8 bits per channel 32bpp layout to XRGB8888. */
+static INLINE void convertRow_8888_XRGB8888(uint32_t *out, const uint32_t *in, int w, int rShift, int gShift, int bShift)
+{
+   int j = 0;
 
-         const uint32_t val = in[j];
-         if(val != 0xFFFFFFFF)
-         {
-            aIn.format.colorToRGB(in[j], r, g, b);
-            out[j] = aOut.format.RGBToColor(r, g, b);
-         }
-      }
+#if defined(RETRO_BLIT_SSE2)
+   const __m128i rCount = _mm_cvtsi32_si128(rShift);
+   const __m128i gCount = _mm_cvtsi32_si128(gShift);
+   const __m128i bCount = _mm_cvtsi32_si128(bShift);
+   const __m128i mask = _mm_set1_epi32(0xFF);
+
+   for(; j + 4 <= w; j += 4)
+   {
+      const __m128i p = _mm_loadu_si128((const __m128i *)(in + j));
+      const __m128i r = _mm_slli_epi32(_mm_and_si128(_mm_srl_epi32(p, rCount), mask), 16);
+      const __m128i g = _mm_slli_epi32(_mm_and_si128(_mm_srl_epi32(p, gCount), mask), 8);
+      const __m128i b = _mm_and_si128(_mm_srl_epi32(p, bCount), mask);
+      _mm_storeu_si128((__m128i *)(out + j), _mm_or_si128(_mm_or_si128(r, g), b));
+   }
+#elif defined(RETRO_BLIT_NEON)
+   const int32x4_t rCount = vdupq_n_s32(-rShift);
+   const int32x4_t gCount = vdupq_n_s32(-gShift);
+   const int32x4_t bCount = vdupq_n_s32(-bShift);
+   const uint32x4_t mask = vdupq_n_u32(0xFF);
+
+   for(; j + 4 <= w; j += 4)
+   {
+      const uint32x4_t p = vld1q_u32(in + j);
+      const uint32x4_t r = vshlq_n_u32(vandq_u32(vshlq_u32(p, rCount), mask), 16);
+      const uint32x4_t g = vshlq_n_u32(vandq_u32(vshlq_u32(p, gCount), mask), 8);
+      const uint32x4_t b = vandq_u32(vshlq_u32(p, bCount), mask);
+      vst1q_u32(out + j, vorrq_u32(vorrq_u32(r, g), b));
+   }
+#endif
+
+   for(; j < w; j ++)
+   {
+      const uint32_t p = in[j];
+      out[j] = (((p >> rShift) & 0xFF) << 16) | (((p >> gShift) & 0xFF) << 8) | ((p >> bShift) & 0xFF);
    }
 }
 
-static INLINE void blit_uint16_uint16(Graphics::Surface& aOut, const Graphics::Surface& aIn, const RetroPalette& aColors)
+template<typename TOut, typename TIn>
+static INLINE void convertRow_generic(TOut *out, const TIn *in, int w, const Graphics::PixelFormat& aInFormat, const Graphics::PixelFormat& aOutFormat)
 {
-   for(int i = 0; i < aIn.h; i ++)
+   for(int j = 0; j < w; j ++)
    {
-      if(i >= aOut.h)
-         continue;
+      uint8 r, g, b;
+      aInFormat.colorToRGB(in[j], r, g, b);
+      out[j] = aOutFormat.RGBToColor(r, g, b);
+   }
+}
 
-      uint16_t* const in = (uint16_t*)aIn.pixels + (i * aIn.w);
-      uint16_t* const out = (uint16_t*)aOut.pixels + (i * aOut.w);
+static INLINE bool isFormat555(const Graphics::PixelFormat& aFormat)
+{
+   return aFormat.bytesPerPixel == 2 && aFormat.rBits() == 5 && aFormat.gBits() == 5 && aFormat.bBits() == 5 &&
+          aFormat.rShift == 10 && aFormat.gShift == 5 && aFormat.bShift == 0;
+}
 
-      for(int j = 0; j < aIn.w; j ++)
-      {
-         if(j >= aOut.w)
-            continue;
+static INLINE bool isFormat565(const Graphics::PixelFormat& aFormat)
+{
+   return aFormat.bytesPerPixel == 2 && aFormat.rBits() == 5 && aFormat.gBits() == 6 && aFormat.bBits() == 5 &&
+          aFormat.rShift == 11 && aFormat.gShift == 5 && aFormat.bShift == 0;
+}
 
-         uint8 r, g, b;
+static INLINE bool isFormat8888(const Graphics::PixelFormat& aFormat)
+{
+   return aFormat.bytesPerPixel == 4 && aFormat.rBits() == 8 && aFormat.gBits() == 8 && aFormat.bBits() == 8;
+}
 
-         const uint16_t val = in[j];
-         if(val != 0xFFFFFFFF)
-         {
-            aIn.format.colorToRGB(in[j], r, g, b);
-            out[j] = aOut.format.RGBToColor(r, g, b);
-         }
-      }
+static INLINE bool isFormatXRGB8888(const Graphics::PixelFormat& aFormat)
+{
+   return isFormat8888(aFormat) && aFormat.rShift == 16 && aFormat.gShift == 8 && aFormat.bShift == 0;
+}
+
+template<typename TOut>
+static INLINE void blit_uint8_fast(Graphics::Surface& aOut, const Graphics::Surface& aIn, const RetroPalette& aColors, const Common::Rect& aRect)
+{
+   const uint32 *lut = aColors.getNativeColors();
+
+   for(int i = aRect.top; i < aRect.bottom; i ++)
+   {
+      const uint8_t *in = (const uint8_t*)aIn.getBasePtr(aRect.left, i);
+      TOut *out = (TOut*)aOut.getBasePtr(aRect.left, i);
+      convertRow_CLUT8(out, in, aRect.width(), lut);
    }
 }
 
-static void blit_uint8_uint16(Graphics::Surface& aOut, const Graphics::Surface& aIn, int aX, int aY, const RetroPalette& aColors, uint32 aKeyColor)
+static INLINE void blit_uint16_fast(Graphics::Surface& aOut, const Graphics::Surface& aIn, const Common::Rect& aRect)
 {
-   for(int i = 0; i < aIn.h; i ++)
+   const bool same = (aIn.format == aOut.format);
+   const bool to565 = isFormat555(aIn.format) && isFormat565(aOut.format);
+
+   for(int i = aRect.top; i < aRect.bottom; i ++)
    {
-      if((i + aY) < 0 || (i + aY) >= aOut.h)
-         continue;
+      const uint16_t *in = (const uint16_t*)aIn.getBasePtr(aRect.left, i);
+      uint16_t *out = (uint16_t*)aOut.getBasePtr(aRect.left, i);
+
+      if(same)
+         memcpy(out, in, aRect.width() * 2);
+      else if(to565)
+         convertRow_555_565(out, in, aRect.width());
+      else
+         convertRow_generic(out, in, aRect.width(), aIn.format, aOut.format);
+   }
+}
 
-      uint8_t* const in = (uint8_t*)aIn.pixels + (i * aIn.w);
-      uint16_t* const out = (uint16_t*)aOut.pixels + ((i + aY) * aOut.w);
+static INLINE void blit_uint16_uint32_fast(Graphics::Surface& aOut, const Graphics::Surface& aIn, const Common::Rect& aRect)
+{
+   const bool toXRGB = isFormatXRGB8888(aOut.format);
+   const bool from565 = toXRGB && isFormat565(aIn.format);
+   const bool from555 = toXRGB && isFormat555(aIn.format);
 
-      for(int j = 0; j < aIn.w; j ++)
-      {
-         if((j + aX) < 0 || (j + aX) >= aOut.w)
-            continue;
+   for(int i = aRect.top; i < aRect.bottom; i ++)
+   {
+      const uint16_t *in = (const uint16_t*)aIn.getBasePtr(aRect.left, i);
+      uint32_t *out = (uint32_t*)aOut.getBasePtr(aRect.left, i);
+
+      if(from565)
+         convertRow_16_XRGB8888<6>(out, in, aRect.width());
+      else if(from555)
+         convertRow_16_XRGB8888<5>(out, in, aRect.width());
+      else
+         convertRow_generic(out, in, aRect.width(), aIn.format, aOut.format);
+   }
+}
 
-         uint8 r, g, b;
+static INLINE void blit_uint32_uint16_fast(Graphics::Surface& aOut, const Graphics::Surface& aIn, const Common::Rect& aRect)
+{
+   const bool to565 = isFormat8888(aIn.format) && isFormat565(aOut.format);
 
-         const uint8_t val = in[j];
-         if(val != aKeyColor)
-         {
-            unsigned char *col = aColors.getColor(val);
-            r = *col++;
-            g = *col++;
-            b = *col++;
-            out[j + aX] = aOut.format.RGBToColor(r, g, b);
-         }
+   for(int i = aRect.top; i < aRect.bottom; i ++)
+   {
+      const uint32_t *in = (const uint32_t*)aIn.getBasePtr(aRect.left, i);
+      uint16_t *out = (uint16_t*)aOut.getBasePtr(aRect.left, i);
+
+      if(to565)
+         convertRow_8888_565(out, in, aRect.width(), aIn.format.rShift, aIn.format.gShift, aIn.format.bShift);
+      else
+         convertRow_generic(out, in, aRect.width(), aIn.format, aOut.format);
+   }
+}
+
+static INLINE void blit_uint32_fast(Graphics::Surface& aOut, const Graphics::Surface& aIn, const Common::Rect& aRect)
+{
+   const bool same = isFormatXRGB8888(aIn.format) && isFormatXRGB8888(aOut.format);
+   const bool toXRGB = isFormat8888(aIn.format) && isFormatXRGB8888(aOut.format);
+
+   for(int i = aRect.top; i < aRect.bottom; i ++)
+   {
+      const uint32_t *in = (const uint32_t*)aIn.getBasePtr(aRect.left, i);
+      uint32_t *out = (uint32_t*)aOut.getBasePtr(aRect.left, i);
+
+      if(same)
+         memcpy(out, in, aRect.width() * 4);
+      else if(toXRGB)
+         convertRow_8888_XRGB8888(out, in, aRect.width(), aIn.format.rShift, aIn.format.gShift, aIn.format.bShift);
+      else
+         convertRow_generic(out, in, aRect.width(), aIn.format, aOut.format);
+   }
+}
+
+/* Converts aRect of aIn (a game screen or the overlay) into the screen surface aOut. */
+static void blitRect(Graphics::Surface& aOut, const Graphics::Surface& aIn, const RetroPalette& aColors, const Common::Rect& aRect)
+{
+   if(aOut.format.bytesPerPixel == 4)
+   {
+      switch(aIn.format.bytesPerPixel)
+      {
+         case 1:
+            blit_uint8_fast<uint32_t>(aOut, aIn, aColors, aRect);
+            break;
+         case 2:
+            blit_uint16_uint32_fast(aOut, aIn, aRect);
+            break;
+         case 4:
+            blit_uint32_fast(aOut, aIn, aRect);
+            break;
+      }
+   }
+   else
+   {
+      switch(aIn.format.bytesPerPixel)
+      {
+         case 1:
+            blit_uint8_fast<uint16_t>(aOut, aIn, aColors, aRect);
+            break;
+         case 2:
+            blit_uint16_fast(aOut, aIn, aRect);
+            break;
+         case 4:
+            blit_uint32_uint16_fast(aOut, aIn, aRect);
+            break;
       }
    }
 }
 
-static void blit_uint16_uint16(Graphics::Surface& aOut, const Graphics::Surface& aIn, int aX, int aY, const RetroPalette& aColors, uint32 aKeyColor)
+/* Draws a cursor at (aX, aY), skipping pixels that match aKeyColor. */
+template<typename TOut, typename TIn>
+static void blit_cursor(Graphics::Surface& aOut, const Graphics::Surface& aIn, int aX, int aY, const RetroPalette& aColors, uint32 aKeyColor)
 {
+   const uint32 *lut = aColors.getNativeColors();
+
    for(int i = 0; i < aIn.h; i ++)
    {
       if((i + aY) < 0 || (i + aY) >= aOut.h)
          continue;
 
-      uint16_t* const in = (uint16_t*)aIn.pixels + (i * aIn.w);
-      uint16_t* const out = (uint16_t*)aOut.pixels + ((i + aY) * aOut.w);
+      const TIn* const in = (const TIn*)aIn.getBasePtr(0, i);
+      TOut* const out = (TOut*)aOut.getBasePtr(0, i + aY);
 
       for(int j = 0; j < aIn.w; j ++)
       {
          if((j + aX) < 0 || (j + aX) >= aOut.w)
             continue;
 
-         uint8 r, g, b;
+         const TIn val = in[j];
+         if(val == aKeyColor)
+            continue;
 
-         const uint16_t val = in[j];
-         if(val != aKeyColor)
+         if(sizeof(TIn) == 1)
+            out[j + aX] = lut[val];
+         else
          {
-            aIn.format.colorToRGB(in[j], r, g, b);
+            uint8 r, g, b;
+            aIn.format.colorToRGB(val, r, g, b);
             out[j + aX] = aOut.format.RGBToColor(r, g, b);
          }
       }
    }
 }
 
+static void blitCursor(Graphics::Surface& aOut, const Graphics::Surface& aIn, int aX, int aY, const RetroPalette& aColors, uint32 aKeyColor)
+{
+   if(aOut.format.bytesPerPixel == 4)
+   {
+      if(aIn.format.bytesPerPixel == 1)
+         blit_cursor<uint32_t, uint8_t>(aOut, aIn, aX, aY, aColors, aKeyColor);
+      else if(aIn.format.bytesPerPixel == 4)
+         blit_cursor<uint32_t, uint32_t>(aOut, aIn, aX, aY, aColors, aKeyColor);
+      else
+         blit_cursor<uint32_t, uint16_t>(aOut, aIn, aX, aY, aColors, aKeyColor);
+   }
+   else
+   {
+      if(aIn.format.bytesPerPixel == 1)
+         blit_cursor<uint16_t, uint8_t>(aOut, aIn, aX, aY, aColors, aKeyColor);
+      else if(aIn.format.bytesPerPixel == 4)
+         blit_cursor<uint16_t, uint32_t>(aOut, aIn, aX, aY, aColors, aKeyColor);
+      else
+         blit_cursor<uint16_t, uint16_t>(aOut, aIn, aX, aY, aColors, aKeyColor);
+   }
+}
+
 static INLINE void copyRectToSurface(uint8_t *pixels, int out_pitch, const uint8_t *src, int pitch, int x, int y, int w, int h, int out_bpp)
 {
    uint8_t *dst = pixels + y * out_pitch + x * out_bpp;
@@ -249,8 +583,80 @@ static INLINE void copyRectToSurface(uint8_t *pixels, int out_pitch, const uint8
    }while(--h);
 }
 
+/* Savestate buffer, keeps its storage between snapshots so taking one every
+ * frame (rewind, run-ahead) does not go through the allocator. */
+class RetroStateStream : public Common::WriteStream
+{
+   public:
+      RetroStateStream() : _data(0), _size(0), _capacity(0) {}
+
+      virtual ~RetroStateStream()
+      {
+         free(_data);
+      }
+
+      void clear()
+      {
+         _size = 0;
+      }
+
+      const byte *getData() const
+      {
+         return _data;
+      }
+
+      uint32 size() const
+      {
+         return _size;
+      }
+
+      virtual uint32 write(const void *dataPtr, uint32 dataSize)
+      {
+         if(_size + dataSize > _capacity)
+         {
+            const uint32 capacity = MAX<uint32>(_capacity * 2, _size + dataSize);
+            byte *data = (byte*)realloc(_data, capacity);
+            if(!data)
+               return 0;
+
+            _data = data;
+            _capacity = capacity;
+         }
+
+         memcpy(_data + _size, dataPtr, dataSize);
+         _size += dataSize;
+         return dataSize;
+      }
+
+      virtual int32 pos() const
+      {
+         return _size;
+      }
+
+   private:
+      byte *_data;
+      uint32 _size;
+      uint32 _capacity;
+};
+
+#ifdef HAVE_THREADS
+/* Ring of mixed stereo frames between the audio thread and retro_run, the
+ * thread always mixes whole chunks so a chunk never wraps around the end */
+#define AUDIO_RING_FRAMES 8192
+#define AUDIO_CHUNK_FRAMES 256
+#endif
+
+#define RETRO_STATE_MAGIC MKTAG('S','V','M','R')
+#define RETRO_STATE_VERSION 1
+#define RETRO_STATE_HEADER_SIZE 12
+
 static Common::String s_systemDir;
 static Common::String s_saveDir;
+static unsigned s_audioRate = 44100;
+static bool s_fixedTiming = false;
+
+/* In fixed timing, this many event polls without the clock moving end the frame */
+#define FIXED_TIMING_MAX_POLLS 1000
 
 #ifdef FRONTEND_SUPPORTS_RGB565
 #define SURF_BPP 2
@@ -282,12 +688,20 @@ static Common::String s_saveDir;
 #define SURF_ASHIFT 15
 #endif
 
+#define NUM_DIRTY_RECT 64
+
 std::list<Common::Event> _events;
 
 class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
    public:
       Graphics::Surface _screen;
 
+      /* Regions of _screen that have to be converted again on the next updateScreen */
+      Common::Rect _dirtyRects[NUM_DIRTY_RECT];
+      int _numDirtyRects;
+      bool _forceFull;
+      bool _screenUpdated;
+
       Graphics::Surface _gameScreen;
       RetroPalette _gamePalette;
 
@@ -304,28 +718,64 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
       int _mouseHotspotY;
       int _mouseKeyColor;
       bool _mouseDontScale;
+      bool _mouseDirty;
+      Common::Rect _mouseDrawnRect;
       bool _mouseButtons[2];
       bool _joypadmouseButtons[2];
       bool _joypadstartButton;
 
-      uint32 _startTime;
-      uint32 _threadExitTime;
+      /* Virtual clock, advanced by the frontend once per retro_run. The
+       * engine may spend the time up to _frameDeadline in delayMillis()
+       * without returning to the frontend. */
+      uint32 _clock;
+      uint32 _frameDeadline;
+      uint32 _frameRemainder;
+      uint32 _frameStart;
+      uint32 _framePolls;
+      bool _timersRunning;
+      bool _quitPosted;
+
+      /* Savestates are taken on the emulator thread, see leaveThread() */
+      enum StateRequest { kStateNone, kStateSave, kStateLoad };
+      StateRequest _stateRequest;
+      bool _stateResult;
+      bool _stateCached;
+      RetroStateStream _state;
+      size_t _stateSizeHint;
+      const byte *_stateLoadData;
+      uint32 _stateLoadSize;
 
 
       Audio::MixerImpl* _mixer;
 
+#ifdef HAVE_THREADS
+      /* Only the audio thread advances _audioWrite and only the frontend thread
+       * advances _audioRead, each publishing its index to the other one */
+      pthread_t _audioThread;
+      bool _audioThreadRunning;
+      bool _audioThreadExit;
+      uint32 *_audioRing;
+      uint32 _audioRead;
+      uint32 _audioWrite;
+      uint32 _audioFill;
+      uint32 _audioUnderruns;
+#endif
+
 
       OSystem_RETRO() :
+         _numDirtyRects(0), _forceFull(true), _screenUpdated(true), _overlayVisible(false),
          _mousePaletteEnabled(false), _mouseVisible(false), _mouseX(0), _mouseY(0), _mouseHotspotX(0), _mouseHotspotY(0),
-         _mouseKeyColor(0), _mouseDontScale(false), _mixer(0), _startTime(0), _threadExitTime(10)
+         _mouseKeyColor(0), _mouseDontScale(false), _mouseDirty(true), _mixer(0), _clock(0), _frameDeadline(0), _frameRemainder(0), _frameStart(0), _framePolls(0), _timersRunning(false), _quitPosted(false),
+         _stateRequest(kStateNone), _stateResult(false), _stateCached(false), _stateSizeHint(0), _stateLoadData(0), _stateLoadSize(0)
+#ifdef HAVE_THREADS
+         , _audioThreadRunning(false), _audioThreadExit(false), _audioRing(0), _audioRead(0), _audioWrite(0), _audioFill(0), _audioUnderruns(0)
+#endif
    {
       _fsFactory = new FS_SYSTEM_FACTORY();
       memset(_mouseButtons, 0, sizeof(_mouseButtons));
       memset(_joypadmouseButtons, 0, sizeof(_joypadmouseButtons));
       _joypadstartButton = false;
 
-      _startTime = getMillis();
-
       if(s_systemDir.empty())
          s_systemDir = ".";
 
@@ -340,9 +790,103 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
          _mouseImage.free();
          _screen.free();
 
+#ifdef HAVE_THREADS
+         stopAudioThread();
+#endif
          delete _mixer;
       }
 
+#ifdef HAVE_THREADS
+      static void *audioThreadFunc(void *arg)
+      {
+         OSystem_RETRO *system = (OSystem_RETRO *)arg;
+
+         struct timespec tv_delay;
+         tv_delay.tv_sec = 0;
+         tv_delay.tv_nsec = 1000 * 1000;
+
+         while(!__atomic_load_n(&system->_audioThreadExit, __ATOMIC_ACQUIRE))
+         {
+            const uint32 write = system->_audioWrite;
+            const uint32 read = __atomic_load_n(&system->_audioRead, __ATOMIC_ACQUIRE);
+
+            // Stay only a little ahead of the frontend, the mix should follow the game closely
+            if(write - read + AUDIO_CHUNK_FRAMES > system->_audioFill)
+            {
+               nanosleep(&tv_delay, 0);
+               continue;
+            }
+
+            system->_mixer->mixCallback((byte *)(system->_audioRing + (write & (AUDIO_RING_FRAMES - 1))), AUDIO_CHUNK_FRAMES * 4);
+            __atomic_store_n(&system->_audioWrite, write + AUDIO_CHUNK_FRAMES, __ATOMIC_RELEASE);
+         }
+
+         return 0;
+      }
+
+      bool startAudioThread(uint32 aFramesPerRun)
+      {
+         if(_audioThreadRunning || !_mixer)
+            return _audioThreadRunning;
+
+         // Two frames ahead, at least a chunk more than one frame takes
+         _audioFill = (aFramesPerRun * 2 + AUDIO_CHUNK_FRAMES - 1) & ~(AUDIO_CHUNK_FRAMES - 1);
+         _audioFill = MIN<uint32>(MAX<uint32>(_audioFill, 2 * AUDIO_CHUNK_FRAMES), AUDIO_RING_FRAMES);
+
+         _audioRing = new uint32[AUDIO_RING_FRAMES];
+         _audioRead = _audioWrite = 0;
+         _audioUnderruns = 0;
+         _audioThreadExit = false;
+
+         if(pthread_create(&_audioThread, 0, audioThreadFunc, this) != 0)
+         {
+            delete[] _audioRing;
+            _audioRing = 0;
+            return false;
+         }
+
+         _audioThreadRunning = true;
+         return true;
+      }
+
+      void stopAudioThread()
+      {
+         if(!_audioThreadRunning)
+            return;
+
+         __atomic_store_n(&_audioThreadExit, true, __ATOMIC_RELEASE);
+         pthread_join(_audioThread, 0);
+         _audioThreadRunning = false;
+
+         delete[] _audioRing;
+         _audioRing = 0;
+      }
+
+      void readAudio(uint32 *aBuffer, uint32 aFrames)
+      {
+         const uint32 read = _audioRead;
+         const uint32 write = __atomic_load_n(&_audioWrite, __ATOMIC_ACQUIRE);
+         const uint32 frames = MIN(aFrames, write - read);
+
+         const uint32 pos = read & (AUDIO_RING_FRAMES - 1);
+         const uint32 first = MIN(frames, AUDIO_RING_FRAMES - pos);
+         memcpy(aBuffer, _audioRing + pos, first * 4);
+         memcpy(aBuffer + first, _audioRing, (frames - first) * 4);
+         __atomic_store_n(&_audioRead, read + frames, __ATOMIC_RELEASE);
+
+         // Keep the frontend fed with silence rather than fall behind the timing
+         if(frames < aFrames)
+         {
+            memset(aBuffer + frames, 0, (aFrames - frames) * 4);
+            _audioUnderruns++;
+
+            if (log_cb)
+               log_cb(RETRO_LOG_DEBUG, "Audio thread underrun, %u frames missing (%u so far).\n", aFrames - frames, _audioUnderruns);
+         }
+      }
+#endif
+
+
       virtual void initBackend()
       {
          _savefileManager = new DefaultSaveFileManager(s_saveDir);
@@ -351,7 +895,7 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
 #else
          _overlay.create(RES_W, RES_H, Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15));
 #endif
-         _mixer = new Audio::MixerImpl(this, 44100);
+         _mixer = new Audio::MixerImpl(this, s_audioRate);
          _timerManager = new DefaultTimerManager();
 
          _mixer->setReady(true);
@@ -367,7 +911,10 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
       virtual void setFeatureState(Feature f, bool enable)
       {
          if (f == kFeatureCursorPalette)
+         {
             _mousePaletteEnabled = enable;
+            _mouseDirty = true;
+         }
       }
 
       virtual bool getFeatureState(Feature f)
@@ -399,6 +946,7 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
       virtual void initSize(uint width, uint height, const Graphics::PixelFormat *format)
       {
          _gameScreen.create(width, height, format ? *format : Graphics::PixelFormat::createFormatCLUT8());
+         _forceFull = true;
       }
 
       virtual int16 getHeight()
@@ -420,6 +968,10 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
       {
          Common::List<Graphics::PixelFormat> result;
 
+         /* ARGB8888 - matches the XRGB8888 screen, no conversion needed */
+         if(isFormatXRGB8888(getRetroScreenFormat()))
+            result.push_back(Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24));
+
          /* RGBA8888 */
          result.push_back(Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
 
@@ -443,6 +995,12 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
       virtual void setPalette(const byte *colors, uint start, uint num)
       {
          _gamePalette.set(colors, start, num);
+
+         if(!_overlayVisible && _gameScreen.format.bytesPerPixel == 1)
+            _forceFull = true;
+
+         if(!_mousePaletteEnabled)
+            _mouseDirty = true;
       }
 
       virtual void grabPalette(byte *colors, uint start, uint num)
@@ -457,39 +1015,76 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
          const uint8_t *src = (const uint8_t*)buf;
          uint8_t *pix = (uint8_t*)_gameScreen.pixels;
          copyRectToSurface(pix, _gameScreen.pitch, src, pitch, x, y, w, h, _gameScreen.format.bytesPerPixel);
+
+         if(!_overlayVisible)
+            addDirtyRect(Common::Rect(x, y, x + w, y + h));
       }
 
       virtual void updateScreen()
+      {
+         RETRO_PERFORMANCE_INIT(retro_presentation);
+         RETRO_PERFORMANCE_START(retro_presentation);
+         presentScreen();
+         RETRO_PERFORMANCE_STOP(retro_presentation);
+
+         // Every presented frame hands control back to the frontend
+         yieldFrame();
+      }
+
+      void presentScreen()
       {
          const Graphics::Surface& srcSurface = (_overlayVisible) ? _overlay : _gameScreen;
-         if(srcSurface.w && srcSurface.h)
+         checkScreenSize(srcSurface);
+
+         // The cursor has to be erased from its old position and drawn at its new one
+         Common::Rect mouseRect;
+         if(_mouseVisible && _mouseImage.w && _mouseImage.h)
          {
-            switch(srcSurface.format.bytesPerPixel)
-            {
-               case 1:
-               case 3:
-                  blit_uint8_uint16_fast(_screen, srcSurface, _gamePalette);
-                  break;
-               case 2:
-                  blit_uint16_uint16(_screen, srcSurface, _gamePalette);
-                  break;
-               case 4:
-                  blit_uint32_uint16(_screen, srcSurface, _gamePalette);
-                  break;
-            }
+            const int x = _mouseX - _mouseHotspotX;
+            const int y = _mouseY - _mouseHotspotY;
+            mouseRect = Common::Rect(x, y, x + _mouseImage.w, y + _mouseImage.h);
+            mouseRect.clip(_screen.w, _screen.h);
+         }
+
+         if(_mouseDirty || mouseRect != _mouseDrawnRect)
+         {
+            addDirtyRect(_mouseDrawnRect);
+            addDirtyRect(mouseRect);
+            _mouseDirty = false;
+         }
+
+         if(!_forceFull && !_numDirtyRects)
+            return;
+
+         if(_forceFull)
+         {
+            _dirtyRects[0] = Common::Rect(_screen.w, _screen.h);
+            _numDirtyRects = 1;
+         }
+
+         for(int i = 0; i < _numDirtyRects; i ++)
+         {
+            Common::Rect rect = _dirtyRects[i];
+            rect.clip(MIN(srcSurface.w, _screen.w), MIN(srcSurface.h, _screen.h));
+            if(rect.isEmpty())
+               continue;
+
+            blitRect(_screen, srcSurface, _gamePalette, rect);
          }
 
          // Draw Mouse
-         if(_mouseVisible && _mouseImage.w && _mouseImage.h)
+         if(!mouseRect.isEmpty())
          {
             const int x = _mouseX - _mouseHotspotX;
             const int y = _mouseY - _mouseHotspotY;
 
-            if(_mouseImage.format.bytesPerPixel == 1)
-               blit_uint8_uint16(_screen, _mouseImage, x, y, _mousePaletteEnabled ? _mousePalette : _gamePalette, _mouseKeyColor);
-            else
-               blit_uint16_uint16(_screen, _mouseImage, x, y, _mousePaletteEnabled ? _mousePalette : _gamePalette, _mouseKeyColor);
+            blitCursor(_screen, _mouseImage, x, y, _mousePaletteEnabled ? _mousePalette : _gamePalette, _mouseKeyColor);
          }
+
+         _mouseDrawnRect = mouseRect;
+         _numDirtyRects = 0;
+         _forceFull = false;
+         _screenUpdated = true;
       }
 
       virtual Graphics::Surface *lockScreen()
@@ -499,7 +1094,9 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
 
       virtual void unlockScreen()
       {
-         /* EMPTY */
+         // We don't know what was drawn into the locked surface
+         if(!_overlayVisible)
+            _forceFull = true;
       }
 
       virtual void setShakePos(int shakeOffset)
@@ -510,16 +1107,21 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
       virtual void showOverlay()
       {
          _overlayVisible = true;
+         _forceFull = true;
       }
 
       virtual void hideOverlay()
       {
          _overlayVisible = false;
+         _forceFull = true;
       }
 
       virtual void clearOverlay()
       {
          _overlay.fillRect(Common::Rect(_overlay.w, _overlay.h), 0);
+
+         if(_overlayVisible)
+            _forceFull = true;
       }
 
       virtual void grabOverlay(void *buf, int pitch)
@@ -540,6 +1142,9 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
          const uint8_t *src = (const uint8_t*)buf;
          uint8_t *pix = (uint8_t*)_overlay.pixels;
          copyRectToSurface(pix, _overlay.pitch, src, pitch, x, y, w, h, _overlay.format.bytesPerPixel);
+
+         if(_overlayVisible)
+            addDirtyRect(Common::Rect(x, y, x + w, y + h));
       }
 
       virtual int16 getOverlayHeight()
@@ -587,33 +1192,172 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
          _mouseHotspotY = hotspotY;
          _mouseKeyColor = keycolor;
          _mouseDontScale = dontScale;
+         _mouseDirty = true;
       }
 
       virtual void setCursorPalette(const byte *colors, uint start, uint num)
       {
          _mousePalette.set(colors, start, num);
          _mousePaletteEnabled = true;
+         _mouseDirty = true;
       }
 
-      bool retroCheckThread(uint32 offset = 0)
+      void leaveThread()
       {
-         if(_threadExitTime <= (getMillis() + offset))
+         extern void retro_leave_thread();
+         retro_leave_thread();
+
+         // The frontend may switch back here only to have a savestate handled
+         while(_stateRequest != kStateNone)
          {
-            extern void retro_leave_thread();
+            handleStateRequest();
             retro_leave_thread();
+         }
 
-            _threadExitTime = getMillis() + 10;
-            return true;
+         // The engine is about to run again
+         _stateCached = false;
+      }
+
+      void handleStateRequest()
+      {
+         const uint32 start = getHostMillis();
+
+         if(_stateRequest == kStateSave)
+         {
+            _state.clear();
+            _stateResult = (g_engine->saveGameStream(&_state).getCode() == Common::kNoError);
+            _stateCached = _stateResult;
+         }
+         else
+         {
+            // The engine no longer matches the snapshot taken before the load
+            _stateCached = false;
+            Common::MemoryReadStream stream(_stateLoadData, _stateLoadSize);
+            _stateResult = (g_engine->loadGameStream(&stream).getCode() == Common::kNoError);
          }
 
-         return false;
+         const uint32 duration = getHostMillis() - start;
+         if (log_cb)
+            log_cb(duration > 1000 / 60 ? RETRO_LOG_WARN : RETRO_LOG_DEBUG, "Savestate %s took %u ms.\n",
+                  _stateRequest == kStateSave ? "save" : "load", duration);
+
+         _stateRequest = kStateNone;
       }
 
-      virtual bool pollEvent(Common::Event &event)
+      bool runStateRequest(StateRequest aRequest)
+      {
+         // Only snapshot a running engine which is not inside a dialog or the GMM
+         if(!g_engine || g_engine->isPaused())
+            return false;
+
+         if(aRequest == kStateSave ? !g_engine->canSaveGameStateCurrently() : !g_engine->canLoadGameStateCurrently())
+            return false;
+
+         extern void retro_enter_thread();
+         _stateRequest = aRequest;
+         retro_enter_thread();
+         return _stateResult;
+      }
+
+      bool takeSnapshot()
+      {
+         return _stateCached || runStateRequest(kStateSave);
+      }
+
+      size_t getStateSize()
+      {
+         if(!takeSnapshot())
+            return 0;
+
+         // Leave room for the state to grow, frontends size their buffers once
+         size_t size = RETRO_STATE_HEADER_SIZE + _state.size() + _state.size() / 4;
+         size = (size + 0xFFFF) & ~(size_t)0xFFFF;
+         _stateSizeHint = MAX(_stateSizeHint, size);
+         return _stateSizeHint;
+      }
+
+      bool saveState(void *aData, size_t aSize)
+      {
+         if(!takeSnapshot() || RETRO_STATE_HEADER_SIZE + _state.size() > aSize)
+            return false;
+
+         byte *out = (byte*)aData;
+         WRITE_BE_UINT32(out, RETRO_STATE_MAGIC);
+         WRITE_LE_UINT32(out + 4, RETRO_STATE_VERSION);
+         WRITE_LE_UINT32(out + 8, _state.size());
+         memcpy(out + RETRO_STATE_HEADER_SIZE, _state.getData(), _state.size());
+         memset(out + RETRO_STATE_HEADER_SIZE + _state.size(), 0, aSize - RETRO_STATE_HEADER_SIZE - _state.size());
+         return true;
+      }
+
+      bool loadState(const void *aData, size_t aSize)
+      {
+         const byte *in = (const byte*)aData;
+         if(aSize < RETRO_STATE_HEADER_SIZE || READ_BE_UINT32(in) != RETRO_STATE_MAGIC || READ_LE_UINT32(in + 4) != RETRO_STATE_VERSION)
+            return false;
+
+         const uint32 size = READ_LE_UINT32(in + 8);
+         if(RETRO_STATE_HEADER_SIZE + size > aSize)
+            return false;
+
+         _stateLoadData = in + RETRO_STATE_HEADER_SIZE;
+         _stateLoadSize = size;
+         const bool result = runStateRequest(kStateLoad);
+         _stateLoadData = 0;
+         return result;
+      }
+
+      void advanceFrame(uint32 aMicros)
+      {
+         _frameRemainder += aMicros;
+         _frameDeadline += _frameRemainder / 1000;
+         _frameRemainder %= 1000;
+      }
+
+      void setClock(uint32 aClock)
       {
-         retroCheckThread();
+         _clock = aClock;
+         _framePolls = 0;
+
+         // Fire the timers due by now, so they run at the same virtual time whatever the host load
+         runTimers();
+      }
 
+      void runTimers()
+      {
+         // A timer callback which sleeps must not fire timers from inside itself
+         if(!_timerManager || _timersRunning)
+            return;
+
+         _timersRunning = true;
          ((DefaultTimerManager*)_timerManager)->handler();
+         _timersRunning = false;
+      }
+
+      void yieldFrame()
+      {
+         // Whatever the engine did not sleep of this frame's time has passed now
+         setClock(_frameDeadline);
+         leaveThread();
+         _frameStart = getHostMillis();
+      }
+
+      bool isFrameStalled()
+      {
+         // Engines which wait for time to pass by polling alone would never see the clock move.
+         // Fixed timing must not depend on the host, so it counts polls instead of host time.
+         if(s_fixedTiming)
+            return ++_framePolls >= FIXED_TIMING_MAX_POLLS;
+
+         return getHostMillis() - _frameStart >= 1000 / 60;
+      }
+
+      virtual bool pollEvent(Common::Event &event)
+      {
+         if(isFrameStalled())
+            yieldFrame();
+
+         runTimers();
 
 
          if(!_events.empty())
@@ -628,25 +1372,80 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
 
       virtual uint32 getMillis(bool skipRecord = false)
       {
+         return _clock;
+      }
+
+      uint32 getHostMillis() const
+      {
 #if defined(GEKKO)
-         return (ticks_to_microsecs(gettime()) / 1000.0) - _startTime;
+         return ticks_to_microsecs(gettime()) / 1000.0;
 #elif defined(__CELLOS_LV2__)
-         return (sys_time_get_system_time() / 1000.0) - _startTime;
+         return sys_time_get_system_time() / 1000.0;
 #else
          struct timeval t;
          gettimeofday(&t, 0);
 
-         return ((t.tv_sec * 1000) + (t.tv_usec / 1000)) - _startTime;
+         return (t.tv_sec * 1000) + (t.tv_usec / 1000);
 #endif
       }
 
       virtual void delayMillis(uint msecs)
       {
-         if(!retroCheckThread(msecs))
-            retro_sleep(msecs);
+         // Sleeping only moves the virtual clock, past the end of the frame
+         // the rest of the delay is spent in the frontend instead. Once the
+         // frontend is unloading no more frames are handed out, so stop waiting.
+         const uint32 target = _clock + msecs;
+         while((int32)(target - _frameDeadline) > 0 && !_quitPosted)
+            yieldFrame();
+
+         setClock(target);
       }
 
 
+#ifdef HAVE_THREADS
+      virtual MutexRef createMutex(void)
+      {
+         pthread_mutexattr_t attr;
+
+         pthread_mutexattr_init(&attr);
+         pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+
+         pthread_mutex_t *mutex = new pthread_mutex_t;
+
+         if(pthread_mutex_init(mutex, &attr) != 0)
+         {
+            warning("pthread_mutex_init() failed");
+
+            delete mutex;
+            mutex = 0;
+         }
+
+         pthread_mutexattr_destroy(&attr);
+         return (MutexRef)mutex;
+      }
+
+      virtual void lockMutex(MutexRef mutex)
+      {
+         if(pthread_mutex_lock((pthread_mutex_t *)mutex) != 0)
+            warning("pthread_mutex_lock() failed");
+      }
+
+      virtual void unlockMutex(MutexRef mutex)
+      {
+         if(pthread_mutex_unlock((pthread_mutex_t *)mutex) != 0)
+            warning("pthread_mutex_unlock() failed");
+      }
+
+      virtual void deleteMutex(MutexRef mutex)
+      {
+         pthread_mutex_t *m = (pthread_mutex_t *)mutex;
+
+         if(pthread_mutex_destroy(m) != 0)
+            warning("pthread_mutex_destroy() failed");
+         else
+            delete m;
+      }
+#else
       virtual MutexRef createMutex(void)
       {
          return MutexRef();
@@ -666,6 +1465,7 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
       {
          /* EMPTY */
       }
+#endif
 
       virtual void quit()
       {
@@ -729,23 +1529,43 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
 
       //
 
-      const Graphics::Surface& getScreen()
+      void addDirtyRect(const Common::Rect& aRect)
       {
-         const Graphics::Surface& srcSurface = (_overlayVisible) ? _overlay : _gameScreen;
+         if(_forceFull || aRect.isEmpty())
+            return;
 
-         if(srcSurface.w != _screen.w || srcSurface.h != _screen.h)
+         if(_numDirtyRects == NUM_DIRTY_RECT)
          {
-#ifdef FRONTEND_SUPPORTS_RGB565
-            _screen.create(srcSurface.w, srcSurface.h, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
-#else
-            _screen.create(srcSurface.w, srcSurface.h, Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15));
-#endif
+            _forceFull = true;
+            return;
          }
 
+         _dirtyRects[_numDirtyRects++] = aRect;
+      }
+
+      void checkScreenSize(const Graphics::Surface& aSrcSurface)
+      {
+         if(aSrcSurface.w != _screen.w || aSrcSurface.h != _screen.h)
+         {
+            _screen.create(aSrcSurface.w, aSrcSurface.h, getRetroScreenFormat());
+            _forceFull = true;
+            _screenUpdated = true;
+         }
+      }
 
+      const Graphics::Surface& getScreen()
+      {
+         checkScreenSize((_overlayVisible) ? _overlay : _gameScreen);
          return _screen;
       }
 
+      bool checkScreenUpdated()
+      {
+         const bool updated = _screenUpdated;
+         _screenUpdated = false;
+         return updated;
+      }
+
 #define ANALOG_VALUE_X_ADD 1
 #define ANALOG_VALUE_Y_ADD 1
 #define ANALOG_THRESHOLD1 10000
@@ -1008,6 +1828,7 @@ class OSystem_RETRO : public EventsBaseBackend, public PaletteManager {
          Common::Event ev;
          ev.type = Common::EVENT_QUIT;
          _events.push_back(ev);
+         _quitPosted = true;
       }
 };
 
@@ -1021,26 +1842,94 @@ const Graphics::Surface& getScreen()
    return ((OSystem_RETRO*)g_system)->getScreen();
 }
 
+bool retroScreenUpdated()
+{
+   return ((OSystem_RETRO*)g_system)->checkScreenUpdated();
+}
+
 void retroProcessMouse(retro_input_state_t aCallback)
 {
    ((OSystem_RETRO*)g_system)->processMouse(aCallback);
 }
 
+void retroAdvanceFrame(unsigned aMicros)
+{
+   ((OSystem_RETRO*)g_system)->advanceFrame(aMicros);
+}
+
 void retroPostQuit()
 {
    ((OSystem_RETRO*)g_system)->postQuit();
 }
 
+size_t retroGetStateSize()
+{
+   return ((OSystem_RETRO*)g_system)->getStateSize();
+}
+
+bool retroSaveState(void *aData, size_t aSize)
+{
+   return ((OSystem_RETRO*)g_system)->saveState(aData, aSize);
+}
+
+bool retroLoadState(const void *aData, size_t aSize)
+{
+   return ((OSystem_RETRO*)g_system)->loadState(aData, aSize);
+}
+
+#ifdef HAVE_THREADS
+bool retroStartAudioThread(unsigned aFramesPerRun)
+{
+   return ((OSystem_RETRO*)g_system)->startAudioThread(aFramesPerRun);
+}
+
+void retroStopAudioThread()
+{
+   ((OSystem_RETRO*)g_system)->stopAudioThread();
+}
+
+void retroReadAudio(uint32_t *aBuffer, unsigned aFrames)
+{
+   ((OSystem_RETRO*)g_system)->readAudio(aBuffer, aFrames);
+}
+#endif
+
 void retroSetSystemDir(const char* aPath)
 {
    s_systemDir = Common::String(aPath ? aPath : ".");
 }
 
+void retroSetFixedTiming(bool aFixed)
+{
+   s_fixedTiming = aFixed;
+}
+
+void retroSetAudioRate(unsigned aRate)
+{
+   s_audioRate = aRate;
+}
+
 void retroSetSaveDir(const char* aPath)
 {
    s_saveDir = Common::String(aPath ? aPath : ".");
 }
 
+void retroSetPixelFormat(retro_pixel_format aFormat)
+{
+   switch(aFormat)
+   {
+      case RETRO_PIXEL_FORMAT_XRGB8888:
+         s_screenFormat = Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0);
+         break;
+      case RETRO_PIXEL_FORMAT_RGB565:
+         s_screenFormat = Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0);
+         break;
+      default:
+         s_screenFormat = Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15);
+         break;
+   }
+}
+
 void retroKeyEvent(bool down, unsigned keycode, uint32_t character, uint16_t key_modifiers)
 {
    ((OSystem_RETRO*)g_system)->processKeyEvent(down, keycode, character, key_modifiers);
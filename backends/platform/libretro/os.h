@@ -42,14 +42,36 @@
 extern int access(const char *path, int amode);
 #endif
 
+/* Performance counters, reported to the frontend's perf interface when it has one */
+extern struct retro_perf_callback perf_cb;
+
+#define RETRO_PERFORMANCE_INIT(name) static struct retro_perf_counter name = {#name}; if (perf_cb.perf_register && !name.registered) perf_cb.perf_register(&(name))
+#define RETRO_PERFORMANCE_START(name) if (perf_cb.perf_start) perf_cb.perf_start(&(name))
+#define RETRO_PERFORMANCE_STOP(name) if (perf_cb.perf_stop) perf_cb.perf_stop(&(name))
+
 OSystem* retroBuildOS();
 const Graphics::Surface& getScreen();
+bool retroScreenUpdated();
 
 void retroProcessMouse(retro_input_state_t aCallback);
 void retroPostQuit();
+void retroAdvanceFrame(unsigned aMicros);
+
+size_t retroGetStateSize();
+bool retroSaveState(void *aData, size_t aSize);
+bool retroLoadState(const void *aData, size_t aSize);
+
+#ifdef HAVE_THREADS
+bool retroStartAudioThread(unsigned aFramesPerRun);
+void retroStopAudioThread();
+void retroReadAudio(uint32_t *aBuffer, unsigned aFrames);
+#endif
 
 void retroSetSystemDir(const char* aPath);
 void retroSetSaveDir(const char* aPath);
+void retroSetPixelFormat(retro_pixel_format aFormat);
+void retroSetAudioRate(unsigned aRate);
+void retroSetFixedTiming(bool aFixed);
 
 void retroKeyEvent(bool down, unsigned keycode, uint32_t character, uint16_t key_modifiers);
 
@@ -197,6 +197,9 @@ void registerDefaults() {
 	ConfMan.registerDefault("native_mt32", false);
 	ConfMan.registerDefault("enable_gs", false);
 	ConfMan.registerDefault("midi_gain", 100);
+	ConfMan.registerDefault("midi_render_cache", false);
+	ConfMan.registerDefault("midi_render_cache_size", 128);
+	ConfMan.registerDefault("mt32_threaded", false);
 
 	ConfMan.registerDefault("music_driver", "auto");
 	ConfMan.registerDefault("mt32_device", "null");
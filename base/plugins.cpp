@@ -527,6 +527,12 @@ GameList EngineManager::detectGames(const Common::FSList &fslist) const {
 			candidates.push_back((**iter)->detectGames(fslist));
 		}
 	} while (PluginManager::instance().loadNextPlugin());
+
+	// Only the plugins left in memory are asked, which is enough for the
+	// cache shared by the AdvancedDetector engines
+	plugins = getPlugins();
+	for (iter = plugins.begin(); iter != plugins.end(); ++iter)
+		(**iter)->saveDetectionCache();
 	return candidates;
 }
 
@@ -213,6 +213,17 @@ public:
 	 */
 	bool isWritable() const;
 
+	/**
+	 * Returns the size and the time of the last modification of the file
+	 * referred by this node. Comparing them to earlier values tells whether
+	 * the file has changed, e.g. to validate cached information about it.
+	 *
+	 * @param size				set to the size of the file in bytes
+	 * @param modificationTime	set to the time of the last modification, in a backend specific unit
+	 * @return true if the information is available, false otherwise.
+	 */
+	bool getFileStats(uint32 &size, uint32 &modificationTime) const;
+
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
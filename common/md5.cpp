@@ -30,187 +30,226 @@
 #include "common/endian.h"
 #include "common/str.h"
 #include "common/stream.h"
+#include "common/util.h"
 
 namespace Common {
 
-struct md5_context {
-	uint32 total[2];
-	uint32 state[4];
-	uint8 buffer[64];
-};
-
-static void md5_starts(md5_context *ctx);
-static void md5_update(md5_context *ctx, const uint8 *input, uint32 length);
-static void md5_finish(md5_context *ctx, uint8 digest[16]);
-
-
-#define GET_UINT32(n, b, i)	(n) = READ_LE_UINT32(b + i)
-#define PUT_UINT32(n, b, i)	WRITE_LE_UINT32(b + i, n)
-
-void md5_starts(md5_context *ctx) {
-	ctx->total[0] = 0;
-	ctx->total[1] = 0;
-
-	ctx->state[0] = 0x67452301;
-	ctx->state[1] = 0xEFCDAB89;
-	ctx->state[2] = 0x98BADCFE;
-	ctx->state[3] = 0x10325476;
-}
+/**
+ * The MD5 transform, applied to the given number of consecutive 64 byte
+ * blocks. The state is kept in registers across the blocks.
+ */
+static void md5_process(uint32 state[4], const uint8 *data, uint32 blocks) {
+	uint32 A = state[0];
+	uint32 B = state[1];
+	uint32 C = state[2];
+	uint32 D = state[3];
+
+#ifdef SCUMM_LITTLE_ENDIAN
+	uint32 buffer[16];
+#else
+	uint32 X[16];
+#endif
 
-static void md5_process(md5_context *ctx, const uint8 data[64]) {
-	uint32 X[16], A, B, C, D;
-
-	GET_UINT32(X[0],  data,  0);
-	GET_UINT32(X[1],  data,  4);
-	GET_UINT32(X[2],  data,  8);
-	GET_UINT32(X[3],  data, 12);
-	GET_UINT32(X[4],  data, 16);
-	GET_UINT32(X[5],  data, 20);
-	GET_UINT32(X[6],  data, 24);
-	GET_UINT32(X[7],  data, 28);
-	GET_UINT32(X[8],  data, 32);
-	GET_UINT32(X[9],  data, 36);
-	GET_UINT32(X[10], data, 40);
-	GET_UINT32(X[11], data, 44);
-	GET_UINT32(X[12], data, 48);
-	GET_UINT32(X[13], data, 52);
-	GET_UINT32(X[14], data, 56);
-	GET_UINT32(X[15], data, 60);
-
-#define S(x, n) ((x << n) | ((x & 0xFFFFFFFF) >> (32 - n)))
+#define S(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
 
 #define P(a, b, c, d, k, s, t)                    \
 {                                                 \
 	a += F(b,c,d) + X[k] + t; a = S(a,s) + b; \
 }
 
-	A = ctx->state[0];
-	B = ctx->state[1];
-	C = ctx->state[2];
-	D = ctx->state[3];
+	for (; blocks > 0; --blocks, data += 64) {
+#ifdef SCUMM_LITTLE_ENDIAN
+		// The words of the block can be used in place when aligned
+		const uint32 *X;
+		if (((size_t)data & 3) == 0) {
+			X = (const uint32 *)data;
+		} else {
+			memcpy(buffer, data, 64);
+			X = buffer;
+		}
+#else
+		for (int i = 0; i < 16; ++i)
+			X[i] = READ_LE_UINT32(data + i * 4);
+#endif
+
+		const uint32 AA = A, BB = B, CC = C, DD = D;
 
 #define F(x, y, z) (z ^ (x & (y ^ z)))
 
-	P(A, B, C, D,  0,  7, 0xD76AA478);
-	P(D, A, B, C,  1, 12, 0xE8C7B756);
-	P(C, D, A, B,  2, 17, 0x242070DB);
-	P(B, C, D, A,  3, 22, 0xC1BDCEEE);
-	P(A, B, C, D,  4,  7, 0xF57C0FAF);
-	P(D, A, B, C,  5, 12, 0x4787C62A);
-	P(C, D, A, B,  6, 17, 0xA8304613);
-	P(B, C, D, A,  7, 22, 0xFD469501);
-	P(A, B, C, D,  8,  7, 0x698098D8);
-	P(D, A, B, C,  9, 12, 0x8B44F7AF);
-	P(C, D, A, B, 10, 17, 0xFFFF5BB1);
-	P(B, C, D, A, 11, 22, 0x895CD7BE);
-	P(A, B, C, D, 12,  7, 0x6B901122);
-	P(D, A, B, C, 13, 12, 0xFD987193);
-	P(C, D, A, B, 14, 17, 0xA679438E);
-	P(B, C, D, A, 15, 22, 0x49B40821);
+		P(A, B, C, D,  0,  7, 0xD76AA478);
+		P(D, A, B, C,  1, 12, 0xE8C7B756);
+		P(C, D, A, B,  2, 17, 0x242070DB);
+		P(B, C, D, A,  3, 22, 0xC1BDCEEE);
+		P(A, B, C, D,  4,  7, 0xF57C0FAF);
+		P(D, A, B, C,  5, 12, 0x4787C62A);
+		P(C, D, A, B,  6, 17, 0xA8304613);
+		P(B, C, D, A,  7, 22, 0xFD469501);
+		P(A, B, C, D,  8,  7, 0x698098D8);
+		P(D, A, B, C,  9, 12, 0x8B44F7AF);
+		P(C, D, A, B, 10, 17, 0xFFFF5BB1);
+		P(B, C, D, A, 11, 22, 0x895CD7BE);
+		P(A, B, C, D, 12,  7, 0x6B901122);
+		P(D, A, B, C, 13, 12, 0xFD987193);
+		P(C, D, A, B, 14, 17, 0xA679438E);
+		P(B, C, D, A, 15, 22, 0x49B40821);
 
 #undef F
 
-#define F(x, y, z) (y ^ (z & (x ^ y)))
-
-	P(A, B, C, D,  1,  5, 0xF61E2562);
-	P(D, A, B, C,  6,  9, 0xC040B340);
-	P(C, D, A, B, 11, 14, 0x265E5A51);
-	P(B, C, D, A,  0, 20, 0xE9B6C7AA);
-	P(A, B, C, D,  5,  5, 0xD62F105D);
-	P(D, A, B, C, 10,  9, 0x02441453);
-	P(C, D, A, B, 15, 14, 0xD8A1E681);
-	P(B, C, D, A,  4, 20, 0xE7D3FBC8);
-	P(A, B, C, D,  9,  5, 0x21E1CDE6);
-	P(D, A, B, C, 14,  9, 0xC33707D6);
-	P(C, D, A, B,  3, 14, 0xF4D50D87);
-	P(B, C, D, A,  8, 20, 0x455A14ED);
-	P(A, B, C, D, 13,  5, 0xA9E3E905);
-	P(D, A, B, C,  2,  9, 0xFCEFA3F8);
-	P(C, D, A, B,  7, 14, 0x676F02D9);
-	P(B, C, D, A, 12, 20, 0x8D2A4C8A);
+		// (x & z) | (y & ~z), as a sum of two independent terms since
+		// their bits never overlap
+#define F(x, y, z) ((x & z) + (y & ~z))
+
+		P(A, B, C, D,  1,  5, 0xF61E2562);
+		P(D, A, B, C,  6,  9, 0xC040B340);
+		P(C, D, A, B, 11, 14, 0x265E5A51);
+		P(B, C, D, A,  0, 20, 0xE9B6C7AA);
+		P(A, B, C, D,  5,  5, 0xD62F105D);
+		P(D, A, B, C, 10,  9, 0x02441453);
+		P(C, D, A, B, 15, 14, 0xD8A1E681);
+		P(B, C, D, A,  4, 20, 0xE7D3FBC8);
+		P(A, B, C, D,  9,  5, 0x21E1CDE6);
+		P(D, A, B, C, 14,  9, 0xC33707D6);
+		P(C, D, A, B,  3, 14, 0xF4D50D87);
+		P(B, C, D, A,  8, 20, 0x455A14ED);
+		P(A, B, C, D, 13,  5, 0xA9E3E905);
+		P(D, A, B, C,  2,  9, 0xFCEFA3F8);
+		P(C, D, A, B,  7, 14, 0x676F02D9);
+		P(B, C, D, A, 12, 20, 0x8D2A4C8A);
 
 #undef F
 
 #define F(x, y, z) (x ^ y ^ z)
 
-	P(A, B, C, D,  5,  4, 0xFFFA3942);
-	P(D, A, B, C,  8, 11, 0x8771F681);
-	P(C, D, A, B, 11, 16, 0x6D9D6122);
-	P(B, C, D, A, 14, 23, 0xFDE5380C);
-	P(A, B, C, D,  1,  4, 0xA4BEEA44);
-	P(D, A, B, C,  4, 11, 0x4BDECFA9);
-	P(C, D, A, B,  7, 16, 0xF6BB4B60);
-	P(B, C, D, A, 10, 23, 0xBEBFBC70);
-	P(A, B, C, D, 13,  4, 0x289B7EC6);
-	P(D, A, B, C,  0, 11, 0xEAA127FA);
-	P(C, D, A, B,  3, 16, 0xD4EF3085);
-	P(B, C, D, A,  6, 23, 0x04881D05);
-	P(A, B, C, D,  9,  4, 0xD9D4D039);
-	P(D, A, B, C, 12, 11, 0xE6DB99E5);
-	P(C, D, A, B, 15, 16, 0x1FA27CF8);
-	P(B, C, D, A,  2, 23, 0xC4AC5665);
+		P(A, B, C, D,  5,  4, 0xFFFA3942);
+		P(D, A, B, C,  8, 11, 0x8771F681);
+		P(C, D, A, B, 11, 16, 0x6D9D6122);
+		P(B, C, D, A, 14, 23, 0xFDE5380C);
+		P(A, B, C, D,  1,  4, 0xA4BEEA44);
+		P(D, A, B, C,  4, 11, 0x4BDECFA9);
+		P(C, D, A, B,  7, 16, 0xF6BB4B60);
+		P(B, C, D, A, 10, 23, 0xBEBFBC70);
+		P(A, B, C, D, 13,  4, 0x289B7EC6);
+		P(D, A, B, C,  0, 11, 0xEAA127FA);
+		P(C, D, A, B,  3, 16, 0xD4EF3085);
+		P(B, C, D, A,  6, 23, 0x04881D05);
+		P(A, B, C, D,  9,  4, 0xD9D4D039);
+		P(D, A, B, C, 12, 11, 0xE6DB99E5);
+		P(C, D, A, B, 15, 16, 0x1FA27CF8);
+		P(B, C, D, A,  2, 23, 0xC4AC5665);
 
 #undef F
 
 #define F(x, y, z) (y ^ (x | ~z))
 
-	P(A, B, C, D,  0,  6, 0xF4292244);
-	P(D, A, B, C,  7, 10, 0x432AFF97);
-	P(C, D, A, B, 14, 15, 0xAB9423A7);
-	P(B, C, D, A,  5, 21, 0xFC93A039);
-	P(A, B, C, D, 12,  6, 0x655B59C3);
-	P(D, A, B, C,  3, 10, 0x8F0CCC92);
-	P(C, D, A, B, 10, 15, 0xFFEFF47D);
-	P(B, C, D, A,  1, 21, 0x85845DD1);
-	P(A, B, C, D,  8,  6, 0x6FA87E4F);
-	P(D, A, B, C, 15, 10, 0xFE2CE6E0);
-	P(C, D, A, B,  6, 15, 0xA3014314);
-	P(B, C, D, A, 13, 21, 0x4E0811A1);
-	P(A, B, C, D,  4,  6, 0xF7537E82);
-	P(D, A, B, C, 11, 10, 0xBD3AF235);
-	P(C, D, A, B,  2, 15, 0x2AD7D2BB);
-	P(B, C, D, A,  9, 21, 0xEB86D391);
+		P(A, B, C, D,  0,  6, 0xF4292244);
+		P(D, A, B, C,  7, 10, 0x432AFF97);
+		P(C, D, A, B, 14, 15, 0xAB9423A7);
+		P(B, C, D, A,  5, 21, 0xFC93A039);
+		P(A, B, C, D, 12,  6, 0x655B59C3);
+		P(D, A, B, C,  3, 10, 0x8F0CCC92);
+		P(C, D, A, B, 10, 15, 0xFFEFF47D);
+		P(B, C, D, A,  1, 21, 0x85845DD1);
+		P(A, B, C, D,  8,  6, 0x6FA87E4F);
+		P(D, A, B, C, 15, 10, 0xFE2CE6E0);
+		P(C, D, A, B,  6, 15, 0xA3014314);
+		P(B, C, D, A, 13, 21, 0x4E0811A1);
+		P(A, B, C, D,  4,  6, 0xF7537E82);
+		P(D, A, B, C, 11, 10, 0xBD3AF235);
+		P(C, D, A, B,  2, 15, 0x2AD7D2BB);
+		P(B, C, D, A,  9, 21, 0xEB86D391);
 
 #undef F
 
-	ctx->state[0] += A;
-	ctx->state[1] += B;
-	ctx->state[2] += C;
-	ctx->state[3] += D;
+		A += AA;
+		B += BB;
+		C += CC;
+		D += DD;
+	}
+
+#undef P
+#undef S
+
+	state[0] = A;
+	state[1] = B;
+	state[2] = C;
+	state[3] = D;
 }
 
-void md5_update(md5_context *ctx, const uint8 *input, uint32 length) {
+MD5::MD5() {
+	reset();
+}
+
+void MD5::reset() {
+	_total[0] = 0;
+	_total[1] = 0;
+
+	_state[0] = 0x67452301;
+	_state[1] = 0xEFCDAB89;
+	_state[2] = 0x98BADCFE;
+	_state[3] = 0x10325476;
+}
+
+void MD5::update(const void *data, uint32 length) {
+	const uint8 *input = (const uint8 *)data;
 	uint32 left, fill;
 
 	if (!length)
 		return;
 
-	left = ctx->total[0] & 0x3F;
+	left = _total[0] & 0x3F;
 	fill = 64 - left;
 
-	ctx->total[0] += length;
-	ctx->total[0] &= 0xFFFFFFFF;
+	_total[0] += length;
+	_total[0] &= 0xFFFFFFFF;
 
-	if (ctx->total[0] < length)
-		ctx->total[1]++;
+	if (_total[0] < length)
+		_total[1]++;
 
 	if (left && length >= fill) {
-		memcpy((void *)(ctx->buffer + left), (const void *)input, fill);
-		md5_process(ctx, ctx->buffer);
+		memcpy((void *)(_buffer + left), (const void *)input, fill);
+		md5_process(_state, _buffer, 1);
 		length -= fill;
 		input  += fill;
 		left = 0;
 	}
 
-	while (length >= 64) {
-		md5_process(ctx, input);
-		length -= 64;
-		input  += 64;
+	// All whole blocks are hashed straight from the input
+	if (length >= 64) {
+		md5_process(_state, input, length / 64);
+		input  += length & ~0x3F;
+		length &= 0x3F;
 	}
 
 	if (length) {
-		memcpy((void *)(ctx->buffer + left), (const void *)input, length);
+		memcpy((void *)(_buffer + left), (const void *)input, length);
+	}
+}
+
+uint32 MD5::update(ReadStream &stream, uint32 length) {
+	// Read in large blocks, or everything at once when restricted to a
+	// small part, as each read may be a system call
+	const uint32 kMaxReadSize = 64 * 1024;
+	const uint32 bufSize = (length != 0 && length < kMaxReadSize) ? length : kMaxReadSize;
+	uint8 *buf = new uint8[bufSize];
+	uint32 hashed = 0;
+
+	while (length == 0 || hashed < length) {
+		const uint32 readlen = (length == 0) ? bufSize : MIN(bufSize, length - hashed);
+		const uint32 i = stream.read(buf, readlen);
+		if (i == 0)
+			break;
+
+		update(buf, i);
+		hashed += i;
+
+		// Some streams return less than asked for before their end, so
+		// only stop at the end or on an empty read
+		if (stream.eos())
+			break;
 	}
+
+	delete[] buf;
+	return hashed;
 }
 
 static const uint8 md5_padding[64] = {
@@ -220,76 +259,123 @@ static const uint8 md5_padding[64] = {
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
 };
 
-void md5_finish(md5_context *ctx, uint8 digest[16]) {
+void MD5::finish(uint8 digest[16]) {
 	uint32 last, padn;
 	uint32 high, low;
 	uint8 msglen[8];
 
-	high = (ctx->total[0] >> 29) | (ctx->total[1] << 3);
-	low  = (ctx->total[0] <<  3);
+	high = (_total[0] >> 29) | (_total[1] << 3);
+	low  = (_total[0] <<  3);
 
-	PUT_UINT32(low,  msglen, 0);
-	PUT_UINT32(high, msglen, 4);
+	WRITE_LE_UINT32(msglen, low);
+	WRITE_LE_UINT32(msglen + 4, high);
 
-	last = ctx->total[0] & 0x3F;
+	last = _total[0] & 0x3F;
 	padn = (last < 56) ? (56 - last) : (120 - last);
 
-	md5_update(ctx, md5_padding, padn);
-	md5_update(ctx, msglen, 8);
+	update(md5_padding, padn);
+	update(msglen, 8);
 
-	PUT_UINT32(ctx->state[0], digest,  0);
-	PUT_UINT32(ctx->state[1], digest,  4);
-	PUT_UINT32(ctx->state[2], digest,  8);
-	PUT_UINT32(ctx->state[3], digest, 12);
+	WRITE_LE_UINT32(digest,      _state[0]);
+	WRITE_LE_UINT32(digest +  4, _state[1]);
+	WRITE_LE_UINT32(digest +  8, _state[2]);
+	WRITE_LE_UINT32(digest + 12, _state[3]);
 }
 
+String md5DigestToString(const uint8 digest[16]) {
+	static const char hexDigits[] = "0123456789abcdef";
+	char md5[33];
 
-bool computeStreamMD5(ReadStream &stream, uint8 digest[16], uint32 length) {
-
-#ifdef DISABLE_MD5
-	memset(digest, 0, 16);
-#else
-	md5_context ctx;
-	int i;
-	unsigned char buf[1000];
-	bool restricted = (length != 0);
-	uint32 readlen;
-
-	if (!restricted || sizeof(buf) <= length)
-		readlen = sizeof(buf);
-	else
-		readlen = length;
+	for (int i = 0; i < 16; i++) {
+		md5[i * 2]     = hexDigits[digest[i] >> 4];
+		md5[i * 2 + 1] = hexDigits[digest[i] & 0x0F];
+	}
+	md5[32] = 0;
 
-	md5_starts(&ctx);
+	return String(md5);
+}
 
-	while ((i = stream.read(buf, readlen)) > 0) {
-		md5_update(&ctx, buf, i);
+String MD5::finishAsString() {
+	uint8 digest[16];
+	finish(digest);
+	return md5DigestToString(digest);
+}
 
-		if (restricted) {
-			length -= i;
-			if (length == 0)
-				break;
 
-			if (sizeof(buf) > length)
-				readlen = length;
-		}
-	}
+bool computeStreamMD5(ReadStream &stream, uint8 digest[16], uint32 length) {
 
-	md5_finish(&ctx, digest);
+#ifdef DISABLE_MD5
+	memset(digest, 0, 16);
+#else
+	MD5 md5;
+	md5.update(stream, length);
+	md5.finish(digest);
 #endif
 	return true;
 }
 
 String computeStreamMD5AsString(ReadStream &stream, uint32 length) {
-	String md5;
 	uint8 digest[16];
-	if (computeStreamMD5(stream, digest, length)) {
-		for (int i = 0; i < 16; i++) {
-			md5 += String::format("%02x", (int)digest[i]);
+	if (computeStreamMD5(stream, digest, length))
+		return md5DigestToString(digest);
+
+	return String();
+}
+
+bool computeStreamMD5HeadAndTail(SeekableReadStream &stream, uint8 headDigest[16], uint32 headLength, uint8 tailDigest[16], uint32 tailLength) {
+#ifdef DISABLE_MD5
+	memset(headDigest, 0, 16);
+	memset(tailDigest, 0, 16);
+	return true;
+#else
+	const int32 size = stream.size();
+	if (size < 0)
+		return false;
+
+	const uint32 headEnd = MIN<uint32>(headLength, size);
+	const uint32 tailStart = size - MIN<uint32>(tailLength, size);
+	MD5 head, tail;
+
+	if (!stream.seek(0))
+		return false;
+
+	if (tailStart > headEnd) {
+		// Apart: read the two parts only. A length of 0 would mean the
+		// whole stream to update().
+		if (headEnd > 0 && head.update(stream, headEnd) != headEnd)
+			return false;
+		if (tailStart < (uint32)size && (!stream.seek(tailStart) || tail.update(stream, size - tailStart) != size - tailStart))
+			return false;
+	} else {
+		// Overlapping or adjacent: read the whole stream once, and hash
+		// each block into the checksums it belongs to
+		const uint32 kBlockSize = 64 * 1024;
+		uint8 *buf = new uint8[MIN<uint32>(kBlockSize, MAX<uint32>(size, 1))];
+		uint32 pos = 0;
+
+		while (pos < (uint32)size) {
+			const uint32 length = MIN<uint32>(kBlockSize, size - pos);
+			if (stream.read(buf, length) != length)
+				break;
+
+			if (pos < headEnd)
+				head.update(buf, MIN(length, headEnd - pos));
+			if (pos + length > tailStart) {
+				const uint32 skip = (pos < tailStart) ? tailStart - pos : 0;
+				tail.update(buf + skip, length - skip);
+			}
+			pos += length;
 		}
+
+		delete[] buf;
+		if (pos != (uint32)size)
+			return false;
 	}
 
-	return md5;
+	head.finish(headDigest);
+	tail.finish(tailDigest);
+	return true;
+#endif
 }
 
 } // End of namespace Common
@@ -28,8 +28,49 @@
 namespace Common {
 
 class ReadStream;
+class SeekableReadStream;
 class String;
 
+/**
+ * Incremental MD5 computation, for data which is hashed piece by piece,
+ * e.g. as it arrives or from several parts of a file.
+ */
+class MD5 {
+public:
+	MD5();
+
+	/** Start over with a new checksum. */
+	void reset();
+
+	/** Add the given data to the checksum. */
+	void update(const void *data, uint32 length);
+
+	/**
+	 * Add data read from the given stream to the checksum.
+	 * @param[in] stream	the stream to read the data from
+	 * @param[in] length	the number of bytes to read; 0 means all until the end of the stream
+	 * @return the number of bytes which were read and hashed
+	 */
+	uint32 update(ReadStream &stream, uint32 length = 0);
+
+	/**
+	 * Finish the computation and return the 128 bit checksum in digest.
+	 * Afterwards, reset() needs to be called before hashing new data.
+	 */
+	void finish(uint8 digest[16]);
+
+	/**
+	 * Finish the computation and return the checksum as a lowercase hex
+	 * string of length 32.
+	 */
+	String finishAsString();
+
+private:
+	uint32 _total[2];
+	uint32 _state[4];
+	uint8 _buffer[64];
+};
+
 /**
  * Compute the MD5 checksum of the content of the given ReadStream.
  * The 128 bit MD5 checksum is returned directly in the array digest.
@@ -54,6 +95,25 @@ bool computeStreamMD5(ReadStream &stream, uint8 digest[16], uint32 length = 0);
  */
 String computeStreamMD5AsString(ReadStream &stream, uint32 length = 0);
 
+/**
+ * Converts a 128 bit MD5 checksum to a lowercase hex string of length 32,
+ * as returned by computeStreamMD5AsString().
+ */
+String md5DigestToString(const uint8 digest[16]);
+
+/**
+ * Compute the MD5 checksums of the beginning and of the end of the given
+ * stream in one pass. If the two parts overlap, the stream is read only
+ * once. Lengths larger than the stream are limited to its size.
+ * @param[in] stream		the stream of whose data the MD5s are computed
+ * @param[out] headDigest	the MD5 checksum of the first headLength bytes
+ * @param[in] headLength	the number of bytes at the beginning to compute the checksum for
+ * @param[out] tailDigest	the MD5 checksum of the last tailLength bytes
+ * @param[in] tailLength	the number of bytes at the end to compute the checksum for
+ * @return true on success, false if an error occurred
+ */
+bool computeStreamMD5HeadAndTail(SeekableReadStream &stream, uint8 headDigest[16], uint32 headLength, uint8 tailDigest[16], uint32 tailLength);
+
 } // End of namespace Common
 
 #endif
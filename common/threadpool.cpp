@@ -0,0 +1,358 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// pthread.h pulls in time.h
+#ifdef HAVE_THREADS
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_unistd_h
+#endif
+
+#include "common/threadpool.h"
+#include "common/queue.h"
+#include "common/textconsole.h"
+
+#ifdef HAVE_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+namespace Common {
+
+#ifdef HAVE_THREADS
+
+struct ThreadPool::State {
+	pthread_mutex_t mutex;
+	pthread_cond_t workCond;
+	pthread_cond_t doneCond;
+
+	pthread_t *threads;
+	uint threadCount;
+	bool quit;
+
+	// The loop being run, all protected by the mutex
+	JobProc proc;
+	void *param;
+	uint next;
+	uint count;
+	uint pending;
+
+	/**
+	 * Runs the jobs of the current loop until none is left. Called with the
+	 * mutex held, and returns with it held.
+	 */
+	void runJobs() {
+		while (next < count) {
+			const uint index = next++;
+			pthread_mutex_unlock(&mutex);
+			proc(param, index);
+			pthread_mutex_lock(&mutex);
+
+			if (--pending == 0)
+				pthread_cond_signal(&doneCond);
+		}
+	}
+
+	static void *workerProc(void *arg) {
+		State *state = (State *)arg;
+
+		pthread_mutex_lock(&state->mutex);
+		while (!state->quit) {
+			if (state->next < state->count)
+				state->runJobs();
+			else
+				pthread_cond_wait(&state->workCond, &state->mutex);
+		}
+		pthread_mutex_unlock(&state->mutex);
+
+		return 0;
+	}
+};
+
+ThreadPool::ThreadPool(uint threadCount) : _state(new State()) {
+	if (threadCount == 0)
+		threadCount = getCPUCount();
+
+	pthread_mutex_init(&_state->mutex, 0);
+	pthread_cond_init(&_state->workCond, 0);
+	pthread_cond_init(&_state->doneCond, 0);
+	_state->quit = false;
+	_state->proc = 0;
+	_state->param = 0;
+	_state->next = _state->count = _state->pending = 0;
+
+	// The calling thread is one of the threads
+	_state->threads = new pthread_t[threadCount];
+	_state->threadCount = 0;
+	for (uint i = 1; i < threadCount; ++i) {
+		if (pthread_create(&_state->threads[_state->threadCount], 0, State::workerProc, _state) != 0) {
+			warning("ThreadPool: pthread_create() failed, using %d threads", _state->threadCount + 1);
+			break;
+		}
+		++_state->threadCount;
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	pthread_mutex_lock(&_state->mutex);
+	_state->quit = true;
+	pthread_cond_broadcast(&_state->workCond);
+	pthread_mutex_unlock(&_state->mutex);
+
+	for (uint i = 0; i < _state->threadCount; ++i)
+		pthread_join(_state->threads[i], 0);
+
+	pthread_cond_destroy(&_state->doneCond);
+	pthread_cond_destroy(&_state->workCond);
+	pthread_mutex_destroy(&_state->mutex);
+	delete[] _state->threads;
+	delete _state;
+}
+
+uint ThreadPool::getThreadCount() const {
+	return _state->threadCount + 1;
+}
+
+void ThreadPool::parallelFor(uint count, JobProc proc, void *param) {
+	if (_state->threadCount == 0 || count <= 1) {
+		for (uint i = 0; i < count; ++i)
+			proc(param, i);
+		return;
+	}
+
+	pthread_mutex_lock(&_state->mutex);
+	_state->proc = proc;
+	_state->param = param;
+	_state->next = 0;
+	_state->count = count;
+	_state->pending = count;
+	pthread_cond_broadcast(&_state->workCond);
+
+	_state->runJobs();
+	while (_state->pending > 0)
+		pthread_cond_wait(&_state->doneCond, &_state->mutex);
+
+	_state->next = _state->count = 0;
+	pthread_mutex_unlock(&_state->mutex);
+}
+
+uint ThreadPool::getCPUCount() {
+#ifdef _SC_NPROCESSORS_ONLN
+	const long count = sysconf(_SC_NPROCESSORS_ONLN);
+	if (count > 1)
+		return (uint)count;
+#endif
+	return 1;
+}
+
+struct WorkerThread::State {
+	struct Job {
+		JobId id;
+		JobProc proc;
+		void *param;
+	};
+
+	pthread_mutex_t mutex;
+	pthread_cond_t workCond;
+	pthread_cond_t doneCond;
+
+	pthread_t thread;
+	bool threaded;
+	bool quit;
+
+	// All protected by the mutex
+	Queue<Job> queue;
+	JobId lastJob;
+	JobId doneJob;
+	bool running;
+
+	static void *workerProc(void *arg) {
+		State *state = (State *)arg;
+
+		pthread_mutex_lock(&state->mutex);
+		while (true) {
+			if (!state->queue.empty()) {
+				const Job job = state->queue.pop();
+				state->running = true;
+				pthread_mutex_unlock(&state->mutex);
+				job.proc(job.param);
+				pthread_mutex_lock(&state->mutex);
+				state->running = false;
+
+				// Jobs cancelled meanwhile are done as well
+				state->doneJob = state->queue.empty() ? state->lastJob : state->queue.front().id - 1;
+				pthread_cond_broadcast(&state->doneCond);
+			} else if (state->quit) {
+				break;
+			} else {
+				pthread_cond_wait(&state->workCond, &state->mutex);
+			}
+		}
+		pthread_mutex_unlock(&state->mutex);
+
+		return 0;
+	}
+};
+
+WorkerThread::WorkerThread() : _state(new State()) {
+	pthread_mutex_init(&_state->mutex, 0);
+	pthread_cond_init(&_state->workCond, 0);
+	pthread_cond_init(&_state->doneCond, 0);
+	_state->quit = false;
+	_state->lastJob = _state->doneJob = 0;
+	_state->running = false;
+
+	_state->threaded = pthread_create(&_state->thread, 0, State::workerProc, _state) == 0;
+	if (!_state->threaded)
+		warning("WorkerThread: pthread_create() failed, running the jobs directly");
+}
+
+WorkerThread::~WorkerThread() {
+	if (_state->threaded) {
+		pthread_mutex_lock(&_state->mutex);
+		_state->quit = true;
+		pthread_cond_signal(&_state->workCond);
+		pthread_mutex_unlock(&_state->mutex);
+
+		pthread_join(_state->thread, 0);
+	}
+
+	pthread_cond_destroy(&_state->doneCond);
+	pthread_cond_destroy(&_state->workCond);
+	pthread_mutex_destroy(&_state->mutex);
+	delete _state;
+}
+
+bool WorkerThread::isThreaded() const {
+	return _state->threaded;
+}
+
+WorkerThread::JobId WorkerThread::addJob(JobProc proc, void *param) {
+	pthread_mutex_lock(&_state->mutex);
+	State::Job job;
+	job.id = ++_state->lastJob;
+	job.proc = proc;
+	job.param = param;
+
+	if (!_state->threaded) {
+		pthread_mutex_unlock(&_state->mutex);
+		proc(param);
+		pthread_mutex_lock(&_state->mutex);
+		_state->doneJob = job.id;
+	} else {
+		_state->queue.push(job);
+		pthread_cond_signal(&_state->workCond);
+	}
+	pthread_mutex_unlock(&_state->mutex);
+
+	return job.id;
+}
+
+bool WorkerThread::isDone(JobId job) const {
+	pthread_mutex_lock(&_state->mutex);
+	const bool done = _state->doneJob >= job;
+	pthread_mutex_unlock(&_state->mutex);
+	return done;
+}
+
+void WorkerThread::wait(JobId job) {
+	pthread_mutex_lock(&_state->mutex);
+	while (_state->doneJob < job)
+		pthread_cond_wait(&_state->doneCond, &_state->mutex);
+	pthread_mutex_unlock(&_state->mutex);
+}
+
+void WorkerThread::waitAll() {
+	pthread_mutex_lock(&_state->mutex);
+	while (_state->doneJob < _state->lastJob)
+		pthread_cond_wait(&_state->doneCond, &_state->mutex);
+	pthread_mutex_unlock(&_state->mutex);
+}
+
+void WorkerThread::cancelPending() {
+	pthread_mutex_lock(&_state->mutex);
+	_state->queue.clear();
+	if (!_state->running)
+		_state->doneJob = _state->lastJob;
+	pthread_mutex_unlock(&_state->mutex);
+}
+
+#else
+
+struct ThreadPool::State {
+};
+
+ThreadPool::ThreadPool(uint threadCount) : _state(0) {
+}
+
+ThreadPool::~ThreadPool() {
+}
+
+uint ThreadPool::getThreadCount() const {
+	return 1;
+}
+
+void ThreadPool::parallelFor(uint count, JobProc proc, void *param) {
+	for (uint i = 0; i < count; ++i)
+		proc(param, i);
+}
+
+uint ThreadPool::getCPUCount() {
+	return 1;
+}
+
+struct WorkerThread::State {
+	JobId lastJob;
+};
+
+WorkerThread::WorkerThread() : _state(new State()) {
+	_state->lastJob = 0;
+}
+
+WorkerThread::~WorkerThread() {
+	delete _state;
+}
+
+bool WorkerThread::isThreaded() const {
+	return false;
+}
+
+WorkerThread::JobId WorkerThread::addJob(JobProc proc, void *param) {
+	proc(param);
+	return ++_state->lastJob;
+}
+
+bool WorkerThread::isDone(JobId job) const {
+	return true;
+}
+
+void WorkerThread::wait(JobId job) {
+}
+
+void WorkerThread::waitAll() {
+}
+
+void WorkerThread::cancelPending() {
+}
+
+#endif
+
+} // End of namespace Common
@@ -0,0 +1,160 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_THREADPOOL_H
+#define COMMON_THREADPOOL_H
+
+#include "common/scummsys.h"
+#include "common/noncopyable.h"
+
+namespace Common {
+
+/**
+ * A set of worker threads which run the iterations of a loop in parallel.
+ *
+ * Without thread support (HAVE_THREADS) there are no workers, and the loop
+ * is run on the calling thread instead, so users need no special case for
+ * that.
+ *
+ * The jobs run concurrently with each other and with the calling thread, so
+ * they must not touch objects which are not thread safe. This includes
+ * copying SharedPtrs (and thus FSNodes), whose reference counts are not
+ * atomic, and creating or copying Strings which do not fit their internal
+ * buffer, as their reference counts come from a shared pool without a lock.
+ */
+class ThreadPool : NonCopyable {
+public:
+	/**
+	 * A job, called once for each index of a loop.
+	 */
+	typedef void (*JobProc)(void *param, uint index);
+
+	/**
+	 * Creates the pool and starts its worker threads.
+	 *
+	 * @param threadCount	number of threads to run the jobs on, including
+	 *						the calling thread, or 0 for one per CPU
+	 */
+	explicit ThreadPool(uint threadCount = 0);
+	~ThreadPool();
+
+	/**
+	 * Returns the number of threads the jobs are run on, including the
+	 * calling thread. This is 1 without thread support.
+	 */
+	uint getThreadCount() const;
+
+	/**
+	 * Calls proc(param, index) for each index from 0 to count - 1, and
+	 * returns once all calls have returned. The calling thread takes part.
+	 *
+	 * The pool runs one loop at a time: this must not be called from more
+	 * than one thread at a time, nor from inside a job.
+	 */
+	void parallelFor(uint count, JobProc proc, void *param);
+
+	/**
+	 * Returns the number of CPUs available, or 1 when unknown.
+	 */
+	static uint getCPUCount();
+
+private:
+	struct State;
+	State *_state;
+};
+
+/**
+ * A thread which runs jobs in the background, one at a time and in the
+ * order they were added, while the caller goes on with its own work.
+ *
+ * Without thread support (HAVE_THREADS), or when the thread cannot be
+ * started, the jobs are run right away by addJob() instead. Users which
+ * only want the work done when it is overlapped with theirs can check
+ * isThreaded().
+ *
+ * The same rules as for ThreadPool jobs apply to sharing objects with the
+ * jobs.
+ */
+class WorkerThread : NonCopyable {
+public:
+	/**
+	 * A job, called once on the worker thread.
+	 */
+	typedef void (*JobProc)(void *param);
+
+	/**
+	 * Identifies an added job. Later jobs have higher ids.
+	 */
+	typedef uint32 JobId;
+
+	/**
+	 * Creates the worker and starts its thread.
+	 */
+	WorkerThread();
+
+	/**
+	 * Runs the jobs still queued, then stops the thread.
+	 */
+	~WorkerThread();
+
+	/**
+	 * Returns whether the jobs run on a thread of their own.
+	 */
+	bool isThreaded() const;
+
+	/**
+	 * Queues proc(param) to be run after the jobs added before it.
+	 *
+	 * @return the id of the job, to wait for it
+	 */
+	JobId addJob(JobProc proc, void *param);
+
+	/**
+	 * Returns whether the given job, and thus all jobs added before it,
+	 * has been run or cancelled.
+	 */
+	bool isDone(JobId job) const;
+
+	/**
+	 * Waits until the given job has been run or cancelled.
+	 */
+	void wait(JobId job);
+
+	/**
+	 * Waits until all jobs added so far have been run or cancelled.
+	 */
+	void waitAll();
+
+	/**
+	 * Drops the jobs which have not been started yet. A job which is
+	 * running is not interrupted: use wait() or waitAll() for it.
+	 */
+	void cancelPending();
+
+private:
+	struct State;
+	State *_state;
+};
+
+} // End of namespace Common
+
+#endif
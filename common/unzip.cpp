@@ -103,9 +103,13 @@ typedef struct {
 
 #endif  // !USE_ZLIB
 
+#include "common/bufferedstream.h"
 #include "common/fs.h"
 #include "common/unzip.h"
 #include "common/memstream.h"
+#include "common/mutex.h"
+#include "common/ptr.h"
+#include "common/zlib.h"
 
 #include "common/hashmap.h"
 #include "common/hash-str.h"
@@ -378,10 +382,24 @@ typedef struct {
 typedef Common::HashMap<Common::String, cached_file_in_zip, Common::IgnoreCase_Hash,
 	Common::IgnoreCase_EqualTo> ZipHash;
 
+/* ZipSharedStream owns the zipfile stream. It is shared by the archive and the
+   streams of its members, which read directly from it and may outlive the
+   archive. It has to be locked while it is in use.
+*/
+struct ZipSharedStream {
+	Common::ScopedPtr<Common::SeekableReadStream> _stream;
+	Common::Mutex _mutex;
+
+	ZipSharedStream(Common::SeekableReadStream *stream) : _stream(stream) {}
+};
+
 /* unz_s contain internal information about the zipfile
 */
 typedef struct {
+	Common::SharedPtr<ZipSharedStream> _shared;	/* owner of the zipfile stream */
 	Common::SeekableReadStream *_stream;				/* io structore of the zipfile */
+	uLong stream_offset;			/* position of the first byte of _stream in the zipfile,
+									non zero while parsing the central dir from memory */
 	unz_global_info gi;				/* public global information */
 	uLong byte_before_the_zipfile;	/* byte before the zipfile, (>0 for sfx)*/
 	uLong num_file;					/* number of the current file in the zipfile*/
@@ -543,7 +561,9 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 
 	int err=UNZ_OK;
 
+	us->_shared = Common::SharedPtr<ZipSharedStream>(new ZipSharedStream(stream));
 	us->_stream = stream;
+	us->stream_offset = 0;
 
 	central_pos = unzlocal_SearchCentralDir(*us->_stream);
 	if (central_pos==0)
@@ -595,7 +615,6 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 		err=UNZ_BADZIPFILE;
 
 	if (err != UNZ_OK) {
-		delete us->_stream;
 		delete us;
 		return NULL;
 	}
@@ -605,6 +624,19 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 	us->central_pos = central_pos;
 	us->pfile_in_zip_read = NULL;
 
+	// Parse the central directory from memory, reading it field by field from
+	// the zipfile stream is slow
+	byte *centralDir = (byte *)malloc(us->size_central_dir);
+	if (centralDir) {
+		us->_stream->seek(us->offset_central_dir + us->byte_before_the_zipfile, SEEK_SET);
+		if (us->_stream->read(centralDir, us->size_central_dir) == us->size_central_dir) {
+			us->_stream = new Common::MemoryReadStream(centralDir, us->size_central_dir, DisposeAfterUse::YES);
+			us->stream_offset = us->offset_central_dir + us->byte_before_the_zipfile;
+		} else {
+			free(centralDir);
+		}
+	}
+
 	err = unzGoToFirstFile((unzFile)us);
 
 	while (err == UNZ_OK) {
@@ -626,6 +658,12 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 		// Move to the next file
 		err = unzGoToNextFile((unzFile)us);
 	}
+
+	if (us->_stream != us->_shared->_stream.get()) {
+		delete us->_stream;
+		us->_stream = us->_shared->_stream.get();
+		us->stream_offset = 0;
+	}
 	return (unzFile)us;
 }
 
@@ -644,7 +682,6 @@ int unzClose(unzFile file) {
 	if (s->pfile_in_zip_read != NULL)
 		unzCloseCurrentFile(file);
 
-	delete s->_stream;
 	delete s;
 	return UNZ_OK;
 }
@@ -710,7 +747,7 @@ static int unzlocal_GetCurrentFileInfoInternal(unzFile file,
 	if (file==NULL)
 		return UNZ_PARAMERROR;
 	s=(unz_s*)file;
-	s->_stream->seek(s->pos_in_central_dir+s->byte_before_the_zipfile, SEEK_SET);
+	s->_stream->seek(s->pos_in_central_dir+s->byte_before_the_zipfile-s->stream_offset, SEEK_SET);
 	if (s->_stream->err())
 		err=UNZ_ERRNO;
 
@@ -1419,10 +1456,89 @@ int unzGetGlobalComment(unzFile file, char *szComment, uLong uSizeBuf) {
 
 namespace Common {
 
+/**
+ * Reads a member's data straight from the zipfile stream: the contents of
+ * a stored member, or the compressed data of a deflated one. The zipfile
+ * stream is shared with the archive and its other members, so every read
+ * locks it and seeks to the position first.
+ */
+class ZipMemberReadStream : public SeekableReadStream {
+	SharedPtr<ZipSharedStream> _shared;
+	uint32 _begin;
+	uint32 _size;
+	uint32 _pos;
+	bool _eos;
+	bool _err;
+
+public:
+	ZipMemberReadStream(const SharedPtr<ZipSharedStream> &shared, uint32 begin, uint32 size)
+		: _shared(shared), _begin(begin), _size(size), _pos(0), _eos(false), _err(false) {
+	}
+
+	virtual uint32 read(void *dataPtr, uint32 dataSize) {
+		if (dataSize > _size - _pos) {
+			dataSize = _size - _pos;
+			_eos = true;
+		}
+		if (!dataSize)
+			return 0;
+
+		StackLock lock(_shared->_mutex);
+		SeekableReadStream &stream = *_shared->_stream;
+		if (!stream.seek(_begin + _pos, SEEK_SET)) {
+			_err = true;
+			return 0;
+		}
+
+		const uint32 read = stream.read(dataPtr, dataSize);
+		if (read < dataSize)
+			_err = stream.err() || stream.eos();
+		_pos += read;
+		return read;
+	}
+
+	virtual bool eos() const { return _eos; }
+	virtual bool err() const { return _err; }
+	virtual void clearErr() { _eos = _err = false; }
+
+	virtual int32 pos() const { return _pos; }
+	virtual int32 size() const { return _size; }
+
+	virtual bool seek(int32 offset, int whence = SEEK_SET) {
+		switch (whence) {
+		case SEEK_END:
+			offset = _size + offset;
+			break;
+		case SEEK_CUR:
+			offset = _pos + offset;
+			break;
+		case SEEK_SET:
+		default:
+			break;
+		}
+
+		if (offset < 0 || (uint32)offset > _size)
+			return false;
+
+		_pos = offset;
+		_eos = false;
+		return true;
+	}
+};
 
 class ZipArchive : public Archive {
 	unzFile _zipFile;
 
+	enum {
+		// Deflated members up to this size are inflated at once and kept in
+		// memory, which makes seeking in them cheap
+		kMaxInflateInMemory = 256 * 1024,
+		// Stored members are read through a buffer of this size, so that
+		// small reads do not each lock and seek the zipfile stream.
+		// Deflated members are already read in big chunks by the inflater.
+		kStoredBufferSize = 16 * 1024
+	};
+
 public:
 	ZipArchive(unzFile zipFile);
 
@@ -1486,6 +1602,9 @@ const ArchiveMemberPtr ZipArchive::getMember(const String &name) const {
 }
 
 SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) const {
+	const unz_s *const archive = (const unz_s *)_zipFile;
+	StackLock lock(archive->_shared->_mutex);
+
 	if (unzLocateFile(_zipFile, name.c_str(), 2) != UNZ_OK)
 		return 0;
 
@@ -1496,6 +1615,23 @@ SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) co
 	if (unzGetCurrentFileInfo(_zipFile, &fileInfo, NULL, 0, NULL, 0, NULL, 0) != UNZ_OK)
 		return 0;
 
+	// Stored members are read from the zipfile when they are used. So are
+	// big deflated members, which are inflated as they are read.
+	const file_in_zip_read_info_s *member = archive->pfile_in_zip_read;
+	const uint32 begin = member->pos_in_zipfile + member->byte_before_the_zipfile;
+
+	if (fileInfo.compression_method == 0) {
+		unzCloseCurrentFile(_zipFile);
+		return wrapBufferedSeekableReadStream(new ZipMemberReadStream(archive->_shared, begin, fileInfo.uncompressed_size),
+		                                      kStoredBufferSize, DisposeAfterUse::YES);
+	}
+
+	if (fileInfo.uncompressed_size > kMaxInflateInMemory) {
+		unzCloseCurrentFile(_zipFile);
+		return wrapDeflateReadStream(new ZipMemberReadStream(archive->_shared, begin, fileInfo.compressed_size),
+		                             fileInfo.uncompressed_size, fileInfo.crc);
+	}
+
 	byte *buffer = (byte *)malloc(fileInfo.uncompressed_size);
 	assert(buffer);
 
@@ -1510,11 +1646,6 @@ SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) co
 	}
 
 	return new MemoryReadStream(buffer, fileInfo.uncompressed_size, DisposeAfterUse::YES);
-
-	// FIXME: instead of reading all into a memory stream, we could
-	// instead create a new ZipStream class. But then we have to be
-	// careful to handle the case where the client code opens multiple
-	// files in the archive and tries to use them independently.
 }
 
 Archive *makeZipArchive(const String &name) {
@@ -24,6 +24,7 @@
 #define FORBIDDEN_SYMBOL_ALLOW_ALL
 
 #include "common/zlib.h"
+#include "common/array.h"
 #include "common/ptr.h"
 #include "common/util.h"
 #include "common/stream.h"
@@ -145,15 +146,46 @@ bool inflateZlibInstallShield(byte *dst, uint dstLen, const byte *src, uint srcL
 static bool _shownBackwardSeekingWarning = false;
 #endif
 
+// inflateGetDictionary() is needed to build the seek index
+#if ZLIB_VERNUM >= 0x1271
+#define GZIP_SEEK_INDEX
+#endif
+
 /**
  * A simple wrapper class which can be used to wrap around an arbitrary
  * other SeekableReadStream and will then provide on-the-fly decompression support.
- * Assumes the compressed data to be in gzip format.
+ * Assumes the compressed data to be in gzip format, or raw deflate data if
+ * requested. Raw deflate data has no checksum of its own, so its CRC-32 is
+ * passed in and checked once the end of the data is reached.
+ *
+ * Once the stream has been seeked backwards, it records checkpoints while it
+ * decompresses: the position and the history window of zlib at the start of
+ * a deflate block, every few KiB of output. Later seeks then resume from the
+ * nearest checkpoint instead of decompressing from the start of the file.
  */
 class GZipReadStream : public SeekableReadStream {
 protected:
 	enum {
-		BUFSIZE = 16384		// 1 << MAX_WBITS
+		BUFSIZE = 16384,		// 1 << MAX_WBITS
+		WINSIZE = 32768,		// Size of the deflate history window
+
+		// Initial distance between checkpoints in the output
+		kCheckpointSpacing = 64 * 1024,
+		// Maximum number of checkpoints. When it is reached, every other
+		// checkpoint is dropped and the spacing doubled.
+		kMaxCheckpoints = 32
+	};
+
+	/**
+	 * State needed to resume decompression at the start of a deflate block.
+	 */
+	struct Checkpoint {
+		uint32 outPos;		// Position in the decompressed data
+		uint32 inPos;		// Position in the wrapped stream
+		int bits;			// Bits of the byte before inPos belonging to the block
+		uint32 crc;			// CRC-32 of the output before outPos, for raw deflate data
+		uint windowSize;
+		byte *window;		// The last WINSIZE bytes of output
 	};
 
 	byte	_buf[BUFSIZE];
@@ -164,16 +196,116 @@ protected:
 	uint32 _pos;
 	uint32 _origSize;
 	bool _eos;
+	int _windowBits;
+	bool _checkCrc;
+	uint32 _expectedCrc;
+	uint32 _crc;
+
+	Array<Checkpoint> _checkpoints;
+	bool _indexing;
+	uint32 _checkpointSpacing;
+
+	void addCheckpoint(uint32 outPos) {
+#ifdef GZIP_SEEK_INDEX
+		// Only at block boundaries, and not after the last block
+		if (!(_stream.data_type & 128) || (_stream.data_type & 64))
+			return;
+
+		const uint32 lastPos = _checkpoints.empty() ? 0 : _checkpoints.back().outPos;
+		if (outPos < lastPos + _checkpointSpacing)
+			return;
+
+		if (_checkpoints.size() >= kMaxCheckpoints) {
+			uint kept = 0;
+			for (uint i = 0; i < _checkpoints.size(); ++i) {
+				if (i & 1)
+					delete[] _checkpoints[i].window;
+				else
+					_checkpoints[kept++] = _checkpoints[i];
+			}
+			_checkpoints.resize(kept);
+			_checkpointSpacing *= 2;
+			return;
+		}
+
+		Checkpoint checkpoint;
+		checkpoint.outPos = outPos;
+		checkpoint.inPos = _wrapped->pos() - _stream.avail_in;
+		checkpoint.bits = _stream.data_type & 7;
+		checkpoint.crc = _crc;
+		checkpoint.window = new byte[WINSIZE];
+		checkpoint.windowSize = WINSIZE;
+		if (inflateGetDictionary(&_stream, checkpoint.window, &checkpoint.windowSize) != Z_OK) {
+			delete[] checkpoint.window;
+			return;
+		}
+		_checkpoints.push_back(checkpoint);
+#endif
+	}
+
+	/** Return the last checkpoint at or before pos, if any. */
+	const Checkpoint *findCheckpoint(uint32 pos) const {
+		const Checkpoint *checkpoint = 0;
+		for (uint i = 0; i < _checkpoints.size() && _checkpoints[i].outPos <= pos; ++i)
+			checkpoint = &_checkpoints[i];
+		return checkpoint;
+	}
+
+	/**
+	 * Restart decompression at the given checkpoint, or at the start of the
+	 * data if there is none.
+	 */
+	bool restart(const Checkpoint *checkpoint) {
+		_stream.next_in = _buf;
+		_stream.avail_in = 0;
+
+		if (!checkpoint) {
+			_pos = 0;
+			_crc = crc32(0, Z_NULL, 0);
+			_wrapped->seek(0, SEEK_SET);
+#ifdef GZIP_SEEK_INDEX
+			_zlibErr = inflateReset2(&_stream, _windowBits);
+#else
+			_zlibErr = inflateReset(&_stream);
+#endif
+			return _zlibErr == Z_OK;
+		}
+
+#ifdef GZIP_SEEK_INDEX
+		// Blocks are raw deflate data
+		_zlibErr = inflateReset2(&_stream, -MAX_WBITS);
+		if (_zlibErr != Z_OK)
+			return false;
+
+		_wrapped->seek(checkpoint->inPos - (checkpoint->bits ? 1 : 0), SEEK_SET);
+		if (checkpoint->bits) {
+			const byte partial = _wrapped->readByte();
+			_zlibErr = inflatePrime(&_stream, checkpoint->bits, partial >> (8 - checkpoint->bits));
+			if (_zlibErr != Z_OK)
+				return false;
+		}
+
+		_zlibErr = inflateSetDictionary(&_stream, checkpoint->window, checkpoint->windowSize);
+		if (_zlibErr != Z_OK)
+			return false;
+
+		_pos = checkpoint->outPos;
+		_crc = checkpoint->crc;
+#endif
+		return true;
+	}
 
 public:
 
-	GZipReadStream(SeekableReadStream *w, uint32 knownSize = 0) : _wrapped(w), _stream() {
+	GZipReadStream(SeekableReadStream *w, uint32 knownSize = 0, bool rawDeflate = false, uint32 rawDeflateCrc = 0) : _wrapped(w), _stream(),
+		_checkCrc(rawDeflate), _expectedCrc(rawDeflateCrc), _crc(crc32(0, Z_NULL, 0)),
+		_indexing(false), _checkpointSpacing(kCheckpointSpacing) {
 		assert(w != 0);
 
 		// Verify file header is correct
 		w->seek(0, SEEK_SET);
-		uint16 header = w->readUint16BE();
-		assert(header == 0x1F8B ||
+		uint16 header = rawDeflate ? 0 : w->readUint16BE();
+		assert(rawDeflate || header == 0x1F8B ||
 		       ((header & 0x0F00) == 0x0800 && header % 31 == 0));
 
 		if (header == 0x1F8B) {
@@ -194,7 +326,9 @@ public:
 		// the compressed file. This feature was added in zlib 1.2.0.4,
 		// released 10 August 2003.
 		// Note: This is *crucial* for savegame compatibility, do *not* remove!
-		_zlibErr = inflateInit2(&_stream, MAX_WBITS + 32);
+		// Negative windowBits select raw deflate data, without any header.
+		_windowBits = rawDeflate ? -MAX_WBITS : MAX_WBITS + 32;
+		_zlibErr = inflateInit2(&_stream, _windowBits);
 		if (_zlibErr != Z_OK)
 			return;
 
@@ -205,6 +339,9 @@ public:
 
 	~GZipReadStream() {
 		inflateEnd(&_stream);
+
+		for (uint i = 0; i < _checkpoints.size(); ++i)
+			delete[] _checkpoints[i].window;
 	}
 
 	bool err() const { return (_zlibErr != Z_OK) && (_zlibErr != Z_STREAM_END); }
@@ -224,7 +361,25 @@ public:
 				_stream.next_in = _buf;
 				_stream.avail_in = _wrapped->read(_buf, BUFSIZE);
 			}
-			_zlibErr = inflate(&_stream, Z_NO_FLUSH);
+
+			byte *out = _stream.next_out;
+			if (_indexing) {
+				// Stop at every block boundary, to check for a checkpoint
+				_zlibErr = inflate(&_stream, Z_BLOCK);
+				if (_checkCrc)
+					_crc = crc32(_crc, out, _stream.next_out - out);
+				if (_zlibErr == Z_OK)
+					addCheckpoint(_pos + dataSize - _stream.avail_out);
+			} else {
+				_zlibErr = inflate(&_stream, Z_NO_FLUSH);
+				if (_checkCrc)
+					_crc = crc32(_crc, out, _stream.next_out - out);
+			}
+
+			if (_zlibErr == Z_STREAM_END && _checkCrc && _crc != _expectedCrc) {
+				warning("GZipReadStream: CRC mismatch in deflate data");
+				_zlibErr = Z_DATA_ERROR;
+			}
 		}
 
 		// Update the position counter
@@ -263,9 +418,10 @@ public:
 		assert(newPos >= 0);
 
 		if ((uint32)newPos < _pos) {
-			// To search backward, we have to restart the whole decompression
-			// from the start of the file. A rather wasteful operation, best
-			// to avoid it. :/
+			// To search backward, we have to restart the decompression from
+			// the last checkpoint before the new position. Checkpoints are
+			// only recorded from now on, so the first time this means
+			// starting over from the start of the file.
 
 #ifndef RELEASE_BUILD
 			if (!_shownBackwardSeekingWarning) {
@@ -277,13 +433,17 @@ public:
 			}
 #endif
 
-			_pos = 0;
-			_wrapped->seek(0, SEEK_SET);
-			_zlibErr = inflateReset(&_stream);
-			if (_zlibErr != Z_OK)
+#ifdef GZIP_SEEK_INDEX
+			_indexing = true;
+#endif
+			if (!restart(findCheckpoint(newPos)))
+				return false;	// FIXME: STREAM REWRITE
+		} else {
+			// Seeking forward, skip ahead to a checkpoint if there is one
+			// between here and the new position
+			const Checkpoint *checkpoint = findCheckpoint(newPos);
+			if (checkpoint && checkpoint->outPos > _pos && !restart(checkpoint))
 				return false;	// FIXME: STREAM REWRITE
-			_stream.next_in = _buf;
-			_stream.avail_in = 0;
 		}
 
 		offset = newPos - _pos;
@@ -432,6 +592,17 @@ SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, ui
 	return toBeWrapped;
 }
 
+SeekableReadStream *wrapDeflateReadStream(SeekableReadStream *toBeWrapped, uint32 knownSize, uint32 crc) {
+	if (!toBeWrapped)
+		return 0;
+#if defined(USE_ZLIB)
+	return new GZipReadStream(toBeWrapped, knownSize, true, crc);
+#else
+	delete toBeWrapped;
+	return 0;
+#endif
+}
+
 WriteStream *wrapCompressedWriteStream(WriteStream *toBeWrapped) {
 #if defined(USE_ZLIB)
 	if (toBeWrapped)
@@ -120,6 +120,23 @@ bool inflateZlibInstallShield(byte *dst, uint dstLen, const byte *src, uint srcL
  */
 SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, uint32 knownSize = 0);
 
+/**
+ * Take an arbitrary SeekableReadStream containing raw deflate data, without
+ * zlib or gzip header, as found in ZIP archives, and wrap it in a custom
+ * stream which provides transparent on-the-fly decompression. When the end
+ * of the data is reached, the stream reports an error if the decompressed
+ * data does not match the given CRC-32. If there is no ZLIB support, NULL
+ * is returned and the stream is destroyed.
+ *
+ * It is safe to call this with a NULL parameter (in this case, NULL is
+ * returned).
+ *
+ * @param toBeWrapped	the stream to be wrapped
+ * @param knownSize		the length of the decompressed data
+ * @param crc			the CRC-32 of the decompressed data
+ */
+SeekableReadStream *wrapDeflateReadStream(SeekableReadStream *toBeWrapped, uint32 knownSize, uint32 crc);
+
 /**
  * Take an arbitrary WriteStream and wrap it in a custom stream which provides
  * transparent on-the-fly compression. The compressed data is written in the
@@ -26,8 +26,10 @@
 #include "common/macresman.h"
 #include "common/md5.h"
 #include "common/config-manager.h"
+#include "common/savefile.h"
 #include "common/system.h"
 #include "common/textconsole.h"
+#include "common/threadpool.h"
 #include "common/translation.h"
 #include "gui/EventRecorder.h"
 #include "engines/advancedDetector.h"
@@ -147,6 +149,198 @@ bool cleanupPirated(ADGameDescList &matched) {
 	return false;
 }
 
+namespace {
+
+/**
+ * Cache of the properties of the files read during detection. It is shared
+ * by all engines and kept across sessions in a file next to the saved games,
+ * so that each file is only read once. An entry is used as long as the size
+ * and the modification time of its file are unchanged.
+ */
+class ADDetectionCache {
+public:
+	ADDetectionCache() : _loaded(false), _dirty(false) {}
+
+	bool lookup(const Common::String &key, uint32 size, uint32 modificationTime, ADFileProperties &fileProps);
+	void store(const Common::String &key, uint32 size, uint32 modificationTime, const ADFileProperties &fileProps);
+	void save();
+
+private:
+	enum {
+		kMaxEntries = 65536
+	};
+
+	struct Entry {
+		uint32 size;
+		uint32 modificationTime;
+		ADFileProperties fileProps;
+		bool used;
+	};
+
+	typedef Common::HashMap<Common::String, Entry> EntryMap;
+
+	EntryMap _entries;
+	bool _loaded;
+	bool _dirty;
+
+	void load();
+};
+
+const char *const kDetectionCacheName = "detection.cache";
+const uint32 kDetectionCacheTag = MKTAG('A', 'D', 'C', '1');
+
+void ADDetectionCache::load() {
+	_loaded = true;
+
+	Common::InSaveFile *in = g_system->getSavefileManager()->openForLoading(kDetectionCacheName);
+	if (!in)
+		return;
+
+	if (in->readUint32BE() == kDetectionCacheTag) {
+		for (uint32 count = in->readUint32LE(); count > 0; --count) {
+			Common::String key;
+			Entry entry;
+
+			const uint16 keyLength = in->readUint16LE();
+			for (uint16 i = 0; i < keyLength; ++i)
+				key += (char)in->readByte();
+			entry.size = in->readUint32LE();
+			entry.modificationTime = in->readUint32LE();
+			entry.fileProps.size = in->readSint32LE();
+			const byte md5Length = in->readByte();
+			for (byte i = 0; i < md5Length; ++i)
+				entry.fileProps.md5 += (char)in->readByte();
+			entry.used = false;
+
+			if (in->err() || in->eos()) {
+				warning("ADDetectionCache: '%s' is truncated", kDetectionCacheName);
+				break;
+			}
+
+			_entries[key] = entry;
+		}
+	}
+
+	delete in;
+}
+
+bool ADDetectionCache::lookup(const Common::String &key, uint32 size, uint32 modificationTime, ADFileProperties &fileProps) {
+	if (!_loaded)
+		load();
+
+	EntryMap::iterator i = _entries.find(key);
+	if (i == _entries.end() || i->_value.size != size || i->_value.modificationTime != modificationTime)
+		return false;
+
+	i->_value.used = true;
+	fileProps = i->_value.fileProps;
+	return true;
+}
+
+void ADDetectionCache::store(const Common::String &key, uint32 size, uint32 modificationTime, const ADFileProperties &fileProps) {
+	if (!_loaded)
+		load();
+
+	Entry &entry = _entries[key];
+	entry.size = size;
+	entry.modificationTime = modificationTime;
+	entry.fileProps = fileProps;
+	entry.used = true;
+	_dirty = true;
+}
+
+void ADDetectionCache::save() {
+	if (!_dirty)
+		return;
+	_dirty = false;
+
+	// Forget the files which were not seen in this session when the cache
+	// grows too large
+	if (_entries.size() > kMaxEntries) {
+		for (EntryMap::iterator i = _entries.begin(); i != _entries.end(); ++i) {
+			if (!i->_value.used)
+				_entries.erase(i);
+		}
+	}
+
+	Common::OutSaveFile *out = g_system->getSavefileManager()->openForSaving(kDetectionCacheName, false);
+	if (!out) {
+		warning("ADDetectionCache: Could not save '%s'", kDetectionCacheName);
+		return;
+	}
+
+	out->writeUint32BE(kDetectionCacheTag);
+	out->writeUint32LE(_entries.size());
+	for (EntryMap::const_iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		out->writeUint16LE(i->_key.size());
+		out->write(i->_key.c_str(), i->_key.size());
+		out->writeUint32LE(i->_value.size);
+		out->writeUint32LE(i->_value.modificationTime);
+		out->writeSint32LE(i->_value.fileProps.size);
+		out->writeByte(i->_value.fileProps.md5.size());
+		out->write(i->_value.fileProps.md5.c_str(), i->_value.fileProps.md5.size());
+	}
+
+	out->finalize();
+	if (out->err())
+		warning("ADDetectionCache: Could not save '%s'", kDetectionCacheName);
+	delete out;
+}
+
+ADDetectionCache &getDetectionCache() {
+	static ADDetectionCache cache;
+	return cache;
+}
+
+/**
+ * A file whose properties are computed on a worker thread. The stream is
+ * opened by the calling thread, and the worker only writes plain data:
+ * creating Strings or copying FSNodes is not thread safe.
+ */
+struct ADFileJob {
+	ADFileJob() : size(0), modificationTime(0), md5Bytes(0), stream(0), fileSize(0), hashed(false) {}
+
+	Common::String fname;
+	Common::String cacheKey;
+	uint32 size;
+	uint32 modificationTime;
+	uint md5Bytes;
+	Common::SeekableReadStream *stream;
+
+	// Written by the worker thread
+	int32 fileSize;
+	uint8 md5[16];
+	bool hashed;
+};
+
+void computeFileProperties(void *param, uint index) {
+	ADFileJob &job = (*(Common::Array<ADFileJob> *)param)[index];
+
+	job.fileSize = (int32)job.stream->size();
+	job.hashed = Common::computeStreamMD5(*job.stream, job.md5, job.md5Bytes);
+}
+
+/**
+ * Looks a file up in the detection cache. On a miss, returns the key and
+ * the file stats to store its properties with, or an empty key if they
+ * cannot be cached.
+ */
+bool lookupFileProperties(const Common::FSNode &node, uint md5Bytes, Common::String &cacheKey, uint32 &size, uint32 &modificationTime, ADFileProperties &fileProps) {
+	if (!node.getFileStats(size, modificationTime)) {
+		cacheKey.clear();
+		return false;
+	}
+
+	cacheKey = Common::String::format("%s:%u", node.getPath().c_str(), md5Bytes);
+	return getDetectionCache().lookup(cacheKey, size, modificationTime, fileProps);
+}
+
+} // End of anonymous namespace
+
+void AdvancedMetaEngine::saveDetectionCache() const {
+	getDetectionCache().save();
+}
+
 
 GameList AdvancedMetaEngine::detectGames(const Common::FSList &fslist) const {
 	ADGameDescList matches;
@@ -403,13 +597,23 @@ bool AdvancedMetaEngine::getFileProperties(const Common::FSNode &parent, const F
 	if (!allFiles.contains(fname))
 		return false;
 
+	const Common::FSNode &node = allFiles[fname];
+	Common::String cacheKey;
+	uint32 size, modificationTime;
+
+	if (lookupFileProperties(node, _md5Bytes, cacheKey, size, modificationTime, fileProps))
+		return true;
+
 	Common::File testFile;
 
-	if (!testFile.open(allFiles[fname]))
+	if (!testFile.open(node))
 		return false;
 
 	fileProps.size = (int32)testFile.size();
 	fileProps.md5 = Common::computeStreamMD5AsString(testFile, _md5Bytes);
+
+	if (!cacheKey.empty())
+		getDetectionCache().store(cacheKey, size, modificationTime, fileProps);
 	return true;
 }
 
@@ -423,7 +627,11 @@ ADGameDescList AdvancedMetaEngine::detectGame(const Common::FSNode &parent, cons
 	debug(3, "Starting detection in dir '%s'", parent.getPath().c_str());
 
 	// Check which files are included in some ADGameDescription *and* are present.
-	// Compute MD5s and file sizes for these files.
+	// Compute MD5s and file sizes for these files. Those which are not in the
+	// detection cache are read afterwards, in parallel.
+	Common::Array<ADFileJob> jobs;
+	FileMap queuedFiles;
+
 	for (descPtr = _gameDescriptors; ((const ADGameDescription *)descPtr)->gameId != 0; descPtr += _descItemSize) {
 		g = (const ADGameDescription *)descPtr;
 
@@ -431,9 +639,31 @@ ADGameDescList AdvancedMetaEngine::detectGame(const Common::FSNode &parent, cons
 			Common::String fname = fileDesc->fileName;
 			ADFileProperties tmp;
 
-			if (filesProps.contains(fname))
+			if (filesProps.contains(fname) || queuedFiles.contains(fname))
 				continue;
 
+			if (!(g->flags & ADGF_MACRESFORK) && allFiles.contains(fname)) {
+				const Common::FSNode &node = allFiles[fname];
+				ADFileJob job;
+
+				if (lookupFileProperties(node, _md5Bytes, job.cacheKey, job.size, job.modificationTime, tmp)) {
+					debug(3, "> '%s': '%s' (cached)", fname.c_str(), tmp.md5.c_str());
+					filesProps[fname] = tmp;
+				} else if (job.cacheKey.empty() && (!node.exists() || node.isDirectory())) {
+					// Not a readable file
+					continue;
+				} else {
+					job.stream = node.createReadStream();
+					if (!job.stream)
+						continue;
+					job.fname = fname;
+					job.md5Bytes = _md5Bytes;
+					jobs.push_back(job);
+					queuedFiles[fname] = node;
+				}
+				continue;
+			}
+
 			if (getFileProperties(parent, allFiles, *g, fname, tmp)) {
 				debug(3, "> '%s': '%s'", fname.c_str(), tmp.md5.c_str());
 				filesProps[fname] = tmp;
@@ -441,6 +671,33 @@ ADGameDescList AdvancedMetaEngine::detectGame(const Common::FSNode &parent, cons
 		}
 	}
 
+	if (!jobs.empty()) {
+		const uint32 startTime = g_system->getMillis();
+
+		if (jobs.size() > 1) {
+			Common::ThreadPool pool(MIN<uint>(jobs.size(), kMaxDetectionThreads));
+			pool.parallelFor(jobs.size(), computeFileProperties, &jobs);
+		} else {
+			computeFileProperties(&jobs, 0);
+		}
+
+		for (uint j = 0; j < jobs.size(); ++j) {
+			const ADFileJob &job = jobs[j];
+			delete job.stream;
+			if (!job.hashed)
+				continue;
+
+			ADFileProperties &fileProps = filesProps[job.fname];
+			fileProps.size = job.fileSize;
+			fileProps.md5 = Common::md5DigestToString(job.md5);
+			debug(3, "> '%s': '%s'", job.fname.c_str(), fileProps.md5.c_str());
+			if (!job.cacheKey.empty())
+				getDetectionCache().store(job.cacheKey, job.size, job.modificationTime, fileProps);
+		}
+
+		debug(2, "Read %d files for detection in %d ms", jobs.size(), g_system->getMillis() - startTime);
+	}
+
 	ADGameDescList matched;
 	int maxFilesMatched = 0;
 	bool gotAnyMatchesWithAllFiles = false;
@@ -268,12 +268,28 @@ public:
 
 	virtual const ExtraGuiOptions getExtraGuiOptions(const Common::String &target) const;
 
+	/**
+	 * Writes the properties of the files read during detection to disk, if
+	 * there are new ones, so they need not be read again next time. The
+	 * cache is shared by all engines using the AdvancedDetector.
+	 */
+	virtual void saveDetectionCache() const;
+
 protected:
 	// To be implemented by subclasses
 	virtual bool createInstance(OSystem *syst, Engine **engine, const ADGameDescription *desc) const = 0;
 
 	typedef Common::HashMap<Common::String, Common::FSNode, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> FileMap;
 
+	/**
+	 * The maximum number of threads reading files in parallel during
+	 * detection. Reading is mostly bound by the storage latency, so this
+	 * does not depend on the number of CPUs.
+	 */
+	enum {
+		kMaxDetectionThreads = 8
+	};
+
 	/**
 	 * An (optional) generic fallback detect function which is invoked
 	 * if the regular MD5 based detection failed to detect anything.
@@ -82,6 +82,8 @@ public:
 
 protected:
 	void readSoundData(Common::SeekableReadStream *stream);
+	// processFrame() reads the video track directly
+	bool canDecodeAhead() const { return false; }
 
 private:
 	void handleNextFrame();
@@ -100,6 +100,7 @@ void MusicPlayer::playSMF(int track, bool loop) {
 		_parser = parser;
 
 		syncVolume();
+		beginRenderCache(_midiData, midiMusicSize);
 
 		_isLooping = loop;
 		_isPlaying = true;
@@ -653,6 +653,16 @@ bool Engine::canSaveGameStateCurrently() {
 	return false;
 }
 
+Common::Error Engine::saveGameStream(Common::WriteStream *stream) {
+	// Not supported by default
+	return Common::kUnknownError;
+}
+
+Common::Error Engine::loadGameStream(Common::SeekableReadStream *stream) {
+	// Not supported by default
+	return Common::kUnknownError;
+}
+
 void Engine::quitGame() {
 	Common::Event event;
 
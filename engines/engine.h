@@ -39,7 +39,9 @@ namespace Common {
 class Error;
 class EventManager;
 class SaveFileManager;
+class SeekableReadStream;
 class TimerManager;
+class WriteStream;
 class FSNode;
 }
 namespace GUI {
@@ -245,6 +247,23 @@ public:
 	 */
 	virtual bool canSaveGameStateCurrently();
 
+	/**
+	 * Save a game state into a stream instead of a savefile slot. This is
+	 * used by backends which keep state snapshots in memory.
+	 * @param stream	the stream into which the savestate should be written
+	 * @return returns kNoError on success, else an error code.
+	 */
+	virtual Common::Error saveGameStream(Common::WriteStream *stream);
+
+	/**
+	 * Load a game state written by saveGameStream(). Engines which can only
+	 * restore at specific points of their main loop copy the data and apply
+	 * it there, so the stream may be deleted once this returns.
+	 * @param stream	the stream from which the savestate should be loaded
+	 * @return returns kNoError on success, else an error code.
+	 */
+	virtual Common::Error loadGameStream(Common::SeekableReadStream *stream);
+
 protected:
 
 	/**
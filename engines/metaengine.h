@@ -81,6 +81,12 @@ public:
 	 */
 	virtual GameList detectGames(const Common::FSList &fslist) const = 0;
 
+	/**
+	 * Writes what the detector cached during detectGames() to disk. This is
+	 * called by EngineManager::detectGames() after all engines were run.
+	 */
+	virtual void saveDetectionCache() const {}
+
 	/**
 	 * Tries to instantiate an engine instance based on the settings of
 	 * the currently active ConfMan target. That is, the MetaEngine should
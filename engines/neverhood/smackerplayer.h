@@ -51,6 +51,10 @@ public:
 class NeverhoodSmackerDecoder : public Video::SmackerDecoder {
 public:
 	void forceSeekToFrame(uint frame);
+
+protected:
+	// forceSeekToFrame() decodes frames directly
+	bool canDecodeAhead() const { return false; }
 };
 
 class SmackerPlayer : public Entity {
@@ -110,6 +110,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("resource_id",		WRAP_METHOD(Console, cmdResourceId));
 	registerCmd("resource_info",		WRAP_METHOD(Console, cmdResourceInfo));
 	registerCmd("resource_types",		WRAP_METHOD(Console, cmdResourceTypes));
+	registerCmd("resource_cache",		WRAP_METHOD(Console, cmdResourceCache));
 	registerCmd("list",				WRAP_METHOD(Console, cmdList));
 	registerCmd("hexgrep",			WRAP_METHOD(Console, cmdHexgrep));
 	registerCmd("verify_scripts",		WRAP_METHOD(Console, cmdVerifyScripts));
@@ -358,6 +359,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" resource_id - Identifies a resource number by splitting it up in resource type and resource number\n");
 	debugPrintf(" resource_info - Shows info about a resource\n");
 	debugPrintf(" resource_types - Shows the valid resource types\n");
+	debugPrintf(" resource_cache - Shows the memory use and statistics of the resource cache\n");
 	debugPrintf(" list - Lists all the resources of a given type\n");
 	debugPrintf(" hexgrep - Searches some resources for a particular sequence of bytes, represented as hexadecimal numbers\n");
 	debugPrintf(" verify_scripts - Performs sanity checks on SCI1.1-SCI2.1 game scripts (e.g. if they're up to 64KB in total)\n");
@@ -967,6 +969,36 @@ bool Console::cmdResourceTypes(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdResourceCache(int argc, const char **argv) {
+	if (argc > 2 || (argc == 2 && strcmp(argv[1], "reset"))) {
+		debugPrintf("Shows the memory use of the resource cache, and its hits, misses,\n");
+		debugPrintf("evictions and prefetches per resource type.\n");
+		debugPrintf("Usage: %s [reset]\n", argv[0]);
+		debugPrintf("With \"reset\", the statistics are cleared.\n");
+		return true;
+	}
+
+	if (argc == 2) {
+		_engine->getResMan()->resetCacheStats();
+		debugPrintf("Resource cache statistics cleared\n");
+		return true;
+	}
+
+	const ResourceManager *resMan = _engine->getResMan();
+	debugPrintf("Cached: %d of %d KiB, locked: %d KiB\n", resMan->getMemoryLRU() / 1024,
+				resMan->getMaxMemoryLRU() / 1024, resMan->getMemoryLocked() / 1024);
+	debugPrintf("%-12s %8s %8s %8s %8s\n", "Type", "Hits", "Misses", "Evicted", "Prefetch");
+
+	for (int i = 0; i < kResourceTypeInvalid; i++) {
+		const ResourceCacheStats &stats = resMan->getCacheStats((ResourceType)i);
+		if (stats.hits || stats.misses || stats.evictions || stats.prefetches)
+			debugPrintf("%-12s %8d %8d %8d %8d\n", getResourceTypeName((ResourceType)i),
+						stats.hits, stats.misses, stats.evictions, stats.prefetches);
+	}
+
+	return true;
+}
+
 bool Console::cmdHexgrep(int argc, const char **argv) {
 	if (argc < 4) {
 		debugPrintf("Searches some resources for a particular sequence of bytes, represented as decimal or hexadecimal numbers.\n");
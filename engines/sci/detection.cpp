@@ -884,6 +884,21 @@ Common::Error SciEngine::saveGameState(int slot, const Common::String &desc) {
 	return Common::kNoError;
 }
 
+Common::Error SciEngine::saveGameStream(Common::WriteStream *stream) {
+	// Snapshots are taken often, so no thumbnail is stored (restoring skips it if present)
+	if (!gamestate_save(_gamestate, stream, "", "", false) || stream->err())
+		return Common::kWritingFailed;
+	return Common::kNoError;
+}
+
+Common::Error SciEngine::loadGameStream(Common::SeekableReadStream *stream) {
+	// Applied by gamestate_delayedrestore() like loadGameState(), so keep a copy
+	delete _gamestate->_delayedRestoreStream;
+	_gamestate->_delayedRestoreStream = stream->readStream(stream->size() - stream->pos());
+	_gamestate->_delayedRestoreGame = true;
+	return Common::kNoError;
+}
+
 bool SciEngine::canLoadGameStateCurrently() {
 	return !_gamestate->executionStackBase;
 }
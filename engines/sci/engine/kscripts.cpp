@@ -206,6 +206,11 @@ reg_t kScriptID(EngineState *s, int argc, reg_t *argv) {
 	if (argv[0].getSegment())
 		return argv[0];
 
+	// Games load the script of a new room here, after setting the room
+	// number, which is the time to load the rest of the room too
+	if (script == s->currentRoomNumber() && !s->_segMan->getScriptSegment(script))
+		g_sci->getResMan()->prefetchRoomResources(script);
+
 	SegmentId scriptSeg = s->_segMan->getScriptSegment(script, SCRIPT_GET_LOAD);
 
 	if (!scriptSeg)
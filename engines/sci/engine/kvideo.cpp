@@ -80,17 +80,26 @@ void playVideo(Video::VideoDecoder *videoDecoder, VideoState videoState) {
 
 	while (!g_engine->shouldQuit() && !videoDecoder->endOfVideo() && !skipVideo) {
 		if (videoDecoder->needsUpdate()) {
-			const Graphics::Surface *frame = videoDecoder->decodeNextFrame();
+			bool frameDecoded;
 
-			if (frame) {
-				if (scaleBuffer) {
+			if (scaleBuffer) {
+				const Graphics::Surface *frame = videoDecoder->decodeNextFrame();
+				frameDecoded = (frame != 0);
+
+				if (frame) {
 					// TODO: Probably should do aspect ratio correction in KQ6
 					g_sci->_gfxScreen->scale2x((const byte *)frame->getPixels(), scaleBuffer, videoDecoder->getWidth(), videoDecoder->getHeight(), bytesPerPixel);
 					g_system->copyRectToScreen(scaleBuffer, pitch, x, y, width, height);
-				} else {
-					g_system->copyRectToScreen(frame->getPixels(), frame->pitch, x, y, width, height);
 				}
+			} else {
+				// Decode straight into the screen
+				Graphics::Surface *screen = g_system->lockScreen();
+				Graphics::Surface area = screen->getSubArea(Common::Rect(x, y, x + width, y + height));
+				frameDecoded = videoDecoder->decodeNextFrameInto(area);
+				g_system->unlockScreen();
+			}
 
+			if (frameDecoded) {
 				if (videoDecoder->hasDirtyPalette()) {
 					const byte *palette = videoDecoder->getPalette();
 					g_system->getPaletteManager()->setPalette(palette, 0, 255);
@@ -1028,7 +1028,7 @@ void SegManager::reconstructClones() {
 #pragma mark -
 
 
-bool gamestate_save(EngineState *s, Common::WriteStream *fh, const Common::String &savename, const Common::String &version) {
+bool gamestate_save(EngineState *s, Common::WriteStream *fh, const Common::String &savename, const Common::String &version, bool writeThumbnail) {
 	TimeDate curTime;
 	g_system->getTimeAndDate(curTime);
 
@@ -1051,7 +1051,8 @@ bool gamestate_save(EngineState *s, Common::WriteStream *fh, const Common::Strin
 
 	Common::Serializer ser(0, fh);
 	sync_SavegameMetadata(ser, meta);
-	Graphics::saveThumbnail(*fh);
+	if (writeThumbnail)
+		Graphics::saveThumbnail(*fh);
 	s->saveLoadWithSerializer(ser);		// FIXME: Error handling?
 	if (g_sci->_gfxPorts)
 		g_sci->_gfxPorts->saveLoadWithSerializer(ser);
@@ -1068,6 +1069,20 @@ extern void showScummVMDialog(const Common::String &message);
 
 void gamestate_delayedrestore(EngineState *s) {
 	int savegameId = s->_delayedRestoreGameId; // delayedRestoreGameId gets destroyed within gamestate_restore()!
+
+	if (s->_delayedRestoreStream) {
+		// in-memory state from SciEngine::loadGameStream()
+		Common::SeekableReadStream *in = s->_delayedRestoreStream;
+		s->_delayedRestoreStream = 0;
+		gamestate_restore(s, in);
+		delete in;
+		if (s->r_acc != make_reg(0, 1))
+			gamestate_afterRestoreFixUp(s, -1);
+		else
+			warning("Restoring in-memory gamestate failed");
+		return;
+	}
+
 	Common::String fileName = g_sci->getSavegameName(savegameId);
 	Common::SeekableReadStream *in = g_sci->getSaveFileManager()->openForLoading(fileName);
 
@@ -1093,14 +1108,16 @@ void gamestate_afterRestoreFixUp(EngineState *s, int savegameId) {
 		//  We can't trust that global, that's why we set the actual savedgame id right here directly after
 		//   restoring a saved game.
 		//  If we didn't, the game would always save to a new slot
-		s->variables[VAR_GLOBAL][0xC5].setOffset(SAVEGAMEID_OFFICIALRANGE_START + savegameId);
+		if (savegameId >= 0)
+			s->variables[VAR_GLOBAL][0xC5].setOffset(SAVEGAMEID_OFFICIALRANGE_START + savegameId);
 		break;
 	case GID_MOTHERGOOSE256:
 		// WORKAROUND: Mother Goose SCI1/SCI1.1 does some weird things for
 		//  saving a previously restored game.
 		// We set the current savedgame-id directly and remove the script
 		//  code concerning this via script patch.
-		s->variables[VAR_GLOBAL][0xB3].setOffset(SAVEGAMEID_OFFICIALRANGE_START + savegameId);
+		if (savegameId >= 0)
+			s->variables[VAR_GLOBAL][0xB3].setOffset(SAVEGAMEID_OFFICIALRANGE_START + savegameId);
 		break;
 	case GID_JONES:
 		// HACK: The code that enables certain menu items isn't called when a game is restored from the
@@ -86,12 +86,13 @@ struct SavegameMetadata {
  * @param savename	The description of the savegame
  * @return 0 on success, 1 otherwise
  */
-bool gamestate_save(EngineState *s, Common::WriteStream *save, const Common::String &savename, const Common::String &version);
+bool gamestate_save(EngineState *s, Common::WriteStream *save, const Common::String &savename, const Common::String &version, bool writeThumbnail = true);
 
 // does a delayed saved game restore, used by ScummVM game menu - see detection.cpp / SciEngine::loadGameState()
 void gamestate_delayedrestore(EngineState *s);
 
-// does a few fixups right after restoring a saved game
+// does a few fixups right after restoring a saved game, savegameId is -1 for
+// in-memory states, which keep the ids of the game they were taken from
 void gamestate_afterRestoreFixUp(EngineState *s, int savegameId);
 
 /**
@@ -20,6 +20,7 @@
  *
  */
 
+#include "common/stream.h"
 #include "common/system.h"
 
 #include "sci/sci.h"	// for INCLUDE_OLDGFX
@@ -70,13 +71,15 @@ static const uint16 s_halfWidthSJISMap[256] = {
 
 EngineState::EngineState(SegManager *segMan)
 : _segMan(segMan),
-	_dirseeker() {
+	_dirseeker(),
+	_delayedRestoreStream(0) {
 
 	reset(false);
 }
 
 EngineState::~EngineState() {
 	delete _msgState;
+	delete _delayedRestoreStream;
 }
 
 void EngineState::reset(bool isRestoring) {
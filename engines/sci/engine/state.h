@@ -135,6 +135,7 @@ public:
 	bool _delayedRestoreGame;  // boolean, that triggers delayed restore (triggered by ScummVM menu)
 	int _delayedRestoreGameId; // the saved game id, that it supposed to get restored (triggered by ScummVM menu)
 	bool _delayedRestoreFromLauncher; // is set, when the the delayed restore game was triggered from launcher
+	Common::SeekableReadStream *_delayedRestoreStream; // restored instead of _delayedRestoreGameId, see SciEngine::loadGameStream()
 
 	uint _chosenQfGImportItem; // Remembers the item selected in QfG import rooms
 
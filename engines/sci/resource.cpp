@@ -22,6 +22,7 @@
 
 // Resource library
 
+#include "common/config-manager.h"
 #include "common/file.h"
 #include "common/fs.h"
 #include "common/macresman.h"
@@ -201,6 +202,8 @@ Resource::Resource(ResourceManager *resMan, ResourceId id) : _resMan(resMan), _i
 	_source = NULL;
 	_header = NULL;
 	_headerSize = 0;
+	_lruPrev = NULL;
+	_lruNext = NULL;
 }
 
 Resource::~Resource() {
@@ -890,7 +893,10 @@ void ResourceManager::init() {
 	_maxMemoryLRU = 256 * 1024; // 256KiB
 	_memoryLocked = 0;
 	_memoryLRU = 0;
-	_LRU.clear();
+	_lruFirst = NULL;
+	_lruLast = NULL;
+	resetCacheStats();
+	_prefetchRooms = false;
 	_resMap.clear();
 	_audioMapSCI1 = NULL;
 #ifdef ENABLE_SCI32
@@ -951,6 +957,14 @@ void ResourceManager::init() {
 		_maxMemoryLRU = 2048 * 1024; // 2MiB
 	}
 
+	// The budget can be raised (or lowered) by the user, in KiB
+	if (ConfMan.hasKey("sci_resource_cache_size") && ConfMan.getInt("sci_resource_cache_size") > 0) {
+		_maxMemoryLRU = ConfMan.getInt("sci_resource_cache_size") * 1024;
+		debugC(1, kDebugLevelResMan, "resMan: Resource cache budget set to %d KiB", _maxMemoryLRU / 1024);
+	}
+
+	_prefetchRooms = ConfMan.hasKey("sci_prefetch_resources") && ConfMan.getBool("sci_prefetch_resources");
+
 	switch (_viewType) {
 	case kViewEga:
 		debugC(1, kDebugLevelResMan, "resMan: Detected EGA graphic resources");
@@ -997,7 +1011,16 @@ void ResourceManager::removeFromLRU(Resource *res) {
 		warning("resMan: trying to remove resource that isn't enqueued");
 		return;
 	}
-	_LRU.remove(res);
+	if (res->_lruPrev)
+		res->_lruPrev->_lruNext = res->_lruNext;
+	else
+		_lruFirst = res->_lruNext;
+	if (res->_lruNext)
+		res->_lruNext->_lruPrev = res->_lruPrev;
+	else
+		_lruLast = res->_lruPrev;
+	res->_lruPrev = res->_lruNext = NULL;
+
 	_memoryLRU -= res->size;
 	res->_status = kResStatusAllocated;
 }
@@ -1007,7 +1030,14 @@ void ResourceManager::addToLRU(Resource *res) {
 		warning("resMan: trying to enqueue resource with state %d", res->_status);
 		return;
 	}
-	_LRU.push_front(res);
+	res->_lruPrev = NULL;
+	res->_lruNext = _lruFirst;
+	if (_lruFirst)
+		_lruFirst->_lruPrev = res;
+	else
+		_lruLast = res;
+	_lruFirst = res;
+
 	_memoryLRU += res->size;
 #if SCI_VERBOSE_RESMAN
 	debug("Adding %s (%d bytes) to lru control: %d bytes total",
@@ -1020,15 +1050,11 @@ void ResourceManager::addToLRU(Resource *res) {
 void ResourceManager::printLRU() {
 	int mem = 0;
 	int entries = 0;
-	Common::List<Resource *>::iterator it = _LRU.begin();
-	Resource *res;
 
-	while (it != _LRU.end()) {
-		res = *it;
+	for (Resource *res = _lruFirst; res; res = res->_lruNext) {
 		debug("\t%s: %d bytes", res->_id.toString().c_str(), res->size);
 		mem += res->size;
 		++entries;
-		++it;
 	}
 
 	debug("Total: %d entries, %d bytes (mgr says %d)", entries, mem, _memoryLRU);
@@ -1036,10 +1062,11 @@ void ResourceManager::printLRU() {
 
 void ResourceManager::freeOldResources() {
 	while (_maxMemoryLRU < _memoryLRU) {
-		assert(!_LRU.empty());
-		Resource *goner = *_LRU.reverse_begin();
+		assert(_lruLast);
+		Resource *goner = _lruLast;
 		removeFromLRU(goner);
 		goner->unalloc();
+		_cacheStats[goner->getType()].evictions++;
 #ifdef SCI_VERBOSE_RESMAN
 		debug("resMan-debug: LRU: Freeing %s (%d bytes)", goner->_id.toString().c_str(), goner->size);
 #endif
@@ -1065,9 +1092,14 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 	if (!retval)
 		return NULL;
 
-	if (retval->_status == kResStatusNoMalloc)
+	if (retval->_status == kResStatusNoMalloc) {
+		_cacheStats[retval->getType()].misses++;
 		loadResource(retval);
-	else if (retval->_status == kResStatusEnqueued)
+	} else {
+		_cacheStats[retval->getType()].hits++;
+	}
+
+	if (retval->_status == kResStatusEnqueued)
 		// The resource is removed from its current position
 		// in the LRU list because it has been requested
 		// again. Below, it will either be locked, or it
@@ -1117,6 +1149,36 @@ void ResourceManager::unlockResource(Resource *res) {
 	freeOldResources();
 }
 
+void ResourceManager::prefetchRoomResources(uint16 roomNumber) {
+	// The picture and the messages of a room usually share its number
+	static const ResourceType types[] = { kResourceTypePic, kResourceTypeMessage, kResourceTypePalette };
+
+	if (!_prefetchRooms)
+		return;
+
+	for (int i = 0; i < ARRAYSIZE(types); i++) {
+		Resource *res = testResource(ResourceId(types[i], roomNumber));
+		if (!res || res->_status != kResStatusNoMalloc)
+			continue;
+
+		// The size is only known in advance for some map formats
+		if (res->size && _memoryLRU + (int)res->size > _maxMemoryLRU)
+			continue;
+
+		loadResource(res);
+		if (res->_status != kResStatusAllocated)
+			continue;
+
+		_cacheStats[res->getType()].prefetches++;
+		addToLRU(res);
+		freeOldResources();
+	}
+}
+
+void ResourceManager::resetCacheStats() {
+	memset(_cacheStats, 0, sizeof(_cacheStats));
+}
+
 const char *ResourceManager::versionDescription(ResVersion version) const {
 	switch (version) {
 	case kResVersionUnknown:
@@ -1917,6 +1979,13 @@ Resource *ResourceManager::updateResource(ResourceId resId, ResourceSource *src,
 		_resMap.setVal(resId, res);
 	}
 
+	// Keep the LRU list and its size consistent, and drop the data of the
+	// old version so that the next request loads the new one
+	if (res->_status == kResStatusEnqueued)
+		removeFromLRU(res);
+	if (res->_status == kResStatusAllocated)
+		res->unalloc();
+
 	res->_status = kResStatusNoMalloc;
 	res->_source = src;
 	res->_headerSize = 0;
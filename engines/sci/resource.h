@@ -284,6 +284,8 @@ protected:
 	uint16 _lockers; /**< Number of places where this resource was locked */
 	ResourceSource *_source;
 	ResourceManager *_resMan;
+	Resource *_lruPrev; /**< Next more recently used resource in the LRU list */
+	Resource *_lruNext; /**< Next less recently used resource in the LRU list */
 
 	bool loadPatch(Common::SeekableReadStream *file);
 	bool loadFromPatchFile();
@@ -296,6 +298,14 @@ protected:
 
 typedef Common::HashMap<ResourceId, Resource *, ResourceIdHash> ResourceMap;
 
+/** Resource cache statistics of a resource type */
+struct ResourceCacheStats {
+	uint32 hits;		///< Requests for resources which were in memory
+	uint32 misses;		///< Requests for resources which had to be loaded
+	uint32 evictions;	///< Resources freed to keep the cache within its memory budget
+	uint32 prefetches;	///< Resources loaded ahead of a room change
+};
+
 class IntMapResourceSource;
 class ResourceManager {
 	// FIXME: These 'friend' declarations are meant to be a temporary hack to
@@ -374,6 +384,26 @@ public:
 	 */
 	Common::List<ResourceId> listResources(ResourceType type, int mapNumber = -1);
 
+	/**
+	 * Loads the resources a room is likely to use, like its picture and
+	 * messages, before the room asks for them. They are added to the LRU
+	 * list as most recently used. Resources which are known not to fit
+	 * into the free part of the cache budget are skipped.
+	 * @param roomNumber	The number of the room
+	 */
+	void prefetchRoomResources(uint16 roomNumber);
+
+	/** Returns the cache statistics of a resource type. */
+	const ResourceCacheStats &getCacheStats(ResourceType type) const { return _cacheStats[type]; }
+	/** Clears the cache statistics of all resource types. */
+	void resetCacheStats();
+	/** Returns the number of bytes of resources under LRU control. */
+	int getMemoryLRU() const { return _memoryLRU; }
+	/** Returns the number of bytes of locked resources. */
+	int getMemoryLocked() const { return _memoryLocked; }
+	/** Returns the memory budget of the resources under LRU control. */
+	int getMaxMemoryLRU() const { return _maxMemoryLRU; }
+
 	void setAudioLanguage(int language);
 	int getAudioLanguage() const;
 	void changeAudioDirectory(Common::String path);
@@ -463,7 +493,10 @@ protected:
 	Common::List<ResourceSource *> _sources;
 	int _memoryLocked;	///< Amount of resource bytes in locked memory
 	int _memoryLRU;		///< Amount of resource bytes under LRU control
-	Common::List<Resource *> _LRU; ///< Last Resource Used list
+	Resource *_lruFirst;	///< Most recently used resource of the LRU list
+	Resource *_lruLast;		///< Least recently used resource of the LRU list
+	ResourceCacheStats _cacheStats[kResourceTypeInvalid];
+	bool _prefetchRooms;	///< Whether prefetchRoomResources() loads anything
 	ResourceMap _resMap;
 	Common::List<Common::File *> _volumeFiles; ///< list of opened volume files
 	ResourceSource *_audioMapSCI1; ///< Currently loaded audio map for SCI1
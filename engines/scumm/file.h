@@ -37,6 +37,7 @@ protected:
 public:
 	BaseScummFile() : _encbyte(0) {}
 	void setEnc(byte value) { _encbyte = value; }
+	byte getEnc() const { return _encbyte; }
 
 	virtual bool open(const Common::String &filename) = 0;
 	virtual bool openSubFile(const Common::String &filename) = 0;
@@ -117,6 +117,7 @@ void ScummEngine::parseEvent(Common::Event event) {
 				_saveLoadSlot = 10;
 
 			_saveLoadDescription = Common::String::format("Quicksave %d", _saveLoadSlot);
+			discardSaveLoadStream();
 			_saveLoadFlag = (event.kbd.hasFlags(Common::KBD_ALT)) ? 1 : 2;
 			_saveTemporaryState = false;
 		} else if (event.kbd.hasFlags(Common::KBD_CTRL) && event.kbd.keycode == Common::KEYCODE_f) {
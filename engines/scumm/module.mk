@@ -36,6 +36,7 @@ MODULE_OBJS := \
 	midiparser_ro.o \
 	object.o \
 	palette.o \
+	prefetch.o \
 	players/player_ad.o \
 	players/player_apple2.o \
 	players/player_mac.o \
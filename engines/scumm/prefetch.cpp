@@ -0,0 +1,190 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/memstream.h"
+#include "common/system.h"
+
+#include "scumm/file.h"
+#include "scumm/prefetch.h"
+#include "scumm/resource.h"
+#include "scumm/scumm.h"
+
+namespace Scumm {
+
+extern const char *nameOfResType(ResType type);
+
+RoomPrefetcher::RoomPrefetcher(ScummEngine *vm) : _vm(vm), _file(0), _budget(0) {
+}
+
+RoomPrefetcher::~RoomPrefetcher() {
+	cancel();
+	delete _file;
+}
+
+void RoomPrefetcher::startRoom(int room) {
+	cancel();
+
+	if (!_worker.isThreaded())
+		return;
+
+	if (room >= 0x80 && _vm->_game.version < 7 && _vm->_game.heversion <= 71)
+		room = _vm->_resourceMapper[room & 0x7F];
+
+	// Only the offsets of the rooms in the open data file are known
+	if (room <= 0 || _vm->_lastLoadedRoom <= 0 || room >= (int)_vm->_res->_types[rtRoom].size())
+		return;
+	const uint32 roomOffset = _vm->_res->_types[rtRoom][room]._roomoffs;
+	if (roomOffset == 0 || roomOffset == RES_INVALID_OFFSET)
+		return;
+
+	const Common::String fileName = _vm->generateFilename(room);
+	if (!_file || fileName != _fileName) {
+		delete _file;
+		_file = new ScummFile();
+		_fileName = fileName;
+		if (!_vm->openFile(*_file, _fileName, true)) {
+			delete _file;
+			_file = 0;
+			return;
+		}
+	}
+	_file->setEnc(_vm->_fileHandle->getEnc());
+
+	const uint32 maxSize = _vm->_res->getMaxHeapThreshold();
+	const uint32 lockedSize = _vm->_res->getLockedSize();
+	_budget = (maxSize > lockedSize) ? maxSize - lockedSize : 0;
+
+	// The room is needed first, then its scripts run and load the rest
+	if (_vm->getResourceRoomNr(rtRoom, room) == room && !_vm->_res->isResourceLoaded(rtRoom, room))
+		addEntry(rtRoom, room, roomOffset + _vm->getResourceRoomOffset(rtRoom, room));
+
+	static const ResType types[] = { rtScript, rtCostume, rtSound };
+	for (int i = 0; i < ARRAYSIZE(types); ++i) {
+		const ResourceManager::ResTypeData &resources = _vm->_res->_types[types[i]];
+		for (ResId idx = 1; idx < resources.size(); ++idx) {
+			if (resources[idx]._roomno != room || resources[idx]._address)
+				continue;
+			const uint32 offset = _vm->getResourceRoomOffset(types[i], idx);
+			if (offset != RES_INVALID_OFFSET)
+				addEntry(types[i], idx, roomOffset + offset);
+		}
+	}
+
+	debugC(DEBUG_RESOURCE, "Prefetching %d resources of room %d", _entries.size(), room);
+}
+
+void RoomPrefetcher::addEntry(ResType type, ResId idx, uint32 offset) {
+	Entry *entry = new Entry();
+	entry->prefetcher = this;
+	entry->type = type;
+	entry->idx = idx;
+	entry->offset = offset;
+	entry->data = 0;
+	entry->size = 0;
+	_entries.push_back(entry);
+
+	entry->job = _worker.addJob(readEntry, entry);
+}
+
+void RoomPrefetcher::readEntry(void *param) {
+	Entry *entry = (Entry *)param;
+	RoomPrefetcher *prefetcher = entry->prefetcher;
+	ScummFile &file = *prefetcher->_file;
+
+	// Runs on the worker thread: no error() here, a failed read only means
+	// the resource is loaded from the data file as usual
+	file.clearErr();
+	if ((int32)entry->offset < 0 || (int32)entry->offset + 8 > file.size())
+		return;
+
+	file.seek(entry->offset, SEEK_SET);
+	file.readUint32BE();
+	const uint32 size = file.readUint32BE();
+	if (file.err() || file.eos() || size < 8 || size > prefetcher->_budget || (int32)(entry->offset + size) > file.size())
+		return;
+
+	byte *data = new byte[size];
+	file.seek(-8, SEEK_CUR);
+	if (file.read(data, size) != size) {
+		delete[] data;
+		return;
+	}
+
+	entry->data = data;
+	entry->size = size;
+	prefetcher->_budget -= size;
+}
+
+bool RoomPrefetcher::loadResource(ResType type, ResId idx) {
+	Entry *entry = 0;
+	for (uint i = 0; i < _entries.size(); ++i) {
+		if (_entries[i]->type == type && _entries[i]->idx == idx) {
+			entry = _entries.remove_at(i);
+			break;
+		}
+	}
+	if (!entry)
+		return false;
+
+	const uint32 waitStart = _vm->_system->getMillis();
+	_worker.wait(entry->job);
+	_vm->_sceneLoadStats.waitTime += _vm->_system->getMillis() - waitStart;
+
+	bool loaded = false;
+	if (!entry->data) {
+		// Over the budget, or not readable
+	} else if (type == rtSound) {
+		// Sounds are converted while they are read
+		Common::MemoryReadStream stream(entry->data, entry->size);
+		loaded = _vm->readSoundResource(idx, stream) != 0;
+		if (stream.eos() || stream.err()) {
+			// The sound data goes beyond its block: read it from the file
+			_vm->_res->nukeResource(type, idx);
+			loaded = false;
+		}
+	} else if (READ_BE_UINT32(entry->data) == _vm->_res->_types[type]._tag || _vm->_game.heversion >= 70) {
+		memcpy(_vm->_res->createResource(type, idx, entry->size), entry->data, entry->size);
+		loaded = true;
+	}
+
+	if (loaded) {
+		debugC(DEBUG_RESOURCE, "Prefetched %s %d, %d bytes", nameOfResType(type), idx, entry->size);
+		++_vm->_sceneLoadStats.prefetched;
+	}
+
+	delete[] entry->data;
+	delete entry;
+	return loaded;
+}
+
+void RoomPrefetcher::cancel() {
+	_worker.cancelPending();
+	_worker.waitAll();
+
+	for (uint i = 0; i < _entries.size(); ++i) {
+		delete[] _entries[i]->data;
+		delete _entries[i];
+	}
+	_entries.clear();
+}
+
+} // End of namespace Scumm
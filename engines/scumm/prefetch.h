@@ -0,0 +1,110 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef SCUMM_PREFETCH_H
+#define SCUMM_PREFETCH_H
+
+#include "common/array.h"
+#include "common/str.h"
+#include "common/threadpool.h"
+#include "scumm/scumm.h"	// for ResType
+
+namespace Scumm {
+
+class ScummFile;
+
+/**
+ * Reads the resources stored in the data file block of a room on a
+ * background thread, at the start of the scene change to that room. This
+ * is the room itself and the global scripts, costumes and sounds listed
+ * in the resource directories as belonging to it, which is where the
+ * games keep most of what the room's scripts load. The reads overlap with
+ * the exit script and the setup of the room, and loadResource() then takes
+ * the data from memory instead of the data file.
+ *
+ * Only the raw data is read in the background, into buffers owned by the
+ * prefetcher: the resource manager is only touched by the main thread, as
+ * the resources are created when they are actually loaded. The amount of
+ * data read ahead is limited to the part of the heap not taken by locked
+ * resources, and data which was not used is dropped at the next scene
+ * change.
+ *
+ * This is only done for games with big headers (v5+ and HE), and only for
+ * rooms in the data file which is currently open, whose offsets are known.
+ * Without thread support nothing is read ahead.
+ */
+class RoomPrefetcher {
+public:
+	RoomPrefetcher(ScummEngine *vm);
+	~RoomPrefetcher();
+
+	/**
+	 * Drops what was read for the previous room, and starts reading the
+	 * resources of the given room in the background.
+	 */
+	void startRoom(int room);
+
+	/**
+	 * Creates the given resource from the data read in the background,
+	 * waiting for the read to finish if needed. The file position and
+	 * room state are the caller's business.
+	 *
+	 * @return false if the resource was not read ahead, or could not be
+	 *         used, so it has to be loaded from the data file
+	 */
+	bool loadResource(ResType type, ResId idx);
+
+	/**
+	 * Stops the background reads and frees the data which was not used.
+	 */
+	void cancel();
+
+private:
+	struct Entry {
+		RoomPrefetcher *prefetcher;
+		ResType type;
+		ResId idx;
+		uint32 offset;
+		Common::WorkerThread::JobId job;
+
+		// Written by the worker thread
+		byte *data;
+		uint32 size;
+	};
+
+	void addEntry(ResType type, ResId idx, uint32 offset);
+	static void readEntry(void *param);
+
+	ScummEngine *_vm;
+	Common::WorkerThread _worker;
+
+	ScummFile *_file;
+	Common::String _fileName;
+	Common::Array<Entry *> _entries;
+
+	/** Bytes which may still be read ahead, only used by the worker thread */
+	uint32 _budget;
+};
+
+} // End of namespace Scumm
+
+#endif
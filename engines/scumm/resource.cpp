@@ -32,6 +32,7 @@
 #include "scumm/imuse_digi/dimuse.h"
 #include "scumm/he/intern_he.h"
 #include "scumm/object.h"
+#include "scumm/prefetch.h"
 #include "scumm/resource.h"
 #include "scumm/scumm.h"
 #include "scumm/scumm_v5.h"
@@ -612,7 +613,10 @@ void ScummEngine::ensureResourceLoaded(ResType type, ResId idx) {
 	if (idx <= _res->_types[type].size() && _res->_types[type][idx]._address)
 		return;
 
+	const uint32 loadStart = _system->getMillis();
 	loadResource(type, idx);
+	_sceneLoadStats.loadTime += _system->getMillis() - loadStart;
+	++_sceneLoadStats.loads;
 
 	if (_game.version == 5 && type == rtRoom && (int)idx == _roomResource)
 		VAR(VAR_ROOM_FLAG) = 1;
@@ -644,6 +648,13 @@ int ScummEngine::loadResource(ResType type, ResId idx) {
 
 	openRoom(roomNr);
 
+	if (_roomPrefetcher && _roomPrefetcher->loadResource(type, idx)) {
+		if (_dumpScripts && type == rtScript) {
+			dumpResource("script-", idx, getResourceAddress(rtScript, idx));
+		}
+		return 1;
+	}
+
 	_fileHandle->seek(fileOffs + _fileOffset, SEEK_SET);
 
 	if (_game.features & GF_OLD_BUNDLE) {
@@ -664,7 +675,7 @@ int ScummEngine::loadResource(ResType type, ResId idx) {
 		}
 	} else {
 		if (type == rtSound) {
-			return readSoundResource(idx);
+			return readSoundResource(idx, *_fileHandle);
 		}
 
 		// Sanity check: Is this the right tag for this resource type?
@@ -1119,6 +1130,21 @@ bool ResourceManager::isResourceLoaded(ResType type, ResId idx) const {
 	return _types[type][idx]._address != NULL;
 }
 
+uint32 ResourceManager::getLockedSize() const {
+	uint32 lockedSize = 0;
+
+	for (ResType type = rtFirst; type <= rtLast; type = ResType(type + 1)) {
+		ResId idx = _types[type].size();
+		while (idx-- > 0) {
+			const Resource &tmp = _types[type][idx];
+			if (tmp.isLocked() && tmp._address)
+				lockedSize += tmp._size;
+		}
+	}
+
+	return lockedSize;
+}
+
 void ResourceManager::resourceStats() {
 	uint32 lockedSize = 0, lockedNum = 0;
 
@@ -181,6 +181,7 @@ public:
 	~ResourceManager();
 
 	void setHeapThreshold(int min, int max);
+	uint32 getMaxHeapThreshold() const { return _maxHeapThreshold; }
 
 	void allocResTypeData(ResType type, uint32 tag, int num, ResTypeMode mode);
 	void freeResources();
@@ -223,6 +224,12 @@ public:
 	 */
 	void increaseResourceCounters();
 
+	/**
+	 * Returns the size of the loaded resources which are locked, and thus
+	 * cannot be expired.
+	 */
+	uint32 getLockedSize() const;
+
 	void resourceStats();
 
 //protected:
@@ -28,6 +28,7 @@
 #include "scumm/he/intern_he.h"
 #endif
 #include "scumm/object.h"
+#include "scumm/prefetch.h"
 #include "scumm/resource.h"
 #include "scumm/scumm_v3.h"
 #include "scumm/sound.h"
@@ -44,6 +45,13 @@ void ScummEngine::startScene(int room, Actor *a, int objectNr) {
 
 	debugC(DEBUG_GENERAL, "Loading room %d", room);
 
+	const uint32 sceneStart = _system->getMillis();
+	_sceneLoadStats.reset();
+
+	// Read the resources of the new room while the old one is left
+	if (_roomPrefetcher)
+		_roomPrefetcher->startRoom(room);
+
 	stopTalk();
 
 	fadeOut(_switchRoomEffect2);
@@ -215,6 +223,10 @@ void ScummEngine::startScene(int room, Actor *a, int objectNr) {
 
 	_doEffect = true;
 
+	debugC(DEBUG_RESOURCE, "Scene change to room %d took %d ms, %d ms of it loading %d resources (%d read ahead, %d ms waiting for them)",
+	       room, _system->getMillis() - sceneStart, _sceneLoadStats.loadTime, _sceneLoadStats.loads,
+	       _sceneLoadStats.prefetched, _sceneLoadStats.waitTime);
+
 	// Hint the backend about the virtual keyboard during copy protection screens
 	if (_game.id == GID_MONKEY2) {
 		if (_system->getFeatureState(OSystem::kFeatureVirtualKeyboard)) {
@@ -106,6 +106,25 @@ Common::Error ScummEngine::saveGameState(int slot, const Common::String &desc) {
 	return Common::kNoError;
 }
 
+Common::Error ScummEngine::saveGameStream(Common::WriteStream *stream) {
+	// Snapshots are taken often, so skip the thumbnail (loadState copes
+	// with its absence) and write straight into the caller's stream.
+	if (!saveState(stream, true, false) || stream->err())
+		return Common::kWritingFailed;
+	return Common::kNoError;
+}
+
+Common::Error ScummEngine::loadGameStream(Common::SeekableReadStream *stream) {
+	// Like loadGameState(), the actual load is done in scummLoop_handleSaveLoad()
+	delete _saveLoadStream;
+	_saveLoadStream = stream->readStream(stream->size() - stream->pos());
+
+	_saveLoadSlot = 0;
+	_saveTemporaryState = false;
+	_saveLoadFlag = 2;		// 2 for load
+	return Common::kNoError;
+}
+
 bool ScummEngine::canSaveGameStateCurrently() {
 	// Disallow saving in v0-v3 games when a 'prequel' to a cutscene is shown.
 	// This is a blank screen with text, and while this is shown, saving should
@@ -138,7 +157,14 @@ bool ScummEngine::canSaveGameStateCurrently() {
 }
 
 
+void ScummEngine::discardSaveLoadStream() {
+	// Any other save or load request replaces the one from loadGameStream()
+	delete _saveLoadStream;
+	_saveLoadStream = NULL;
+}
+
 void ScummEngine::requestSave(int slot, const Common::String &name) {
+	discardSaveLoadStream();
 	_saveLoadSlot = slot;
 	_saveTemporaryState = false;
 	_saveLoadFlag = 1;		// 1 for save
@@ -146,6 +172,7 @@ void ScummEngine::requestSave(int slot, const Common::String &name) {
 }
 
 void ScummEngine::requestLoad(int slot) {
+	discardSaveLoadStream();
 	_saveLoadSlot = slot;
 	_saveTemporaryState = (slot == 100);
 	_saveLoadFlag = 2;		// 2 for load
@@ -173,7 +200,7 @@ static bool saveSaveGameHeader(Common::WriteStream *out, SaveGameHeader &hdr) {
 	return true;
 }
 
-bool ScummEngine::saveState(Common::WriteStream *out, bool writeHeader) {
+bool ScummEngine::saveState(Common::WriteStream *out, bool writeHeader, bool writeThumbnail) {
 	SaveGameHeader hdr;
 
 	if (writeHeader) {
@@ -181,7 +208,8 @@ bool ScummEngine::saveState(Common::WriteStream *out, bool writeHeader) {
 		saveSaveGameHeader(out, hdr);
 	}
 #if !defined(__DS__) && !defined(__N64__) /* && !defined(__PLAYSTATION2__) */
-	Graphics::saveThumbnail(*out);
+	if (writeThumbnail)
+		Graphics::saveThumbnail(*out);
 #endif
 	saveInfos(out);
 
@@ -321,7 +349,15 @@ bool ScummEngine::loadState(int slot, bool compat, Common::String &filename) {
 	SaveGameHeader hdr;
 	int sb, sh;
 
-	Common::SeekableReadStream *in = openSaveFileForReading(slot, compat, filename);
+	Common::SeekableReadStream *in;
+	if (_saveLoadStream) {
+		// Data handed over by loadGameStream()
+		in = _saveLoadStream;
+		_saveLoadStream = NULL;
+		filename = "memory";
+	} else {
+		in = openSaveFileForReading(slot, compat, filename);
+	}
 	if (!in)
 		return false;
 
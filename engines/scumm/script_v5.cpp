@@ -1718,6 +1718,7 @@ void ScummEngine_v5::o5_roomOps() {
 		darkenPalette(a, a, a, b, c);
 		break;
 	case 9:		// SO_ROOM_SAVEGAME
+		discardSaveLoadStream();
 		_saveLoadFlag = getVarOrDirectByte(PARAM_1);
 		_saveLoadSlot = getVarOrDirectByte(PARAM_2);
 		_saveLoadSlot = 99;					/* use this slot */
@@ -1640,6 +1640,7 @@ void ScummEngine_v6::o6_roomOps() {
 		break;
 
 	case 180:		// SO_ROOM_SAVEGAME
+		discardSaveLoadStream();
 		_saveTemporaryState = true;
 		_saveLoadSlot = pop();
 		_saveLoadFlag = pop();
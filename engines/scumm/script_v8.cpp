@@ -730,6 +730,7 @@ void ScummEngine_v8::o8_roomOps() {
 		setCurrentPalette(a);
 		break;
 	case 0x5D:		// SO_ROOM_SAVE_GAME Save game
+		discardSaveLoadStream();
 		_saveSound = 0;
 		_saveTemporaryState = true;
 		_saveLoadSlot = 1;
@@ -1127,6 +1128,7 @@ void ScummEngine_v8::o8_kernelSetFunctions() {
 		break;
 	}
 	case 27: // saveGameRead
+		discardSaveLoadStream();
 		_saveLoadSlot = args[1];
 		_saveLoadFlag = 2;
 		_saveTemporaryState = false;
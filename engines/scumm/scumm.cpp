@@ -51,6 +51,7 @@
 #include "scumm/he/logic_he.h"
 #include "scumm/he/sound_he.h"
 #include "scumm/object.h"
+#include "scumm/prefetch.h"
 #include "scumm/players/player_ad.h"
 #include "scumm/players/player_nes.h"
 #include "scumm/players/player_sid.h"
@@ -153,6 +154,7 @@ ScummEngine::ScummEngine(OSystem *syst, const DetectorResult &dr)
 	}
 
 	_fileHandle = 0;
+	_roomPrefetcher = 0;
 
 	// Init all vars
 	_imuse = NULL;
@@ -217,6 +219,7 @@ ScummEngine::ScummEngine(OSystem *syst, const DetectorResult &dr)
 	_saveLoadSlot = 0;
 	_lastSaveTime = 0;
 	_saveTemporaryState = false;
+	_saveLoadStream = NULL;
 	memset(_localScriptOffsets, 0, sizeof(_localScriptOffsets));
 	_scriptPointer = NULL;
 	_scriptOrgPointer = NULL;
@@ -589,6 +592,7 @@ ScummEngine::~ScummEngine() {
 	DebugMan.clearAllDebugChannels();
 
 	delete _musicEngine;
+	delete _saveLoadStream;
 
 	_mixer->stopAll();
 
@@ -605,6 +609,7 @@ ScummEngine::~ScummEngine() {
 	delete _messageDialog;
 	delete _pauseDialog;
 	delete _versionDialog;
+	delete _roomPrefetcher;
 	delete _fileHandle;
 
 	delete _sound;
@@ -1240,6 +1245,14 @@ Common::Error ScummEngine::init() {
 	if (_filenamePattern.genMethod == kGenDiskNumSteam || _filenamePattern.genMethod == kGenRoomNumSteam)
 		_game.platform = Common::kPlatformDOS;
 
+	// Read the resources of the next room in the background. This needs a
+	// second handle on the data files, so it is left out for the Steam
+	// versions, whose index file lives in the executable.
+	if (_game.version >= 5 && !(_game.features & (GF_OLD_BUNDLE | GF_SMALL_HEADER)) &&
+	    _filenamePattern.genMethod != kGenDiskNumSteam && _filenamePattern.genMethod != kGenRoomNumSteam &&
+	    (!ConfMan.hasKey("scumm_prefetch_resources") || ConfMan.getBool("scumm_prefetch_resources")))
+		_roomPrefetcher = new RoomPrefetcher(this);
+
 	// Load CJK font, if present
 	// Load it earlier so _useCJKMode variable could be set
 	loadCJKFont();
@@ -2086,6 +2099,7 @@ Common::Error ScummEngine::go() {
 	} else {
 		_saveLoadFlag = 0;
 	}
+	discardSaveLoadStream();
 
 	int diff = 0;	// Duration of one loop iteration
 
@@ -2452,6 +2466,7 @@ void ScummEngine::scummLoop_handleSaveLoad() {
 			clearClickedStatus();
 
 		_saveLoadFlag = 0;
+		discardSaveLoadStream();
 		_lastSaveTime = _system->getMillis();
 	}
 }
@@ -2712,6 +2727,7 @@ bool ScummEngine::startManiac() {
 
 	if (!maniacTarget.empty()) {
 		// Request a temporary save game to be made.
+		discardSaveLoadStream();
 		_saveLoadFlag = 1;
 		_saveLoadSlot = 100;
 		_saveTemporaryState = true;
@@ -370,6 +370,21 @@ enum ResType {
 typedef uint16 ResId;
 
 class ResourceManager;
+class RoomPrefetcher;
+
+/**
+ * Time spent loading resources during a scene change, reported once the
+ * new room has been entered.
+ */
+struct SceneLoadStats {
+	uint32 loads;			///< resources loaded
+	uint32 loadTime;		///< milliseconds spent loading them
+	uint32 prefetched;		///< resources which had been read in the background
+	uint32 waitTime;		///< milliseconds spent waiting for the background reads
+
+	SceneLoadStats() { reset(); }
+	void reset() { loads = loadTime = prefetched = waitTime = 0; }
+};
 
 /**
  * Base class for all SCUMM engines.
@@ -379,6 +394,7 @@ class ScummEngine : public Engine {
 	friend class CharsetRenderer;
 	friend class CharsetRendererTownsClassic;
 	friend class ResourceManager;
+	friend class RoomPrefetcher;
 
 public:
 	/* Put often used variables at the top.
@@ -436,6 +452,8 @@ public:
 	virtual bool canLoadGameStateCurrently();
 	virtual Common::Error saveGameState(int slot, const Common::String &desc);
 	virtual bool canSaveGameStateCurrently();
+	virtual Common::Error saveGameStream(Common::WriteStream *stream);
+	virtual Common::Error loadGameStream(Common::SeekableReadStream *stream);
 
 	virtual void pauseEngineIntern(bool pause);
 
@@ -602,11 +620,13 @@ protected:
 	bool _saveTemporaryState;
 	Common::String _saveLoadFileName;
 	Common::String _saveLoadDescription;
+	Common::SeekableReadStream *_saveLoadStream;	// pending loadGameStream() data, used instead of a slot
 
-	bool saveState(Common::WriteStream *out, bool writeHeader = true);
+	bool saveState(Common::WriteStream *out, bool writeHeader = true, bool writeThumbnail = true);
 	bool saveState(int slot, bool compat, Common::String &fileName);
 	bool loadState(int slot, bool compat);
 	bool loadState(int slot, bool compat, Common::String &fileName);
+	void discardSaveLoadStream();
 	virtual void saveOrLoad(Serializer *s);
 	void saveResource(Serializer *ser, ResType type, ResId idx);
 	void loadResource(Serializer *ser, ResType type, ResId idx);
@@ -725,6 +745,10 @@ protected:
 	/* Should be in Resource class */
 	BaseScummFile *_fileHandle;
 	uint32 _fileOffset;
+
+	/** Reads the resources of the next room in the background, if enabled */
+	RoomPrefetcher *_roomPrefetcher;
+	SceneLoadStats _sceneLoadStats;
 public:
 	/** The name of the (macintosh/rescumm style) container file, if any. */
 	Common::String _containerFile;
@@ -765,7 +789,7 @@ public:
 	void ensureResourceLoaded(ResType type, ResId idx);
 
 protected:
-	int readSoundResource(ResId idx);
+	int readSoundResource(ResId idx, Common::SeekableReadStream &file);
 	int readSoundResourceSmallHeader(ResId idx);
 	bool isResourceInUse(ResType type, ResId idx) const;
 
@@ -1138,7 +1138,7 @@ void Sound::saveLoadWithSerializer(Serializer *ser) {
  * could stand a thorough cleanup!
  */
 
-int ScummEngine::readSoundResource(ResId idx) {
+int ScummEngine::readSoundResource(ResId idx, Common::SeekableReadStream &file) {
 	uint32 pos, total_size, size, tag, basetag, max_total_size;
 	int pri, best_pri;
 	uint32 best_size = 0, best_offs = 0;
@@ -1148,10 +1148,10 @@ int ScummEngine::readSoundResource(ResId idx) {
 
 	pos = 0;
 
-	_fileHandle->readUint32LE();
-	max_total_size = _fileHandle->readUint32BE() - 8;
-	basetag = _fileHandle->readUint32BE();
-	total_size = _fileHandle->readUint32BE();
+	file.readUint32LE();
+	max_total_size = file.readUint32BE() - 8;
+	basetag = file.readUint32BE();
+	total_size = file.readUint32BE();
 
 	debugC(DEBUG_RESOURCE, "  basetag: %s, total_size=%d", tag2str(basetag), total_size);
 
@@ -1159,16 +1159,16 @@ int ScummEngine::readSoundResource(ResId idx) {
 	case MKTAG('M','I','D','I'):
 	case MKTAG('i','M','U','S'):
 		if (_sound->_musicType != MDT_PCSPK && _sound->_musicType != MDT_PCJR) {
-			_fileHandle->seek(-8, SEEK_CUR);
-			_fileHandle->read(_res->createResource(rtSound, idx, total_size + 8), total_size + 8);
+			file.seek(-8, SEEK_CUR);
+			file.read(_res->createResource(rtSound, idx, total_size + 8), total_size + 8);
 			return 1;
 		}
 		break;
 	case MKTAG('S','O','U',' '):
 		best_pri = -1;
 		while (pos < total_size) {
-			tag = _fileHandle->readUint32BE();
-			size = _fileHandle->readUint32BE() + 8;
+			tag = file.readUint32BE();
+			size = file.readUint32BE() + 8;
 			pos += size;
 
 			pri = -1;
@@ -1233,25 +1233,25 @@ int ScummEngine::readSoundResource(ResId idx) {
 			if (pri > best_pri) {
 				best_pri = pri;
 				best_size = size;
-				best_offs = _fileHandle->pos();
+				best_offs = file.pos();
 			}
 
-			_fileHandle->seek(size - 8, SEEK_CUR);
+			file.seek(size - 8, SEEK_CUR);
 		}
 
 		if (best_pri != -1) {
-			_fileHandle->seek(best_offs - 8, SEEK_SET);
+			file.seek(best_offs - 8, SEEK_SET);
 			ptr = _res->createResource(rtSound, idx, best_size);
-			_fileHandle->read(ptr, best_size);
+			file.read(ptr, best_size);
 			//dumpResource("sound-", idx, ptr);
 			return 1;
 		}
 		break;
 	case MKTAG('M','a','c','0'):
-		_fileHandle->seek(-12, SEEK_CUR);
-		total_size = _fileHandle->readUint32BE() - 8;
+		file.seek(-12, SEEK_CUR);
+		total_size = file.readUint32BE() - 8;
 		ptr = _res->createResource(rtSound, idx, total_size);
-		_fileHandle->read(ptr, total_size);
+		file.read(ptr, total_size);
 		//dumpResource("sound-", idx, ptr);
 		return 1;
 
@@ -1261,19 +1261,19 @@ int ScummEngine::readSoundResource(ResId idx) {
 	case MKTAG('D','I','G','I'):
 	case MKTAG('C','r','e','a'):
 	case 0x460e200d:	// WORKAROUND bug # 1311447
-		_fileHandle->seek(-12, SEEK_CUR);
-		total_size = _fileHandle->readUint32BE();
+		file.seek(-12, SEEK_CUR);
+		total_size = file.readUint32BE();
 		ptr = _res->createResource(rtSound, idx, total_size);
-		_fileHandle->read(ptr, total_size - 8);
+		file.read(ptr, total_size - 8);
 		//dumpResource("sound-", idx, ptr);
 		return 1;
 
 	case MKTAG('H','S','H','D'):
 		// HE sound type without SOUN header
-		_fileHandle->seek(-16, SEEK_CUR);
+		file.seek(-16, SEEK_CUR);
 		total_size = max_total_size + 8;
 		ptr = _res->createResource(rtSound, idx, total_size);
-		_fileHandle->read(ptr, total_size);
+		file.read(ptr, total_size);
 		//dumpResource("sound-", idx, ptr);
 		return 1;
 
@@ -1284,18 +1284,18 @@ int ScummEngine::readSoundResource(ResId idx) {
 		Common::File dmuFile;
 		char buffer[128];
 		debugC(DEBUG_SOUND, "Found base tag FMUS in sound %d, size %d", idx, total_size);
-		debugC(DEBUG_SOUND, "It was at position %d", _fileHandle->pos());
+		debugC(DEBUG_SOUND, "It was at position %d", file.pos());
 
-		_fileHandle->seek(4, SEEK_CUR);
+		file.seek(4, SEEK_CUR);
 		// HSHD size
-		tmpsize = _fileHandle->readUint32BE();
+		tmpsize = file.readUint32BE();
 		// skip to size part of the SDAT block
-		_fileHandle->seek(tmpsize - 4, SEEK_CUR);
+		file.seek(tmpsize - 4, SEEK_CUR);
 		// SDAT size
-		tmpsize = _fileHandle->readUint32BE();
+		tmpsize = file.readUint32BE();
 
 		// SDAT contains name of file we want
-		_fileHandle->read(buffer, MIN(128, tmpsize - 8));
+		file.read(buffer, MIN(128, tmpsize - 8));
 		// files seem to be 11 chars (8.3)
 		char *p = (char *)memchr(buffer, '.', 12);
 		if (!p) p = &buffer[8];
@@ -1318,11 +1318,11 @@ int ScummEngine::readSoundResource(ResId idx) {
 
 	default:
 		if (SWAP_BYTES_32(basetag) == max_total_size) {
-			_fileHandle->seek(-12, SEEK_CUR);
-			total_size = _fileHandle->readUint32BE();
-			_fileHandle->seek(-8, SEEK_CUR);
+			file.seek(-12, SEEK_CUR);
+			total_size = file.readUint32BE();
+			file.seek(-8, SEEK_CUR);
 			ptr = _res->createResource(rtSound, idx, total_size);
-			_fileHandle->read(ptr, total_size);
+			file.read(ptr, total_size);
 			//dumpResource("sound-", idx, ptr);
 			return 1;
 		}
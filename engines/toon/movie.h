@@ -37,6 +37,8 @@ public:
 
 protected:
 	void handleAudioTrack(byte track, uint32 chunkSize, uint32 unpackedSize);
+	// isLowRes() follows the frames as they are decoded
+	bool canDecodeAhead() const { return false; }
 	SmackerVideoTrack *createVideoTrack(uint32 width, uint32 height, uint32 frameCount, const Common::Rational &frameRate, uint32 flags, uint32 signature) const;
 
 private:
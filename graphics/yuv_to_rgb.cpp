@@ -83,9 +83,18 @@
 // BASIS, AND BROWN UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE,
 // SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
+#include "common/util.h"
 #include "graphics/surface.h"
 #include "graphics/yuv_to_rgb.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define YUV_SIMD_SSE2
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define YUV_SIMD_NEON
+#endif
+
 namespace Common {
 DECLARE_SINGLETON(Graphics::YUVToRGBManager);
 }
@@ -159,6 +168,7 @@ YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::Lu
 
 YUVToRGBManager::YUVToRGBManager() {
 	_lookup = 0;
+	_backend = hasBackend(kBackendSIMD) ? kBackendSIMD : kBackendLookup;
 
 	int16 *Cr_r_tab = &_colorTab[0 * 256];
 	int16 *Cr_g_tab = &_colorTab[1 * 256];
@@ -192,6 +202,344 @@ const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, Y
 	return _lookup;
 }
 
+void YUVToRGBManager::prepareLookup(const Graphics::PixelFormat &format, YUVToRGBManager::LuminanceScale scale) {
+	getLookup(format, scale);
+}
+
+bool YUVToRGBManager::hasBackend(Backend backend) {
+	switch (backend) {
+	case kBackendLookup:
+		return true;
+	case kBackendSIMD:
+#if defined(YUV_SIMD_SSE2) || defined(YUV_SIMD_NEON)
+		return true;
+#else
+		return false;
+#endif
+	default:
+		return false;
+	}
+}
+
+bool YUVToRGBManager::setBackend(Backend backend) {
+	if (!hasBackend(backend))
+		return false;
+
+	_backend = backend;
+	return true;
+}
+
+#if defined(YUV_SIMD_SSE2) || defined(YUV_SIMD_NEON)
+
+// The SIMD backend converts eight pixels at a time, with the same integer
+// math as the tables: the color tables hold the chroma scaled by constant
+// factors and truncated towards zero, which a multiply by a 16 bit fraction
+// reproduces exactly for all chroma values, and the lookup table clamps the
+// sums and scales the luminance, which min/max and another multiply do.
+
+/**
+ * What the SIMD code needs to know about the destination.
+ */
+struct SIMDParams {
+	const uint32 *rgbToPix;
+	const int16 *colorTab;
+	bool itu;
+	int rLoss, rShift, gLoss, gShift, bLoss, bShift;
+	uint32 alpha;
+
+	SIMDParams(const YUVToRGBLookup *lookup, const int16 *tab) {
+		const Graphics::PixelFormat format = lookup->getFormat();
+		rgbToPix = lookup->getRGBToPix();
+		colorTab = tab;
+		itu = lookup->getScale() == YUVToRGBManager::kScaleITU;
+		rLoss = format.rLoss;
+		rShift = format.rShift;
+		gLoss = format.gLoss;
+		gShift = format.gShift;
+		bLoss = format.bLoss;
+		bShift = format.bShift;
+		alpha = (0xFF >> format.aLoss) << format.aShift;
+	}
+
+	/** One pixel through the tables, for the pixels after the last group of eight */
+	uint32 lookupPixel(byte y, byte u, byte v) const {
+		const uint32 *L = &rgbToPix[y];
+		return L[colorTab[v]] | L[colorTab[256 + v] + colorTab[512 + u]] | L[colorTab[768 + u]];
+	}
+};
+
+#if defined(YUV_SIMD_SSE2)
+
+// Eight signed 16 bit values
+typedef __m128i Vec16;
+
+static inline Vec16 vecSplat(int16 x) { return _mm_set1_epi16(x); }
+static inline Vec16 vecSet2x4(int16 a, int16 b) { return _mm_setr_epi16(a, a, a, a, b, b, b, b); }
+static inline Vec16 vecLoad(const int16 *src) { return _mm_loadu_si128((const __m128i *)src); }
+static inline Vec16 vecLoadBytes(const byte *src) { return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)src), _mm_setzero_si128()); }
+static inline Vec16 vecAdd(Vec16 a, Vec16 b) { return _mm_add_epi16(a, b); }
+static inline Vec16 vecSub(Vec16 a, Vec16 b) { return _mm_sub_epi16(a, b); }
+static inline Vec16 vecMul(Vec16 a, Vec16 b) { return _mm_mullo_epi16(a, b); }
+static inline Vec16 vecMulHighUnsigned(Vec16 a, Vec16 b) { return _mm_mulhi_epu16(a, b); }
+static inline Vec16 vecMin(Vec16 a, Vec16 b) { return _mm_min_epi16(a, b); }
+static inline Vec16 vecMax(Vec16 a, Vec16 b) { return _mm_max_epi16(a, b); }
+static inline Vec16 vecXor(Vec16 a, Vec16 b) { return _mm_xor_si128(a, b); }
+static inline Vec16 vecSign(Vec16 a) { return _mm_srai_epi16(a, 15); }
+static inline Vec16 vecShiftLeft(Vec16 a, int n) { return _mm_sll_epi16(a, _mm_cvtsi32_si128(n)); }
+static inline Vec16 vecShiftRight(Vec16 a, int n) { return _mm_srl_epi16(a, _mm_cvtsi32_si128(n)); }
+static inline Vec16 vecDoubleLow(Vec16 a) { return _mm_unpacklo_epi16(a, a); }
+static inline Vec16 vecDoubleHigh(Vec16 a) { return _mm_unpackhi_epi16(a, a); }
+
+/**
+ * Packs eight pixels of components in [0, 255] into the destination format.
+ */
+template<typename PixelInt>
+static inline void vecStorePixels(PixelInt *dst, Vec16 r, Vec16 g, Vec16 b, const SIMDParams &params) {
+	r = vecShiftRight(r, params.rLoss);
+	g = vecShiftRight(g, params.gLoss);
+	b = vecShiftRight(b, params.bLoss);
+
+	if (sizeof(PixelInt) == 2) {
+		__m128i pix = _mm_or_si128(vecShiftLeft(r, params.rShift), vecShiftLeft(g, params.gShift));
+		pix = _mm_or_si128(pix, vecShiftLeft(b, params.bShift));
+		pix = _mm_or_si128(pix, _mm_set1_epi16((int16)params.alpha));
+		_mm_storeu_si128((__m128i *)dst, pix);
+	} else {
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i rShift = _mm_cvtsi32_si128(params.rShift);
+		const __m128i gShift = _mm_cvtsi32_si128(params.gShift);
+		const __m128i bShift = _mm_cvtsi32_si128(params.bShift);
+		const __m128i alpha = _mm_set1_epi32(params.alpha);
+		__m128i lo = _mm_or_si128(_mm_sll_epi32(_mm_unpacklo_epi16(r, zero), rShift), _mm_sll_epi32(_mm_unpacklo_epi16(g, zero), gShift));
+		__m128i hi = _mm_or_si128(_mm_sll_epi32(_mm_unpackhi_epi16(r, zero), rShift), _mm_sll_epi32(_mm_unpackhi_epi16(g, zero), gShift));
+		lo = _mm_or_si128(_mm_or_si128(lo, _mm_sll_epi32(_mm_unpacklo_epi16(b, zero), bShift)), alpha);
+		hi = _mm_or_si128(_mm_or_si128(hi, _mm_sll_epi32(_mm_unpackhi_epi16(b, zero), bShift)), alpha);
+		_mm_storeu_si128((__m128i *)dst, lo);
+		_mm_storeu_si128((__m128i *)(dst + 4), hi);
+	}
+}
+
+#elif defined(YUV_SIMD_NEON)
+
+// Eight signed 16 bit values
+typedef int16x8_t Vec16;
+
+static inline Vec16 vecSplat(int16 x) { return vdupq_n_s16(x); }
+static inline Vec16 vecSet2x4(int16 a, int16 b) { return vcombine_s16(vdup_n_s16(a), vdup_n_s16(b)); }
+static inline Vec16 vecLoad(const int16 *src) { return vld1q_s16(src); }
+static inline Vec16 vecLoadBytes(const byte *src) { return vreinterpretq_s16_u16(vmovl_u8(vld1_u8(src))); }
+static inline Vec16 vecAdd(Vec16 a, Vec16 b) { return vaddq_s16(a, b); }
+static inline Vec16 vecSub(Vec16 a, Vec16 b) { return vsubq_s16(a, b); }
+static inline Vec16 vecMul(Vec16 a, Vec16 b) { return vmulq_s16(a, b); }
+static inline Vec16 vecMin(Vec16 a, Vec16 b) { return vminq_s16(a, b); }
+static inline Vec16 vecMax(Vec16 a, Vec16 b) { return vmaxq_s16(a, b); }
+static inline Vec16 vecXor(Vec16 a, Vec16 b) { return veorq_s16(a, b); }
+static inline Vec16 vecSign(Vec16 a) { return vshrq_n_s16(a, 15); }
+static inline Vec16 vecShiftLeft(Vec16 a, int n) { return vshlq_s16(a, vdupq_n_s16(n)); }
+static inline Vec16 vecShiftRight(Vec16 a, int n) { return vreinterpretq_s16_u16(vshlq_u16(vreinterpretq_u16_s16(a), vdupq_n_s16(-n))); }
+static inline Vec16 vecDoubleLow(Vec16 a) { return vzipq_s16(a, a).val[0]; }
+static inline Vec16 vecDoubleHigh(Vec16 a) { return vzipq_s16(a, a).val[1]; }
+
+static inline Vec16 vecMulHighUnsigned(Vec16 a, Vec16 b) {
+	const uint16x8_t ua = vreinterpretq_u16_s16(a);
+	const uint16x8_t ub = vreinterpretq_u16_s16(b);
+	const uint32x4_t lo = vmull_u16(vget_low_u16(ua), vget_low_u16(ub));
+	const uint32x4_t hi = vmull_u16(vget_high_u16(ua), vget_high_u16(ub));
+	return vreinterpretq_s16_u16(vcombine_u16(vshrn_n_u32(lo, 16), vshrn_n_u32(hi, 16)));
+}
+
+/**
+ * Packs eight pixels of components in [0, 255] into the destination format.
+ */
+template<typename PixelInt>
+static inline void vecStorePixels(PixelInt *dst, Vec16 r, Vec16 g, Vec16 b, const SIMDParams &params) {
+	const uint16x8_t ur = vreinterpretq_u16_s16(vecShiftRight(r, params.rLoss));
+	const uint16x8_t ug = vreinterpretq_u16_s16(vecShiftRight(g, params.gLoss));
+	const uint16x8_t ub = vreinterpretq_u16_s16(vecShiftRight(b, params.bLoss));
+
+	if (sizeof(PixelInt) == 2) {
+		uint16x8_t pix = vorrq_u16(vshlq_u16(ur, vdupq_n_s16(params.rShift)), vshlq_u16(ug, vdupq_n_s16(params.gShift)));
+		pix = vorrq_u16(pix, vshlq_u16(ub, vdupq_n_s16(params.bShift)));
+		pix = vorrq_u16(pix, vdupq_n_u16((uint16)params.alpha));
+		vst1q_u16((uint16_t *)dst, pix);
+	} else {
+		const int32x4_t rShift = vdupq_n_s32(params.rShift);
+		const int32x4_t gShift = vdupq_n_s32(params.gShift);
+		const int32x4_t bShift = vdupq_n_s32(params.bShift);
+		const uint32x4_t alpha = vdupq_n_u32(params.alpha);
+		uint32x4_t lo = vorrq_u32(vshlq_u32(vmovl_u16(vget_low_u16(ur)), rShift), vshlq_u32(vmovl_u16(vget_low_u16(ug)), gShift));
+		uint32x4_t hi = vorrq_u32(vshlq_u32(vmovl_u16(vget_high_u16(ur)), rShift), vshlq_u32(vmovl_u16(vget_high_u16(ug)), gShift));
+		lo = vorrq_u32(vorrq_u32(lo, vshlq_u32(vmovl_u16(vget_low_u16(ub)), bShift)), alpha);
+		hi = vorrq_u32(vorrq_u32(hi, vshlq_u32(vmovl_u16(vget_high_u16(ub)), bShift)), alpha);
+		vst1q_u32((uint32_t *)dst, lo);
+		vst1q_u32((uint32_t *)(dst + 4), hi);
+	}
+}
+
+#endif
+
+/**
+ * Computes trunc(c * factor) for chroma values c in [-128, 127], where
+ * factor is mul / 2^(16 - pre), like the color tables do.
+ */
+static inline Vec16 scaleChroma(Vec16 c, int pre, int16 mul) {
+	const Vec16 sign = vecSign(c);
+	Vec16 a = vecSub(vecXor(c, sign), sign);
+	a = vecMulHighUnsigned(vecShiftLeft(a, pre), vecSplat(mul));
+	return vecSub(vecXor(a, sign), sign);
+}
+
+/**
+ * The offsets the color tables add to the luminance for each component.
+ */
+static inline void chromaOffsets(Vec16 u, Vec16 v, Vec16 &r, Vec16 &g, Vec16 &b) {
+	const Vec16 cr = vecSub(v, vecSplat(128));
+	const Vec16 cb = vecSub(u, vecSplat(128));
+
+	r = scaleChroma(cr, 1, (int16)45876);		// 0.419 / 0.299
+	g = vecSub(vecSub(vecSplat(0), scaleChroma(cr, 0, (int16)46735)), scaleChroma(cb, 0, 22562));	// 0.299 / 0.419, 0.114 / 0.331
+	b = scaleChroma(cb, 1, (int16)58109);		// 0.587 / 0.331
+}
+
+/**
+ * Clamps a color component like the lookup table does, and scales ITU
+ * luminance to the full range: (c - 16) * 255 / 219 is c - 16 plus
+ * (c - 16) * 36 / 219, and the multiply by 10774 / 65536 rounds the same for
+ * all values up to 219.
+ */
+static inline Vec16 clampComponent(Vec16 c, bool itu) {
+	if (itu) {
+		c = vecSub(vecMin(vecMax(c, vecSplat(16)), vecSplat(235)), vecSplat(16));
+		return vecAdd(c, vecMulHighUnsigned(c, vecSplat(10774)));
+	}
+	return vecMin(vecMax(c, vecSplat(0)), vecSplat(255));
+}
+
+template<typename PixelInt>
+static inline void putPixels(PixelInt *dst, Vec16 y, Vec16 r, Vec16 g, Vec16 b, const SIMDParams &params) {
+	vecStorePixels<PixelInt>(dst, clampComponent(vecAdd(y, r), params.itu), clampComponent(vecAdd(y, g), params.itu),
+	                         clampComponent(vecAdd(y, b), params.itu), params);
+}
+
+template<typename PixelInt>
+void convertYUV444ToRGBSIMD(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	const SIMDParams params(lookup, colorTab);
+
+	for (int h = 0; h < yHeight; h++) {
+		PixelInt *dst = (PixelInt *)dstPtr;
+
+		int w = 0;
+		for (; w + 8 <= yWidth; w += 8) {
+			Vec16 r, g, b;
+			chromaOffsets(vecLoadBytes(uSrc + w), vecLoadBytes(vSrc + w), r, g, b);
+			putPixels<PixelInt>(dst + w, vecLoadBytes(ySrc + w), r, g, b, params);
+		}
+		for (; w < yWidth; w++)
+			dst[w] = params.lookupPixel(ySrc[w], uSrc[w], vSrc[w]);
+
+		dstPtr += dstPitch;
+		ySrc += yPitch;
+		uSrc += uvPitch;
+		vSrc += uvPitch;
+	}
+}
+
+template<typename PixelInt>
+void convertYUV420ToRGBSIMD(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	const SIMDParams params(lookup, colorTab);
+
+	// Like the lookup backend, leave out an odd last row and column
+	const int halfHeight = yHeight >> 1;
+	const int width = yWidth & ~1;
+
+	for (int h = 0; h < halfHeight; h++) {
+		PixelInt *dst0 = (PixelInt *)dstPtr;
+		PixelInt *dst1 = (PixelInt *)(dstPtr + dstPitch);
+		const byte *ySrc1 = ySrc + yPitch;
+
+		// Eight chroma values cover sixteen pixels of both rows
+		int w = 0;
+		for (; w + 16 <= width; w += 16) {
+			Vec16 r, g, b;
+			chromaOffsets(vecLoadBytes(uSrc + (w >> 1)), vecLoadBytes(vSrc + (w >> 1)), r, g, b);
+
+			const Vec16 rLow = vecDoubleLow(r), gLow = vecDoubleLow(g), bLow = vecDoubleLow(b);
+			const Vec16 rHigh = vecDoubleHigh(r), gHigh = vecDoubleHigh(g), bHigh = vecDoubleHigh(b);
+			putPixels<PixelInt>(dst0 + w, vecLoadBytes(ySrc + w), rLow, gLow, bLow, params);
+			putPixels<PixelInt>(dst0 + w + 8, vecLoadBytes(ySrc + w + 8), rHigh, gHigh, bHigh, params);
+			putPixels<PixelInt>(dst1 + w, vecLoadBytes(ySrc1 + w), rLow, gLow, bLow, params);
+			putPixels<PixelInt>(dst1 + w + 8, vecLoadBytes(ySrc1 + w + 8), rHigh, gHigh, bHigh, params);
+		}
+		for (; w < width; w++) {
+			const byte u = uSrc[w >> 1], v = vSrc[w >> 1];
+			dst0[w] = params.lookupPixel(ySrc[w], u, v);
+			dst1[w] = params.lookupPixel(ySrc1[w], u, v);
+		}
+
+		dstPtr += dstPitch * 2;
+		ySrc += yPitch * 2;
+		uSrc += uvPitch;
+		vSrc += uvPitch;
+	}
+}
+
+template<typename PixelInt>
+void convertYUV410ToRGBSIMD(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	const SIMDParams params(lookup, colorTab);
+
+	// Like the lookup backend, only convert whole groups of four pixels
+	const int width = (yWidth >> 2) * 4;
+
+	for (int h = 0; h < yHeight; h++) {
+		PixelInt *dst = (PixelInt *)dstPtr;
+		const byte *uRow = uSrc + (h >> 2) * uvPitch;
+		const byte *vRow = vSrc + (h >> 2) * uvPitch;
+
+		// The weights of the bilinear interpolation of the lookup backend,
+		// for two groups of four pixels
+		const int yDiff = h & 3;
+		int16 weights[4][8];
+		for (int i = 0; i < 8; i++) {
+			const int xDiff = i & 3;
+			weights[0][i] = (4 - xDiff) * (4 - yDiff);
+			weights[1][i] = xDiff * (4 - yDiff);
+			weights[2][i] = yDiff * (4 - xDiff);
+			weights[3][i] = xDiff * yDiff;
+		}
+		const Vec16 weightA = vecLoad(weights[0]), weightB = vecLoad(weights[1]);
+		const Vec16 weightC = vecLoad(weights[2]), weightD = vecLoad(weights[3]);
+
+		int w = 0;
+		for (; w + 8 <= width; w += 8) {
+			const int index = w >> 2;
+			const Vec16 u = vecShiftRight(vecAdd(
+				vecAdd(vecMul(vecSet2x4(uRow[index], uRow[index + 1]), weightA), vecMul(vecSet2x4(uRow[index + 1], uRow[index + 2]), weightB)),
+				vecAdd(vecMul(vecSet2x4(uRow[index + uvPitch], uRow[index + uvPitch + 1]), weightC), vecMul(vecSet2x4(uRow[index + uvPitch + 1], uRow[index + uvPitch + 2]), weightD))), 4);
+			const Vec16 v = vecShiftRight(vecAdd(
+				vecAdd(vecMul(vecSet2x4(vRow[index], vRow[index + 1]), weightA), vecMul(vecSet2x4(vRow[index + 1], vRow[index + 2]), weightB)),
+				vecAdd(vecMul(vecSet2x4(vRow[index + uvPitch], vRow[index + uvPitch + 1]), weightC), vecMul(vecSet2x4(vRow[index + uvPitch + 1], vRow[index + uvPitch + 2]), weightD))), 4);
+
+			Vec16 r, g, b;
+			chromaOffsets(u, v, r, g, b);
+			putPixels<PixelInt>(dst + w, vecLoadBytes(ySrc + w), r, g, b, params);
+		}
+		for (; w < width; w++) {
+			const int index = w >> 2;
+			const int xDiff = w & 3;
+			const byte u = (uRow[index] * (4 - xDiff) * (4 - yDiff) + uRow[index + 1] * xDiff * (4 - yDiff) +
+					uRow[index + uvPitch] * yDiff * (4 - xDiff) + uRow[index + uvPitch + 1] * xDiff * yDiff) >> 4;
+			const byte v = (vRow[index] * (4 - xDiff) * (4 - yDiff) + vRow[index + 1] * xDiff * (4 - yDiff) +
+					vRow[index + uvPitch] * yDiff * (4 - xDiff) + vRow[index + uvPitch + 1] * xDiff * yDiff) >> 4;
+			dst[w] = params.lookupPixel(ySrc[w], u, v);
+		}
+
+		dstPtr += dstPitch;
+		ySrc += yPitch;
+	}
+}
+
+#endif
+
 #define PUT_PIXEL(s, d) \
 	L = &rgbToPix[(s)]; \
 	*((PixelInt *)(d)) = (L[cr_r] | L[crb_g] | L[cb_b])
@@ -235,6 +583,16 @@ void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::Lumina
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
+#if defined(YUV_SIMD_SSE2) || defined(YUV_SIMD_NEON)
+	if (_backend == kBackendSIMD) {
+		if (dst->format.bytesPerPixel == 2)
+			convertYUV444ToRGBSIMD<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		else
+			convertYUV444ToRGBSIMD<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		return;
+	}
+#endif
+
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
 		convertYUV444ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
@@ -291,6 +649,16 @@ void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::Lumina
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
+#if defined(YUV_SIMD_SSE2) || defined(YUV_SIMD_NEON)
+	if (_backend == kBackendSIMD) {
+		if (dst->format.bytesPerPixel == 2)
+			convertYUV420ToRGBSIMD<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		else
+			convertYUV420ToRGBSIMD<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		return;
+	}
+#endif
+
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
 		convertYUV420ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
@@ -376,6 +744,16 @@ void YUVToRGBManager::convert410(Graphics::Surface *dst, YUVToRGBManager::Lumina
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
+#if defined(YUV_SIMD_SSE2) || defined(YUV_SIMD_NEON)
+	if (_backend == kBackendSIMD) {
+		if (dst->format.bytesPerPixel == 2)
+			convertYUV410ToRGBSIMD<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		else
+			convertYUV410ToRGBSIMD<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		return;
+	}
+#endif
+
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
 		convertYUV410ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
@@ -54,6 +54,39 @@ public:
 		kScaleITU   /** Luminance values range from [16, 235], the range from ITU-R BT.601 */
 	};
 
+	/** Implementations of the conversions, which give the same pixels */
+	enum Backend {
+		kBackendLookup, /** Portable C++ code, with table lookups for each pixel */
+		kBackendSIMD    /** SSE2 or NEON code, if the build targets either */
+	};
+
+	/**
+	 * Check whether a backend is compiled in.
+	 */
+	static bool hasBackend(Backend backend);
+
+	/**
+	 * Select the backend used by the conversions. The default is the SIMD
+	 * backend when available and the lookup one otherwise.
+	 *
+	 * @return false if the backend is not compiled in
+	 */
+	bool setBackend(Backend backend);
+
+	Backend getBackend() const { return _backend; }
+
+	/**
+	 * Create the lookup tables for a format and scale before they are used.
+	 * The conversions create them when they are first needed, so this has
+	 * to be called before converting on another thread. That thread may
+	 * then convert to this format and scale while no other thread converts
+	 * to a different one.
+	 *
+	 * @param format  the format of the destination surfaces
+	 * @param scale   the scale of the luminance values
+	 */
+	void prepareLookup(const Graphics::PixelFormat &format, LuminanceScale scale);
+
 	/**
 	 * Convert a YUV444 image to an RGB surface
 	 *
@@ -114,6 +147,7 @@ private:
 
 	YUVToRGBLookup *_lookup;
 	int16 _colorTab[4 * 256]; // 2048 bytes
+	Backend _backend;
 };
 
 } // End of namespace Graphics
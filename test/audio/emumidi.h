@@ -0,0 +1,303 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/softsynth/emumidi.h"
+#include "common/config-manager.h"
+#include "common/hash-str.h"
+#include "common/hashmap.h"
+#include "common/memstream.h"
+
+#include "../common/system_helper.h"
+
+typedef Common::HashMap<Common::String, Common::Array<byte> > RenderCacheTestFiles;
+
+/**
+ * Save files kept in memory, without compression.
+ */
+class RenderCacheTestSaveFileManager : public Common::SaveFileManager {
+public:
+	RenderCacheTestSaveFileManager(RenderCacheTestFiles &files) : _files(files) {}
+
+	Common::OutSaveFile *openForSaving(const Common::String &name, bool compress = true) {
+		return new Common::OutSaveFile(new Writer(_files, name));
+	}
+
+	Common::InSaveFile *openForLoading(const Common::String &name) {
+		if (!_files.contains(name))
+			return 0;
+
+		const Common::Array<byte> &file = _files[name];
+		byte *data = (byte *)malloc(file.size() + 1);
+		if (file.size())
+			memcpy(data, &file[0], file.size());
+		return new Common::MemoryReadStream(data, file.size(), DisposeAfterUse::YES);
+	}
+
+	Common::InSaveFile *openRawFile(const Common::String &name) {
+		return openForLoading(name);
+	}
+
+	bool removeSavefile(const Common::String &name) {
+		if (!_files.contains(name))
+			return false;
+		_files.erase(name);
+		return true;
+	}
+
+	Common::StringArray listSavefiles(const Common::String &pattern) {
+		Common::StringArray names;
+		for (RenderCacheTestFiles::iterator i = _files.begin(); i != _files.end(); ++i) {
+			if (i->_key.matchString(pattern))
+				names.push_back(i->_key);
+		}
+		return names;
+	}
+
+	void updateSavefilesList(Common::StringArray &lockedFiles) {}
+
+private:
+	/** Stores the data written once it is deleted. */
+	class Writer : public Common::MemoryWriteStreamDynamic {
+	public:
+		Writer(RenderCacheTestFiles &files, const Common::String &name) :
+			Common::MemoryWriteStreamDynamic(DisposeAfterUse::YES), _files(files), _name(name) {}
+
+		~Writer() {
+			Common::Array<byte> &file = _files[_name];
+			file.resize(size());
+			if (size())
+				memcpy(&file[0], getData(), size());
+		}
+
+	private:
+		RenderCacheTestFiles &_files;
+		Common::String _name;
+	};
+
+	RenderCacheTestFiles &_files;
+};
+
+/**
+ * A synth whose output only depends on the notes held, so playing live
+ * after falling back from the cache sounds the same as playing live all
+ * along, as long as the held notes are sent again.
+ */
+class RenderCacheTestSynth : public MidiDriver_Emulated {
+public:
+	uint32 _generated;
+
+	RenderCacheTestSynth(bool cache) : MidiDriver_Emulated(0), _generated(0), _cache(cache) {
+		_baseFreq = 100;
+		memset(_notes, 0, sizeof(_notes));
+	}
+
+	void close() {
+		closeRenderCache();
+		_isOpen = false;
+	}
+
+	void send(uint32 b) {
+		if (filterRenderCacheEvent(b))
+			return;
+
+		const byte channel = b & 0x0F;
+		const byte note = (b >> 8) & 0x7F;
+		switch (b & 0xF0) {
+		case 0x80:
+			_notes[channel][note] = 0;
+			break;
+		case 0x90:
+			_notes[channel][note] = (b >> 16) & 0x7F;
+			break;
+		default:
+			break;
+		}
+	}
+
+	MidiChannel *allocateChannel() { return 0; }
+	MidiChannel *getPercussionChannel() { return 0; }
+
+	bool isStereo() const { return false; }
+	int getRate() const { return 22050; }
+
+protected:
+	void generateSamples(int16 *buf, int len) {
+		int16 level = 0;
+		for (int channel = 0; channel < 16; ++channel) {
+			for (int note = 0; note < 128; ++note) {
+				if (_notes[channel][note])
+					level += (channel + 1) * note + _notes[channel][note];
+			}
+		}
+
+		for (int i = 0; i < len; ++i)
+			buf[i] = level;
+		_generated += len;
+	}
+
+	Common::String getRenderCacheId() const { return _cache ? "test" : ""; }
+
+	bool isRenderIdle() const {
+		for (int channel = 0; channel < 16; ++channel) {
+			for (int note = 0; note < 128; ++note) {
+				if (_notes[channel][note])
+					return false;
+			}
+		}
+		return true;
+	}
+
+private:
+	bool _cache;
+	byte _notes[16][128];
+};
+
+/**
+ * Plays a track of notes, each held for most of ten ticks, on three
+ * channels. A different note can be added on one tick, to diverge from the
+ * recording.
+ */
+class RenderCacheTestPlayer {
+public:
+	enum {
+		kTrackLength = 60,
+		kKey = 1234
+	};
+
+	RenderCacheTestPlayer(RenderCacheTestSynth &synth, int divergeTick) :
+		_synth(synth), _divergeTick(divergeTick), _tick(0), _trackGenerated(0) {}
+
+	static void timerProc(void *param) {
+		((RenderCacheTestPlayer *)param)->onTimer();
+	}
+
+	/** The frames the synth rendered until the end of the track. */
+	uint32 getTrackGenerated() const { return _trackGenerated; }
+
+private:
+	void onTimer() {
+		const int tick = _tick++;
+		if (tick >= kTrackLength)
+			return;
+
+		const uint32 note = ((40 + tick / 10) << 8) | ((tick / 10) % 3);
+		if (tick % 10 == 0)
+			_synth.send(0x90 | note | (100 << 16));
+		else if (tick % 10 == 7)
+			_synth.send(0x80 | note);
+
+		if (tick == _divergeTick)
+			_synth.send(0x9F | (90 << 8) | (64 << 16));
+
+		if (tick == kTrackLength - 1) {
+			_trackGenerated = _synth._generated;
+			_synth.property(MidiDriver::PROP_RENDER_CACHE_END, 1);
+		}
+	}
+
+	RenderCacheTestSynth &_synth;
+	int _divergeTick;
+	int _tick;
+	uint32 _trackGenerated;
+};
+
+class RenderCacheTestSuite : public CxxTest::TestSuite {
+private:
+	enum {
+		kFrames = 22050,	// One second, the track plays for 0.6
+		kBufferLength = 500
+	};
+
+	TestSystem _system;
+	RenderCacheTestFiles _files;
+
+	/**
+	 * Plays the track, and returns the output. generated is set to the
+	 * frames the synth rendered until the end of the track.
+	 */
+	Common::Array<int16> play(bool cache, int divergeTick, uint32 &generated) {
+		RenderCacheTestSynth synth(cache);
+		RenderCacheTestPlayer player(synth, divergeTick);
+		Common::Array<int16> output;
+		output.resize(kFrames);
+
+		synth.open();
+		synth.setTimerCallback(&player, &RenderCacheTestPlayer::timerProc);
+		synth.property(MidiDriver::PROP_RENDER_CACHE_BEGIN, RenderCacheTestPlayer::kKey);
+		for (uint32 pos = 0; pos < kFrames; pos += kBufferLength)
+			synth.readBuffer(&output[pos], MIN<uint32>(kBufferLength, kFrames - pos));
+		synth.property(MidiDriver::PROP_RENDER_CACHE_END, 0);
+		synth.close();
+
+		generated = player.getTrackGenerated();
+		return output;
+	}
+
+	Common::Array<int16> playLive(int divergeTick) {
+		uint32 generated;
+		return play(false, divergeTick, generated);
+	}
+
+	Common::StringArray getCacheFiles() {
+		return _system.getSavefileManager()->listSavefiles("midicache-*");
+	}
+
+	void record() {
+		uint32 generated;
+		TS_ASSERT(play(true, -1, generated) == playLive(-1));
+		TS_ASSERT_LESS_THAN(0u, generated);
+		TS_ASSERT_EQUALS(getCacheFiles().size(), 1u);
+	}
+
+public:
+	void setUp() {
+		_files.clear();
+		_system.install();
+		_system.setSavefileManager(new RenderCacheTestSaveFileManager(_files));
+		ConfMan.setBool("midi_render_cache", true, Common::ConfigManager::kTransientDomain);
+		ConfMan.setInt("midi_render_cache_size", 16, Common::ConfigManager::kTransientDomain);
+	}
+
+	void tearDown() {
+		ConfMan.removeKey("midi_render_cache", Common::ConfigManager::kTransientDomain);
+		ConfMan.removeKey("midi_render_cache_size", Common::ConfigManager::kTransientDomain);
+		_system.setSavefileManager(0);
+		_system.uninstall();
+	}
+
+	void test_replay() {
+		record();
+
+		// The notes are heard from the cache, the synth stays idle
+		uint32 generated;
+		TS_ASSERT(play(true, -1, generated) == playLive(-1));
+		TS_ASSERT_EQUALS(generated, 0u);
+		TS_ASSERT_EQUALS(getCacheFiles().size(), 1u);
+	}
+
+	void test_event_mismatch() {
+		record();
+
+		// The synth takes over with the notes held at that point, and the
+		// recording is kept for the next play
+		uint32 generated;
+		TS_ASSERT(play(true, 43, generated) == playLive(43));
+		TS_ASSERT_LESS_THAN(0u, generated);
+		TS_ASSERT_EQUALS(getCacheFiles().size(), 1u);
+
+		TS_ASSERT(play(true, -1, generated) == playLive(-1));
+		TS_ASSERT_EQUALS(generated, 0u);
+	}
+
+	void test_truncated_file() {
+		record();
+
+		// Falling back in the middle of a held note, the file is removed
+		Common::Array<byte> &file = _files[getCacheFiles()[0]];
+		file.resize(file.size() * 35 / 100);
+
+		uint32 generated;
+		TS_ASSERT(play(true, -1, generated) == playLive(-1));
+		TS_ASSERT_LESS_THAN(0u, generated);
+		TS_ASSERT_EQUALS(getCacheFiles().size(), 0u);
+	}
+};
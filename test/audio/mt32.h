@@ -0,0 +1,128 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/scummsys.h"
+
+#ifdef USE_MT32EMU
+#include "audio/softsynth/mt32/mt32emu.h"
+#include "audio/softsynth/mt32/BReverbModel.h"
+#include "audio/softsynth/mt32/SampleKernels.h"
+#endif
+
+class MT32RenderingTestSuite : public CxxTest::TestSuite
+{
+#ifdef USE_MT32EMU
+private:
+	uint32 _seed;
+
+	int16 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return (int16)(_seed >> 16);
+	}
+
+	/**
+	 * Fills a buffer with a signal resembling a recorded MIDI score: loud
+	 * noise bursts with samples at the limits, separated by silence so the
+	 * reverb tails are exercised too.
+	 */
+	void fillSignal(int16 *buf, int len, int offset) {
+		for (int i = 0; i < len; ++i) {
+			const int pos = (offset + i) % 6000;
+			if (pos < 2000)
+				buf[i] = nextRandom();
+			else if (pos < 2100)
+				buf[i] = (pos & 1) ? 32767 : -32768;
+			else
+				buf[i] = 0;
+		}
+	}
+
+	void compareReverb(MT32Emu::ReverbMode mode, bool mt32Compatible, uint8 time, uint8 level) {
+		static const int chunks[] = { 1, 77, 78, 200, 513, 1024, 31, 4096 };
+
+		MT32Emu::BReverbModel scalar(mode, mt32Compatible);
+		MT32Emu::BReverbModel block(mode, mt32Compatible);
+		scalar.open();
+		block.open();
+		scalar.setParameters(time, level);
+		block.setParameters(time, level);
+
+		int16 inLeft[4096], inRight[4096];
+		int16 scalarLeft[4096], scalarRight[4096], blockLeft[4096], blockRight[4096];
+
+		_seed = 1;
+		int offset = 0;
+		for (int pass = 0; pass < 4; ++pass) {
+			for (int c = 0; c < ARRAYSIZE(chunks); ++c) {
+				const int len = chunks[c];
+				fillSignal(inLeft, len, offset);
+				fillSignal(inRight, len, offset + 1000);
+				offset += len;
+
+				scalar.process(inLeft, inRight, scalarLeft, scalarRight, len);
+				block.processBlocks(inLeft, inRight, blockLeft, blockRight, len);
+
+				TS_ASSERT_EQUALS(memcmp(scalarLeft, blockLeft, len * sizeof(int16)), 0);
+				TS_ASSERT_EQUALS(memcmp(scalarRight, blockRight, len * sizeof(int16)), 0);
+			}
+		}
+
+		// Only one channel requested
+		fillSignal(inLeft, 1000, offset);
+		fillSignal(inRight, 1000, offset);
+		scalar.process(inLeft, inRight, scalarLeft, NULL, 1000);
+		block.processBlocks(inLeft, inRight, blockLeft, NULL, 1000);
+		TS_ASSERT_EQUALS(memcmp(scalarLeft, blockLeft, 1000 * sizeof(int16)), 0);
+	}
+
+	void compareReverbModes(bool mt32Compatible) {
+		static const uint8 parameters[][2] = { { 0, 0 }, { 5, 3 }, { 7, 7 }, { 1, 1 }, { 7, 2 } };
+
+		for (int mode = MT32Emu::REVERB_MODE_ROOM; mode <= MT32Emu::REVERB_MODE_TAP_DELAY; ++mode) {
+			for (int p = 0; p < ARRAYSIZE(parameters); ++p)
+				compareReverb((MT32Emu::ReverbMode)mode, mt32Compatible, parameters[p][0], parameters[p][1]);
+		}
+	}
+#endif
+
+public:
+	void test_reverb_cm32l() {
+#ifdef USE_MT32EMU
+		compareReverbModes(false);
+#endif
+	}
+
+	void test_reverb_mt32() {
+#ifdef USE_MT32EMU
+		compareReverbModes(true);
+#endif
+	}
+
+	void test_mix_panned() {
+#ifdef USE_MT32EMU
+		static const int32 pans[] = { 0, 18, 128, 256, -256, -146 };
+
+		int16 in[300], left[300], right[300], refLeft[300], refRight[300];
+
+		_seed = 7;
+		for (int p = 0; p < ARRAYSIZE(pans); ++p) {
+			for (int i = 0; i < ARRAYSIZE(in); ++i) {
+				in[i] = (i % 50 == 0) ? -32768 : nextRandom();
+				refLeft[i] = left[i] = nextRandom();
+				refRight[i] = right[i] = (i % 7 == 0) ? 32767 : nextRandom();
+			}
+
+			const int32 leftPan = pans[p];
+			const int32 rightPan = pans[ARRAYSIZE(pans) - 1 - p];
+			for (int i = 0; i < ARRAYSIZE(in); ++i) {
+				refLeft[i] = MT32Emu::Synth::clipSampleEx((int32)refLeft[i] + (int16)((in[i] * leftPan) >> 8));
+				refRight[i] = MT32Emu::Synth::clipSampleEx((int32)refRight[i] + (int16)((in[i] * rightPan) >> 8));
+			}
+
+			// Odd length to cover the scalar tail
+			MT32Emu::SampleKernels::mixPanned(left, right, in, leftPan, rightPan, ARRAYSIZE(in) - 3);
+			TS_ASSERT_EQUALS(memcmp(left, refLeft, (ARRAYSIZE(in) - 3) * sizeof(int16)), 0);
+			TS_ASSERT_EQUALS(memcmp(right, refRight, (ARRAYSIZE(in) - 3) * sizeof(int16)), 0);
+		}
+#endif
+	}
+};
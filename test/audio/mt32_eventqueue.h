@@ -0,0 +1,166 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/softsynth/mt32_eventqueue.h"
+#include "common/threadpool.h"
+
+class MT32EventQueueTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum {
+		kEventCount = 1024,
+		kSysExBufferSize = 8192,
+		kThreadedEvents = 200000
+	};
+
+	static void fillSysEx(byte *data, uint32 len, uint32 seed) {
+		for (uint32 i = 0; i < len; ++i)
+			data[i] = (seed * 31 + i) & 0x7F;
+	}
+
+	/** Pops the next event, which must be the given one. */
+	void checkPop(MidiEventQueue_MT32 &queue, uint32 msg, uint32 len, uint32 seed) {
+		uint32 poppedMsg, poppedLen;
+		const byte *data;
+		TS_ASSERT(queue.peek(poppedMsg, data, poppedLen));
+		TS_ASSERT_EQUALS(poppedMsg, msg);
+		TS_ASSERT_EQUALS(poppedLen, len);
+
+		if (len) {
+			byte expected[kSysExBufferSize];
+			fillSysEx(expected, len, seed);
+			TS_ASSERT(data);
+			TS_ASSERT_EQUALS(memcmp(data, expected, len), 0);
+		} else {
+			TS_ASSERT(!data);
+		}
+
+		queue.pop();
+	}
+
+	struct Producer {
+		MidiEventQueue_MT32 *queue;
+	};
+
+	/** Runs on the worker, pushing numbered events and some SysEx. */
+	static void produce(void *param) {
+		MidiEventQueue_MT32 &queue = *((Producer *)param)->queue;
+		byte sysEx[300];
+
+		for (uint32 i = 0; i < kThreadedEvents; ++i) {
+			const uint32 len = (i % 7 == 0) ? i % 300 + 1 : 0;
+			fillSysEx(sysEx, len, i);
+			while (!queue.push(len ? 0xFFFFFFFF : i, sysEx, len))
+				;
+		}
+	}
+
+public:
+	void test_order() {
+		MidiEventQueue_MT32 queue;
+		byte sysEx[100];
+		uint32 msg, len;
+		const byte *data;
+
+		TS_ASSERT(!queue.peek(msg, data, len));
+
+		for (uint32 i = 0; i < 10; ++i) {
+			fillSysEx(sysEx, i * 10, i);
+			TS_ASSERT(queue.push(0x90 | (i << 8), NULL, 0));
+			TS_ASSERT(queue.push(0xFFFFFFFF, sysEx, i * 10));
+		}
+
+		// The payload stays valid until the event is popped
+		TS_ASSERT(queue.peek(msg, data, len));
+		TS_ASSERT(queue.peek(msg, data, len));
+		for (uint32 i = 0; i < 10; ++i) {
+			checkPop(queue, 0x90 | (i << 8), 0, 0);
+			checkPop(queue, 0xFFFFFFFF, i * 10, i);
+		}
+
+		TS_ASSERT(!queue.peek(msg, data, len));
+		TS_ASSERT_EQUALS(queue.getOverflowCount(), 0u);
+	}
+
+	void test_sysex_wrap() {
+		MidiEventQueue_MT32 queue;
+		byte sysEx[3000];
+
+		// Payloads which do not fit before the end of the ring are stored
+		// from its start, and must come out whole
+		for (uint32 i = 0; i < 50; ++i) {
+			const uint32 len = 1000 + i * 37 % 1500;
+			fillSysEx(sysEx, len, i);
+			TS_ASSERT(queue.push(0xFFFFFFFF, sysEx, len));
+			if (i >= 1)
+				checkPop(queue, 0xFFFFFFFF, 1000 + (i - 1) * 37 % 1500, i - 1);
+		}
+		checkPop(queue, 0xFFFFFFFF, 1000 + 49 * 37 % 1500, 49);
+		TS_ASSERT_EQUALS(queue.getOverflowCount(), 0u);
+	}
+
+	void test_overflow() {
+		MidiEventQueue_MT32 queue;
+		byte sysEx[kSysExBufferSize + 1];
+		fillSysEx(sysEx, sizeof(sysEx), 0);
+
+		for (uint32 i = 0; i < kEventCount; ++i)
+			TS_ASSERT(queue.push(i, NULL, 0));
+		TS_ASSERT(!queue.push(kEventCount, NULL, 0));
+		TS_ASSERT_EQUALS(queue.getOverflowCount(), 1u);
+
+		// Room is made by the consumer
+		checkPop(queue, 0, 0, 0);
+		TS_ASSERT(queue.push(kEventCount, NULL, 0));
+		for (uint32 i = 1; i <= kEventCount; ++i)
+			checkPop(queue, i, 0, 0);
+
+		// SysEx payloads fill up their own ring
+		TS_ASSERT(!queue.push(0xFFFFFFFF, sysEx, kSysExBufferSize + 1));
+		TS_ASSERT(queue.push(0xFFFFFFFF, sysEx, kSysExBufferSize / 2));
+		TS_ASSERT(queue.push(0xFFFFFFFF, sysEx, kSysExBufferSize / 2));
+		TS_ASSERT(!queue.push(0xFFFFFFFF, sysEx, 1));
+		TS_ASSERT(queue.push(1, NULL, 0));
+		TS_ASSERT_EQUALS(queue.getOverflowCount(), 3u);
+
+		queue.reset();
+		uint32 msg, len;
+		const byte *data;
+		TS_ASSERT(!queue.peek(msg, data, len));
+		TS_ASSERT_EQUALS(queue.getOverflowCount(), 0u);
+		TS_ASSERT(queue.push(0xFFFFFFFF, sysEx, kSysExBufferSize));
+	}
+
+	void test_threads() {
+		// The producer must run alongside, or it would wait forever on a
+		// full queue
+		Common::WorkerThread worker;
+		if (!worker.isThreaded())
+			return;
+
+		MidiEventQueue_MT32 *queue = new MidiEventQueue_MT32();
+		Producer producer;
+		producer.queue = queue;
+		worker.addJob(produce, &producer);
+
+		uint32 errors = 0;
+		for (uint32 i = 0; i < kThreadedEvents; ) {
+			uint32 msg, len;
+			const byte *data;
+			if (!queue->peek(msg, data, len))
+				continue;
+
+			const uint32 expectedLen = (i % 7 == 0) ? i % 300 + 1 : 0;
+			byte expected[300];
+			fillSysEx(expected, expectedLen, i);
+			if (msg != (expectedLen ? 0xFFFFFFFF : i) || len != expectedLen || (len && memcmp(data, expected, len)))
+				++errors;
+
+			queue->pop();
+			++i;
+		}
+
+		worker.waitAll();
+		TS_ASSERT_EQUALS(errors, 0u);
+		delete queue;
+	}
+};
@@ -0,0 +1,133 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/mixer_intern.h"
+
+#include "opl_helper.h"
+#include "../common/system_helper.h"
+
+#ifndef DISABLE_DOSBOX_OPL
+#include "audio/softsynth/opl/dosbox.h"
+#endif
+
+class OPLTestSuite : public CxxTest::TestSuite
+{
+#ifndef DISABLE_DOSBOX_OPL
+private:
+	TestSystem _system;
+
+	/**
+	 * Plays a tune through the DOSBox emulator, reading its output in
+	 * pieces of the given sizes. Before some of the pieces, a register is
+	 * written through the ports, like a driver outside the timer callback
+	 * would. The output has to match rendering straight from the DBOPL
+	 * emulator, with all the writes made at the same frames.
+	 */
+	void compareRendering(bool opl3, uint32 rate, uint32 tickLength, const uint32 *bufferLengths, uint bufferLengthCount) {
+		Audio::MixerImpl mixer(&_system, rate);
+		mixer.setReady(true);
+		_system.setMixer(&mixer);
+
+		const uint32 frames = rate * 2;
+		const uint32 samples = opl3 ? frames * 2 : frames;
+		const Common::Array<OPLTuneWrite> writes = makeOPLTune(opl3, frames, tickLength);
+		Common::Array<OPLTuneWrite> outsideWrites;
+
+		int16 *buffer = new int16[samples];
+		int16 *expected = new int16[samples];
+
+		OPL::DOSBox::OPL *opl = new OPL::DOSBox::OPL(opl3 ? OPL::Config::kOpl3 : OPL::Config::kOpl2);
+		TS_ASSERT(opl->init());
+		TS_ASSERT_EQUALS(opl->isStereo(), opl3);
+		OPLTunePlayer player(opl, writes, tickLength);
+		player.start(rate);
+
+		for (uint32 pos = 0, piece = 0; pos < frames; ++piece) {
+			const uint32 length = MIN<uint32>(bufferLengths[piece % bufferLengthCount], frames - pos);
+
+			if (pos && piece % 3 == 0) {
+				OPLTuneWrite write;
+				write.time = pos;
+				write.reg = ((opl3 && piece % 2) ? 0x100 : 0) + 0xA0 + piece % 9;
+				write.val = piece & 0xFF;
+				outsideWrites.push_back(write);
+
+				if (write.reg >= 0x100) {
+					opl->write(0x222, write.reg & 0xFF);
+					opl->write(0x223, write.val);
+				} else {
+					opl->write(0x388, write.reg);
+					opl->write(0x389, write.val);
+				}
+			}
+
+			TS_ASSERT_EQUALS(opl->readBuffer(buffer + (opl3 ? pos * 2 : pos), opl3 ? length * 2 : length), (int)(opl3 ? length * 2 : length));
+			pos += length;
+		}
+
+		delete opl;
+		_system.setMixer(0);
+
+		// Ticks falling onto the end of a piece are run at the end of it,
+		// before the writes made outside
+		Common::Array<OPLTuneWrite> allWrites;
+		for (uint tune = 0, outside = 0; tune < writes.size() || outside < outsideWrites.size(); ) {
+			if (outside == outsideWrites.size() || (tune < writes.size() && writes[tune].time <= outsideWrites[outside].time))
+				allWrites.push_back(writes[tune++]);
+			else
+				allWrites.push_back(outsideWrites[outside++]);
+		}
+
+		OPL::DOSBox::DBOPL::InitTables();
+		OPL::DOSBox::DBOPL::Chip chip;
+		chip.Setup(rate);
+		// DBOPL does not render OPL3 output exactly the same when the blocks
+		// are split differently, so render in the same pieces
+		uint next = 0;
+		for (uint32 pos = 0, piece = 0; pos < frames; ++piece) {
+			const uint32 length = MIN<uint32>(bufferLengths[piece % bufferLengthCount], frames - pos);
+			renderOPLFrames(chip, allWrites, next, expected, pos, pos + length);
+			pos += length;
+		}
+
+		TS_ASSERT_EQUALS(memcmp(buffer, expected, samples * sizeof(int16)), 0);
+
+		delete[] buffer;
+		delete[] expected;
+	}
+#endif
+
+public:
+	void setUp() {
+#ifndef DISABLE_DOSBOX_OPL
+		_system.install();
+#endif
+	}
+
+	void tearDown() {
+#ifndef DISABLE_DOSBOX_OPL
+		_system.uninstall();
+#endif
+	}
+
+	void test_dosbox_opl2() {
+#ifndef DISABLE_DOSBOX_OPL
+		const uint32 mixed[] = { 2048, 1, 777, 315 };
+		const uint32 single[] = { 1000 };
+		const uint32 tiny[] = { 7 };
+
+		compareRendering(false, 22050, 315, mixed, ARRAYSIZE(mixed));
+		compareRendering(false, 44100, 441, single, ARRAYSIZE(single));
+		compareRendering(false, 48000, 1, tiny, ARRAYSIZE(tiny));
+#endif
+	}
+
+	void test_dosbox_opl3() {
+#ifndef DISABLE_DOSBOX_OPL
+		const uint32 mixed[] = { 2048, 1, 777, 315 };
+		const uint32 single[] = { 1000 };
+
+		compareRendering(true, 22050, 315, mixed, ARRAYSIZE(mixed));
+		compareRendering(true, 44100, 441, single, ARRAYSIZE(single));
+#endif
+	}
+};
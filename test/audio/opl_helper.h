@@ -0,0 +1,147 @@
+#ifndef TEST_SOUND_OPL_HELPER_H
+#define TEST_SOUND_OPL_HELPER_H
+
+#include "common/array.h"
+#include "common/func.h"
+
+#ifndef DISABLE_DOSBOX_OPL
+#include "audio/fmopl.h"
+#include "audio/softsynth/opl/dbopl.h"
+
+/**
+ * A register write of a tune, along with the frame it is made at.
+ */
+struct OPLTuneWrite {
+	uint32 time;
+	uint16 reg;
+	uint8 val;
+};
+
+static uint32 nextOPLTuneRandom(uint32 &seed) {
+	seed = seed * 1103515245 + 12345;
+	return seed >> 16;
+}
+
+static void addOPLWrite(Common::Array<OPLTuneWrite> &writes, uint32 time, uint16 reg, uint8 val) {
+	OPLTuneWrite write;
+	write.time = time;
+	write.reg = reg;
+	write.val = val;
+	writes.push_back(write);
+}
+
+/**
+ * Creates the register writes of a tune, made on timer ticks like a
+ * music driver would: instrument setup, notes on and off, with vibrato,
+ * tremolo, feedback and percussion.
+ */
+static Common::Array<OPLTuneWrite> makeOPLTune(bool opl3, uint32 frames, uint32 tickLength) {
+	Common::Array<OPLTuneWrite> writes;
+	uint32 seed = 3;
+	const uint16 banks = opl3 ? 2 : 1;
+
+	addOPLWrite(writes, 0, 0x01, 0x20);
+	if (opl3)
+		addOPLWrite(writes, 0, 0x105, 0x01);
+
+	for (uint16 bank = 0; bank < banks; ++bank) {
+		const uint16 base = bank * 0x100;
+		for (uint16 op = 0; op < 0x16; ++op) {
+			if ((op & 7) > 5)
+				continue;
+			addOPLWrite(writes, 0, base + 0x20 + op, 0x20 | (nextOPLTuneRandom(seed) & 0xDF));
+			addOPLWrite(writes, 0, base + 0x40 + op, nextOPLTuneRandom(seed) & 0x3F);
+			addOPLWrite(writes, 0, base + 0x60 + op, 0x88 | (nextOPLTuneRandom(seed) & 0x77));
+			addOPLWrite(writes, 0, base + 0x80 + op, nextOPLTuneRandom(seed) & 0xFF);
+			addOPLWrite(writes, 0, base + 0xE0 + op, nextOPLTuneRandom(seed) & (opl3 ? 7 : 3));
+		}
+		for (uint16 ch = 0; ch < 9; ++ch)
+			addOPLWrite(writes, 0, base + 0xC0 + ch, (opl3 ? 0x30 : 0) | (nextOPLTuneRandom(seed) & 0x0F));
+	}
+
+	for (uint32 time = tickLength, tick = 0; time < frames; time += tickLength, ++tick) {
+		const uint16 base = (opl3 && (tick & 1)) ? 0x100 : 0;
+		const uint16 ch = nextOPLTuneRandom(seed) % 9;
+
+		if (tick % 3 == 0) {
+			addOPLWrite(writes, time, base + 0xB0 + ch, 0x00);
+		} else {
+			addOPLWrite(writes, time, base + 0xA0 + ch, nextOPLTuneRandom(seed) & 0xFF);
+			addOPLWrite(writes, time, base + 0xB0 + ch, 0x20 | (nextOPLTuneRandom(seed) & 0x1F));
+		}
+		if (tick % 16 == 5)
+			addOPLWrite(writes, time, 0xBD, 0xE0 | (nextOPLTuneRandom(seed) & 0x1F));
+	}
+
+	return writes;
+}
+
+/**
+ * Renders frames of a tune straight from the DBOPL emulator, from pos up to
+ * end, writing the registers at their frames. next is the first write not
+ * made yet. OPL3 output is stereo once OPL3 mode is enabled.
+ */
+static void renderOPLFrames(OPL::DOSBox::DBOPL::Chip &chip, const Common::Array<OPLTuneWrite> &writes, uint &next, int16 *buffer, uint32 pos, uint32 end) {
+	int32 tempBuffer[512 * 2];
+
+	while (pos < end) {
+		while (next < writes.size() && writes[next].time <= pos) {
+			chip.WriteReg(writes[next].reg, writes[next].val);
+			++next;
+		}
+
+		const uint32 writeEnd = (next < writes.size()) ? MIN<uint32>(writes[next].time, end) : end;
+		while (pos < writeEnd) {
+			const uint32 step = MIN<uint32>(writeEnd - pos, 512);
+			if (chip.opl3Active) {
+				chip.GenerateBlock3(step, tempBuffer);
+				for (uint32 i = 0; i < step * 2; ++i)
+					buffer[pos * 2 + i] = tempBuffer[i];
+			} else {
+				chip.GenerateBlock2(step, tempBuffer);
+				for (uint32 i = 0; i < step; ++i)
+					buffer[pos + i] = tempBuffer[i];
+			}
+			pos += step;
+		}
+	}
+}
+
+/**
+ * Renders a whole tune straight from the DBOPL emulator.
+ */
+static void renderOPLPerTick(OPL::DOSBox::DBOPL::Chip &chip, const Common::Array<OPLTuneWrite> &writes, int16 *buffer, uint32 frames) {
+	uint next = 0;
+	renderOPLFrames(chip, writes, next, buffer, 0, frames);
+}
+
+/**
+ * Plays a tune through an OPL, making the writes of each tick from its
+ * timer callback.
+ */
+class OPLTunePlayer {
+public:
+	OPLTunePlayer(OPL::OPL *opl, const Common::Array<OPLTuneWrite> &writes, uint32 tickLength) :
+		_opl(opl), _writes(writes), _tickLength(tickLength), _tick(0), _next(0) {}
+
+	void start(uint32 rate) {
+		_opl->start(new Common::Functor0Mem<void, OPLTunePlayer>(this, &OPLTunePlayer::onTimer), rate / _tickLength);
+	}
+
+private:
+	void onTimer() {
+		const uint32 time = _tick++ * _tickLength;
+		for (; _next < _writes.size() && _writes[_next].time <= time; ++_next)
+			_opl->writeReg(_writes[_next].reg, _writes[_next].val);
+	}
+
+	OPL::OPL *_opl;
+	const Common::Array<OPLTuneWrite> &_writes;
+	uint32 _tickLength;
+	uint32 _tick;
+	uint _next;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,123 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/rate.h"
+
+#include "helper.h"
+
+class RateConverterTestSuite : public CxxTest::TestSuite
+{
+private:
+	/**
+	 * Runs a converter over a sine and returns the mix. The output buffer is
+	 * prefilled close to the limits so the saturation gets exercised.
+	 */
+	int16 *convert(Audio::RateConverterBackend backend, int inRate, int outRate, bool stereo, bool reverseStereo,
+	               Audio::st_volume_t volL, Audio::st_volume_t volR, int &frames) {
+		Audio::SeekableAudioStream *s = createSineStream<int16>(inRate, 1, 0, false, stereo);
+
+		const Audio::RateConverterBackend oldBackend = Audio::getRateConverterBackend();
+		TS_ASSERT(Audio::setRateConverterBackend(backend));
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, stereo, reverseStereo);
+		Audio::setRateConverterBackend(oldBackend);
+
+		const int outFrames = outRate + 100;
+		int16 *out = new int16[outFrames * 2];
+		for (int i = 0; i < outFrames * 2; ++i)
+			out[i] = (i % 3) ? 30000 - i : i - 30000;
+
+		// Pull in odd sized pieces, like the mixer does
+		frames = 0;
+		int got;
+		do {
+			got = converter->flow(*s, out + frames * 2, MIN(333, outFrames - frames), volL, volR);
+			frames += got;
+		} while (got > 0 && frames < outFrames);
+
+		delete converter;
+		delete s;
+		return out;
+	}
+
+	void compareBackends(int inRate, int outRate, bool stereo, bool reverseStereo) {
+		static const Audio::st_volume_t volumes[][2] = { { 256, 256 }, { 255, 128 }, { 0, 77 }, { 1, 200 } };
+
+		if (!Audio::hasRateConverterBackend(Audio::kRateConverterSIMD))
+			return;
+
+		for (int v = 0; v < ARRAYSIZE(volumes); ++v) {
+			int genericFrames, simdFrames;
+			int16 *generic = convert(Audio::kRateConverterGeneric, inRate, outRate, stereo, reverseStereo, volumes[v][0], volumes[v][1], genericFrames);
+			int16 *simd = convert(Audio::kRateConverterSIMD, inRate, outRate, stereo, reverseStereo, volumes[v][0], volumes[v][1], simdFrames);
+
+			TS_ASSERT_EQUALS(genericFrames, simdFrames);
+			TS_ASSERT_EQUALS(memcmp(generic, simd, sizeof(int16) * (outRate + 100) * 2), 0);
+
+			delete[] generic;
+			delete[] simd;
+		}
+	}
+
+public:
+	void test_copy_generic() {
+		const int rate = 11025;
+		int16 *sine;
+		Audio::SeekableAudioStream *s = createSineStream<int16>(rate, 1, &sine, false, true);
+
+		const Audio::RateConverterBackend oldBackend = Audio::getRateConverterBackend();
+		Audio::setRateConverterBackend(Audio::kRateConverterGeneric);
+		Audio::RateConverter *converter = Audio::makeRateConverter(rate, rate, true, true);
+		Audio::setRateConverterBackend(oldBackend);
+
+		int16 *out = new int16[rate * 2];
+		for (int i = 0; i < rate * 2; ++i)
+			out[i] = (i & 1) ? 32000 : -1000;
+
+		TS_ASSERT_EQUALS(converter->flow(*s, out, rate, 200, 100), rate);
+
+		// Reversed stereo, volume applied with a shift, saturated add
+		for (int i = 0; i < rate; ++i) {
+			const int left = CLIP(-1000 + ((sine[i * 2 + 1] * 100) >> 8), -32768, 32767);
+			const int right = CLIP(32000 + ((sine[i * 2] * 200) >> 8), -32768, 32767);
+			TS_ASSERT_EQUALS(out[i * 2], left);
+			TS_ASSERT_EQUALS(out[i * 2 + 1], right);
+		}
+
+		delete[] out;
+		delete[] sine;
+		delete converter;
+		delete s;
+	}
+
+	void test_copy_simd_mono() {
+		compareBackends(22050, 22050, false, false);
+	}
+
+	void test_copy_simd_stereo() {
+		compareBackends(22050, 22050, true, false);
+	}
+
+	void test_copy_simd_reverse_stereo() {
+		compareBackends(22050, 22050, true, true);
+	}
+
+	void test_simple_simd_mono() {
+		compareBackends(44100, 22050, false, false);
+	}
+
+	void test_simple_simd_reverse_stereo() {
+		compareBackends(44100, 11025, true, true);
+	}
+
+	void test_linear_simd_mono() {
+		compareBackends(11025, 44100, false, false);
+	}
+
+	void test_linear_simd_stereo() {
+		compareBackends(22050, 48000, true, false);
+	}
+
+	void test_linear_simd_reverse_stereo() {
+		compareBackends(32000, 44100, true, true);
+	}
+};
@@ -0,0 +1,89 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "common/util.h"
+
+#ifdef USE_BINK
+#include "video/bink_dsp.h"
+#endif
+
+#include "test/benchmark/benchmark.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * The Bink IDCT and block copy functions with each backend.
+ */
+void benchmarkBinkDSP() {
+#ifdef USE_BINK
+	static const char *const names[] = { "IDCT put", "IDCT add", "copy" };
+	const int pitch = 48;
+	const uint32 blockCount = 2000000;
+
+	// Coefficients like the bitstream has them: the first row and a few
+	// others set, the rest zero
+	int16 blocks[16][64];
+	uint32 seed = 5;
+	for (int b = 0; b < 16; b++) {
+		for (int i = 0; i < 64; i++) {
+			seed = seed * 1103515245 + 12345;
+			const bool set = (i < 8 || ((seed >> 16) & 3) == 0);
+			seed = seed * 1103515245 + 12345;
+			blocks[b][i] = set ? (int16)(((seed >> 16) % 4096) - 2048) : 0;
+		}
+	}
+
+	byte plane[pitch * 24];
+	memset(plane, 0, sizeof(plane));
+
+	const Video::BinkDSPBackend oldBackend = Video::getBinkDSPBackend();
+
+	printf("Bink block functions, %u blocks per case\n", blockCount);
+	for (int b = 0; b < 2; b++) {
+		if (!Video::setBinkDSPBackend(b ? Video::kBinkDSPSIMD : Video::kBinkDSPGeneric))
+			continue;
+
+		for (int f = 0; f < ARRAYSIZE(names); f++) {
+			int16 block[64];
+			const clock_t start = clock();
+			for (uint32 i = 0; i < blockCount; i++) {
+				memcpy(block, blocks[i & 15], sizeof(block));
+				if (f == 0)
+					Video::binkIDCTPut(plane + (i & 7), pitch, block);
+				else if (f == 1)
+					Video::binkIDCTAdd(plane + (i & 7), pitch, block);
+				else
+					Video::binkCopyBlock(plane + (i & 7), plane + 8 * pitch, pitch);
+			}
+			const double msecs = msecsSince(start);
+
+			printf("  %-8s %-8s %8.2f ms %10.0f blocks/s\n", b ? "simd" : "generic", names[f],
+			       msecs, msecs > 0 ? blockCount * 1000.0 / msecs : 0.0);
+		}
+	}
+
+	Video::setBinkDSPBackend(oldBackend);
+#endif
+}
@@ -0,0 +1,86 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+/*
+ * Timings of the code paths which have several implementations, e.g. a
+ * generic and a SIMD one. They are kept out of the unit tests, which only
+ * check that the implementations give the same results.
+ *
+ * Usage: benchmark [<name>...]
+ * Runs the given benchmarks, or all of them.
+ */
+
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "common/util.h"
+
+#include "test/benchmark/benchmark.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const struct {
+	const char *name;
+	void (*run)();
+} benchmarks[] = {
+	{ "rate", benchmarkRateConverter },
+	{ "opl", benchmarkOPL },
+	{ "threadpool", benchmarkThreadPool },
+	{ "md5", benchmarkMD5 },
+	{ "yuv", benchmarkYUVToRGB },
+	{ "bink", benchmarkBinkDSP }
+};
+
+double msecsSince(clock_t start) {
+	return (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char *argv[]) {
+	for (int i = 1; i < argc; ++i) {
+		bool found = false;
+		for (int b = 0; b < ARRAYSIZE(benchmarks); ++b)
+			found |= !strcmp(argv[i], benchmarks[b].name);
+		if (!found) {
+			fprintf(stderr, "Usage: %s [<name>...]\nBenchmarks:", argv[0]);
+			for (int b = 0; b < ARRAYSIZE(benchmarks); ++b)
+				fprintf(stderr, " %s", benchmarks[b].name);
+			fprintf(stderr, "\n");
+			return 1;
+		}
+	}
+
+	bool first = true;
+	for (int b = 0; b < ARRAYSIZE(benchmarks); ++b) {
+		bool run = (argc < 2);
+		for (int i = 1; i < argc; ++i)
+			run |= !strcmp(argv[i], benchmarks[b].name);
+		if (!run)
+			continue;
+
+		if (!first)
+			printf("\n");
+		first = false;
+		benchmarks[b].run();
+	}
+
+	return 0;
+}
@@ -0,0 +1,61 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "common/md5.h"
+#include "common/memstream.h"
+#include "common/str.h"
+
+#include "test/benchmark/benchmark.h"
+
+#include <stdio.h>
+
+/**
+ * The MD5 throughput on a large buffer, and on the beginnings of many files
+ * like the detection hashes them.
+ */
+void benchmarkMD5() {
+	const uint32 size = 32 * 1024 * 1024;
+	byte *data = new byte[size];
+	for (uint32 i = 0; i < size; i++)
+		data[i] = (byte)(i * 7);
+
+	Common::MemoryReadStream stream(data, size);
+	clock_t start = clock();
+	Common::computeStreamMD5AsString(stream);
+	double msecs = msecsSince(start);
+	printf("MD5 of %u MB: %8.2f ms %8.1f MB/s\n", size / (1024 * 1024), msecs,
+	       msecs > 0 ? size * 1000.0 / msecs / (1024 * 1024) : 0.0);
+
+	const uint32 files = 20000;
+	start = clock();
+	for (uint32 i = 0; i < files; i++) {
+		Common::MemoryReadStream file(data + i * 16, 100000);
+		Common::computeStreamMD5AsString(file, 5000);
+	}
+	msecs = msecsSince(start);
+	printf("MD5 of the first 5000 bytes of %u files: %8.2f ms %8.0f files/s\n", files, msecs,
+	       msecs > 0 ? files * 1000.0 / msecs : 0.0);
+
+	delete[] data;
+}
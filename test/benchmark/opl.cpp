@@ -0,0 +1,87 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "audio/mixer_intern.h"
+#include "test/audio/opl_helper.h"
+#include "test/benchmark/benchmark.h"
+#include "test/common/system_helper.h"
+
+#ifndef DISABLE_DOSBOX_OPL
+#include "audio/softsynth/opl/dosbox.h"
+#endif
+
+#include <stdio.h>
+
+/**
+ * The DOSBox OPL emulator playing a tune for 20 seconds of output, in
+ * buffers of 2048 frames, compared with rendering straight from DBOPL.
+ */
+void benchmarkOPL() {
+#ifndef DISABLE_DOSBOX_OPL
+	const uint32 rate = 44100;
+	const uint32 frames = rate * 20;
+	const uint32 tickLength = rate / 70;
+	const uint32 bufferLength = 2048;
+	int16 *buffer = new int16[frames * 2];
+
+	TestSystem system;
+	system.install();
+	Audio::MixerImpl *mixer = new Audio::MixerImpl(&system, rate);
+	mixer->setReady(true);
+	system.setMixer(mixer);
+
+	printf("DOSBox OPL, %u seconds of output per case\n", frames / rate);
+	for (int opl3 = 0; opl3 < 2; ++opl3) {
+		const Common::Array<OPLTuneWrite> writes = makeOPLTune(opl3 != 0, frames, tickLength);
+
+		for (int emulator = 0; emulator < 2; ++emulator) {
+			OPL::DOSBox::DBOPL::InitTables();
+			OPL::DOSBox::DBOPL::Chip chip;
+			chip.Setup(rate);
+			OPL::DOSBox::OPL opl(opl3 ? OPL::Config::kOpl3 : OPL::Config::kOpl2);
+			opl.init();
+			OPLTunePlayer player(&opl, writes, tickLength);
+			player.start(rate);
+
+			const clock_t start = clock();
+			if (emulator) {
+				const int stereoFactor = opl3 ? 2 : 1;
+				for (uint32 pos = 0; pos < frames; pos += bufferLength)
+					opl.readBuffer(buffer + pos * stereoFactor, MIN(bufferLength, frames - pos) * stereoFactor);
+			} else {
+				renderOPLPerTick(chip, writes, buffer, frames);
+			}
+			const double msecs = msecsSince(start);
+
+			printf("  %-5s %-9s %8.2f ms %10.0f samples/s\n", opl3 ? "opl3" : "opl2", emulator ? "emulator" : "dbopl",
+			       msecs, msecs > 0 ? frames * 1000.0 / msecs : 0.0);
+		}
+	}
+
+	system.setMixer(0);
+	delete mixer;
+	system.uninstall();
+	delete[] buffer;
+#endif
+}
@@ -0,0 +1,93 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "common/memstream.h"
+#include "common/util.h"
+
+#include "audio/audiostream.h"
+#include "audio/rate.h"
+
+#include "test/audio/helper.h"
+#include "test/benchmark/benchmark.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * The rate converter backends on the three conversion kinds, each run for
+ * 200 seconds of stereo output.
+ */
+void benchmarkRateConverter() {
+	static const struct {
+		const char *name;
+		int inRate, outRate;
+	} cases[] = {
+		{ "copy", 44100, 44100 },
+		{ "simple", 44100, 22050 },
+		{ "linear", 22050, 44100 }
+	};
+	static const struct {
+		const char *name;
+		Audio::RateConverterBackend backend;
+	} backends[] = {
+		{ "generic", Audio::kRateConverterGeneric },
+		{ "simd", Audio::kRateConverterSIMD },
+		{ "arm", Audio::kRateConverterARM }
+	};
+
+	const int iterations = 200;
+	const Audio::RateConverterBackend oldBackend = Audio::getRateConverterBackend();
+	int16 *out = new int16[44100 * 2];
+
+	printf("Rate converter, %d seconds of stereo output per case\n", iterations);
+	for (int c = 0; c < ARRAYSIZE(cases); ++c) {
+		for (int b = 0; b < ARRAYSIZE(backends); ++b) {
+			if (!Audio::setRateConverterBackend(backends[b].backend))
+				continue;
+
+			Audio::SeekableAudioStream *s = createSineStream<int16>(cases[c].inRate, 1, 0, false, true);
+			Audio::RateConverter *converter = Audio::makeRateConverter(cases[c].inRate, cases[c].outRate, true, false);
+			memset(out, 0, sizeof(int16) * 44100 * 2);
+
+			const clock_t start = clock();
+			for (int i = 0; i < iterations; ++i) {
+				s->rewind();
+				for (int frames = 0; frames < cases[c].outRate; ) {
+					const int got = converter->flow(*s, out + frames * 2, MIN(1024, cases[c].outRate - frames), 200, 180);
+					if (got <= 0)
+						break;
+					frames += got;
+				}
+			}
+
+			printf("  %-8s %-8s %8.2f ms\n", cases[c].name, backends[b].name, msecsSince(start));
+
+			delete converter;
+			delete s;
+		}
+	}
+
+	Audio::setRateConverterBackend(oldBackend);
+	delete[] out;
+}
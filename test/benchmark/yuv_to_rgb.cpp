@@ -0,0 +1,99 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "common/util.h"
+
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+
+#include "test/benchmark/benchmark.h"
+
+#include <stdio.h>
+
+/**
+ * The YUV to RGB backends converting 200 frames of 640x480, for each
+ * subsampling and destination depth.
+ */
+void benchmarkYUVToRGB() {
+	static const char *const subsamplingNames[] = { "444", "420", "410" };
+	const int width = 640, height = 480;
+	const int frames = 200;
+
+	// The chroma planes have the extra row and column which convert410 reads
+	const int yPitch = width, uvPitch = width + 1;
+	byte *y = new byte[yPitch * height];
+	byte *u = new byte[uvPitch * (height + 1)];
+	byte *v = new byte[uvPitch * (height + 1)];
+	uint32 seed = 1;
+	for (int i = 0; i < yPitch * height; ++i) {
+		seed = seed * 1103515245 + 12345;
+		y[i] = seed >> 16;
+	}
+	for (int i = 0; i < uvPitch * (height + 1); ++i) {
+		seed = seed * 1103515245 + 12345;
+		u[i] = seed >> 16;
+		v[i] = seed >> 24;
+	}
+
+	const Graphics::YUVToRGBManager::Backend oldBackend = YUVToRGBMan.getBackend();
+
+	printf("YUV to RGB, %d frames of %dx%d\n", frames, width, height);
+	for (int subsampling = 0; subsampling < ARRAYSIZE(subsamplingNames); ++subsampling) {
+		for (int bytesPerPixel = 2; bytesPerPixel <= 4; bytesPerPixel += 2) {
+			Graphics::Surface dst;
+			dst.create(width, height, (bytesPerPixel == 2) ? Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0) : Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0));
+
+			for (int backend = 0; backend < 2; ++backend) {
+				if (!YUVToRGBMan.setBackend((Graphics::YUVToRGBManager::Backend)backend))
+					continue;
+
+				const clock_t start = clock();
+				for (int i = 0; i < frames; ++i) {
+					switch (subsampling) {
+					case 0:
+						YUVToRGBMan.convert444(&dst, Graphics::YUVToRGBManager::kScaleITU, y, u, v, width, height, yPitch, uvPitch);
+						break;
+					case 1:
+						YUVToRGBMan.convert420(&dst, Graphics::YUVToRGBManager::kScaleITU, y, u, v, width, height, yPitch, uvPitch);
+						break;
+					default:
+						YUVToRGBMan.convert410(&dst, Graphics::YUVToRGBManager::kScaleITU, y, u, v, width, height, yPitch, uvPitch);
+						break;
+					}
+				}
+				const double msecs = msecsSince(start);
+
+				printf("  %s %d bpp %-6s %8.2f ms %8.1f frames/s\n", subsamplingNames[subsampling], bytesPerPixel * 8,
+				       backend ? "simd" : "lookup", msecs, msecs > 0 ? frames * 1000.0 / msecs : 0.0);
+			}
+
+			dst.free();
+		}
+	}
+
+	YUVToRGBMan.setBackend(oldBackend);
+	delete[] y;
+	delete[] u;
+	delete[] v;
+}
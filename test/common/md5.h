@@ -1,6 +1,7 @@
 #include <cxxtest/TestSuite.h>
 
 #include "common/md5.h"
+#include "common/memstream.h"
 #include "common/stream.h"
 
 /*
@@ -27,6 +28,21 @@ static const char *md5_test_digest[] = {
 	"57edf4a22be3c955ac49da2e2107b67a"
 };
 
+/**
+ * A stream which returns less than asked for on each read before its end,
+ * like pipes or network streams do.
+ */
+class ShortReadStream : public Common::ReadStream {
+public:
+	ShortReadStream(const byte *data, uint32 size) : _stream(data, size) {}
+
+	bool eos() const { return _stream.eos(); }
+	uint32 read(void *dataPtr, uint32 dataSize) { return _stream.read(dataPtr, MIN<uint32>(dataSize, 1000)); }
+
+private:
+	Common::MemoryReadStream _stream;
+};
+
 class MD5TestSuite : public CxxTest::TestSuite {
 	public:
 	void test_computeStreamMD5() {
@@ -47,4 +63,105 @@ class MD5TestSuite : public CxxTest::TestSuite {
 		}
 	}
 
+	void test_incremental() {
+		// Feed the test vectors in pieces of every size, from unaligned
+		// addresses
+		char buffer[100];
+		for (int i = 0; i < 7; i++) {
+			const uint32 length = strlen(md5_test_string[i]);
+			for (uint32 piece = 1; piece <= length + 1; piece++) {
+				memcpy(buffer + 1, md5_test_string[i], length);
+
+				Common::MD5 md5;
+				for (uint32 pos = 0; pos < length; pos += piece)
+					md5.update(buffer + 1 + pos, MIN(piece, length - pos));
+				TS_ASSERT_EQUALS(md5.finishAsString(), md5_test_digest[i]);
+			}
+		}
+
+		// Streams, and reuse after reset()
+		Common::MD5 md5;
+		Common::MemoryReadStream stream((const byte *)md5_test_string[6], strlen(md5_test_string[6]));
+		TS_ASSERT_EQUALS(md5.update(stream, 62), 62u);
+		TS_ASSERT_EQUALS(md5.update(stream), 18u);
+		TS_ASSERT_EQUALS(md5.finishAsString(), md5_test_digest[6]);
+
+		md5.reset();
+		md5.update(md5_test_string[2], 3);
+		TS_ASSERT_EQUALS(md5.finishAsString(), md5_test_digest[2]);
+	}
+
+	void test_large() {
+		// Several blocks at once, compared to block by block hashing
+		const uint32 size = 100000;
+		byte *data = new byte[size + 1];
+		for (uint32 i = 0; i < size + 1; i++)
+			data[i] = (byte)(i * 7 + (i >> 8));
+
+		for (uint32 offset = 0; offset < 2; offset++) {
+			Common::MD5 blocks;
+			for (uint32 pos = 0; pos < size; pos += 64)
+				blocks.update(data + offset + pos, MIN<uint32>(64, size - pos));
+
+			Common::MemoryReadStream stream(data + offset, size);
+			TS_ASSERT_EQUALS(Common::computeStreamMD5AsString(stream), blocks.finishAsString());
+
+			stream.seek(0);
+			Common::MD5 head;
+			head.update(data + offset, 5000);
+			TS_ASSERT_EQUALS(Common::computeStreamMD5AsString(stream, 5000), head.finishAsString());
+		}
+
+		delete[] data;
+	}
+
+	void test_short_reads() {
+		const uint32 size = 100000;
+		byte *data = new byte[size];
+		for (uint32 i = 0; i < size; i++)
+			data[i] = (byte)(i * 11 + (i >> 9));
+
+		Common::MD5 whole;
+		whole.update(data, size);
+		ShortReadStream stream(data, size);
+		TS_ASSERT_EQUALS(Common::computeStreamMD5AsString(stream), whole.finishAsString());
+
+		Common::MD5 head;
+		head.update(data, 5000);
+		ShortReadStream headStream(data, size);
+		TS_ASSERT_EQUALS(Common::computeStreamMD5AsString(headStream, 5000), head.finishAsString());
+
+		delete[] data;
+	}
+
+	void test_head_and_tail() {
+		const uint32 size = 200000;
+		byte *data = new byte[size];
+		for (uint32 i = 0; i < size; i++)
+			data[i] = (byte)(i * 13 + (i >> 10));
+
+		static const uint32 lengths[][2] = {
+			{ 5000, 5000 }, { 150000, 150000 }, { 100000, 100000 }, { 0, 300 }, { 300000, 10 }, { 70000, 0 }
+		};
+
+		for (int i = 0; i < ARRAYSIZE(lengths); i++) {
+			const uint32 headLength = lengths[i][0], tailLength = lengths[i][1];
+			Common::MemoryReadStream stream(data, size);
+			uint8 headDigest[16], tailDigest[16], digest[16];
+
+			TS_ASSERT(Common::computeStreamMD5HeadAndTail(stream, headDigest, headLength, tailDigest, tailLength));
+
+			Common::MD5 head;
+			head.update(data, MIN(headLength, size));
+			head.finish(digest);
+			TS_ASSERT_EQUALS(memcmp(headDigest, digest, 16), 0);
+
+			Common::MD5 tail;
+			tail.update(data + size - MIN(tailLength, size), MIN(tailLength, size));
+			tail.finish(digest);
+			TS_ASSERT_EQUALS(memcmp(tailDigest, digest, 16), 0);
+		}
+
+		delete[] data;
+	}
 };
@@ -0,0 +1,92 @@
+#ifndef TEST_COMMON_SYSTEM_HELPER_H
+#define TEST_COMMON_SYSTEM_HELPER_H
+
+#include "common/savefile.h"
+#include "common/system.h"
+#include "graphics/pixelformat.h"
+
+/**
+ * An OSystem without any screen, sound or events, for tests of code which
+ * needs g_system for little more than mutexes. The tests run on a single
+ * thread, so mutexes do nothing. Install it in setUp() with install() and
+ * take it down in tearDown() with uninstall().
+ *
+ * There is no mixer unless the test sets one, which nothing drives: the
+ * tests read from their streams themselves. Likewise for the save file
+ * manager, which the system then owns.
+ */
+class TestSystem : public OSystem {
+public:
+	TestSystem() : _millis(0), _mixer(0), _previous(0) {}
+
+	void install() {
+		_previous = g_system;
+		g_system = this;
+	}
+
+	void uninstall() {
+		g_system = _previous;
+	}
+
+	void setMixer(Audio::Mixer *mixer) {
+		_mixer = mixer;
+	}
+
+	void setSavefileManager(Common::SaveFileManager *saveFileMan) {
+		delete _savefileManager;
+		_savefileManager = saveFileMan;
+	}
+
+	const GraphicsMode *getSupportedGraphicsModes() const { return 0; }
+	int getDefaultGraphicsMode() const { return 0; }
+	bool setGraphicsMode(int mode) { return true; }
+	int getGraphicsMode() const { return 0; }
+	Graphics::PixelFormat getScreenFormat() const { return Graphics::PixelFormat::createFormatCLUT8(); }
+	Common::List<Graphics::PixelFormat> getSupportedFormats() const { return Common::List<Graphics::PixelFormat>(); }
+	void initSize(uint width, uint height, const Graphics::PixelFormat *format) {}
+	int16 getHeight() { return 0; }
+	int16 getWidth() { return 0; }
+	PaletteManager *getPaletteManager() { return 0; }
+	void copyRectToScreen(const void *buf, int pitch, int x, int y, int w, int h) {}
+	Graphics::Surface *lockScreen() { return 0; }
+	void unlockScreen() {}
+	void fillScreen(uint32 col) {}
+	void updateScreen() {}
+	void setShakePos(int shakeOffset) {}
+
+	void showOverlay() {}
+	void hideOverlay() {}
+	Graphics::PixelFormat getOverlayFormat() const { return Graphics::PixelFormat(); }
+	void clearOverlay() {}
+	void grabOverlay(void *buf, int pitch) {}
+	void copyRectToOverlay(const void *buf, int pitch, int x, int y, int w, int h) {}
+	int16 getOverlayHeight() { return 0; }
+	int16 getOverlayWidth() { return 0; }
+
+	bool showMouse(bool visible) { return false; }
+	void warpMouse(int x, int y) {}
+	void setMouseCursor(const void *buf, uint w, uint h, int hotspotX, int hotspotY, uint32 keycolor, bool dontScale, const Graphics::PixelFormat *format) {}
+
+	/** Time only passes in delayMillis(). */
+	uint32 getMillis(bool skipRecord = false) { return _millis; }
+	void delayMillis(uint msecs) { _millis += msecs; }
+	void getTimeAndDate(TimeDate &t) const {}
+
+	MutexRef createMutex() { return 0; }
+	void lockMutex(MutexRef mutex) {}
+	void unlockMutex(MutexRef mutex) {}
+	void deleteMutex(MutexRef mutex) {}
+
+	Audio::Mixer *getMixer() { return _mixer; }
+	void quit() {}
+	void displayMessageOnOSD(const char *msg) {}
+	void displayActivityIconOnOSD(const Graphics::Surface *icon) {}
+	void logMessage(LogMessageType::Type type, const char *message) {}
+
+private:
+	uint32 _millis;
+	Audio::Mixer *_mixer;
+	OSystem *_previous;
+};
+
+#endif
@@ -0,0 +1,141 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/md5.h"
+#include "common/memstream.h"
+#include "common/threadpool.h"
+
+class ThreadPoolTestSuite : public CxxTest::TestSuite
+{
+private:
+	struct Counts {
+		Common::Array<uint> calls;
+	};
+
+	static void countCall(void *param, uint index) {
+		Counts *counts = (Counts *)param;
+		++counts->calls[index];
+	}
+
+	/**
+	 * A file of a game directory, hashed like the AdvancedDetector does.
+	 */
+	struct HashJob {
+		const byte *data;
+		uint32 size;
+		uint32 md5Bytes;
+		uint8 md5[16];
+	};
+
+	/** Runs on the workers, which must not create Strings. */
+	static void hashFile(void *param, uint index) {
+		HashJob &job = (*(Common::Array<HashJob> *)param)[index];
+		Common::MemoryReadStream stream(job.data, job.size);
+		Common::computeStreamMD5(stream, job.md5, job.md5Bytes);
+	}
+
+	struct Order {
+		Common::Array<uint> jobs;
+		uint next;
+	};
+
+	struct OrderedJob {
+		Order *order;
+		uint index;
+	};
+
+	static void recordJob(void *param) {
+		OrderedJob *job = (OrderedJob *)param;
+		job->order->jobs.push_back(job->index);
+	}
+
+public:
+	void test_parallel_for() {
+		Common::ThreadPool pool(4);
+		TS_ASSERT_LESS_THAN_EQUALS(1u, pool.getThreadCount());
+		TS_ASSERT_LESS_THAN_EQUALS(pool.getThreadCount(), 4u);
+
+		static const uint counts[] = { 0, 1, 2, 3, 1000, 7 };
+		Counts c;
+		for (int i = 0; i < ARRAYSIZE(counts); ++i) {
+			c.calls.clear();
+			c.calls.resize(counts[i]);
+			for (uint j = 0; j < counts[i]; ++j)
+				c.calls[j] = 0;
+
+			pool.parallelFor(counts[i], countCall, &c);
+			for (uint j = 0; j < counts[i]; ++j)
+				TS_ASSERT_EQUALS(c.calls[j], 1u);
+		}
+	}
+
+	void test_parallel_md5() {
+		const uint32 fileSize = 20000;
+		byte *data = new byte[fileSize * 16];
+		for (uint32 i = 0; i < fileSize * 16; ++i)
+			data[i] = (byte)(i * 7 + (i >> 9));
+
+		Common::Array<HashJob> jobs;
+		for (uint i = 0; i < 16; ++i) {
+			HashJob job;
+			job.data = data + i * fileSize;
+			job.size = fileSize - i * 100;
+			job.md5Bytes = (i & 1) ? 5000 : 0;
+			jobs.push_back(job);
+		}
+
+		Common::ThreadPool pool;
+		pool.parallelFor(jobs.size(), hashFile, &jobs);
+
+		for (uint i = 0; i < jobs.size(); ++i) {
+			Common::MemoryReadStream stream(jobs[i].data, jobs[i].size);
+			TS_ASSERT_EQUALS(Common::md5DigestToString(jobs[i].md5), Common::computeStreamMD5AsString(stream, jobs[i].md5Bytes));
+		}
+
+		delete[] data;
+	}
+
+	void test_worker_thread() {
+		Order order;
+		OrderedJob jobs[100];
+		Common::WorkerThread::JobId ids[100];
+
+		{
+			Common::WorkerThread worker;
+			for (uint i = 0; i < 50; ++i) {
+				jobs[i].order = &order;
+				jobs[i].index = i;
+				ids[i] = worker.addJob(recordJob, &jobs[i]);
+			}
+
+			worker.wait(ids[20]);
+			TS_ASSERT(worker.isDone(ids[20]));
+			TS_ASSERT(worker.isDone(ids[0]));
+			worker.waitAll();
+			TS_ASSERT(worker.isDone(ids[49]));
+
+			TS_ASSERT_EQUALS(order.jobs.size(), 50u);
+			for (uint i = 0; i < order.jobs.size(); ++i)
+				TS_ASSERT_EQUALS(order.jobs[i], i);
+
+			// Cancelled jobs are done, whether they ran or not
+			for (uint i = 50; i < 100; ++i) {
+				jobs[i].order = &order;
+				jobs[i].index = i;
+				ids[i] = worker.addJob(recordJob, &jobs[i]);
+			}
+			worker.cancelPending();
+			worker.waitAll();
+			TS_ASSERT(worker.isDone(ids[99]));
+			TS_ASSERT_LESS_THAN_EQUALS(order.jobs.size(), 100u);
+
+			for (uint i = 0; i < 10; ++i)
+				worker.addJob(recordJob, &jobs[i]);
+		}
+
+		// The queued jobs are run before the worker is destroyed
+		TS_ASSERT_LESS_THAN_EQUALS(60u, order.jobs.size());
+		for (uint i = 1; i < order.jobs.size() - 10; ++i)
+			TS_ASSERT_EQUALS(order.jobs[i], order.jobs[i - 1] + 1);
+	}
+};
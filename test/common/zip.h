@@ -0,0 +1,271 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/memstream.h"
+#include "common/unzip.h"
+#include "common/zlib.h"
+
+#include "system_helper.h"
+
+class ZipTestSuite : public CxxTest::TestSuite {
+#if defined(USE_ZLIB)
+private:
+	enum {
+		kStoredSize = 100 * 1024,
+		kSmallSize = 10 * 1024,
+		kBigSize = 600 * 1024	// Inflated as it is read
+	};
+
+	struct Member {
+		const char *name;
+		const byte *data;
+		uint32 size;
+		bool deflate;
+	};
+
+	TestSystem _system;	// The archive stream is shared behind a mutex
+	uint32 _seed;
+
+	uint32 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 16;
+	}
+
+	byte *createData(uint32 size, uint32 seed) {
+		static const char *const words[] = { "zip", "archive", "member", "stored", "deflated", "\n" };
+		byte *data = new byte[size];
+
+		_seed = seed;
+		for (uint32 pos = 0; pos < size; ) {
+			const char *word = words[nextRandom() % ARRAYSIZE(words)];
+			while (*word && pos < size)
+				data[pos++] = *word++;
+			if (pos < size)
+				data[pos++] = 'a' + nextRandom() % 26;
+		}
+
+		return data;
+	}
+
+	/**
+	 * Deflates the data, taking the raw deflate data and the CRC-32 out of
+	 * a gzip stream.
+	 */
+	byte *deflate(const byte *data, uint32 size, uint32 &deflatedSize, uint32 &crc) {
+		Common::MemoryWriteStreamDynamic *out = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+		Common::WriteStream *gzip = Common::wrapCompressedWriteStream(out);
+		gzip->write(data, size);
+		gzip->finalize();
+
+		// 10 bytes of header, the CRC-32 and the size at the end
+		byte *compressed = out->getData();
+		deflatedSize = out->size() - 18;
+		crc = READ_LE_UINT32(compressed + out->size() - 8);
+		delete gzip;
+
+		byte *deflated = new byte[deflatedSize];
+		memcpy(deflated, compressed + 10, deflatedSize);
+		free(compressed);
+		return deflated;
+	}
+
+	/**
+	 * Builds a ZIP archive with the given members. The CRC-32 of the
+	 * members is xor'ed with badCrc.
+	 */
+	Common::Archive *createArchive(const Member *members, int count, uint32 badCrc = 0) {
+		Common::MemoryWriteStreamDynamic out(DisposeAfterUse::NO);
+		Common::MemoryWriteStreamDynamic directory(DisposeAfterUse::YES);
+
+		for (int i = 0; i < count; ++i) {
+			const Member &member = members[i];
+			uint32 storedSize, crc;
+			byte *stored = deflate(member.data, member.size, storedSize, crc);
+			if (!member.deflate) {
+				delete[] stored;
+				stored = 0;
+				storedSize = member.size;
+			}
+			crc ^= badCrc;
+
+			const uint32 offset = out.pos();
+			const uint16 nameLength = strlen(member.name);
+
+			out.writeUint32LE(0x04034B50);
+			out.writeUint16LE(20);			// Version needed
+			out.writeUint16LE(0);			// Flags
+			out.writeUint16LE(member.deflate ? 8 : 0);
+			out.writeUint32LE(0);			// Time and date
+			out.writeUint32LE(crc);
+			out.writeUint32LE(storedSize);
+			out.writeUint32LE(member.size);
+			out.writeUint16LE(nameLength);
+			out.writeUint16LE(0);			// Extra field
+			out.write(member.name, nameLength);
+			out.write(stored ? stored : member.data, storedSize);
+
+			directory.writeUint32LE(0x02014B50);
+			directory.writeUint16LE(20);	// Version made by
+			directory.writeUint16LE(20);	// Version needed
+			directory.writeUint16LE(0);		// Flags
+			directory.writeUint16LE(member.deflate ? 8 : 0);
+			directory.writeUint32LE(0);		// Time and date
+			directory.writeUint32LE(crc);
+			directory.writeUint32LE(storedSize);
+			directory.writeUint32LE(member.size);
+			directory.writeUint16LE(nameLength);
+			directory.writeUint16LE(0);		// Extra field
+			directory.writeUint16LE(0);		// Comment
+			directory.writeUint16LE(0);		// Disk number
+			directory.writeUint16LE(0);		// Internal attributes
+			directory.writeUint32LE(0);		// External attributes
+			directory.writeUint32LE(offset);
+			directory.write(member.name, nameLength);
+
+			delete[] stored;
+		}
+
+		const uint32 directoryOffset = out.pos();
+		out.write(directory.getData(), directory.size());
+
+		out.writeUint32LE(0x06054B50);
+		out.writeUint16LE(0);				// Disk number
+		out.writeUint16LE(0);				// Disk with the directory
+		out.writeUint16LE(count);
+		out.writeUint16LE(count);
+		out.writeUint32LE(directory.size());
+		out.writeUint32LE(directoryOffset);
+		out.writeUint16LE(0);				// Comment
+
+		return Common::makeZipArchive(new Common::MemoryReadStream(out.getData(), out.size(), DisposeAfterUse::YES));
+	}
+
+	/**
+	 * Reads the whole stream in pieces of varying size, then seeks around
+	 * and compares what is read with the original data.
+	 */
+	void checkMember(Common::SeekableReadStream *stream, const byte *data, uint32 size) {
+		byte buf[5000];
+
+		TS_ASSERT_EQUALS((uint32)stream->size(), size);
+
+		_seed = 3;
+		for (uint32 pos = 0; pos < size; ) {
+			const uint32 length = MIN<uint32>(nextRandom() % sizeof(buf) + 1, size - pos);
+			TS_ASSERT_EQUALS(stream->read(buf, length), length);
+			TS_ASSERT_EQUALS(memcmp(buf, data + pos, length), 0);
+			pos += length;
+		}
+		TS_ASSERT(!stream->err());
+
+		for (int i = 0; i < 20; ++i) {
+			const uint32 pos = nextRandom() * 7 % size;
+			TS_ASSERT(stream->seek(pos, SEEK_SET));
+			TS_ASSERT_EQUALS((uint32)stream->pos(), pos);
+			TS_ASSERT_EQUALS(stream->readByte(), data[pos]);
+		}
+
+		TS_ASSERT(stream->seek(size / 2, SEEK_SET));
+		TS_ASSERT(stream->seek(-100, SEEK_CUR));
+		TS_ASSERT_EQUALS(stream->read(buf, 16), 16u);
+		TS_ASSERT_EQUALS(memcmp(buf, data + size / 2 - 100, 16), 0);
+
+		TS_ASSERT(stream->seek(-16, SEEK_END));
+		TS_ASSERT_EQUALS(stream->read(buf, 32), 16u);
+		TS_ASSERT_EQUALS(memcmp(buf, data + size - 16, 16), 0);
+		TS_ASSERT(stream->eos());
+		TS_ASSERT(!stream->err());
+	}
+#endif
+
+public:
+	void setUp() {
+#if defined(USE_ZLIB)
+		_system.install();
+#endif
+	}
+
+	void tearDown() {
+#if defined(USE_ZLIB)
+		_system.uninstall();
+#endif
+	}
+
+	void test_members() {
+#if defined(USE_ZLIB)
+		byte *stored = createData(kStoredSize, 1);
+		byte *small = createData(kSmallSize, 2);
+		byte *big = createData(kBigSize, 3);
+		const Member members[] = {
+			{ "stored.txt", stored, kStoredSize, false },
+			{ "small.txt", small, kSmallSize, true },
+			{ "big.txt", big, kBigSize, true }
+		};
+
+		Common::Archive *archive = createArchive(members, ARRAYSIZE(members));
+		TS_ASSERT(archive);
+
+		Common::ArchiveMemberList list;
+		TS_ASSERT_EQUALS(archive->listMembers(list), 3);
+		TS_ASSERT(archive->hasFile("STORED.TXT"));
+		TS_ASSERT(!archive->hasFile("missing.txt"));
+		TS_ASSERT(!archive->createReadStreamForMember("missing.txt"));
+
+		Common::SeekableReadStream *streams[ARRAYSIZE(members)];
+		for (int i = 0; i < ARRAYSIZE(members); ++i) {
+			streams[i] = archive->createReadStreamForMember(members[i].name);
+			TS_ASSERT(streams[i]);
+		}
+
+		// Member streams keep working after the archive is gone
+		delete archive;
+
+		for (int i = 0; i < ARRAYSIZE(members); ++i) {
+			checkMember(streams[i], members[i].data, members[i].size);
+			delete streams[i];
+		}
+
+		delete[] stored;
+		delete[] small;
+		delete[] big;
+#endif
+	}
+
+	void test_deflated_crc() {
+#if defined(USE_ZLIB)
+		byte *small = createData(kSmallSize, 4);
+		byte *big = createData(kBigSize, 5);
+		const Member members[] = {
+			{ "small.txt", small, kSmallSize, true },
+			{ "big.txt", big, kBigSize, true }
+		};
+		byte *buf = new byte[kBigSize];
+
+		// Members inflated at once are not opened at all
+		Common::Archive *archive = createArchive(members, ARRAYSIZE(members), 0x100);
+		TS_ASSERT(!archive->createReadStreamForMember("small.txt"));
+
+		// Streamed members fail once they reach their end
+		Common::SeekableReadStream *stream = archive->createReadStreamForMember("big.txt");
+		TS_ASSERT(stream);
+		TS_ASSERT_EQUALS(stream->read(buf, kBigSize / 2), (uint32)kBigSize / 2);
+		TS_ASSERT(!stream->err());
+		stream->read(buf, kBigSize);
+		TS_ASSERT(stream->err());
+		delete stream;
+		delete archive;
+
+		archive = createArchive(members, ARRAYSIZE(members));
+		stream = archive->createReadStreamForMember("big.txt");
+		TS_ASSERT_EQUALS(stream->read(buf, kBigSize), (uint32)kBigSize);
+		TS_ASSERT_EQUALS(memcmp(buf, big, kBigSize), 0);
+		TS_ASSERT(!stream->err());
+		delete stream;
+		delete archive;
+
+		delete[] buf;
+		delete[] small;
+		delete[] big;
+#endif
+	}
+};
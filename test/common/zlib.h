@@ -0,0 +1,177 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "common/zlib.h"
+
+#if defined(USE_ZLIB)
+/**
+ * A memory stream which counts the bytes read from it, to tell how much
+ * compressed data was decompressed.
+ */
+class CountingReadStream : public Common::MemoryReadStream {
+public:
+	uint32 bytesRead;
+
+	CountingReadStream(const byte *data, uint32 size) : Common::MemoryReadStream(data, size), bytesRead(0) {}
+
+	uint32 read(void *dataPtr, uint32 dataSize) {
+		const uint32 read = Common::MemoryReadStream::read(dataPtr, dataSize);
+		bytesRead += read;
+		return read;
+	}
+};
+#endif
+
+class ZlibTestSuite : public CxxTest::TestSuite {
+#if defined(USE_ZLIB)
+private:
+	enum {
+		kDataSize = 1536 * 1024
+	};
+
+	uint32 _seed;
+
+	uint32 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 16;
+	}
+
+	/**
+	 * Creates text-like data, compressible enough to be split into many
+	 * deflate blocks.
+	 */
+	byte *createData() {
+		static const char *const words[] = { "scumm", "engine", "save", "game", "room", "actor", "script", "verb", "\n" };
+		byte *data = new byte[kDataSize];
+
+		_seed = 1;
+		for (uint32 pos = 0; pos < kDataSize; ) {
+			const char *word = words[nextRandom() % ARRAYSIZE(words)];
+			while (*word && pos < kDataSize)
+				data[pos++] = *word++;
+			if (pos < kDataSize)
+				data[pos++] = 'a' + nextRandom() % 26;
+		}
+
+		return data;
+	}
+
+	byte *compress(const byte *data, uint32 &compressedSize) {
+		Common::MemoryWriteStreamDynamic *out = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+		Common::WriteStream *gzip = Common::wrapCompressedWriteStream(out);
+		gzip->write(data, kDataSize);
+		gzip->finalize();
+
+		compressedSize = out->size();
+		byte *compressed = out->getData();
+		delete gzip;
+		return compressed;
+	}
+
+	/**
+	 * Seeks around the stream, backwards and forwards, and compares what is
+	 * read with the original data.
+	 */
+	void checkSeeking(Common::SeekableReadStream *stream, const byte *data) {
+		byte buf[4096];
+
+		TS_ASSERT_EQUALS(stream->size(), kDataSize);
+
+		_seed = 7;
+		for (int i = 0; i < 150; ++i) {
+			const uint32 pos = (i % 10 == 9) ? kDataSize - 100 : nextRandom() * 37 % (kDataSize - sizeof(buf));
+			const uint32 length = (nextRandom() % sizeof(buf)) + 1;
+
+			TS_ASSERT(stream->seek(pos, SEEK_SET));
+			TS_ASSERT_EQUALS((uint32)stream->pos(), pos);
+
+			const uint32 read = stream->read(buf, length);
+			TS_ASSERT_EQUALS(read, MIN<uint32>(length, kDataSize - pos));
+			TS_ASSERT_EQUALS(memcmp(buf, data + pos, read), 0);
+		}
+
+		// Relative seeks
+		TS_ASSERT(stream->seek(1000, SEEK_SET));
+		TS_ASSERT(stream->seek(-500, SEEK_CUR));
+		TS_ASSERT_EQUALS(stream->read(buf, 16), 16u);
+		TS_ASSERT_EQUALS(memcmp(buf, data + 500, 16), 0);
+		TS_ASSERT(stream->seek(-16, SEEK_END));
+		TS_ASSERT_EQUALS(stream->read(buf, 32), 16u);
+		TS_ASSERT_EQUALS(memcmp(buf, data + kDataSize - 16, 16), 0);
+		TS_ASSERT(stream->eos());
+	}
+#endif
+
+public:
+	void test_gzip_seek() {
+#if defined(USE_ZLIB)
+		byte *data = createData();
+		uint32 compressedSize;
+		byte *compressed = compress(data, compressedSize);
+
+		Common::SeekableReadStream *stream = Common::wrapCompressedReadStream(
+			new Common::MemoryReadStream(compressed, compressedSize, DisposeAfterUse::YES));
+		checkSeeking(stream, data);
+
+		delete stream;
+		delete[] data;
+#endif
+	}
+
+	void test_deflate_seek() {
+#if defined(USE_ZLIB)
+		byte *data = createData();
+		uint32 compressedSize;
+		byte *compressed = compress(data, compressedSize);
+
+		// Strip the gzip header and trailer, leaving the raw deflate data.
+		// The trailer starts with the CRC-32.
+		Common::SeekableReadStream *stream = Common::wrapDeflateReadStream(
+			new Common::MemoryReadStream(compressed + 10, compressedSize - 18), kDataSize,
+			READ_LE_UINT32(compressed + compressedSize - 8));
+		checkSeeking(stream, data);
+		TS_ASSERT(!stream->err());
+
+		delete stream;
+		free(compressed);
+		delete[] data;
+#endif
+	}
+
+	/**
+	 * The checkpoints need zlib 1.2.7.1 or newer, which is older than the
+	 * versions the ports ship with.
+	 */
+	void test_gzip_seek_checkpoints() {
+#if defined(USE_ZLIB)
+		byte *data = createData();
+		uint32 compressedSize;
+		byte *compressed = compress(data, compressedSize);
+
+		CountingReadStream *counter = new CountingReadStream(compressed, compressedSize);
+		Common::SeekableReadStream *stream = Common::wrapCompressedReadStream(counter);
+		byte buf[4096];
+
+		// Checkpoints are recorded after the first backward seek
+		stream->read(buf, sizeof(buf));
+		TS_ASSERT(stream->seek(0, SEEK_SET));
+		while (stream->read(buf, sizeof(buf)) == sizeof(buf))
+			;
+
+		// Far into the stream, only the data after the nearest checkpoint
+		// may be decompressed, both backwards and forwards
+		static const uint32 positions[] = { kDataSize - 5000, kDataSize / 2, kDataSize / 4 + 3, kDataSize - 70000 };
+		for (int i = 0; i < ARRAYSIZE(positions); ++i) {
+			counter->bytesRead = 0;
+			TS_ASSERT(stream->seek(positions[i], SEEK_SET));
+			TS_ASSERT_EQUALS(stream->read(buf, 100), 100u);
+			TS_ASSERT_EQUALS(memcmp(buf, data + positions[i], 100), 0);
+			TS_ASSERT_LESS_THAN(counter->bytesRead, compressedSize / 8);
+		}
+
+		delete stream;
+		free(compressed);
+		delete[] data;
+#endif
+	}
+};
@@ -0,0 +1,106 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/file.h"
+#include "common/memstream.h"
+
+#include "sci/resource.h"
+#include "sci/resource_intern.h"
+
+// Only game detection in the resource manager uses these, the tests do not
+// link the rest of the engine
+namespace Sci {
+SciEngine *g_sci = 0;
+const reg_t NULL_REG = {0, 0};
+Common::Platform SciEngine::getPlatform() const { return Common::kPlatformDOS; }
+bool SciEngine::isDemo() const { return false; }
+bool SciEngine::isCD() const { return false; }
+bool SciEngine::isBE() const { return false; }
+void reg_t::setSegment(SegmentId segment) { _segment = segment; }
+uint32 reg_t::getOffset() const { return _offset; }
+void reg_t::setOffset(uint32 offset) { _offset = offset; }
+} // End of namespace Sci
+
+/**
+ * Opens an SCI0 volume file in memory, holding one text resource.
+ */
+static Common::File *openSciTestVolume(const Common::String &name, uint16 number, const char *text) {
+	const uint16 size = strlen(text);
+	byte *volume = (byte *)malloc(8 + size);
+	WRITE_LE_UINT16(volume, (3 << 11) | number);	// text
+	WRITE_LE_UINT16(volume + 2, size + 4);
+	WRITE_LE_UINT16(volume + 4, size);
+	WRITE_LE_UINT16(volume + 6, 0);					// not compressed
+	memcpy(volume + 8, text, size);
+
+	Common::File *file = new Common::File();
+	file->open(new Common::MemoryReadStream(volume, 8 + size, DisposeAfterUse::YES), name);
+	return file;
+}
+
+class SciTestVolumeSource : public Sci::ResourceSource {
+public:
+	SciTestVolumeSource(const Common::String &name) : Sci::ResourceSource(Sci::kSourceVolume, name) {}
+};
+
+/**
+ * A resource manager set up without any game files, like init() would for
+ * an SCI0 game.
+ */
+class SciTestResourceManager : public Sci::ResourceManager {
+public:
+	SciTestResourceManager() {
+		_maxMemoryLRU = 256 * 1024;
+		_memoryLocked = 0;
+		_memoryLRU = 0;
+		_lruFirst = NULL;
+		_lruLast = NULL;
+		resetCacheStats();
+		_prefetchRooms = false;
+		_audioMapSCI1 = NULL;
+		_mapVersion = Sci::kResVersionSci0Sci1Early;
+		_volVersion = Sci::kResVersionSci0Sci1Early;
+	}
+
+	int getMemoryLRU() const { return _memoryLRU; }
+
+	void addVolume(const Common::String &volume, uint16 number, const char *text) {
+		// Already opened volumes are not looked up in SearchMan
+		_volumeFiles.push_back(openSciTestVolume(volume, number, text));
+	}
+
+	void addVolumeResource(const Sci::ResourceId &id, const Common::String &volume) {
+		addResource(id, addSource(new SciTestVolumeSource(volume)), 0);
+	}
+
+	Sci::Resource *patchResource(const Sci::ResourceId &id, const Common::String &volume, uint32 size) {
+		return updateResource(id, addSource(new SciTestVolumeSource(volume)), size);
+	}
+};
+
+class SciResourceTestSuite : public CxxTest::TestSuite {
+public:
+	void test_reload_updated_resource() {
+		const Sci::ResourceId id(Sci::kResourceTypeText, 1);
+		SciTestResourceManager resMan;
+		resMan.addVolume("resource.000", 1, "old text");
+		resMan.addVolume("resource.001", 1, "patched text");
+		resMan.addVolumeResource(id, "resource.000");
+
+		Sci::Resource *res = resMan.findResource(id, false);
+		TS_ASSERT(res);
+		TS_ASSERT_EQUALS(res->size, 8u);
+		TS_ASSERT_EQUALS(memcmp(res->data, "old text", 8), 0);
+		TS_ASSERT_EQUALS(resMan.getMemoryLRU(), 8);
+
+		// The data of the old version must be freed, and the LRU list no
+		// longer account for it
+		TS_ASSERT_EQUALS(resMan.patchResource(id, "resource.001", 12), res);
+		TS_ASSERT(!res->data);
+		TS_ASSERT_EQUALS(resMan.getMemoryLRU(), 0);
+
+		TS_ASSERT_EQUALS(resMan.findResource(id, false), res);
+		TS_ASSERT_EQUALS(res->size, 12u);
+		TS_ASSERT_EQUALS(memcmp(res->data, "patched text", 12), 0);
+		TS_ASSERT_EQUALS(resMan.getMemoryLRU(), 12);
+	}
+};
@@ -0,0 +1,189 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite
+{
+private:
+	enum Subsampling {
+		k444,
+		k420,
+		k410
+	};
+
+	uint32 _seed;
+
+	uint32 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 16;
+	}
+
+	/**
+	 * Planes of a YUV image. The chroma planes have the extra row and column
+	 * which convert410 reads.
+	 */
+	struct Image {
+		int width, height;
+		int yPitch, uvPitch;
+		byte *y, *u, *v;
+
+		Image(int w, int h, Subsampling subsampling) : width(w), height(h) {
+			const int shift = (subsampling == k444) ? 0 : (subsampling == k420) ? 1 : 2;
+			yPitch = w + 5;
+			uvPitch = (w >> shift) + 3;
+			y = new byte[yPitch * h];
+			u = new byte[uvPitch * ((h >> shift) + 1)];
+			v = new byte[uvPitch * ((h >> shift) + 1)];
+		}
+
+		~Image() {
+			delete[] y;
+			delete[] u;
+			delete[] v;
+		}
+	};
+
+	/**
+	 * Fills the planes with random values, and with runs of the extremes so
+	 * both ends of the clamping are hit.
+	 */
+	void fillImage(Image &image, Subsampling subsampling) {
+		const int shift = (subsampling == k444) ? 0 : (subsampling == k420) ? 1 : 2;
+		for (int i = 0; i < image.yPitch * image.height; ++i)
+			image.y[i] = ((i / 37) % 5 == 0) ? ((i & 1) ? 255 : 0) : nextRandom();
+		for (int i = 0; i < image.uvPitch * ((image.height >> shift) + 1); ++i) {
+			image.u[i] = ((i / 11) % 4 == 0) ? ((i & 2) ? 255 : 0) : nextRandom();
+			image.v[i] = ((i / 13) % 4 == 1) ? ((i & 4) ? 255 : 0) : nextRandom();
+		}
+	}
+
+	void convert(Graphics::Surface &dst, Graphics::YUVToRGBManager::LuminanceScale scale, const Image &image, Subsampling subsampling) {
+		switch (subsampling) {
+		case k444:
+			YUVToRGBMan.convert444(&dst, scale, image.y, image.u, image.v, image.width, image.height, image.yPitch, image.uvPitch);
+			break;
+		case k420:
+			YUVToRGBMan.convert420(&dst, scale, image.y, image.u, image.v, image.width, image.height, image.yPitch, image.uvPitch);
+			break;
+		case k410:
+			YUVToRGBMan.convert410(&dst, scale, image.y, image.u, image.v, image.width, image.height, image.yPitch, image.uvPitch);
+			break;
+		}
+	}
+
+	void compareBackends(const Graphics::PixelFormat &format, Subsampling subsampling, int width, int height) {
+		Image image(width, height, subsampling);
+		fillImage(image, subsampling);
+
+		Graphics::Surface lookup, simd;
+		lookup.create(width, height, format);
+		simd.create(width, height, format);
+
+		for (int scale = 0; scale < 2; ++scale) {
+			memset(lookup.getPixels(), 0x55, lookup.pitch * height);
+			memset(simd.getPixels(), 0xAA, simd.pitch * height);
+
+			YUVToRGBMan.setBackend(Graphics::YUVToRGBManager::kBackendLookup);
+			convert(lookup, (Graphics::YUVToRGBManager::LuminanceScale)scale, image, subsampling);
+			YUVToRGBMan.setBackend(Graphics::YUVToRGBManager::kBackendSIMD);
+			convert(simd, (Graphics::YUVToRGBManager::LuminanceScale)scale, image, subsampling);
+
+			for (int y = 0; y < height; ++y)
+				TS_ASSERT_EQUALS(memcmp(lookup.getBasePtr(0, y), simd.getBasePtr(0, y), width * format.bytesPerPixel), 0);
+		}
+
+		lookup.free();
+		simd.free();
+	}
+
+	void compareSubsampling(Subsampling subsampling) {
+		static const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15),
+			Graphics::PixelFormat(2, 5, 5, 5, 0, 0, 5, 10, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24)
+		};
+		// Odd multiples of the subsampling, to cover the pixels after the last block of eight
+		static const int sizes[][2] = { { 640, 48 }, { 324, 20 }, { 12, 8 }, { 4, 4 }, { 612, 4 } };
+		// Sizes which convert420, and convert444 as well, accept but the
+		// blocks and row pairs of the SIMD code do not fit evenly
+		static const int evenSizes[][2] = { { 18, 6 }, { 30, 2 }, { 2, 2 }, { 34, 10 } };
+		static const int oddSizes[][2] = { { 17, 3 }, { 7, 5 }, { 1, 1 }, { 33, 9 } };
+
+		if (!Graphics::YUVToRGBManager::hasBackend(Graphics::YUVToRGBManager::kBackendSIMD))
+			return;
+
+		_seed = 1;
+		for (int f = 0; f < ARRAYSIZE(formats); ++f) {
+			for (int s = 0; s < ARRAYSIZE(sizes); ++s)
+				compareBackends(formats[f], subsampling, sizes[s][0], sizes[s][1]);
+			if (subsampling == k410)
+				continue;
+			for (int s = 0; s < ARRAYSIZE(evenSizes); ++s)
+				compareBackends(formats[f], subsampling, evenSizes[s][0], evenSizes[s][1]);
+			if (subsampling == k420)
+				continue;
+			for (int s = 0; s < ARRAYSIZE(oddSizes); ++s)
+				compareBackends(formats[f], subsampling, oddSizes[s][0], oddSizes[s][1]);
+		}
+	}
+
+public:
+	void tearDown() {
+		YUVToRGBMan.setBackend(Graphics::YUVToRGBManager::hasBackend(Graphics::YUVToRGBManager::kBackendSIMD) ?
+			Graphics::YUVToRGBManager::kBackendSIMD : Graphics::YUVToRGBManager::kBackendLookup);
+	}
+
+	void test_convert444() {
+		compareSubsampling(k444);
+	}
+
+	void test_convert420() {
+		compareSubsampling(k420);
+	}
+
+	void test_convert410() {
+		compareSubsampling(k410);
+	}
+
+	/**
+	 * All luminance and chroma combinations, which would not fit the
+	 * random images.
+	 */
+	void test_all_values() {
+		if (!Graphics::YUVToRGBManager::hasBackend(Graphics::YUVToRGBManager::kBackendSIMD))
+			return;
+
+		Image image(256, 256, k444);
+		for (int y = 0; y < 256; ++y) {
+			for (int x = 0; x < 256; ++x) {
+				image.y[y * image.yPitch + x] = x;
+				image.u[y * image.uvPitch + x] = y;
+			}
+		}
+
+		Graphics::Surface lookup, simd;
+		const Graphics::PixelFormat format(4, 8, 8, 8, 0, 16, 8, 0, 0);
+		lookup.create(256, 256, format);
+		simd.create(256, 256, format);
+
+		for (int v = 0; v < 256; ++v) {
+			for (int i = 0; i < image.uvPitch * 256; ++i)
+				image.v[i] = v;
+
+			for (int scale = 0; scale < 2; ++scale) {
+				YUVToRGBMan.setBackend(Graphics::YUVToRGBManager::kBackendLookup);
+				convert(lookup, (Graphics::YUVToRGBManager::LuminanceScale)scale, image, k444);
+				YUVToRGBMan.setBackend(Graphics::YUVToRGBManager::kBackendSIMD);
+				convert(simd, (Graphics::YUVToRGBManager::LuminanceScale)scale, image, k444);
+				TS_ASSERT_EQUALS(memcmp(lookup.getPixels(), simd.getPixels(), lookup.pitch * 256), 0);
+			}
+		}
+
+		lookup.free();
+		simd.free();
+	}
+};
@@ -5,8 +5,21 @@
 #
 ######################################################################
 
-TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h
-TEST_LIBS    := audio/libaudio.a common/libcommon.a
+TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/graphics/*.h $(srcdir)/test/video/*.h
+BENCHMARKS   := $(srcdir)/test/benchmark/*.cpp
+TEST_LIBS    := video/libvideo.a audio/libaudio.a graphics/libgraphics.a common/libcommon.a
+# For the save files kept in memory by tests
+TEST_OBJS    := backends/saves/savefile.o
+
+ifdef USE_MT32EMU
+TEST_LIBS    += audio/softsynth/mt32/libmt32.a
+endif
+
+# The SCI resource manager is tested on its own, without the rest of the engine
+ifdef ENABLE_SCI
+TESTS        += $(srcdir)/test/engines/sci/*.h
+TEST_OBJS    += engines/sci/resource.o engines/sci/resource_audio.o engines/sci/decompressor.o engines/sci/util.o
+endif
 
 #
 TEST_FLAGS   := --runner=StdioPrinter --no-std --no-eh --include=$(srcdir)/test/cxxtest_mingw.h
@@ -28,15 +41,24 @@ endif
 
 test: test/runner
 	./test/runner
-test/runner: test/runner.cpp $(TEST_LIBS)
+test/runner: test/runner.cpp $(TEST_OBJS) $(TEST_LIBS)
 	$(QUIET_LINK)$(CXX) $(TEST_CXXFLAGS) $(CPPFLAGS) $(TEST_CFLAGS) -o $@ $+ $(TEST_LDFLAGS)
 test/runner.cpp: $(TESTS)
 	@mkdir -p test
 	$(srcdir)/test/cxxtest/cxxtestgen.py $(TEST_FLAGS) -o $@ $+
 
+# Timings of the optimized code paths, which are not part of the tests.
+# Use the 'benchmark' target to run them all, or test/benchmark/benchmark
+# with the names of some of them.
+benchmark: test/benchmark/benchmark
+	./test/benchmark/benchmark
+test/benchmark/benchmark: $(BENCHMARKS) $(TEST_LIBS)
+	@mkdir -p test/benchmark
+	$(QUIET_LINK)$(CXX) $(TEST_CXXFLAGS) $(CPPFLAGS) -o $@ $+ $(TEST_LDFLAGS)
+
 
 clean: clean-test
 clean-test:
-	-$(RM) test/runner.cpp test/runner
+	-$(RM) test/runner.cpp test/runner test/benchmark/benchmark
 
-.PHONY: test clean-test
+.PHONY: test benchmark clean-test
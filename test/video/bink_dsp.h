@@ -0,0 +1,162 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/scummsys.h"
+
+#ifdef USE_BINK
+#include "video/bink_dsp.h"
+#endif
+
+class BinkDSPTestSuite : public CxxTest::TestSuite
+{
+#ifdef USE_BINK
+private:
+	enum {
+		kPitch = 48,
+		kPlaneSize = kPitch * 24
+	};
+
+	uint32 _seed;
+
+	uint32 nextRandom() {
+		_seed = _seed * 1103515245 + 12345;
+		return _seed >> 16;
+	}
+
+	/**
+	 * Fills a block of coefficients like the bitstream does: mostly small
+	 * values with a few zero columns, and every few blocks the extremes,
+	 * which overflow the 16 bit intermediate values of the transform.
+	 */
+	void fillBlock(int16 *block, int kind) {
+		for (int i = 0; i < 64; i++) {
+			switch (kind % 4) {
+			case 0:
+				block[i] = (int16)((nextRandom() % 512) - 256);
+				break;
+			case 1:
+				block[i] = (i < 8 || (nextRandom() & 3) == 0) ? (int16)((nextRandom() % 4096) - 2048) : 0;
+				break;
+			case 2:
+				block[i] = (int16)nextRandom();
+				break;
+			default:
+				block[i] = (nextRandom() & 1) ? -32768 : 32767;
+				break;
+			}
+		}
+	}
+
+	void fillPlane(byte *plane) {
+		for (int i = 0; i < kPlaneSize; i++)
+			plane[i] = (byte)nextRandom();
+	}
+
+	/**
+	 * Runs a block function with each backend on the same input, and
+	 * compares the whole planes, to also catch writes beyond the block.
+	 */
+	template<typename Func>
+	void compareBackends(Func func) {
+		if (!Video::hasBinkDSPBackend(Video::kBinkDSPSIMD))
+			return;
+
+		byte src[kPlaneSize], generic[kPlaneSize], simd[kPlaneSize];
+		int16 block[64], genericBlock[64], simdBlock[64];
+
+		_seed = 1;
+		for (int i = 0; i < 400; i++) {
+			fillBlock(block, i);
+			fillPlane(src);
+			fillPlane(generic);
+			memcpy(simd, generic, kPlaneSize);
+			memcpy(genericBlock, block, sizeof(block));
+			memcpy(simdBlock, block, sizeof(block));
+
+			const int offset = (i % 7) * kPitch + (i % 13);
+			Video::setBinkDSPBackend(Video::kBinkDSPGeneric);
+			func(generic + offset, src + offset, genericBlock);
+			Video::setBinkDSPBackend(Video::kBinkDSPSIMD);
+			func(simd + offset, src + offset, simdBlock);
+
+			TS_ASSERT_EQUALS(memcmp(generic, simd, kPlaneSize), 0);
+			TS_ASSERT_EQUALS(memcmp(genericBlock, simdBlock, sizeof(block)), 0);
+		}
+	}
+
+	struct IDCT {
+		void operator()(byte *, const byte *, int16 *block) const { Video::binkIDCT(block); }
+	};
+
+	struct IDCTPut {
+		void operator()(byte *dest, const byte *, int16 *block) const { Video::binkIDCTPut(dest, kPitch, block); }
+	};
+
+	struct IDCTAdd {
+		void operator()(byte *dest, const byte *, int16 *block) const { Video::binkIDCTAdd(dest, kPitch, block); }
+	};
+
+	struct AddBlock {
+		void operator()(byte *dest, const byte *, int16 *block) const { Video::binkAddBlock(dest, kPitch, block); }
+	};
+
+	struct PutScaledBlock {
+		void operator()(byte *dest, const byte *, int16 *block) const { Video::binkPutScaledBlock(dest, kPitch, block); }
+	};
+
+	struct PutScaledPixels {
+		void operator()(byte *dest, const byte *src, int16 *) const { Video::binkPutScaledPixels(dest, kPitch, src); }
+	};
+
+	struct CopyBlock {
+		void operator()(byte *dest, const byte *src, int16 *) const { Video::binkCopyBlock(dest, src, kPitch); }
+	};
+
+	struct CopyScaledBlock {
+		void operator()(byte *dest, const byte *src, int16 *) const { Video::binkCopyScaledBlock(dest, src, kPitch); }
+	};
+#endif
+
+public:
+	void test_backends() {
+#ifdef USE_BINK
+		TS_ASSERT(Video::hasBinkDSPBackend(Video::kBinkDSPGeneric));
+		TS_ASSERT(Video::setBinkDSPBackend(Video::kBinkDSPGeneric));
+		TS_ASSERT_EQUALS(Video::getBinkDSPBackend(), Video::kBinkDSPGeneric);
+		TS_ASSERT_EQUALS(Video::setBinkDSPBackend(Video::kBinkDSPSIMD), Video::hasBinkDSPBackend(Video::kBinkDSPSIMD));
+#endif
+	}
+
+	void test_idct() {
+#ifdef USE_BINK
+		const Video::BinkDSPBackend backend = Video::getBinkDSPBackend();
+		compareBackends(IDCT());
+		compareBackends(IDCTPut());
+		compareBackends(IDCTAdd());
+		Video::setBinkDSPBackend(backend);
+#endif
+	}
+
+	void test_idct_dc() {
+#ifdef USE_BINK
+		// A block with only a DC coefficient is flat
+		int16 block[64];
+		memset(block, 0, sizeof(block));
+		block[0] = 5 * 256 - 0x7F;
+		Video::binkIDCT(block);
+		for (int i = 0; i < 64; i++)
+			TS_ASSERT_EQUALS(block[i], 5);
+#endif
+	}
+
+	void test_blocks() {
+#ifdef USE_BINK
+		const Video::BinkDSPBackend backend = Video::getBinkDSPBackend();
+		compareBackends(AddBlock());
+		compareBackends(PutScaledBlock());
+		compareBackends(PutScaledPixels());
+		compareBackends(CopyBlock());
+		compareBackends(CopyScaledBlock());
+		Video::setBinkDSPBackend(backend);
+#endif
+	}
+};
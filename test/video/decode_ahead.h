@@ -0,0 +1,172 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "graphics/surface.h"
+#include "video/video_decoder.h"
+
+#include "../common/system_helper.h"
+
+/**
+ * A video of 50 frames, each filled with its number. Every 10th frame
+ * changes the palette.
+ */
+class DecodeAheadTestDecoder : public Video::VideoDecoder {
+public:
+	enum {
+		kFrameCount = 50
+	};
+
+	DecodeAheadTestDecoder() : _track(0) {}
+	~DecodeAheadTestDecoder() { close(); }
+
+	bool loadStream(Common::SeekableReadStream *stream) {
+		_track = new TestVideoTrack();
+		addTrack(_track);
+		return true;
+	}
+
+protected:
+	void readNextPacket() {
+		if (_track->endOfTrack())
+			return;
+
+		_track->_curFrame++;
+		memset(_track->_surface.getPixels(), _track->_curFrame, _track->_surface.pitch * _track->_surface.h);
+		if (_track->_curFrame % 10 == 0) {
+			_track->_palette[0] = _track->_curFrame;
+			_track->_dirtyPalette = true;
+		}
+	}
+
+	bool canDecodeAhead() const { return true; }
+
+private:
+	class TestVideoTrack : public FixedRateVideoTrack {
+	public:
+		Graphics::Surface _surface;
+		int _curFrame;
+		byte _palette[3 * 256];
+		mutable bool _dirtyPalette;
+
+		TestVideoTrack() : _curFrame(-1), _dirtyPalette(false) {
+			_surface.create(8, 8, Graphics::PixelFormat::createFormatCLUT8());
+			memset(_palette, 0, sizeof(_palette));
+		}
+		~TestVideoTrack() { _surface.free(); }
+
+		uint16 getWidth() const { return _surface.w; }
+		uint16 getHeight() const { return _surface.h; }
+		Graphics::PixelFormat getPixelFormat() const { return _surface.format; }
+		int getCurFrame() const { return _curFrame; }
+		int getFrameCount() const { return kFrameCount; }
+		const Graphics::Surface *decodeNextFrame() { return &_surface; }
+		const byte *getPalette() const { _dirtyPalette = false; return _palette; }
+		bool hasDirtyPalette() const { return _dirtyPalette; }
+
+		bool isSeekable() const { return true; }
+		bool seek(const Audio::Timestamp &time) {
+			_curFrame = getFrameAtTime(time) - 1;
+			return true;
+		}
+
+	protected:
+		Common::Rational getFrameRate() const { return 10; }
+	};
+
+	TestVideoTrack *_track;
+};
+
+class DecodeAheadTestSuite : public CxxTest::TestSuite {
+private:
+	TestSystem _system;
+
+	/**
+	 * Decodes the next frame and records what the decoder shows: the frame
+	 * number before and after, the frame contents and the palette.
+	 */
+	void decodeFrame(DecodeAheadTestDecoder &decoder, Common::Array<int> &log) {
+		log.push_back(decoder.getCurFrame());
+
+		const Graphics::Surface *surface = decoder.decodeNextFrame();
+		log.push_back(surface ? *(const byte *)surface->getPixels() : -1);
+
+		log.push_back(decoder.getCurFrame());
+		log.push_back(decoder.endOfVideo());
+		log.push_back(decoder.hasDirtyPalette() ? decoder.getPalette()[0] : -1);
+	}
+
+	/**
+	 * Plays the video with seeks and rewinds, and returns what was shown.
+	 */
+	Common::Array<int> play(uint decodeAhead) {
+		Common::Array<int> log;
+		DecodeAheadTestDecoder decoder;
+		decoder.loadStream(0);
+		TS_ASSERT(decoder.setDecodeAhead(decodeAhead));
+		decoder.start();
+
+		// Forwards, past a later frame and to the end
+		for (int i = 0; i < 20; i++)
+			decodeFrame(decoder, log);
+		TS_ASSERT(decoder.seekToFrame(40));
+		while (!decoder.endOfVideo())
+			decodeFrame(decoder, log);
+		decodeFrame(decoder, log);
+
+		// It is too late to change this now
+		TS_ASSERT(!decoder.setDecodeAhead(decodeAhead ? 0 : 4));
+
+		// Back to the start, then backwards
+		TS_ASSERT(decoder.rewind());
+		for (int i = 0; i < 15; i++)
+			decodeFrame(decoder, log);
+		TS_ASSERT(decoder.seekToFrame(5));
+		for (int i = 0; i < 10; i++)
+			decodeFrame(decoder, log);
+
+		decoder.close();
+		return log;
+	}
+
+public:
+	void setUp() {
+		_system.install();
+	}
+
+	void tearDown() {
+		_system.uninstall();
+	}
+
+	void test_frames() {
+		const Common::Array<int> log = play(0);
+
+		// Every frame shows its own number, and the frames after a seek
+		// start at the frame seeked to
+		TS_ASSERT_EQUALS(log[0], -1);
+		TS_ASSERT_EQUALS(log[1], 0);
+		TS_ASSERT_EQUALS(log[2], 0);
+		TS_ASSERT_EQUALS(log[4], 0);
+		TS_ASSERT_EQUALS(log[19 * 5 + 1], 19);
+		TS_ASSERT_EQUALS(log[20 * 5 + 1], 40);
+		TS_ASSERT_EQUALS(log[20 * 5 + 4], 40);
+		TS_ASSERT_EQUALS(log[29 * 5 + 1], 49);
+		TS_ASSERT_EQUALS(log[29 * 5 + 3], 1);
+		TS_ASSERT_EQUALS(log[30 * 5 + 1], -1);
+		TS_ASSERT_EQUALS(log[31 * 5 + 1], 0);
+		TS_ASSERT_EQUALS(log[46 * 5 + 1], 5);
+		TS_ASSERT_EQUALS(log[51 * 5 + 4], 10);
+	}
+
+	void test_decode_ahead() {
+		// Decoding ahead, on a thread if there is thread support, must show
+		// the same frames at the same time as decoding them when shown
+		const Common::Array<int> expected = play(0);
+
+		for (uint frames = 1; frames <= 4; frames *= 2) {
+			const Common::Array<int> log = play(frames);
+			TS_ASSERT_EQUALS(log.size(), expected.size());
+			for (uint i = 0; i < log.size() && i < expected.size(); i++)
+				TS_ASSERT_EQUALS(log[i], expected[i]);
+		}
+	}
+};
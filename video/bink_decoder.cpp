@@ -39,11 +39,13 @@
 #include "common/rdft.h"
 #include "common/dct.h"
 #include "common/system.h"
+#include "common/threadpool.h"
 
 #include "graphics/yuv_to_rgb.h"
 #include "graphics/surface.h"
 
 #include "video/binkdata.h"
+#include "video/bink_dsp.h"
 #include "video/bink_decoder.h"
 
 static const uint32 kBIKfID = MKTAG('B', 'I', 'K', 'f');
@@ -59,6 +61,9 @@ static const uint16 kAudioFlagStereo = 0x2000;
 // Number of bits used to store first DC value in bundle
 static const uint32 kDCStartBits = 11;
 
+// Rows of the frame converted by each job; must be even for the 4:2:0 planes
+static const int kConvertSliceHeight = 32;
+
 namespace Video {
 
 BinkDecoder::BinkDecoder() {
@@ -222,6 +227,10 @@ VideoDecoder::AudioTrack *BinkDecoder::getAudioTrack(int index) {
 	return (AudioTrack *)track;
 }
 
+void BinkDecoder::prepareDecodeAhead(VideoTrack *track) {
+	YUVToRGBMan.prepareLookup(track->getPixelFormat(), Graphics::YUVToRGBManager::kScaleITU);
+}
+
 BinkDecoder::VideoFrame::VideoFrame() : bits(0) {
 }
 
@@ -245,6 +254,7 @@ BinkDecoder::AudioInfo::~AudioInfo() {
 BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, const Graphics::PixelFormat &format, uint32 frameCount, const Common::Rational &frameRate, bool swapPlanes, bool hasAlpha, uint32 id) :
 		_frameCount(frameCount), _frameRate(frameRate), _swapPlanes(swapPlanes), _hasAlpha(hasAlpha), _id(id) {
 	_curFrame = -1;
+	_outputSurface = 0;
 
 	for (int i = 0; i < 16; i++)
 		_huffman[i] = 0;
@@ -309,11 +319,15 @@ BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, const G
 	memset(_oldPlanes[2],   0, (width >> 1) * (height >> 1));
 	memset(_oldPlanes[3], 255,  width       *  height      );
 
+	_convertPool = new Common::ThreadPool();
+
 	initBundles();
 	initHuffman();
 }
 
 BinkDecoder::BinkVideoTrack::~BinkVideoTrack() {
+	delete _convertPool;
+
 	for (int i = 0; i < 4; i++) {
 		delete[] _curPlanes[i]; _curPlanes[i] = 0;
 		delete[] _oldPlanes[i]; _oldPlanes[i] = 0;
@@ -356,8 +370,13 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 	// The width used here is the surface-width, and not the video-width
 	// to allow for odd-sized videos.
 	assert(_curPlanes[0] && _curPlanes[1] && _curPlanes[2]);
-	YUVToRGBMan.convert420(&_surface, Graphics::YUVToRGBManager::kScaleITU, _curPlanes[0], _curPlanes[1], _curPlanes[2],
-			_surfaceWidth, _surfaceHeight, _surfaceWidth, _surfaceWidth >> 1);
+	const uint sliceCount = (_surfaceHeight + kConvertSliceHeight - 1) / kConvertSliceHeight;
+
+	// The first slice also creates the conversion lookup, which may
+	// not be done by several threads at once
+	convertSlice(0);
+	if (sliceCount > 1)
+		_convertPool->parallelFor(sliceCount - 1, convertSliceJob, this);
 
 	// And swap the planes with the reference planes
 	for (int i = 0; i < 4; i++)
@@ -366,6 +385,33 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 	_curFrame++;
 }
 
+bool BinkDecoder::BinkVideoTrack::setOutputSurface(Graphics::Surface *surface) {
+	// The whole even-sized frame is converted
+	if (surface && (surface->w < _surfaceWidth || surface->h < _surfaceHeight ||
+			(surface->format.bytesPerPixel != 2 && surface->format.bytesPerPixel != 4)))
+		return false;
+
+	_outputSurface = surface;
+	return true;
+}
+
+void BinkDecoder::BinkVideoTrack::convertSlice(uint slice) {
+	const int y = slice * kConvertSliceHeight;
+	const int height = MIN<int>(kConvertSliceHeight, _surfaceHeight - y);
+	const int uvOffset = (y >> 1) * (_surfaceWidth >> 1);
+	Graphics::Surface &surface = _outputSurface ? *_outputSurface : _surface;
+
+	Graphics::Surface dst;
+	dst.init(_surfaceWidth, height, surface.pitch, surface.getBasePtr(0, y), surface.format);
+
+	YUVToRGBMan.convert420(&dst, Graphics::YUVToRGBManager::kScaleITU, _curPlanes[0] + y * _surfaceWidth,
+			_curPlanes[1] + uvOffset, _curPlanes[2] + uvOffset, _surfaceWidth, height, _surfaceWidth, _surfaceWidth >> 1);
+}
+
+void BinkDecoder::BinkVideoTrack::convertSliceJob(void *param, uint index) {
+	((BinkVideoTrack *)param)->convertSlice(index + 1);
+}
+
 void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, bool isChroma) {
 	uint32 blockWidth  = isChroma ? ((_surface.w  + 15) >> 4) : ((_surface.w  + 7) >> 3);
 	uint32 blockHeight = isChroma ? ((_surface.h + 15) >> 4) : ((_surface.h + 7) >> 3);
@@ -624,19 +670,11 @@ uint32 BinkDecoder::BinkVideoTrack::readBundleCount(VideoFrame &video, Bundle &b
 }
 
 void BinkDecoder::BinkVideoTrack::blockSkip(DecodeContext &ctx) {
-	byte *dest = ctx.dest;
-	byte *prev = ctx.prev;
-
-	for (int j = 0; j < 8; j++, dest += ctx.pitch, prev += ctx.pitch)
-		memcpy(dest, prev, 8);
+	binkCopyBlock(ctx.dest, ctx.prev, ctx.pitch);
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaledSkip(DecodeContext &ctx) {
-	byte *dest = ctx.dest;
-	byte *prev = ctx.prev;
-
-	for (int j = 0; j < 16; j++, dest += ctx.pitch, prev += ctx.pitch)
-		memcpy(dest, prev, 16);
+	binkCopyScaledBlock(ctx.dest, ctx.prev, ctx.pitch);
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaledRun(DecodeContext &ctx) {
@@ -683,17 +721,8 @@ void BinkDecoder::BinkVideoTrack::blockScaledIntra(DecodeContext &ctx) {
 
 	readDCTCoeffs(*ctx.video, block, true);
 
-	IDCT(block);
-
-	int16 *src   = block;
-	byte  *dest1 = ctx.dest;
-	byte  *dest2 = ctx.dest + ctx.pitch;
-	for (int j = 0; j < 8; j++, dest1 += (ctx.pitch << 1) - 16, dest2 += (ctx.pitch << 1) - 16, src += 8) {
-
-		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2)
-			dest1[0] = dest1[1] = dest2[0] = dest2[1] = src[i];
-
-	}
+	binkIDCT(block);
+	binkPutScaledBlock(ctx.dest, ctx.pitch, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaledFill(DecodeContext &ctx) {
@@ -721,18 +750,9 @@ void BinkDecoder::BinkVideoTrack::blockScaledPattern(DecodeContext &ctx) {
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaledRaw(DecodeContext &ctx) {
-	byte row[8];
+	binkPutScaledPixels(ctx.dest, ctx.pitch, _bundles[kSourceColors].curPtr);
 
-	byte *dest1 = ctx.dest;
-	byte *dest2 = ctx.dest + ctx.pitch;
-	for (int j = 0; j < 8; j++, dest1 += (ctx.pitch << 1) - 16, dest2 += (ctx.pitch << 1) - 16) {
-		memcpy(row, _bundles[kSourceColors].curPtr, 8);
-
-		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2)
-			dest1[0] = dest1[1] = dest2[0] = dest2[1] = row[i];
-
-		_bundles[kSourceColors].curPtr += 8;
-	}
+	_bundles[kSourceColors].curPtr += 64;
 }
 
 void BinkDecoder::BinkVideoTrack::blockScaled(DecodeContext &ctx) {
@@ -767,13 +787,11 @@ void BinkDecoder::BinkVideoTrack::blockMotion(DecodeContext &ctx) {
 	int8 xOff = getBundleValue(kSourceXOff);
 	int8 yOff = getBundleValue(kSourceYOff);
 
-	byte *dest = ctx.dest;
 	byte *prev = ctx.prev + yOff * ((int32) ctx.pitch) + xOff;
 	if ((prev < ctx.prevStart) || (prev > ctx.prevEnd))
 		error("Copy out of bounds (%d | %d)", ctx.blockX * 8 + xOff, ctx.blockY * 8 + yOff);
 
-	for (int j = 0; j < 8; j++, dest += ctx.pitch, prev += ctx.pitch)
-		memcpy(dest, prev, 8);
+	binkCopyBlock(ctx.dest, prev, ctx.pitch);
 }
 
 void BinkDecoder::BinkVideoTrack::blockRun(DecodeContext &ctx) {
@@ -813,11 +831,7 @@ void BinkDecoder::BinkVideoTrack::blockResidue(DecodeContext &ctx) {
 
 	readResidue(*ctx.video, block, v);
 
-	byte  *dst = ctx.dest;
-	int16 *src = block;
-	for (int i = 0; i < 8; i++, dst += ctx.pitch, src += 8)
-		for (int j = 0; j < 8; j++)
-			dst[j] += src[j];
+	binkAddBlock(ctx.dest, ctx.pitch, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockIntra(DecodeContext &ctx) {
@@ -828,7 +842,7 @@ void BinkDecoder::BinkVideoTrack::blockIntra(DecodeContext &ctx) {
 
 	readDCTCoeffs(*ctx.video, block, true);
 
-	IDCTPut(ctx, block);
+	binkIDCTPut(ctx.dest, ctx.pitch, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockFill(DecodeContext &ctx) {
@@ -849,7 +863,7 @@ void BinkDecoder::BinkVideoTrack::blockInter(DecodeContext &ctx) {
 
 	readDCTCoeffs(*ctx.video, block, false);
 
-	IDCTAdd(ctx, block);
+	binkIDCTAdd(ctx.dest, ctx.pitch, block);
 }
 
 void BinkDecoder::BinkVideoTrack::blockPattern(DecodeContext &ctx) {
@@ -1267,88 +1281,6 @@ void BinkDecoder::BinkVideoTrack::readResidue(VideoFrame &video, int16 *block, i
 	}
 }
 
-#define A1  2896 /* (1/sqrt(2))<<12 */
-#define A2  2217
-#define A3  3784
-#define A4 -5352
-
-#define IDCT_TRANSFORM(dest,s0,s1,s2,s3,s4,s5,s6,s7,d0,d1,d2,d3,d4,d5,d6,d7,munge,src) {\
-    const int a0 = (src)[s0] + (src)[s4]; \
-    const int a1 = (src)[s0] - (src)[s4]; \
-    const int a2 = (src)[s2] + (src)[s6]; \
-    const int a3 = (A1*((src)[s2] - (src)[s6])) >> 11; \
-    const int a4 = (src)[s5] + (src)[s3]; \
-    const int a5 = (src)[s5] - (src)[s3]; \
-    const int a6 = (src)[s1] + (src)[s7]; \
-    const int a7 = (src)[s1] - (src)[s7]; \
-    const int b0 = a4 + a6; \
-    const int b1 = (A3*(a5 + a7)) >> 11; \
-    const int b2 = ((A4*a5) >> 11) - b0 + b1; \
-    const int b3 = (A1*(a6 - a4) >> 11) - b2; \
-    const int b4 = ((A2*a7) >> 11) + b3 - b1; \
-    (dest)[d0] = munge(a0+a2   +b0); \
-    (dest)[d1] = munge(a1+a3-a2+b2); \
-    (dest)[d2] = munge(a1-a3+a2+b3); \
-    (dest)[d3] = munge(a0-a2   -b4); \
-    (dest)[d4] = munge(a0-a2   +b4); \
-    (dest)[d5] = munge(a1-a3+a2-b3); \
-    (dest)[d6] = munge(a1+a3-a2-b2); \
-    (dest)[d7] = munge(a0+a2   -b0); \
-}
-/* end IDCT_TRANSFORM macro */
-
-#define MUNGE_NONE(x) (x)
-#define IDCT_COL(dest,src) IDCT_TRANSFORM(dest,0,8,16,24,32,40,48,56,0,8,16,24,32,40,48,56,MUNGE_NONE,src)
-
-#define MUNGE_ROW(x) (((x) + 0x7F)>>8)
-#define IDCT_ROW(dest,src) IDCT_TRANSFORM(dest,0,1,2,3,4,5,6,7,0,1,2,3,4,5,6,7,MUNGE_ROW,src)
-
-static inline void IDCTCol(int16 *dest, const int16 *src) {
-	if ((src[8] | src[16] | src[24] | src[32] | src[40] | src[48] | src[56]) == 0) {
-		dest[ 0] =
-		dest[ 8] =
-		dest[16] =
-		dest[24] =
-		dest[32] =
-		dest[40] =
-		dest[48] =
-		dest[56] = src[0];
-	} else {
-		IDCT_COL(dest, src);
-	}
-}
-
-void BinkDecoder::BinkVideoTrack::IDCT(int16 *block) {
-	int i;
-	int16 temp[64];
-
-	for (i = 0; i < 8; i++)
-		IDCTCol(&temp[i], &block[i]);
-	for (i = 0; i < 8; i++) {
-		IDCT_ROW( (&block[8*i]), (&temp[8*i]) );
-	}
-}
-
-void BinkDecoder::BinkVideoTrack::IDCTAdd(DecodeContext &ctx, int16 *block) {
-	int i, j;
-
-	IDCT(block);
-	byte *dest = ctx.dest;
-	for (i = 0; i < 8; i++, dest += ctx.pitch, block += 8)
-		for (j = 0; j < 8; j++)
-			 dest[j] += block[j];
-}
-
-void BinkDecoder::BinkVideoTrack::IDCTPut(DecodeContext &ctx, int16 *block) {
-	int i;
-	int16 temp[64];
-	for (i = 0; i < 8; i++)
-		IDCTCol(&temp[i], &block[i]);
-	for (i = 0; i < 8; i++) {
-		IDCT_ROW( (&ctx.dest[i*ctx.pitch]), (&temp[8*i]) );
-	}
-}
-
 BinkDecoder::BinkAudioTrack::BinkAudioTrack(BinkDecoder::AudioInfo &audio) : _audioInfo(&audio) {
 	_audioStream = Audio::makeQueuingAudioStream(_audioInfo->outSampleRate, _audioInfo->outChannels == 2);
 }
@@ -47,6 +47,7 @@ namespace Common {
 class SeekableReadStream;
 class BitStream;
 class Huffman;
+class ThreadPool;
 
 class RDFT;
 class DCT;
@@ -76,6 +77,8 @@ protected:
 	void readNextPacket();
 	bool supportsAudioTrackSwitching() const { return true; }
 	AudioTrack *getAudioTrack(int index);
+	bool canDecodeAhead() const { return true; }
+	void prepareDecodeAhead(VideoTrack *track);
 
 private:
 	static const int kAudioChannelsMax  = 2;
@@ -149,7 +152,8 @@ private:
 		Graphics::PixelFormat getPixelFormat() const { return _surface.format; }
 		int getCurFrame() const { return _curFrame; }
 		int getFrameCount() const { return _frameCount; }
-		const Graphics::Surface *decodeNextFrame() { return &_surface; }
+		const Graphics::Surface *decodeNextFrame() { return _outputSurface ? _outputSurface : &_surface; }
+		bool setOutputSurface(Graphics::Surface *surface);
 
 		/** Decode a video packet. */
 		void decodePacket(VideoFrame &frame);
@@ -238,6 +242,8 @@ private:
 		int _surfaceWidth; ///< The actual surface width
 		int _surfaceHeight; ///< The actual surface height
 
+		Graphics::Surface *_outputSurface; ///< The surface of the caller to decode into, if any
+
 		uint32 _id; ///< The BIK FourCC.
 
 		bool _hasAlpha;   ///< Do video frames have alpha?
@@ -257,6 +263,9 @@ private:
 		byte *_curPlanes[4]; ///< The 4 color planes, YUVA, current frame.
 		byte *_oldPlanes[4]; ///< The 4 color planes, YUVA, last frame.
 
+		/** Runs the color conversion of the slices of a frame on all CPUs. */
+		Common::ThreadPool *_convertPool;
+
 		/** Initialize the bundles. */
 		void initBundles();
 		/** Deinitialize the bundles. */
@@ -268,6 +277,10 @@ private:
 		/** Decode a plane. */
 		void decodePlane(VideoFrame &video, int planeIdx, bool isChroma);
 
+		/** Convert a slice of rows of the current planes into the surface. */
+		void convertSlice(uint slice);
+		static void convertSliceJob(void *param, uint index);
+
 		/** Read/Initialize a bundle for decoding a plane. */
 		void readBundle(VideoFrame &video, Source source);
 
@@ -311,11 +324,6 @@ private:
 		void readDCS         (VideoFrame &video, Bundle &bundle, int startBits, bool hasSign);
 		void readDCTCoeffs   (VideoFrame &video, int16 *block, bool isIntra);
 		void readResidue     (VideoFrame &video, int16 *block, int masksCount);
-
-		// Bink video IDCT
-		void IDCT(int16 *block);
-		void IDCTPut(DecodeContext &ctx, int16 *block);
-		void IDCTAdd(DecodeContext &ctx, int16 *block);
 	};
 
 	class BinkAudioTrack : public AudioTrack {
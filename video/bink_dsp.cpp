@@ -0,0 +1,588 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Based on eos' Bink decoder which is in turn
+// based quite heavily on the Bink decoder found in FFmpeg.
+// Many thanks to Kostya Shishkov for doing the hard work.
+
+#include "common/scummsys.h"
+
+#ifdef USE_BINK
+
+#include "video/bink_dsp.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define BINK_SIMD_SSE2
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define BINK_SIMD_NEON
+#endif
+
+namespace Video {
+
+#define A1  2896 /* (1/sqrt(2))<<12 */
+#define A2  2217
+#define A3  3784
+#define A4 -5352
+
+#define IDCT_TRANSFORM(dest,s0,s1,s2,s3,s4,s5,s6,s7,d0,d1,d2,d3,d4,d5,d6,d7,munge,src) {\
+    const int a0 = (src)[s0] + (src)[s4]; \
+    const int a1 = (src)[s0] - (src)[s4]; \
+    const int a2 = (src)[s2] + (src)[s6]; \
+    const int a3 = (A1*((src)[s2] - (src)[s6])) >> 11; \
+    const int a4 = (src)[s5] + (src)[s3]; \
+    const int a5 = (src)[s5] - (src)[s3]; \
+    const int a6 = (src)[s1] + (src)[s7]; \
+    const int a7 = (src)[s1] - (src)[s7]; \
+    const int b0 = a4 + a6; \
+    const int b1 = (A3*(a5 + a7)) >> 11; \
+    const int b2 = ((A4*a5) >> 11) - b0 + b1; \
+    const int b3 = (A1*(a6 - a4) >> 11) - b2; \
+    const int b4 = ((A2*a7) >> 11) + b3 - b1; \
+    (dest)[d0] = munge(a0+a2   +b0); \
+    (dest)[d1] = munge(a1+a3-a2+b2); \
+    (dest)[d2] = munge(a1-a3+a2+b3); \
+    (dest)[d3] = munge(a0-a2   -b4); \
+    (dest)[d4] = munge(a0-a2   +b4); \
+    (dest)[d5] = munge(a1-a3+a2-b3); \
+    (dest)[d6] = munge(a1+a3-a2-b2); \
+    (dest)[d7] = munge(a0+a2   -b0); \
+}
+/* end IDCT_TRANSFORM macro */
+
+#define MUNGE_NONE(x) (x)
+#define IDCT_COL(dest,src) IDCT_TRANSFORM(dest,0,8,16,24,32,40,48,56,0,8,16,24,32,40,48,56,MUNGE_NONE,src)
+
+#define MUNGE_ROW(x) (((x) + 0x7F)>>8)
+#define IDCT_ROW(dest,src) IDCT_TRANSFORM(dest,0,1,2,3,4,5,6,7,0,1,2,3,4,5,6,7,MUNGE_ROW,src)
+
+static inline void IDCTCol(int16 *dest, const int16 *src) {
+	if ((src[8] | src[16] | src[24] | src[32] | src[40] | src[48] | src[56]) == 0) {
+		dest[ 0] =
+		dest[ 8] =
+		dest[16] =
+		dest[24] =
+		dest[32] =
+		dest[40] =
+		dest[48] =
+		dest[56] = src[0];
+	} else {
+		IDCT_COL(dest, src);
+	}
+}
+
+static void IDCTGeneric(int16 *block) {
+	int i;
+	int16 temp[64];
+
+	for (i = 0; i < 8; i++)
+		IDCTCol(&temp[i], &block[i]);
+	for (i = 0; i < 8; i++) {
+		IDCT_ROW( (&block[8*i]), (&temp[8*i]) );
+	}
+}
+
+static void IDCTPutGeneric(byte *dest, uint32 pitch, const int16 *block) {
+	int i;
+	int16 temp[64];
+	for (i = 0; i < 8; i++)
+		IDCTCol(&temp[i], &block[i]);
+	for (i = 0; i < 8; i++) {
+		IDCT_ROW( (&dest[i*pitch]), (&temp[8*i]) );
+	}
+}
+
+static void addBlockGeneric(byte *dest, uint32 pitch, const int16 *block) {
+	for (int i = 0; i < 8; i++, dest += pitch, block += 8)
+		for (int j = 0; j < 8; j++)
+			dest[j] += block[j];
+}
+
+static void putScaledBlockGeneric(byte *dest, uint32 pitch, const int16 *block) {
+	byte *dest1 = dest;
+	byte *dest2 = dest + pitch;
+	for (int j = 0; j < 8; j++, dest1 += (pitch << 1) - 16, dest2 += (pitch << 1) - 16, block += 8) {
+
+		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2)
+			dest1[0] = dest1[1] = dest2[0] = dest2[1] = block[i];
+
+	}
+}
+
+static void putScaledPixelsGeneric(byte *dest, uint32 pitch, const byte *src) {
+	byte *dest1 = dest;
+	byte *dest2 = dest + pitch;
+	for (int j = 0; j < 8; j++, dest1 += (pitch << 1) - 16, dest2 += (pitch << 1) - 16, src += 8) {
+
+		for (int i = 0; i < 8; i++, dest1 += 2, dest2 += 2)
+			dest1[0] = dest1[1] = dest2[0] = dest2[1] = src[i];
+
+	}
+}
+
+static void copyBlockGeneric(byte *dest, const byte *src, uint32 pitch) {
+	for (int j = 0; j < 8; j++, dest += pitch, src += pitch)
+		memcpy(dest, src, 8);
+}
+
+static void copyScaledBlockGeneric(byte *dest, const byte *src, uint32 pitch) {
+	for (int j = 0; j < 16; j++, dest += pitch, src += pitch)
+		memcpy(dest, src, 16);
+}
+
+#if defined(BINK_SIMD_SSE2)
+
+// The SIMD IDCT transforms all eight columns at once, then transposes the
+// block and transforms the rows the same way. The products are calculated
+// with 32 bits like in the generic code: pmaddwd multiplies the pairs of 16
+// bit inputs which the transform subtracts or adds before multiplying, which
+// also covers the sums of four inputs. The results are truncated to 16 bits
+// where the generic code stores them into int16, so both give the same
+// results for all inputs.
+
+static inline __m128i pair(int16 a, int16 b) {
+	return _mm_set1_epi32((int32)(((uint32)(uint16)b << 16) | (uint16)a));
+}
+
+/**
+ * One pass of the transform over four lanes, given the interleaved input
+ * pairs (s0, s4), (s2, s6), (s5, s3) and (s1, s7).
+ */
+static inline void transformHalf(__m128i p04, __m128i p26, __m128i p53, __m128i p17, __m128i *out) {
+	const __m128i one = pair(1, 1), oneMinus = pair(1, -1);
+
+	const __m128i a0 = _mm_madd_epi16(p04, one);
+	const __m128i a1 = _mm_madd_epi16(p04, oneMinus);
+	const __m128i a2 = _mm_madd_epi16(p26, one);
+	const __m128i a3 = _mm_srai_epi32(_mm_madd_epi16(p26, pair(A1, -A1)), 11);
+	const __m128i a4 = _mm_madd_epi16(p53, one);
+	const __m128i a6 = _mm_madd_epi16(p17, one);
+
+	const __m128i b0 = _mm_add_epi32(a4, a6);
+	const __m128i b1 = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(p53, pair(A3, -A3)), _mm_madd_epi16(p17, pair(A3, -A3))), 11);
+	const __m128i b2 = _mm_add_epi32(_mm_sub_epi32(_mm_srai_epi32(_mm_madd_epi16(p53, pair(A4, -A4)), 11), b0), b1);
+	const __m128i b3 = _mm_sub_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(p17, pair(A1, A1)), _mm_madd_epi16(p53, pair(-A1, -A1))), 11), b2);
+	const __m128i b4 = _mm_sub_epi32(_mm_add_epi32(_mm_srai_epi32(_mm_madd_epi16(p17, pair(A2, -A2)), 11), b3), b1);
+
+	const __m128i a02p = _mm_add_epi32(a0, a2), a02m = _mm_sub_epi32(a0, a2);
+	const __m128i a132 = _mm_sub_epi32(_mm_add_epi32(a1, a3), a2), a132m = _mm_add_epi32(_mm_sub_epi32(a1, a3), a2);
+
+	out[0] = _mm_add_epi32(a02p, b0);
+	out[1] = _mm_add_epi32(a132, b2);
+	out[2] = _mm_add_epi32(a132m, b3);
+	out[3] = _mm_sub_epi32(a02m, b4);
+	out[4] = _mm_add_epi32(a02m, b4);
+	out[5] = _mm_sub_epi32(a132m, b3);
+	out[6] = _mm_sub_epi32(a132, b2);
+	out[7] = _mm_sub_epi32(a02p, b0);
+}
+
+/** Packs two vectors of 32 bit values into one of 16 bit values, truncating them. */
+static inline __m128i packTruncate(__m128i lo, __m128i hi) {
+	return _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(lo, 16), 16), _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16));
+}
+
+/** One pass of the transform over eight lanes, munged like the row pass if requested. */
+static inline void transform(const __m128i *in, __m128i *out, bool row) {
+	__m128i lo[8], hi[8];
+	transformHalf(_mm_unpacklo_epi16(in[0], in[4]), _mm_unpacklo_epi16(in[2], in[6]),
+	              _mm_unpacklo_epi16(in[5], in[3]), _mm_unpacklo_epi16(in[1], in[7]), lo);
+	transformHalf(_mm_unpackhi_epi16(in[0], in[4]), _mm_unpackhi_epi16(in[2], in[6]),
+	              _mm_unpackhi_epi16(in[5], in[3]), _mm_unpackhi_epi16(in[1], in[7]), hi);
+
+	for (int i = 0; i < 8; i++) {
+		if (row) {
+			const __m128i round = _mm_set1_epi32(0x7F);
+			lo[i] = _mm_srai_epi32(_mm_add_epi32(lo[i], round), 8);
+			hi[i] = _mm_srai_epi32(_mm_add_epi32(hi[i], round), 8);
+		}
+		out[i] = packTruncate(lo[i], hi[i]);
+	}
+}
+
+static inline void transpose(__m128i *r) {
+	const __m128i a0 = _mm_unpacklo_epi16(r[0], r[1]);
+	const __m128i a1 = _mm_unpacklo_epi16(r[2], r[3]);
+	const __m128i a2 = _mm_unpacklo_epi16(r[4], r[5]);
+	const __m128i a3 = _mm_unpacklo_epi16(r[6], r[7]);
+	const __m128i a4 = _mm_unpackhi_epi16(r[0], r[1]);
+	const __m128i a5 = _mm_unpackhi_epi16(r[2], r[3]);
+	const __m128i a6 = _mm_unpackhi_epi16(r[4], r[5]);
+	const __m128i a7 = _mm_unpackhi_epi16(r[6], r[7]);
+
+	const __m128i b0 = _mm_unpacklo_epi32(a0, a1);
+	const __m128i b1 = _mm_unpacklo_epi32(a2, a3);
+	const __m128i b2 = _mm_unpackhi_epi32(a0, a1);
+	const __m128i b3 = _mm_unpackhi_epi32(a2, a3);
+	const __m128i b4 = _mm_unpacklo_epi32(a4, a5);
+	const __m128i b5 = _mm_unpacklo_epi32(a6, a7);
+	const __m128i b6 = _mm_unpackhi_epi32(a4, a5);
+	const __m128i b7 = _mm_unpackhi_epi32(a6, a7);
+
+	r[0] = _mm_unpacklo_epi64(b0, b1);
+	r[1] = _mm_unpackhi_epi64(b0, b1);
+	r[2] = _mm_unpacklo_epi64(b2, b3);
+	r[3] = _mm_unpackhi_epi64(b2, b3);
+	r[4] = _mm_unpacklo_epi64(b4, b5);
+	r[5] = _mm_unpackhi_epi64(b4, b5);
+	r[6] = _mm_unpacklo_epi64(b6, b7);
+	r[7] = _mm_unpackhi_epi64(b6, b7);
+}
+
+/** The full IDCT, leaving the rows of the result in r. */
+static inline void IDCTRows(const int16 *block, __m128i *r) {
+	__m128i in[8];
+	for (int i = 0; i < 8; i++)
+		in[i] = _mm_loadu_si128((const __m128i *)(block + i * 8));
+
+	transform(in, r, false);
+	transpose(r);
+	transform(r, in, true);
+	transpose(in);
+
+	for (int i = 0; i < 8; i++)
+		r[i] = in[i];
+}
+
+/** Converts 16 bit values to bytes, keeping the low 8 bits. */
+static inline __m128i toBytes(__m128i a, __m128i b) {
+	const __m128i mask = _mm_set1_epi16(0xFF);
+	return _mm_packus_epi16(_mm_and_si128(a, mask), _mm_and_si128(b, mask));
+}
+
+static inline void storeRows(byte *dest, uint32 pitch, __m128i rows) {
+	_mm_storel_epi64((__m128i *)dest, rows);
+	_mm_storel_epi64((__m128i *)(dest + pitch), _mm_srli_si128(rows, 8));
+}
+
+static inline __m128i addRow(const byte *dest, __m128i row) {
+	return _mm_add_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)dest), _mm_setzero_si128()), row);
+}
+
+static void IDCTSIMD(int16 *block) {
+	__m128i r[8];
+	IDCTRows(block, r);
+
+	for (int i = 0; i < 8; i++)
+		_mm_storeu_si128((__m128i *)(block + i * 8), r[i]);
+}
+
+static void IDCTPutSIMD(byte *dest, uint32 pitch, const int16 *block) {
+	__m128i r[8];
+	IDCTRows(block, r);
+
+	for (int i = 0; i < 8; i += 2, dest += pitch * 2)
+		storeRows(dest, pitch, toBytes(r[i], r[i + 1]));
+}
+
+static void addBlockSIMD(byte *dest, uint32 pitch, const int16 *block) {
+	for (int i = 0; i < 8; i += 2, dest += pitch * 2, block += 16) {
+		const __m128i r0 = addRow(dest, _mm_loadu_si128((const __m128i *)block));
+		const __m128i r1 = addRow(dest + pitch, _mm_loadu_si128((const __m128i *)(block + 8)));
+		storeRows(dest, pitch, toBytes(r0, r1));
+	}
+}
+
+static void putScaledBlockSIMD(byte *dest, uint32 pitch, const int16 *block) {
+	for (int i = 0; i < 8; i += 2, block += 16) {
+		const __m128i rows = toBytes(_mm_loadu_si128((const __m128i *)block), _mm_loadu_si128((const __m128i *)(block + 8)));
+		const __m128i row0 = _mm_unpacklo_epi8(rows, rows), row1 = _mm_unpackhi_epi8(rows, rows);
+		_mm_storeu_si128((__m128i *)dest, row0);
+		dest += pitch;
+		_mm_storeu_si128((__m128i *)dest, row0);
+		dest += pitch;
+		_mm_storeu_si128((__m128i *)dest, row1);
+		dest += pitch;
+		_mm_storeu_si128((__m128i *)dest, row1);
+		dest += pitch;
+	}
+}
+
+static void putScaledPixelsSIMD(byte *dest, uint32 pitch, const byte *src) {
+	for (int i = 0; i < 8; i++, src += 8) {
+		const __m128i row = _mm_loadl_epi64((const __m128i *)src);
+		const __m128i scaled = _mm_unpacklo_epi8(row, row);
+		_mm_storeu_si128((__m128i *)dest, scaled);
+		dest += pitch;
+		_mm_storeu_si128((__m128i *)dest, scaled);
+		dest += pitch;
+	}
+}
+
+static void copyBlockSIMD(byte *dest, const byte *src, uint32 pitch) {
+	for (int j = 0; j < 8; j++, dest += pitch, src += pitch)
+		_mm_storel_epi64((__m128i *)dest, _mm_loadl_epi64((const __m128i *)src));
+}
+
+static void copyScaledBlockSIMD(byte *dest, const byte *src, uint32 pitch) {
+	for (int j = 0; j < 16; j++, dest += pitch, src += pitch)
+		_mm_storeu_si128((__m128i *)dest, _mm_loadu_si128((const __m128i *)src));
+}
+
+#elif defined(BINK_SIMD_NEON)
+
+// The SIMD IDCT transforms all eight columns at once, then transposes the
+// block and transforms the rows the same way. The inputs are widened to 32
+// bits, like in the generic code, and the results are truncated to 16 bits
+// where the generic code stores them into int16, so both give the same
+// results for all inputs.
+
+/**
+ * One pass of the transform over four lanes.
+ */
+static inline void transformHalf(const int32x4_t *s, int32x4_t *out) {
+	const int32x4_t a0 = vaddq_s32(s[0], s[4]);
+	const int32x4_t a1 = vsubq_s32(s[0], s[4]);
+	const int32x4_t a2 = vaddq_s32(s[2], s[6]);
+	const int32x4_t a3 = vshrq_n_s32(vmulq_n_s32(vsubq_s32(s[2], s[6]), A1), 11);
+	const int32x4_t a4 = vaddq_s32(s[5], s[3]);
+	const int32x4_t a5 = vsubq_s32(s[5], s[3]);
+	const int32x4_t a6 = vaddq_s32(s[1], s[7]);
+	const int32x4_t a7 = vsubq_s32(s[1], s[7]);
+
+	const int32x4_t b0 = vaddq_s32(a4, a6);
+	const int32x4_t b1 = vshrq_n_s32(vmulq_n_s32(vaddq_s32(a5, a7), A3), 11);
+	const int32x4_t b2 = vaddq_s32(vsubq_s32(vshrq_n_s32(vmulq_n_s32(a5, A4), 11), b0), b1);
+	const int32x4_t b3 = vsubq_s32(vshrq_n_s32(vmulq_n_s32(vsubq_s32(a6, a4), A1), 11), b2);
+	const int32x4_t b4 = vsubq_s32(vaddq_s32(vshrq_n_s32(vmulq_n_s32(a7, A2), 11), b3), b1);
+
+	const int32x4_t a02p = vaddq_s32(a0, a2), a02m = vsubq_s32(a0, a2);
+	const int32x4_t a132 = vsubq_s32(vaddq_s32(a1, a3), a2), a132m = vaddq_s32(vsubq_s32(a1, a3), a2);
+
+	out[0] = vaddq_s32(a02p, b0);
+	out[1] = vaddq_s32(a132, b2);
+	out[2] = vaddq_s32(a132m, b3);
+	out[3] = vsubq_s32(a02m, b4);
+	out[4] = vaddq_s32(a02m, b4);
+	out[5] = vsubq_s32(a132m, b3);
+	out[6] = vsubq_s32(a132, b2);
+	out[7] = vsubq_s32(a02p, b0);
+}
+
+/** One pass of the transform over eight lanes, munged like the row pass if requested. */
+static inline void transform(const int16x8_t *in, int16x8_t *out, bool row) {
+	int32x4_t s[8], lo[8], hi[8];
+
+	for (int i = 0; i < 8; i++)
+		s[i] = vmovl_s16(vget_low_s16(in[i]));
+	transformHalf(s, lo);
+	for (int i = 0; i < 8; i++)
+		s[i] = vmovl_s16(vget_high_s16(in[i]));
+	transformHalf(s, hi);
+
+	for (int i = 0; i < 8; i++) {
+		if (row) {
+			const int32x4_t round = vdupq_n_s32(0x7F);
+			lo[i] = vshrq_n_s32(vaddq_s32(lo[i], round), 8);
+			hi[i] = vshrq_n_s32(vaddq_s32(hi[i], round), 8);
+		}
+		// Truncating, like storing into int16
+		out[i] = vcombine_s16(vmovn_s32(lo[i]), vmovn_s32(hi[i]));
+	}
+}
+
+static inline void transpose(int16x8_t *r) {
+	const int16x8x2_t t01 = vtrnq_s16(r[0], r[1]);
+	const int16x8x2_t t23 = vtrnq_s16(r[2], r[3]);
+	const int16x8x2_t t45 = vtrnq_s16(r[4], r[5]);
+	const int16x8x2_t t67 = vtrnq_s16(r[6], r[7]);
+
+	const int32x4x2_t u02 = vtrnq_s32(vreinterpretq_s32_s16(t01.val[0]), vreinterpretq_s32_s16(t23.val[0]));
+	const int32x4x2_t u13 = vtrnq_s32(vreinterpretq_s32_s16(t01.val[1]), vreinterpretq_s32_s16(t23.val[1]));
+	const int32x4x2_t u46 = vtrnq_s32(vreinterpretq_s32_s16(t45.val[0]), vreinterpretq_s32_s16(t67.val[0]));
+	const int32x4x2_t u57 = vtrnq_s32(vreinterpretq_s32_s16(t45.val[1]), vreinterpretq_s32_s16(t67.val[1]));
+
+	r[0] = vcombine_s16(vget_low_s16(vreinterpretq_s16_s32(u02.val[0])), vget_low_s16(vreinterpretq_s16_s32(u46.val[0])));
+	r[1] = vcombine_s16(vget_low_s16(vreinterpretq_s16_s32(u13.val[0])), vget_low_s16(vreinterpretq_s16_s32(u57.val[0])));
+	r[2] = vcombine_s16(vget_low_s16(vreinterpretq_s16_s32(u02.val[1])), vget_low_s16(vreinterpretq_s16_s32(u46.val[1])));
+	r[3] = vcombine_s16(vget_low_s16(vreinterpretq_s16_s32(u13.val[1])), vget_low_s16(vreinterpretq_s16_s32(u57.val[1])));
+	r[4] = vcombine_s16(vget_high_s16(vreinterpretq_s16_s32(u02.val[0])), vget_high_s16(vreinterpretq_s16_s32(u46.val[0])));
+	r[5] = vcombine_s16(vget_high_s16(vreinterpretq_s16_s32(u13.val[0])), vget_high_s16(vreinterpretq_s16_s32(u57.val[0])));
+	r[6] = vcombine_s16(vget_high_s16(vreinterpretq_s16_s32(u02.val[1])), vget_high_s16(vreinterpretq_s16_s32(u46.val[1])));
+	r[7] = vcombine_s16(vget_high_s16(vreinterpretq_s16_s32(u13.val[1])), vget_high_s16(vreinterpretq_s16_s32(u57.val[1])));
+}
+
+/** The full IDCT, leaving the rows of the result in r. */
+static inline void IDCTRows(const int16 *block, int16x8_t *r) {
+	int16x8_t in[8];
+	for (int i = 0; i < 8; i++)
+		in[i] = vld1q_s16(block + i * 8);
+
+	transform(in, r, false);
+	transpose(r);
+	transform(r, in, true);
+	transpose(in);
+
+	for (int i = 0; i < 8; i++)
+		r[i] = in[i];
+}
+
+/** Converts 16 bit values to bytes, keeping the low 8 bits. */
+static inline uint8x8_t toBytes(int16x8_t a) {
+	return vmovn_u16(vreinterpretq_u16_s16(a));
+}
+
+static inline int16x8_t addRow(const byte *dest, int16x8_t row) {
+	return vaddq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(dest))), row);
+}
+
+static void IDCTSIMD(int16 *block) {
+	int16x8_t r[8];
+	IDCTRows(block, r);
+
+	for (int i = 0; i < 8; i++)
+		vst1q_s16(block + i * 8, r[i]);
+}
+
+static void IDCTPutSIMD(byte *dest, uint32 pitch, const int16 *block) {
+	int16x8_t r[8];
+	IDCTRows(block, r);
+
+	for (int i = 0; i < 8; i++, dest += pitch)
+		vst1_u8(dest, toBytes(r[i]));
+}
+
+static void addBlockSIMD(byte *dest, uint32 pitch, const int16 *block) {
+	for (int i = 0; i < 8; i++, dest += pitch, block += 8)
+		vst1_u8(dest, toBytes(addRow(dest, vld1q_s16(block))));
+}
+
+static void putScaledBlockSIMD(byte *dest, uint32 pitch, const int16 *block) {
+	for (int i = 0; i < 8; i++, block += 8) {
+		const uint8x8_t row = toBytes(vld1q_s16(block));
+		const uint8x8x2_t scaled = vzip_u8(row, row);
+		const uint8x16_t scaledRow = vcombine_u8(scaled.val[0], scaled.val[1]);
+		vst1q_u8(dest, scaledRow);
+		dest += pitch;
+		vst1q_u8(dest, scaledRow);
+		dest += pitch;
+	}
+}
+
+static void putScaledPixelsSIMD(byte *dest, uint32 pitch, const byte *src) {
+	for (int i = 0; i < 8; i++, src += 8) {
+		const uint8x8_t row = vld1_u8(src);
+		const uint8x8x2_t scaled = vzip_u8(row, row);
+		const uint8x16_t scaledRow = vcombine_u8(scaled.val[0], scaled.val[1]);
+		vst1q_u8(dest, scaledRow);
+		dest += pitch;
+		vst1q_u8(dest, scaledRow);
+		dest += pitch;
+	}
+}
+
+static void copyBlockSIMD(byte *dest, const byte *src, uint32 pitch) {
+	for (int j = 0; j < 8; j++, dest += pitch, src += pitch)
+		vst1_u8(dest, vld1_u8(src));
+}
+
+static void copyScaledBlockSIMD(byte *dest, const byte *src, uint32 pitch) {
+	for (int j = 0; j < 16; j++, dest += pitch, src += pitch)
+		vst1q_u8(dest, vld1q_u8(src));
+}
+
+#endif
+
+static BinkDSPBackend getDefaultBackend() {
+#if defined(BINK_SIMD_SSE2) || defined(BINK_SIMD_NEON)
+	return kBinkDSPSIMD;
+#else
+	return kBinkDSPGeneric;
+#endif
+}
+
+static BinkDSPBackend s_binkDSPBackend = getDefaultBackend();
+
+#if defined(BINK_SIMD_SSE2) || defined(BINK_SIMD_NEON)
+#define BINK_DSP_CALL(name, args) \
+	if (s_binkDSPBackend == kBinkDSPSIMD) \
+		name##SIMD args; \
+	else \
+		name##Generic args
+#else
+#define BINK_DSP_CALL(name, args) name##Generic args
+#endif
+
+bool hasBinkDSPBackend(BinkDSPBackend backend) {
+	switch (backend) {
+	case kBinkDSPGeneric:
+		return true;
+	case kBinkDSPSIMD:
+#if defined(BINK_SIMD_SSE2) || defined(BINK_SIMD_NEON)
+		return true;
+#else
+		return false;
+#endif
+	default:
+		return false;
+	}
+}
+
+bool setBinkDSPBackend(BinkDSPBackend backend) {
+	if (!hasBinkDSPBackend(backend))
+		return false;
+
+	s_binkDSPBackend = backend;
+	return true;
+}
+
+BinkDSPBackend getBinkDSPBackend() {
+	return s_binkDSPBackend;
+}
+
+void binkIDCT(int16 *block) {
+	BINK_DSP_CALL(IDCT, (block));
+}
+
+void binkIDCTPut(byte *dest, uint32 pitch, const int16 *block) {
+	BINK_DSP_CALL(IDCTPut, (dest, pitch, block));
+}
+
+void binkIDCTAdd(byte *dest, uint32 pitch, int16 *block) {
+	binkIDCT(block);
+	binkAddBlock(dest, pitch, block);
+}
+
+void binkAddBlock(byte *dest, uint32 pitch, const int16 *block) {
+	BINK_DSP_CALL(addBlock, (dest, pitch, block));
+}
+
+void binkPutScaledBlock(byte *dest, uint32 pitch, const int16 *block) {
+	BINK_DSP_CALL(putScaledBlock, (dest, pitch, block));
+}
+
+void binkPutScaledPixels(byte *dest, uint32 pitch, const byte *src) {
+	BINK_DSP_CALL(putScaledPixels, (dest, pitch, src));
+}
+
+void binkCopyBlock(byte *dest, const byte *src, uint32 pitch) {
+	BINK_DSP_CALL(copyBlock, (dest, src, pitch));
+}
+
+void binkCopyScaledBlock(byte *dest, const byte *src, uint32 pitch) {
+	BINK_DSP_CALL(copyScaledBlock, (dest, src, pitch));
+}
+
+} // End of namespace Video
+
+#endif
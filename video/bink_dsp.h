@@ -0,0 +1,100 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// The block functions of the Bink video decoder, with portable and SIMD
+// implementations. Based on the same code as the Bink decoder.
+
+#ifndef VIDEO_BINK_DSP_H
+#define VIDEO_BINK_DSP_H
+
+#include "common/scummsys.h"
+
+namespace Video {
+
+/**
+ * Implementations of the Bink block functions.
+ */
+enum BinkDSPBackend {
+	kBinkDSPGeneric,	///< Portable C++ code
+	kBinkDSPSIMD		///< SSE2 or NEON code, if the build targets either
+};
+
+/**
+ * Check whether a backend is compiled in.
+ */
+bool hasBinkDSPBackend(BinkDSPBackend backend);
+
+/**
+ * Select the backend used by the block functions. The default is the SIMD
+ * backend when available and the generic one otherwise. Both give the same
+ * results.
+ *
+ * @return false if the backend is not compiled in
+ */
+bool setBinkDSPBackend(BinkDSPBackend backend);
+
+BinkDSPBackend getBinkDSPBackend();
+
+/**
+ * Inverse DCT of an 8x8 block of coefficients, in place.
+ */
+void binkIDCT(int16 *block);
+
+/**
+ * Inverse DCT of an 8x8 block of coefficients, stored into 8x8 pixels.
+ */
+void binkIDCTPut(byte *dest, uint32 pitch, const int16 *block);
+
+/**
+ * Inverse DCT of an 8x8 block of coefficients, added to 8x8 pixels. The
+ * block is transformed in place.
+ */
+void binkIDCTAdd(byte *dest, uint32 pitch, int16 *block);
+
+/**
+ * Add an 8x8 block of differences to 8x8 pixels.
+ */
+void binkAddBlock(byte *dest, uint32 pitch, const int16 *block);
+
+/**
+ * Store an 8x8 block of values as 16x16 pixels.
+ */
+void binkPutScaledBlock(byte *dest, uint32 pitch, const int16 *block);
+
+/**
+ * Store 8x8 pixels, with a pitch of 8, as 16x16 pixels.
+ */
+void binkPutScaledPixels(byte *dest, uint32 pitch, const byte *src);
+
+/**
+ * Copy 8x8 pixels between two planes with the same pitch.
+ */
+void binkCopyBlock(byte *dest, const byte *src, uint32 pitch);
+
+/**
+ * Copy 16x16 pixels between two planes with the same pitch.
+ */
+void binkCopyScaledBlock(byte *dest, const byte *src, uint32 pitch);
+
+} // End of namespace Video
+
+#endif
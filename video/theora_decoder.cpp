@@ -249,6 +249,10 @@ void TheoraDecoder::readNextPacket() {
 	ensureAudioBufferSize();
 }
 
+void TheoraDecoder::prepareDecodeAhead(VideoTrack *track) {
+	YUVToRGBMan.prepareLookup(track->getPixelFormat(), Graphics::YUVToRGBManager::kScaleITU);
+}
+
 TheoraDecoder::TheoraVideoTrack::TheoraVideoTrack(const Graphics::PixelFormat &format, th_info &theoraInfo, th_setup_info *theoraSetup) {
 	_theoraDecode = th_decode_alloc(&theoraInfo, theoraSetup);
 
@@ -73,6 +73,8 @@ public:
 
 protected:
 	void readNextPacket();
+	bool canDecodeAhead() const { return true; }
+	void prepareDecodeAhead(VideoTrack *track);
 
 private:
 	class TheoraVideoTrack : public VideoTrack {
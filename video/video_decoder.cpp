@@ -25,14 +25,70 @@
 #include "audio/audiostream.h"
 #include "audio/mixer.h" // for kMaxChannelVolume
 
+#include "common/config-manager.h"
 #include "common/rational.h"
+#include "common/rect.h"
 #include "common/file.h"
 #include "common/system.h"
+#include "common/textconsole.h"
+#include "common/threadpool.h"
 
+#include "graphics/conversion.h"
 #include "graphics/palette.h"
+#include "graphics/surface.h"
 
 namespace Video {
 
+// Limit the memory used by the surfaces decoded ahead
+static const uint kMaxDecodeAheadFrames = 16;
+
+/**
+ * A frame decoded ahead, with the state of the video track right after
+ * decoding it.
+ */
+struct VideoDecoder::DecodeAheadFrame {
+	VideoDecoder *decoder;
+	Common::WorkerThread::JobId job;
+
+	Graphics::Surface surface;
+	bool hasSurface;
+	byte palette[256 * 3];
+	bool dirtyPalette;
+
+	int curFrame;
+	uint32 nextFrameStartTime;
+	bool endOfTrack;
+};
+
+/**
+ * The ring of frames decoded ahead of the single video track. One frame is
+ * the one last returned by decodeNextFrame(), the others are decoded in
+ * order by the worker thread, one job per frame.
+ */
+struct VideoDecoder::DecodeAhead {
+	VideoTrack *track;
+	Common::WorkerThread worker;
+	Common::Array<DecodeAheadFrame *> frames;
+	uint next;
+	bool running;
+
+	// The track state of the frame last returned
+	int curFrame;
+	uint32 nextFrameStartTime;
+	bool endOfTrack;
+	byte palette[256 * 3];
+
+	~DecodeAhead() {
+		worker.cancelPending();
+		worker.waitAll();
+
+		for (uint i = 0; i < frames.size(); i++) {
+			frames[i]->surface.free();
+			delete frames[i];
+		}
+	}
+};
+
 VideoDecoder::VideoDecoder() {
 	_startTime = 0;
 	_dirtyPalette = false;
@@ -48,6 +104,11 @@ VideoDecoder::VideoDecoder() {
 	_nextVideoTrack = 0;
 	_mainAudioTrack = 0;
 	_canSetDither = true;
+	_decodeAhead = 0;
+	_decodeAheadFrames = 0;
+
+	if (ConfMan.hasKey("video_decode_ahead"))
+		_decodeAheadFrames = CLIP<int>(ConfMan.getInt("video_decode_ahead"), 0, kMaxDecodeAheadFrames);
 
 	// Find the best format for output
 	_defaultHighColorFormat = g_system->getScreenFormat();
@@ -56,10 +117,18 @@ VideoDecoder::VideoDecoder() {
 		_defaultHighColorFormat = Graphics::PixelFormat(4, 8, 8, 8, 8, 8, 16, 24, 0);
 }
 
+VideoDecoder::~VideoDecoder() {
+	delete _decodeAhead;
+}
+
 void VideoDecoder::close() {
 	if (isPlaying())
 		stop();
 
+	// Stop decoding before the tracks go away
+	delete _decodeAhead;
+	_decodeAhead = 0;
+
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		delete *it;
 
@@ -175,6 +244,40 @@ const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 	_needsUpdate = false;
 	_canSetDither = false;
 
+	if (_decodeAheadFrames != 0 && ((_decodeAhead && _decodeAhead->running) || startDecodeAhead())) {
+		DecodeAhead &ahead = *_decodeAhead;
+
+		if (ahead.endOfTrack) {
+			// Nothing left to decode, but keep the packets coming as usual
+			ahead.worker.waitAll();
+			readNextPacket();
+			return 0;
+		}
+
+		DecodeAheadFrame *frame = ahead.frames[ahead.next];
+		ahead.worker.wait(frame->job);
+
+		ahead.curFrame = frame->curFrame;
+		ahead.nextFrameStartTime = frame->nextFrameStartTime;
+		ahead.endOfTrack = frame->endOfTrack;
+
+		if (frame->dirtyPalette) {
+			memcpy(ahead.palette, frame->palette, sizeof(ahead.palette));
+			_palette = ahead.palette;
+			_dirtyPalette = true;
+		}
+
+		// The frame returned by the previous call is free to be decoded into
+		const uint count = ahead.frames.size();
+		DecodeAheadFrame *freeFrame = ahead.frames[(ahead.next + count - 1) % count];
+		freeFrame->job = ahead.worker.addJob(decodeAheadFrame, freeFrame);
+		ahead.next = (ahead.next + 1) % count;
+
+		findNextVideoTrack();
+
+		return frame->hasSurface ? &frame->surface : 0;
+	}
+
 	readNextPacket();
 
 	// If we have no next video track at this point, there shouldn't be
@@ -195,11 +298,63 @@ const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 	return frame;
 }
 
+bool VideoDecoder::decodeNextFrameInto(Graphics::Surface &dst) {
+	// Check the format before a frame is decoded, as the frame would be
+	// lost if it could not be converted afterwards
+	const Graphics::PixelFormat format = getPixelFormat();
+	assert(dst.format == format || (format.bytesPerPixel > 1 && dst.format.bytesPerPixel > 1 && dst.format.bytesPerPixel != 3));
+
+	VideoTrack *track = _nextVideoTrack;
+	const Graphics::Surface *frame;
+
+	// Frames decoded ahead need surfaces of their own
+	if (track && _decodeAheadFrames == 0 && track->setOutputSurface(&dst)) {
+		frame = decodeNextFrame();
+		track->setOutputSurface(0);
+	} else {
+		frame = decodeNextFrame();
+	}
+
+	if (!frame)
+		return false;
+
+	if (frame->getPixels() == dst.getPixels())
+		return true;
+
+	const uint w = MIN(frame->w, dst.w);
+	const uint h = MIN(frame->h, dst.h);
+
+	if (frame->format == dst.format) {
+		dst.copyRectToSurface(*frame, 0, 0, Common::Rect(w, h));
+		return true;
+	}
+
+	if (!Graphics::crossBlit((byte *)dst.getPixels(), (const byte *)frame->getPixels(), dst.pitch, frame->pitch, w, h, dst.format, frame->format))
+		error("VideoDecoder::decodeNextFrameInto(): Cannot convert a frame to the format of the surface");
+
+	return true;
+}
+
 bool VideoDecoder::setReverse(bool reverse) {
 	// Can only reverse video-only videos
 	if (reverse && hasAudio())
 		return false;
 
+	// Frames are only decoded ahead forwards. The track has gone past the
+	// frames decoded ahead, which are dropped, so put it back after the
+	// last frame that was returned.
+	if (reverse && _decodeAhead && _decodeAhead->running) {
+		const Audio::Timestamp time = _decodeAhead->track->getFrameTime(_decodeAhead->curFrame + 1);
+
+		if (!isSeekable())
+			return false;
+
+		stopDecodeAhead();
+
+		if (!seekIntern(time))
+			return false;
+	}
+
 	// Attempt to make sure all the tracks are in the requested direction
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo && ((VideoTrack *)*it)->isReversed() != reverse) {
@@ -224,7 +379,7 @@ int VideoDecoder::getCurFrame() const {
 
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo)
-			frame += ((VideoTrack *)*it)->getCurFrame() + 1;
+			frame += getTrackCurFrame((VideoTrack *)*it) + 1;
 
 	return frame;
 }
@@ -265,7 +420,7 @@ uint32 VideoDecoder::getTimeToNextFrame() const {
 		return 0;
 
 	uint32 currentTime = getTime();
-	uint32 nextFrameStartTime = _nextVideoTrack->getNextFrameStartTime();
+	uint32 nextFrameStartTime = getTrackNextFrameStartTime(_nextVideoTrack);
 
 	if (_nextVideoTrack->isReversed()) {
 		// For reversed videos, we need to handle the time difference the opposite way.
@@ -284,7 +439,7 @@ uint32 VideoDecoder::getTimeToNextFrame() const {
 
 bool VideoDecoder::endOfVideo() const {
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
-		if (!(*it)->endOfTrack() && (!isPlaying() || (*it)->getTrackType() != Track::kTrackTypeVideo || !_endTimeSet || ((VideoTrack *)*it)->getNextFrameStartTime() < (uint)_endTime.msecs()))
+		if (!trackEnded(*it) && (!isPlaying() || (*it)->getTrackType() != Track::kTrackTypeVideo || !_endTimeSet || getTrackNextFrameStartTime((VideoTrack *)*it) < (uint)_endTime.msecs()))
 			return false;
 
 	return true;
@@ -305,7 +460,10 @@ bool VideoDecoder::rewind() {
 	if (!isRewindable())
 		return false;
 
-	// Stop all tracks so they can be rewound
+	// Stop all tracks so they can be rewound. The worker reads packets
+	// into the audio tracks too, so it has to stop first.
+	stopDecodeAhead();
+
 	if (isPlaying())
 		stopAudio();
 
@@ -339,7 +497,10 @@ bool VideoDecoder::seek(const Audio::Timestamp &time) {
 	if (!isSeekable())
 		return false;
 
-	// Stop all tracks so they can be seeked
+	// Stop all tracks so they can be seeked. The worker reads packets
+	// into the audio tracks too, so it has to stop first.
+	stopDecodeAhead();
+
 	if (isPlaying())
 		stopAudio();
 
@@ -508,6 +669,137 @@ bool VideoDecoder::setDitheringPalette(const byte *palette) {
 	return result;
 }
 
+bool VideoDecoder::setDecodeAhead(uint frames) {
+	// If a frame was already decoded, we can't set it now.
+	if (!_canSetDither)
+		return false;
+
+	_decodeAheadFrames = MIN(frames, kMaxDecodeAheadFrames);
+	return true;
+}
+
+bool VideoDecoder::startDecodeAhead() {
+	if (!canDecodeAhead())
+		return false;
+
+	VideoTrack *track = 0;
+
+	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo) {
+			// Only a single video track is decoded ahead
+			if (track)
+				return false;
+
+			track = (VideoTrack *)*it;
+		}
+	}
+
+	if (!track || track->isReversed())
+		return false;
+
+	if (!_decodeAhead) {
+		_decodeAhead = new DecodeAhead();
+
+		if (!_decodeAhead->worker.isThreaded()) {
+			// Decoding ahead on the same thread would only add latency
+			delete _decodeAhead;
+			_decodeAhead = 0;
+			_decodeAheadFrames = 0;
+			return false;
+		}
+
+		for (uint i = 0; i <= _decodeAheadFrames; i++) {
+			DecodeAheadFrame *frame = new DecodeAheadFrame();
+			frame->decoder = this;
+			frame->hasSurface = false;
+			_decodeAhead->frames.push_back(frame);
+		}
+	}
+
+	prepareDecodeAhead(track);
+
+	DecodeAhead &ahead = *_decodeAhead;
+	ahead.track = track;
+	ahead.curFrame = track->getCurFrame();
+	ahead.nextFrameStartTime = track->getNextFrameStartTime();
+	ahead.endOfTrack = track->endOfTrack();
+	ahead.next = 0;
+	ahead.running = true;
+
+	// The last frame stays free until the first one has been returned
+	for (uint i = 0; i < ahead.frames.size() - 1; i++)
+		ahead.frames[i]->job = ahead.worker.addJob(decodeAheadFrame, ahead.frames[i]);
+
+	return true;
+}
+
+void VideoDecoder::stopDecodeAhead() {
+	if (!_decodeAhead || !_decodeAhead->running)
+		return;
+
+	// The frames decoded ahead are dropped, so the tracks have to be
+	// seeked or rewound to the frame to decode next afterwards
+	_decodeAhead->worker.cancelPending();
+	_decodeAhead->worker.waitAll();
+	_decodeAhead->running = false;
+}
+
+void VideoDecoder::decodeAheadFrame(void *param) {
+	// Runs on the worker thread
+	DecodeAheadFrame *frame = (DecodeAheadFrame *)param;
+	VideoDecoder *decoder = frame->decoder;
+	VideoTrack *track = decoder->_decodeAhead->track;
+
+	frame->hasSurface = false;
+	frame->dirtyPalette = false;
+
+	if (!track->endOfTrack()) {
+		decoder->readNextPacket();
+
+		const Graphics::Surface *surface = track->decodeNextFrame();
+
+		if (surface) {
+			if (frame->surface.w != surface->w || frame->surface.h != surface->h || frame->surface.format != surface->format) {
+				frame->surface.free();
+				frame->surface.create(surface->w, surface->h, surface->format);
+			}
+
+			frame->surface.copyRectToSurface(*surface, 0, 0, Common::Rect(surface->w, surface->h));
+			frame->hasSurface = true;
+		}
+
+		if (track->hasDirtyPalette()) {
+			memcpy(frame->palette, track->getPalette(), sizeof(frame->palette));
+			frame->dirtyPalette = true;
+		}
+	}
+
+	frame->curFrame = track->getCurFrame();
+	frame->nextFrameStartTime = track->getNextFrameStartTime();
+	frame->endOfTrack = track->endOfTrack();
+}
+
+bool VideoDecoder::trackEnded(const Track *track) const {
+	if (_decodeAhead && _decodeAhead->running && track == _decodeAhead->track)
+		return _decodeAhead->endOfTrack;
+
+	return track->endOfTrack();
+}
+
+int VideoDecoder::getTrackCurFrame(const VideoTrack *track) const {
+	if (_decodeAhead && _decodeAhead->running && track == _decodeAhead->track)
+		return _decodeAhead->curFrame;
+
+	return track->getCurFrame();
+}
+
+uint32 VideoDecoder::getTrackNextFrameStartTime(const VideoTrack *track) const {
+	if (_decodeAhead && _decodeAhead->running && track == _decodeAhead->track)
+		return _decodeAhead->nextFrameStartTime;
+
+	return track->getNextFrameStartTime();
+}
+
 VideoDecoder::Track::Track() {
 	_paused = false;
 }
@@ -841,7 +1133,7 @@ const VideoDecoder::Track *VideoDecoder::getTrack(uint track) const {
 
 bool VideoDecoder::endOfVideoTracks() const {
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
-		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !(*it)->endOfTrack())
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !trackEnded(*it))
 			return false;
 
 	return true;
@@ -852,9 +1144,9 @@ VideoDecoder::VideoTrack *VideoDecoder::findNextVideoTrack() {
 	uint32 bestTime = 0xFFFFFFFF;
 
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
-		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !(*it)->endOfTrack()) {
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !trackEnded(*it)) {
 			VideoTrack *track = (VideoTrack *)*it;
-			uint32 time = track->getNextFrameStartTime();
+			uint32 time = getTrackNextFrameStartTime(track);
 
 			if (time < bestTime) {
 				bestTime = time;
@@ -896,7 +1188,7 @@ bool VideoDecoder::hasFramesLeft() const {
 	// This is only used for needsUpdate() atm so that setEndTime() works properly
 	// And unlike endOfVideoTracks(), this takes into account _endTime
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
-		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !(*it)->endOfTrack() && (!isPlaying() || !_endTimeSet || ((VideoTrack *)*it)->getNextFrameStartTime() < (uint)_endTime.msecs()))
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !trackEnded(*it) && (!isPlaying() || !_endTimeSet || getTrackNextFrameStartTime((VideoTrack *)*it) < (uint)_endTime.msecs()))
 			return true;
 
 	return false;
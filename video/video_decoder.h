@@ -52,7 +52,7 @@ namespace Video {
 class VideoDecoder {
 public:
 	VideoDecoder();
-	virtual ~VideoDecoder() {}
+	virtual ~VideoDecoder();
 
 	/////////////////////////////////////////
 	// Opening/Closing a Video
@@ -355,6 +355,27 @@ public:
 	 */
 	virtual const Graphics::Surface *decodeNextFrame();
 
+	/**
+	 * Decode the next frame into a surface of the caller, such as the
+	 * area of the locked screen the video is shown in.
+	 *
+	 * Formats which support it write the frame directly into the surface,
+	 * in the pixel format of the surface, which saves copying the frame
+	 * and converting it afterwards. Other formats decode into their own
+	 * surface as usual, which is then copied into the given one.
+	 *
+	 * The surface must be at least as large as the video. Its pixel
+	 * format must either be the one of the video, or have 2 or 4 bytes
+	 * per pixel for videos which are not paletted either. This is
+	 * enforced before a frame is decoded.
+	 *
+	 * @param dst The surface to decode into
+	 * @return whether a frame was decoded into dst; if not, there was no
+	 *         frame to decode, dst is left unchanged and the last frame
+	 *         should be kept on screen
+	 */
+	bool decodeNextFrameInto(Graphics::Surface &dst);
+
 	/**
 	 * Set the default high color format for videos that convert from YUV.
 	 *
@@ -396,6 +417,27 @@ public:
 	 */
 	bool setDitheringPalette(const byte *palette);
 
+	/**
+	 * Decode frames ahead of time on a thread of their own.
+	 *
+	 * Up to the given number of frames are decoded in advance into a ring
+	 * of surfaces, so that decodeNextFrame() only has to wait for a frame
+	 * when decoding falls behind. Timing, seeking and the frame and palette
+	 * information work the same as when decoding on demand. The surface
+	 * returned by decodeNextFrame() stays valid until the next call.
+	 *
+	 * This only has an effect for formats which support it, with a single
+	 * video track, on builds with thread support. The default is taken
+	 * from the "video_decode_ahead" config key, and is 0 (off).
+	 *
+	 * This should be called before a decodeNextFrame() call. This is
+	 * enforced.
+	 *
+	 * @param frames The number of frames to decode ahead, 0 to disable
+	 * @return true on success, false otherwise
+	 */
+	bool setDecodeAhead(uint frames);
+
 	/////////////////////////////////////////
 	// Audio Control
 	/////////////////////////////////////////
@@ -591,6 +633,16 @@ protected:
 		 */
 		virtual const Graphics::Surface *decodeNextFrame() = 0;
 
+		/**
+		 * Set a surface of the caller to decode the next frame into, in
+		 * its pixel format, instead of the track's own surface. The
+		 * following decodeNextFrame() returns that surface. Passing 0
+		 * goes back to the track's own surface.
+		 *
+		 * @return false if the track cannot decode into this surface
+		 */
+		virtual bool setOutputSurface(Graphics::Surface *surface) { return false; }
+
 		/**
 		 * Get the palette currently in use by this track
 		 */
@@ -913,6 +965,25 @@ protected:
 	 */
 	virtual AudioTrack *getAudioTrack(int index) { return 0; }
 
+	/**
+	 * Can frames of this video be decoded ahead on another thread?
+	 *
+	 * Returning true means that readNextPacket() and the decodeNextFrame()
+	 * of the video track only change the state of this decoder and its
+	 * tracks, and that nothing else reads that state while a video is
+	 * played, besides the functions of VideoDecoder.
+	 *
+	 * @see setDecodeAhead()
+	 */
+	virtual bool canDecodeAhead() const { return false; }
+
+	/**
+	 * Set up what decoding frames of the track creates on first use and
+	 * shares with other threads, such as the tables of YUVToRGBMan. This is
+	 * called on the main thread before frames are decoded ahead.
+	 */
+	virtual void prepareDecodeAhead(VideoTrack *track) {}
+
 private:
 	// Tracks owned by this VideoDecoder
 	TrackList _tracks;
@@ -936,6 +1007,22 @@ private:
 	// Default PixelFormat settings
 	Graphics::PixelFormat _defaultHighColorFormat;
 
+	// Frames decoded ahead, see setDecodeAhead()
+	struct DecodeAhead;
+	struct DecodeAheadFrame;
+	DecodeAhead *_decodeAhead;
+	uint _decodeAheadFrames;
+
+	bool startDecodeAhead();
+	void stopDecodeAhead();
+	static void decodeAheadFrame(void *param);
+
+	// The state of a track as seen by the caller, which the track itself is
+	// ahead of while frames are decoded ahead
+	bool trackEnded(const Track *track) const;
+	int getTrackCurFrame(const VideoTrack *track) const;
+	uint32 getTrackNextFrameStartTime(const VideoTrack *track) const;
+
 	// Internal helper functions
 	void stopAudio();
 	void startAudio();